@@ -0,0 +1,1139 @@
+// Throughput benchmark: runs increasing numbers of bridges over the fake
+// backend, fed by stamped test-pattern sources, and measures each bridge
+// count for a fixed time. Reports sustained fps per bridge, process CPU time
+// per frame, frame bytes moved per second, stamp-to-send latency percentiles
+// and the largest bridge count that still met its deadlines. With --mosaic
+// each count is instead the number of tiles in one mosaic bridge, fed by
+// synthetic cameras, and the mosaic's scale and composition cost per output
+// frame is reported too. With --proxy-outputs each count is measured once
+// per proxy rung, and the CPU each extra rung adds per frame is reported.
+// With --receive-bandwidth all, ndi_to_spout counts are measured once per
+// NDI receive mode, with the CPU and modelled network ingest of each. With
+// --unwatched each spout_to_ndi count is measured again with that share of
+// outputs reporting no receivers, and the CPU their idling saves is
+// reported. With --change-box each bridge reads a synthetic source whose
+// only change per frame is a small moving box, each bridge converts for
+// itself, and each count is measured first with whole-frame conversion so
+// the share of pixels dirty-tile detection reused and the conversion time
+// it saved per frame can be reported. With --counters it instead times a
+// frame's conversion with and without the counter updates (BridgeStats.h)
+// a bridge makes for it, to check they stay under 1% of the frame's cost.
+// With --trace-overhead each count is measured again with frame tracing
+// (Trace.h) on, and the CPU per frame tracing adds is reported.
+// --save-latency writes the last count's latency histograms in the format
+// the GUI exports (.nslh), and --compare reads two such files and reports
+// how each metric's percentiles moved from the first to the second.
+// With --scaler it instead times the output scaler (Scaler.h) on its own
+// for common 4K and 1080p resizes, and scores each filter's output by PSNR
+// against a double-precision reference. Results are written as JSON so
+// builds and machines can be compared.
+
+#include "BridgeLauncher.h"
+#include "BridgeStats.h"
+#include "FakeBackend.h"
+#include "Mosaic.h"
+#include "Platform.h"
+#include "Scaler.h"
+#include "TestPattern.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct BenchSettings {
+        std::vector<unsigned int> bridgeCounts = { 1, 2, 4, 8, 16, 32, 64, 128 };
+        std::string pattern = "moving_box";
+        std::string size = "1920x1080";
+        std::string rate = "60";
+        std::string format = "rgba";
+        bool isSpoutToNDI = true;
+        bool dirtyTiles = true;
+        bool shareCapture = true;     // All bridges read the same source; share its capture
+        double warmupSeconds = 1.0;
+        double durationSeconds = 5.0;
+        unsigned int sendCostUs = 0;
+        double minFpsRatio = 0.95;    // A bridge below this share of the source rate missed its deadlines
+        bool keepGoing = false;       // Keep measuring larger counts after one misses its deadlines
+        std::string outputPath;
+        bool mosaic = false;          // Counts are tiles of one mosaic bridge
+        MosaicSettings mosaicOutput;
+        unsigned int outputWidth = 0; // Bridges resize to this before sending; 0 keeps the source size
+        unsigned int outputHeight = 0;
+        ScaleFilter scaleFilter = ScaleFilter::Bilinear;
+        unsigned int proxyOutputs = 0; // Measure every count with 0 .. this many proxy outputs
+        std::vector<ReceiveBandwidth> bandwidths = { ReceiveBandwidth::Highest };  // ndi_to_spout modes to measure
+        double unwatchedShare = 0.0;  // Also measure each count with this share of outputs unwatched
+        bool scaler = false;          // Benchmark the scaler alone instead of bridges
+        bool counters = false;        // Time counter updates against frame work instead of bridges
+        bool traceOverhead = false;   // Also measure each count with frame tracing on
+        std::string latencyPath;      // Write the last count's latency histograms here
+        std::string comparePaths[2];  // Compare two latency histogram files instead of measuring
+        unsigned int changeBox = 0;   // Read a synthetic source that changes only a box this wide
+
+        PatternSettings source;       // Parsed from pattern, size, rate and format
+    };
+
+    struct LevelResult {
+        unsigned int bridges = 0;
+        unsigned int proxyOutputs = 0;
+        ReceiveBandwidth bandwidth = ReceiveBandwidth::Highest;
+        double unwatchedShare = 0.0;
+        unsigned int unwatched = 0;          // Bridges whose outputs report no receivers; left out of fps
+        unsigned int started = 0;
+        double seconds = 0.0;
+        std::vector<double> bridgeFps;
+        double minFps = 0.0;
+        double meanFps = 0.0;
+        uint64_t framesOut = 0;
+        uint64_t stampedFrames = 0;
+        uint64_t missedFrames = 0;
+        double cpuUsPerFrame = 0.0;
+        double cpuCores = 0.0;        // Process CPU time over wall time
+        double bytesPerSecond = 0.0;  // Frame bytes converted and sent, all bridges
+        unsigned int sourceConnections = 0;  // Times the backend opened a source; 1 when captures are shared
+        double ingestBytesPerSecond = 0.0;   // Modelled network bytes the sources' connections pulled
+        double tileFramesPerSecond = 0.0;    // Mosaic only: source frames scaled into tiles
+        double scaleUsPerTileFrame = 0.0;
+        double composeUsPerFrame = 0.0;      // Mosaic only: scaling, copying and converting per output frame
+        double pyramidUsPerFrame = 0.0;      // Building proxy levels, per full-size frame
+        double rungCpuUsPerFrame = 0.0;      // CPU per frame added by the last proxy rung
+        double idleCpuSavedCores = 0.0;      // Against the same count with every output watched
+        double convertUsPerFrame = 0.0;      // Conversion stage time per frame out
+        double tileReuseRatio = 0.0;         // Share of output pixels copied from clean tiles
+        double tileSavedUsPerFrame = 0.0;    // Conversion against whole-frame conversion, per frame out
+        double tracedCpuUsPerFrame = 0.0;    // The same count with frame tracing on
+        HistogramSnapshot latency;
+        std::vector<LatencyReport> latencyReports;  // Per bridge, with --save-latency only
+        bool metDeadlines = false;
+    };
+
+    // One resize and filter in --scaler mode
+    struct ScalerResult {
+        unsigned int srcWidth = 0;
+        unsigned int srcHeight = 0;
+        unsigned int dstWidth = 0;
+        unsigned int dstHeight = 0;
+        ScaleFilter filter = ScaleFilter::Box;
+        double msPerFrame = 0.0;          // Caller thread only
+        double msPerFrameThreaded = 0.0;  // Default worker pool
+        double megapixelsPerSecond = 0.0; // Output pixels, default worker pool
+        std::vector<std::pair<std::string, double>> psnr;  // Per pattern, dB against the reference
+    };
+
+    // --counters: the same frame work timed without and with counter updates
+    struct CountersResult {
+        uint64_t frames = 0;          // Frames done with counters; about as many without
+        double offUsPerFrame = 0.0;
+        double onUsPerFrame = 0.0;
+
+        double OverheadPercent() const {
+            return offUsPerFrame > 0.0 ? 100.0 * (onUsPerFrame - offUsPerFrame) / offUsPerFrame : 0.0;
+        }
+    };
+
+    const double kCounterBudgetPercent = 1.0;
+
+    void PrintUsage(const char* program) {
+        fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --bridges <list>         Bridge counts to measure, e.g. 1,4,16 (default 1,2,4,...,128)\n"
+            "  --pattern <kind>         bars, ramp, moving_box or noise (default moving_box)\n"
+            "  --size <WxH>             Source resolution (default 1920x1080)\n"
+            "  --rate <fps>             Source frame rate, N or N/D (default 60)\n"
+            "  --format <rgba|bgra>     Source pixel format (default rgba)\n"
+            "  --direction <dir>        spout_to_ndi or ndi_to_spout (default spout_to_ndi)\n"
+            "  --no-dirty-tiles         Convert whole frames\n"
+            "  --no-share-capture       Give every bridge its own capture and conversion\n"
+            "  --warmup <sec>           Unmeasured time before each count (default 1)\n"
+            "  --duration <sec>         Measured time per count (default 5)\n"
+            "  --send-cost-us <us>      Simulated encode/transmit time per frame (default 0)\n"
+            "  --min-fps-ratio <r>      Deadline: every bridge keeps this share of the rate (default 0.95)\n"
+            "  --keep-going             Measure every count even after one misses its deadlines\n"
+            "  --output <file>          Write JSON here instead of standard output\n"
+            "  --mosaic                 Counts are tiles of one ndi_to_spout mosaic bridge, e.g. --bridges 4,9,16\n"
+            "  --mosaic-size <WxH>      Mosaic output resolution (default 1920x1080); --rate sets its cadence\n"
+            "  --no-mosaic-proxy        Feed mosaic tiles full-resolution streams\n"
+            "  --output-size <WxH>      Bridges resize frames to this before sending\n"
+            "  --scale-filter <f>       box, bilinear or lanczos (default bilinear)\n"
+            "  --proxy-outputs <n>      Measure each count with 0..n proxy outputs (1/2, 1/4 size), up to 2\n"
+            "  --receive-bandwidth <m>  ndi_to_spout receive mode: highest, lowest, audio_only, metadata_only\n"
+            "                           or all to measure each count in every mode (default highest)\n"
+            "  --unwatched <r>          Also measure each spout_to_ndi count with this share (0-1] of outputs\n"
+            "                           unwatched, and report the CPU their idling saves\n"
+            "  --change-box <px>        Bridges read a synthetic source that changes only a box this many\n"
+            "                           pixels square; reports the tile reuse ratio and conversion saved.\n"
+            "                           spout_to_ndi only, without capture sharing\n"
+            "  --trace-overhead         Measure each count again with frame tracing on; reports the CPU it adds\n"
+            "  --save-latency <file>    Write the last count's latency histograms (.nslh, as the GUI exports)\n"
+            "  --compare <a> <b>        Compare two latency histogram files and report the change a to b\n"
+            "  --counters               Time per-frame counter updates against the conversion they count\n"
+            "  --scaler                 Time and score the scaler alone; --duration sets the time per resize x10\n",
+            program);
+    }
+
+    bool ParseCounts(const std::string& list, std::vector<unsigned int>& counts) {
+        counts.clear();
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            int count = atoi(item.c_str());
+            if (count < 1 || count > 128) return false;
+            counts.push_back((unsigned int)count);
+        }
+        std::sort(counts.begin(), counts.end());
+        counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+        return !counts.empty();
+    }
+
+    const char* BandwidthName(ReceiveBandwidth bandwidth) {
+        switch (bandwidth) {
+            case ReceiveBandwidth::Lowest:       return "lowest";
+            case ReceiveBandwidth::AudioOnly:    return "audio_only";
+            case ReceiveBandwidth::MetadataOnly: return "metadata_only";
+            default:                             return "highest";
+        }
+    }
+
+    std::string SourceName(const BenchSettings& settings) {
+        return std::string(kPatternSourcePrefix) + settings.pattern + "," + settings.size + "," +
+               settings.rate + "," + settings.format;
+    }
+
+    bool ParseArguments(int argc, char* argv[], BenchSettings& settings) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--bridges" && hasValue) {
+                if (!ParseCounts(argv[++i], settings.bridgeCounts)) return false;
+            }
+            else if (arg == "--pattern" && hasValue) settings.pattern = argv[++i];
+            else if (arg == "--size" && hasValue) settings.size = argv[++i];
+            else if (arg == "--rate" && hasValue) settings.rate = argv[++i];
+            else if (arg == "--format" && hasValue) settings.format = argv[++i];
+            else if (arg == "--direction" && hasValue) {
+                std::string direction = argv[++i];
+                if (direction == "spout_to_ndi") settings.isSpoutToNDI = true;
+                else if (direction == "ndi_to_spout") settings.isSpoutToNDI = false;
+                else return false;
+            }
+            else if (arg == "--no-dirty-tiles") settings.dirtyTiles = false;
+            else if (arg == "--no-share-capture") settings.shareCapture = false;
+            else if (arg == "--warmup" && hasValue) settings.warmupSeconds = atof(argv[++i]);
+            else if (arg == "--duration" && hasValue) settings.durationSeconds = atof(argv[++i]);
+            else if (arg == "--send-cost-us" && hasValue) settings.sendCostUs = (unsigned int)atoi(argv[++i]);
+            else if (arg == "--min-fps-ratio" && hasValue) settings.minFpsRatio = atof(argv[++i]);
+            else if (arg == "--keep-going") settings.keepGoing = true;
+            else if (arg == "--output" && hasValue) settings.outputPath = argv[++i];
+            else if (arg == "--mosaic") settings.mosaic = true;
+            else if (arg == "--mosaic-size" && hasValue) {
+                if (sscanf(argv[++i], "%ux%u", &settings.mosaicOutput.width, &settings.mosaicOutput.height) != 2 ||
+                    settings.mosaicOutput.width < 16 || settings.mosaicOutput.height < 16) {
+                    return false;
+                }
+            }
+            else if (arg == "--no-mosaic-proxy") settings.mosaicOutput.proxy = false;
+            else if (arg == "--output-size" && hasValue) {
+                if (sscanf(argv[++i], "%ux%u", &settings.outputWidth, &settings.outputHeight) != 2 ||
+                    settings.outputWidth < 16 || settings.outputHeight < 16) {
+                    return false;
+                }
+            }
+            else if (arg == "--scale-filter" && hasValue) {
+                std::string filter = argv[++i];
+                if (filter == "box") settings.scaleFilter = ScaleFilter::Box;
+                else if (filter == "bilinear") settings.scaleFilter = ScaleFilter::Bilinear;
+                else if (filter == "lanczos") settings.scaleFilter = ScaleFilter::Lanczos;
+                else return false;
+            }
+            else if (arg == "--proxy-outputs" && hasValue) {
+                settings.proxyOutputs = (unsigned int)atoi(argv[++i]);
+                if (settings.proxyOutputs > FramePyramid::kMaxLevels) return false;
+            }
+            else if (arg == "--receive-bandwidth" && hasValue) {
+                std::string mode = argv[++i];
+                const ReceiveBandwidth modes[] = { ReceiveBandwidth::Highest, ReceiveBandwidth::Lowest,
+                                                   ReceiveBandwidth::AudioOnly, ReceiveBandwidth::MetadataOnly };
+                settings.bandwidths.clear();
+                for (ReceiveBandwidth bandwidth : modes) {
+                    if (mode == "all" || mode == BandwidthName(bandwidth)) settings.bandwidths.push_back(bandwidth);
+                }
+                if (settings.bandwidths.empty()) return false;
+            }
+            else if (arg == "--unwatched" && hasValue) {
+                settings.unwatchedShare = atof(argv[++i]);
+                if (settings.unwatchedShare <= 0.0 || settings.unwatchedShare > 1.0) return false;
+            }
+            else if (arg == "--change-box" && hasValue) {
+                int size = atoi(argv[++i]);
+                if (size < 1) return false;
+                settings.changeBox = (unsigned int)size;
+            }
+            else if (arg == "--scaler") settings.scaler = true;
+            else if (arg == "--counters") settings.counters = true;
+            else if (arg == "--trace-overhead") settings.traceOverhead = true;
+            else if (arg == "--save-latency" && hasValue) settings.latencyPath = argv[++i];
+            else if (arg == "--compare" && i + 2 < argc) {
+                settings.comparePaths[0] = argv[++i];
+                settings.comparePaths[1] = argv[++i];
+            }
+            else return false;
+        }
+        if (settings.durationSeconds <= 0 || settings.warmupSeconds < 0) return false;
+        if (settings.proxyOutputs > 0 && (!settings.isSpoutToNDI || settings.mosaic)) {
+            fprintf(stderr, "Proxy outputs are sent by spout_to_ndi bridges\n");
+            return false;
+        }
+        if ((settings.bandwidths.size() > 1 || settings.bandwidths[0] != ReceiveBandwidth::Highest) &&
+            (settings.isSpoutToNDI || settings.mosaic)) {
+            fprintf(stderr, "Receive modes apply to ndi_to_spout bridges\n");
+            return false;
+        }
+        if (settings.changeBox > 0 && (!settings.isSpoutToNDI || settings.mosaic)) {
+            fprintf(stderr, "Dirty tiles are used by spout_to_ndi bridges\n");
+            return false;
+        }
+        if (settings.changeBox > 0) {
+            settings.shareCapture = false;   // A shared capture converts whole frames once for everyone
+        }
+        if (settings.unwatchedShare > 0.0 && (!settings.isSpoutToNDI || settings.mosaic)) {
+            fprintf(stderr, "Only spout_to_ndi bridges idle without receivers\n");
+            return false;
+        }
+
+        std::string error;
+        if (!ParsePatternSourceName(SourceName(settings), settings.source, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        if (settings.source.format == PixelFormat::UYVY) {
+            fprintf(stderr, "Bridges carry rgba or bgra frames\n");
+            return false;
+        }
+        settings.mosaicOutput.frameRateN = settings.source.frameRateN;
+        settings.mosaicOutput.frameRateD = settings.source.frameRateD;
+        return true;
+    }
+
+    void SleepSeconds(double seconds) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+
+    // What the counters read at the start and end of the measured window
+    struct Sample {
+        uint64_t timeNs = 0;
+        uint64_t cpuNs = 0;
+        std::map<std::string, BridgeStats> bridges;
+        std::map<std::string, FakeSinkReport> sinks;
+        uint64_t ingestBytes = 0;
+        MosaicStats mosaic;
+    };
+
+    Sample TakeSample(const BridgeList& bridges, const FakeBackend& backend) {
+        Sample sample;
+        sample.timeNs = Platform::NowNs();
+        sample.cpuNs = Platform::ProcessCpuTimeNs();
+        for (const auto& bridge : bridges) {
+            sample.bridges[bridge->GetBridgeName()] = bridge->GetStats();
+        }
+        for (const FakeSinkReport& report : backend.GetSinkReports()) {
+            sample.sinks[report.name] = report;
+        }
+        for (const FakeSourceReport& report : backend.GetSourceReports()) {
+            sample.ingestBytes += report.ingestBytes;
+        }
+        sample.mosaic = GetMosaicStats();
+        return sample;
+    }
+
+    LevelResult RunLevel(const BenchSettings& settings, unsigned int count, unsigned int proxyOutputs,
+                         ReceiveBandwidth bandwidth, double unwatchedShare) {
+        LevelResult result;
+        result.bridges = count;
+        result.proxyOutputs = proxyOutputs;
+        result.bandwidth = bandwidth;
+        result.unwatchedShare = unwatchedShare;
+        result.unwatched = (unsigned int)(count * unwatchedShare + 0.5);
+
+        FakeSinkSettings sinkSettings;
+        sinkSettings.sendCostUs = settings.sendCostUs;
+        FakeSourceSettings cameraSettings;
+        cameraSettings.width = settings.source.width;
+        cameraSettings.height = settings.source.height;
+        cameraSettings.frameRate = (double)settings.source.frameRateN / settings.source.frameRateD;
+        cameraSettings.changeBoxSize = settings.changeBox;
+        cameraSettings.stampFrames = settings.changeBox > 0;   // The stamp rows stay dirty too
+        auto backend = std::make_shared<FakeBackend>(cameraSettings, sinkSettings);
+
+        std::vector<BridgeDefinition> definitions;
+        if (settings.mosaic) {
+            // One mosaic over count synthetic cameras
+            BridgeDefinition definition;
+            definition.id = "bench-mosaic";
+            definition.name = "Bench Mosaic";
+            definition.source = kMosaicSourcePrefix;
+            for (unsigned int i = 0; i < count; i++) {
+                definition.source += (i ? "|Bench Camera " : "Bench Camera ") + std::to_string(i + 1);
+            }
+            definition.isSpoutToNDI = false;
+            definition.options.mosaic = settings.mosaicOutput;
+            definition.options.outputWidth = settings.outputWidth;
+            definition.options.outputHeight = settings.outputHeight;
+            definition.options.scaleFilter = settings.scaleFilter;
+            definitions.push_back(definition);
+        }
+        for (unsigned int i = 0; i < count && !settings.mosaic; i++) {
+            BridgeDefinition definition;
+            definition.id = "bench-" + std::to_string(i + 1);
+            definition.name = "Bench " + std::to_string(i + 1);
+            definition.source = settings.changeBox > 0 ? "Bench Camera" : SourceName(settings);
+            definition.isSpoutToNDI = settings.isSpoutToNDI;
+            definition.options.dirtyTiles = settings.dirtyTiles;
+            definition.options.shareCapture = settings.shareCapture;
+            definition.options.outputWidth = settings.outputWidth;
+            definition.options.outputHeight = settings.outputHeight;
+            definition.options.scaleFilter = settings.scaleFilter;
+            definition.options.proxyOutputs = proxyOutputs;
+            definition.options.receiveBandwidth = bandwidth;
+            definitions.push_back(definition);
+        }
+
+        // The first bridges' outputs and proxies have nobody receiving them;
+        // the rest can't tell, so they stay watched
+        std::map<std::string, bool> unwatchedNames;
+        for (unsigned int i = 0; i < result.unwatched && i < definitions.size(); i++) {
+            const std::string& name = definitions[i].name;
+            unwatchedNames[name] = true;
+            backend->SetSinkConnections(name, 0);
+            for (unsigned int level = 1; level <= proxyOutputs; level++) {
+                backend->SetSinkConnections(ProxyOutputName(name, level), 0);
+            }
+        }
+
+        // Bridges take the process default backend when they are created
+        SetDefaultFrameBackend(backend);
+        std::vector<std::string> errors;
+        BridgeList bridges = StartBridges(definitions, errors);
+        SetDefaultFrameBackend(nullptr);
+        for (const std::string& message : errors) {
+            fprintf(stderr, "%s\n", message.c_str());
+        }
+        result.started = (unsigned int)bridges.size();
+
+        SleepSeconds(settings.warmupSeconds);
+        Sample start = TakeSample(bridges, *backend);
+        SleepSeconds(settings.durationSeconds);
+        Sample end = TakeSample(bridges, *backend);
+        if (!settings.latencyPath.empty()) {
+            for (const auto& bridge : bridges) {
+                result.latencyReports.push_back(bridge->GetLatencyReport());
+            }
+        }
+
+        for (auto& bridge : bridges) {
+            bridge->RequestStop();
+        }
+        for (auto& bridge : bridges) {
+            bridge->Stop();
+        }
+
+        for (const FakeSourceReport& report : backend->GetSourceReports()) {
+            result.sourceConnections += (unsigned int)report.opens;
+        }
+
+        result.seconds = (end.timeNs - start.timeNs) / 1e9;
+        uint64_t bytes = 0;
+        uint64_t pyramidNs = 0;
+        uint64_t converted = 0;
+        uint64_t reused = 0;
+        uint64_t convertNs = 0;
+        for (const auto& entry : end.bridges) {
+            if (unwatchedNames.count(entry.first)) continue;
+            const BridgeStats& before = start.bridges[entry.first];
+            uint64_t frames = entry.second.framesOut - before.framesOut;
+            result.bridgeFps.push_back(frames / result.seconds);
+            result.framesOut += frames;
+            bytes += entry.second.bytesProcessed - before.bytesProcessed;
+            pyramidNs += entry.second.Stage(PipelineStage::Scale).totalNs - before.Stage(PipelineStage::Scale).totalNs;
+            converted += entry.second.pixelsConverted - before.pixelsConverted;
+            reused += entry.second.pixelsReused - before.pixelsReused;
+            convertNs += entry.second.Stage(PipelineStage::Convert).totalNs - before.Stage(PipelineStage::Convert).totalNs;
+        }
+        result.convertUsPerFrame = result.framesOut ? convertNs / 1e3 / result.framesOut : 0.0;
+        if (converted + reused > 0) {
+            result.tileReuseRatio = (double)reused / (converted + reused);
+        }
+        if (proxyOutputs > 0 && settings.outputWidth == 0) {
+            result.pyramidUsPerFrame = result.framesOut ? pyramidNs / 1e3 / result.framesOut : 0.0;
+        }
+        for (const auto& entry : end.sinks) {
+            // Latency and stamps are read from the full-size outputs only
+            if (!end.bridges.count(entry.first) || unwatchedNames.count(entry.first)) continue;
+            const FakeSinkReport& before = start.sinks[entry.first];
+            result.stampedFrames += entry.second.stamped - before.stamped;
+            result.missedFrames += entry.second.missed - before.missed;
+            result.latency.Merge(entry.second.latency.Since(before.latency));
+        }
+
+        if (!result.bridgeFps.empty()) {
+            result.minFps = *std::min_element(result.bridgeFps.begin(), result.bridgeFps.end());
+            result.meanFps = result.framesOut / result.seconds / result.bridgeFps.size();
+        }
+        uint64_t cpuNs = end.cpuNs - start.cpuNs;
+        result.cpuUsPerFrame = result.framesOut ? cpuNs / 1e3 / result.framesOut : 0.0;
+        result.cpuCores = cpuNs / 1e9 / result.seconds;
+        result.bytesPerSecond = bytes / result.seconds;
+        result.ingestBytesPerSecond = (end.ingestBytes - start.ingestBytes) / result.seconds;
+
+        uint64_t outputFrames = end.mosaic.outputFrames - start.mosaic.outputFrames;
+        uint64_t tileFrames = end.mosaic.tileFrames - start.mosaic.tileFrames;
+        uint64_t scaleNs = end.mosaic.scaleNs - start.mosaic.scaleNs;
+        uint64_t composeNs = end.mosaic.composeNs - start.mosaic.composeNs;
+        result.tileFramesPerSecond = tileFrames / result.seconds;
+        result.scaleUsPerTileFrame = tileFrames ? scaleNs / 1e3 / tileFrames : 0.0;
+        result.composeUsPerFrame = outputFrames ? (scaleNs + composeNs) / 1e3 / outputFrames : 0.0;
+
+        // Audio- and metadata-only receivers and unwatched outputs have no frames to be late
+        double targetFps = (double)settings.source.frameRateN / settings.source.frameRateD;
+        double periodNs = 1e9 / targetFps;
+        result.metDeadlines = result.started == definitions.size() &&
+                              (!ReceivesVideo(bandwidth) || result.bridgeFps.empty() ||
+                               (result.minFps >= settings.minFpsRatio * targetFps &&
+                                result.latency.ValueAtPercentile(99.0) <= periodNs));
+        return result;
+    }
+
+    void WriteEscaped(std::ostream& out, const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if ((unsigned char)c < 0x20) out << ' ';
+            else out << c;
+        }
+    }
+
+    void WriteJson(std::ostream& out, const BenchSettings& settings, const std::vector<LevelResult>& results) {
+        // Counts only qualify with every proxy rung running
+        unsigned int maxBridges = 0;
+        for (const LevelResult& result : results) {
+            if (result.proxyOutputs != settings.proxyOutputs || result.bandwidth != settings.bandwidths.back() ||
+                result.unwatchedShare != settings.unwatchedShare) {
+                continue;
+            }
+            if (!result.metDeadlines) break;
+            maxBridges = result.bridges;
+        }
+
+        out << "{\n  \"benchmark\": \"bridge-throughput\",\n  \"config\": {\n    \"source\": \"";
+        WriteEscaped(out, SourceName(settings));
+        out << "\",\n    \"width\": " << settings.source.width
+            << ",\n    \"height\": " << settings.source.height
+            << ",\n    \"frameRateN\": " << settings.source.frameRateN
+            << ",\n    \"frameRateD\": " << settings.source.frameRateD
+            << ",\n    \"direction\": \"" << (settings.isSpoutToNDI ? "spout_to_ndi" : "ndi_to_spout")
+            << "\",\n    \"dirtyTiles\": " << (settings.dirtyTiles ? "true" : "false")
+            << ",\n    \"shareCapture\": " << (settings.shareCapture ? "true" : "false")
+            << ",\n    \"sendCostUs\": " << settings.sendCostUs
+            << ",\n    \"warmupSeconds\": " << settings.warmupSeconds
+            << ",\n    \"durationSeconds\": " << settings.durationSeconds
+            << ",\n    \"minFpsRatio\": " << settings.minFpsRatio
+            << ",\n    \"mosaic\": " << (settings.mosaic ? "true" : "false")
+            << ",\n    \"proxyOutputs\": " << settings.proxyOutputs
+            << ",\n    \"unwatchedShare\": " << settings.unwatchedShare
+            << ",\n    \"changeBox\": " << settings.changeBox
+            << ",\n    \"traceOverhead\": " << (settings.traceOverhead ? "true" : "false");
+        if (settings.mosaic) {
+            out << ",\n    \"mosaicWidth\": " << settings.mosaicOutput.width
+                << ",\n    \"mosaicHeight\": " << settings.mosaicOutput.height
+                << ",\n    \"mosaicProxy\": " << (settings.mosaicOutput.proxy ? "true" : "false");
+        }
+        if (settings.outputWidth > 0) {
+            out << ",\n    \"outputWidth\": " << settings.outputWidth
+                << ",\n    \"outputHeight\": " << settings.outputHeight
+                << ",\n    \"scaleFilter\": \"" << ScaleFilterName(settings.scaleFilter) << "\"";
+        }
+        out
+            << "\n  },\n  \"machine\": {\n    \"hardwareThreads\": " << std::thread::hardware_concurrency()
+            << "\n  },\n  \"results\": [";
+
+        for (size_t i = 0; i < results.size(); i++) {
+            const LevelResult& r = results[i];
+            out << (i ? "," : "") << "\n    {\n      \"" << (settings.mosaic ? "tiles" : "bridges") << "\": " << r.bridges;
+            if (settings.proxyOutputs > 0) {
+                out << ",\n      \"proxyOutputs\": " << r.proxyOutputs;
+            }
+            if (!settings.isSpoutToNDI && !settings.mosaic) {
+                out << ",\n      \"receiveBandwidth\": \"" << BandwidthName(r.bandwidth) << "\"";
+            }
+            if (settings.unwatchedShare > 0.0) {
+                out << ",\n      \"unwatchedBridges\": " << r.unwatched;
+            }
+            out << ",\n      \"started\": " << r.started
+                << ",\n      \"metDeadlines\": " << (r.metDeadlines ? "true" : "false")
+                << ",\n      \"seconds\": " << r.seconds
+                << ",\n      \"minFps\": " << r.minFps
+                << ",\n      \"meanFps\": " << r.meanFps
+                << ",\n      \"bridgeFps\": [";
+            for (size_t b = 0; b < r.bridgeFps.size(); b++) {
+                out << (b ? ", " : "") << r.bridgeFps[b];
+            }
+            out << "],\n      \"framesOut\": " << r.framesOut
+                << ",\n      \"stampedFrames\": " << r.stampedFrames
+                << ",\n      \"missedFrames\": " << r.missedFrames
+                << ",\n      \"cpuUsPerFrame\": " << r.cpuUsPerFrame
+                << ",\n      \"cpuCores\": " << r.cpuCores
+                << ",\n      \"bytesPerSecond\": " << (uint64_t)r.bytesPerSecond
+                << ",\n      \"sourceConnections\": " << r.sourceConnections
+                << ",\n      \"ingestBytesPerSecond\": " << (uint64_t)r.ingestBytesPerSecond
+                << ",\n      \"cpuCoresPerBridge\": " << (r.bridges ? r.cpuCores / r.bridges : 0.0)
+                << ",\n      \"ingestBytesPerSecondPerBridge\": " << (uint64_t)(r.bridges ? r.ingestBytesPerSecond / r.bridges : 0.0);
+            if (settings.mosaic) {
+                out << ",\n      \"tileFramesPerSecond\": " << r.tileFramesPerSecond
+                    << ",\n      \"scaleUsPerTileFrame\": " << r.scaleUsPerTileFrame
+                    << ",\n      \"composeUsPerFrame\": " << r.composeUsPerFrame;
+            }
+            if (r.unwatched > 0) {
+                out << ",\n      \"idleCpuSavedCores\": " << r.idleCpuSavedCores
+                    << ",\n      \"idleCpuSavedCoresPerBridge\": " << r.idleCpuSavedCores / r.unwatched;
+            }
+            if (settings.dirtyTiles && !settings.mosaic) {
+                out << ",\n      \"convertUsPerFrame\": " << r.convertUsPerFrame
+                    << ",\n      \"tileReuseRatio\": " << r.tileReuseRatio;
+            }
+            if (settings.changeBox > 0 && settings.dirtyTiles) {
+                out << ",\n      \"tileSavedUsPerFrame\": " << r.tileSavedUsPerFrame;
+            }
+            if (settings.traceOverhead) {
+                out << ",\n      \"tracedCpuUsPerFrame\": " << r.tracedCpuUsPerFrame
+                    << ",\n      \"traceCpuUsPerFrame\": " << r.tracedCpuUsPerFrame - r.cpuUsPerFrame;
+            }
+            if (settings.proxyOutputs > 0) {
+                out << ",\n      \"pyramidUsPerFrame\": " << r.pyramidUsPerFrame
+                    << ",\n      \"rungCpuUsPerFrame\": " << r.rungCpuUsPerFrame;
+            }
+            out
+                << ",\n      \"latencyUs\": { \"p50\": " << r.latency.ValueAtPercentile(50.0) / 1e3
+                << ", \"p99\": " << r.latency.ValueAtPercentile(99.0) / 1e3
+                << ", \"p999\": " << r.latency.ValueAtPercentile(99.9) / 1e3
+                << ", \"max\": " << r.latency.MaxNs() / 1e3 << " }\n    }";
+        }
+        out << "\n  ],\n  \"maxBridgesMeetingDeadlines\": " << maxBridges << "\n}\n";
+    }
+
+    // Straightforward resize in doubles from the same kernels, with the same
+    // edge handling, that FrameScaler's fixed-point banks approximate
+    std::vector<double> ReferenceScale(const VideoFrame& src, ScaleFilter filter, unsigned int dstWidth,
+                                       unsigned int dstHeight) {
+        struct Tap { unsigned int position; double weight; };
+        auto weightsFor = [&](unsigned int srcSize, unsigned int dstSize) {
+            double scale = (double)srcSize / dstSize;
+            double stretch = std::max(1.0, scale);
+            double radius = ScaleKernelRadius(filter) * stretch;
+            std::vector<std::vector<Tap>> taps(dstSize);
+            for (unsigned int i = 0; i < dstSize; i++) {
+                double center = (i + 0.5) * scale - 0.5;
+                double sum = 0.0;
+                for (int x = (int)std::floor(center - radius); x <= (int)std::ceil(center + radius); x++) {
+                    double weight = ScaleKernel(filter, (x - center) / stretch);
+                    if (weight == 0.0) continue;
+                    taps[i].push_back({ (unsigned int)std::max(0, std::min(x, (int)srcSize - 1)), weight });
+                    sum += weight;
+                }
+                for (Tap& tap : taps[i]) tap.weight /= sum;
+            }
+            return taps;
+        };
+        std::vector<std::vector<Tap>> columns = weightsFor(src.width, dstWidth);
+        std::vector<std::vector<Tap>> rows = weightsFor(src.height, dstHeight);
+
+        std::vector<double> horizontal((size_t)src.height * dstWidth * 4);
+        for (unsigned int y = 0; y < src.height; y++) {
+            const unsigned char* line = src.data + y * src.strideBytes;
+            for (unsigned int x = 0; x < dstWidth; x++) {
+                for (int c = 0; c < 4; c++) {
+                    double total = 0.0;
+                    for (const Tap& tap : columns[x]) total += tap.weight * line[tap.position * 4 + c];
+                    horizontal[((size_t)y * dstWidth + x) * 4 + c] = total;
+                }
+            }
+        }
+        std::vector<double> result((size_t)dstHeight * dstWidth * 4);
+        for (unsigned int y = 0; y < dstHeight; y++) {
+            for (size_t i = 0; i < (size_t)dstWidth * 4; i++) {
+                double total = 0.0;
+                for (const Tap& tap : rows[y]) total += tap.weight * horizontal[tap.position * (size_t)dstWidth * 4 + i];
+                result[y * (size_t)dstWidth * 4 + i] = std::min(255.0, std::max(0.0, total));
+            }
+        }
+        return result;
+    }
+
+    double Psnr(const std::vector<unsigned char>& pixels, const std::vector<double>& reference) {
+        double squares = 0.0;
+        for (size_t i = 0; i < pixels.size(); i++) {
+            double error = pixels[i] - reference[i];
+            squares += error * error;
+        }
+        double mse = squares / pixels.size();
+        return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+    }
+
+    // Mean time per Scale call over about seconds of repeated calls
+    double TimeScale(FrameScaler& scaler, const VideoFrame& src, ScaleFilter filter, std::vector<unsigned char>& dst,
+                     unsigned int dstWidth, unsigned int dstHeight, double seconds) {
+        scaler.Scale(src, filter, dst.data(), dstWidth, dstHeight, (size_t)dstWidth * 4);
+        uint64_t start = Platform::NowNs();
+        uint64_t end = start;
+        unsigned int calls = 0;
+        while (calls < 3 || end - start < seconds * 1e9) {
+            scaler.Scale(src, filter, dst.data(), dstWidth, dstHeight, (size_t)dstWidth * 4);
+            calls++;
+            end = Platform::NowNs();
+        }
+        return (end - start) / 1e6 / calls;
+    }
+
+    std::vector<ScalerResult> RunScaler(const BenchSettings& settings) {
+        const unsigned int resizes[][4] = {
+            { 3840, 2160, 1920, 1080 }, { 3840, 2160, 1280, 720 }, { 1920, 1080, 1280, 720 }, { 1920, 1080, 640, 360 }
+        };
+        const std::pair<const char*, PatternKind> patterns[] = {
+            { "bars", PatternKind::Bars }, { "ramp", PatternKind::Ramp }, { "noise", PatternKind::Noise }
+        };
+        const ScaleFilter filters[] = { ScaleFilter::Box, ScaleFilter::Bilinear, ScaleFilter::Lanczos };
+        double seconds = settings.durationSeconds / 10;
+
+        std::vector<ScalerResult> results;
+        for (const auto& resize : resizes) {
+            // Every pattern at this source size, rendered once
+            std::vector<std::vector<unsigned char>> images;
+            std::vector<VideoFrame> frames;
+            for (const auto& pattern : patterns) {
+                PatternSettings patternSettings;
+                patternSettings.kind = pattern.second;
+                patternSettings.width = resize[0];
+                patternSettings.height = resize[1];
+                PatternGenerator generator(patternSettings);
+                images.emplace_back(generator.GetFrameBytes());
+                generator.Render(images.back().data(), 0);
+            }
+            for (auto& image : images) {
+                VideoFrame frame;
+                frame.data = image.data();
+                frame.width = resize[0];
+                frame.height = resize[1];
+                frame.strideBytes = (size_t)resize[0] * 4;
+                frame.format = PixelFormat::RGBA;
+                frames.push_back(frame);
+            }
+
+            for (ScaleFilter filter : filters) {
+                ScalerResult result;
+                result.srcWidth = resize[0];
+                result.srcHeight = resize[1];
+                result.dstWidth = resize[2];
+                result.dstHeight = resize[3];
+                result.filter = filter;
+                std::vector<unsigned char> output((size_t)result.dstWidth * result.dstHeight * 4);
+
+                FrameScaler single(0);
+                FrameScaler threaded;
+                result.msPerFrame = TimeScale(single, frames[0], filter, output, result.dstWidth, result.dstHeight, seconds);
+                result.msPerFrameThreaded = TimeScale(threaded, frames[0], filter, output, result.dstWidth,
+                                                      result.dstHeight, seconds);
+                result.megapixelsPerSecond = (double)result.dstWidth * result.dstHeight / 1e3 / result.msPerFrameThreaded;
+
+                for (size_t i = 0; i < frames.size(); i++) {
+                    single.Scale(frames[i], filter, output.data(), result.dstWidth, result.dstHeight,
+                                 (size_t)result.dstWidth * 4);
+                    double psnr = Psnr(output, ReferenceScale(frames[i], filter, result.dstWidth, result.dstHeight));
+                    result.psnr.emplace_back(patterns[i].first, psnr);
+                }
+
+                fprintf(stderr, "%ux%u -> %ux%u %-8s %6.2f ms, %6.2f ms threaded, %7.1f MP/s, PSNR",
+                        result.srcWidth, result.srcHeight, result.dstWidth, result.dstHeight, ScaleFilterName(filter),
+                        result.msPerFrame, result.msPerFrameThreaded, result.megapixelsPerSecond);
+                for (const auto& score : result.psnr) {
+                    fprintf(stderr, " %s %.1f", score.first.c_str(), score.second);
+                }
+                fprintf(stderr, " dB\n");
+                results.push_back(result);
+            }
+        }
+        return results;
+    }
+
+    // The R/B swap a bridge does on every pixel of a frame
+    void SwapRedBlue(unsigned char* pixels, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            std::swap(pixels[i * 4], pixels[i * 4 + 2]);
+        }
+    }
+
+    CountersResult RunCounters(const BenchSettings& settings) {
+        using Clock = std::chrono::steady_clock;
+        auto toNs = [](Clock::duration d) {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        };
+
+        PatternGenerator generator(settings.source);
+        std::vector<unsigned char> pixels(generator.GetFrameBytes());
+        generator.Render(pixels.data(), 0);
+        size_t count = (size_t)settings.source.width * settings.source.height;
+
+        // Another thread snapshots the counters as the UI and metrics endpoint do
+        BridgeCounters counters;
+        std::atomic<bool> done(false);
+        std::thread reader([&] {
+            while (!done.load()) {
+                BridgeStats stats = counters.Snapshot();
+                (void)stats;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        });
+
+        // What a bridge records around one captured, converted and sent frame
+        auto frameWithCounters = [&] {
+            Clock::time_point captureEnd = Clock::now();
+            counters.UpdateRate(toNs(captureEnd.time_since_epoch()));
+            counters.AddFramesIn();
+            counters.RecordStage(PipelineStage::Capture, 0);
+            SwapRedBlue(pixels.data(), count);
+            Clock::time_point sendStart = Clock::now();
+            counters.RecordStage(PipelineStage::Convert, toNs(sendStart - captureEnd));
+            counters.AddPixels(count, 0);
+            Clock::time_point sendEnd = Clock::now();
+            counters.RecordStage(PipelineStage::Send, toNs(sendEnd - sendStart));
+            counters.AddBytesProcessed(count * 4);
+            counters.AddFramesOut();
+            counters.SetFirstFrameOut(toNs(sendEnd.time_since_epoch()));
+            counters.SetQueueDepth(0);
+            counters.SetPoolBytes(pixels.size());
+        };
+
+        uint64_t warmupEnd = Platform::NowNs() + (uint64_t)(settings.warmupSeconds * 1e9);
+        while (Platform::NowNs() < warmupEnd) SwapRedBlue(pixels.data(), count);
+
+        // Short turns of each, alternating, so clock boosts and other load hit both alike
+        const int kTurns = 20;
+        double turnNs = settings.durationSeconds * 1e9 / (2 * kTurns);
+        uint64_t ns[2] = { 0, 0 };
+        uint64_t frames[2] = { 0, 0 };
+        for (int turn = 0; turn < kTurns; turn++) {
+            for (int on = 0; on < 2; on++) {
+                uint64_t start = Platform::NowNs();
+                uint64_t end = start;
+                while (end - start < turnNs) {
+                    if (on) frameWithCounters();
+                    else SwapRedBlue(pixels.data(), count);
+                    frames[on]++;
+                    end = Platform::NowNs();
+                }
+                ns[on] += end - start;
+            }
+        }
+        done.store(true);
+        reader.join();
+
+        CountersResult result;
+        result.frames = frames[1];
+        result.offUsPerFrame = frames[0] ? ns[0] / 1e3 / frames[0] : 0.0;
+        result.onUsPerFrame = frames[1] ? ns[1] / 1e3 / frames[1] : 0.0;
+        fprintf(stderr, "%ux%u: %.2f us/frame without counters, %.2f us with, %+.3f%%%s\n",
+                settings.source.width, settings.source.height, result.offUsPerFrame, result.onUsPerFrame,
+                result.OverheadPercent(), result.OverheadPercent() < kCounterBudgetPercent ? "" : "  (over budget)");
+        return result;
+    }
+
+    void WriteCountersJson(std::ostream& out, const BenchSettings& settings, const CountersResult& result) {
+        out << "{\n  \"benchmark\": \"counter-overhead\",\n  \"config\": {\n    \"width\": " << settings.source.width
+            << ",\n    \"height\": " << settings.source.height
+            << ",\n    \"warmupSeconds\": " << settings.warmupSeconds
+            << ",\n    \"durationSeconds\": " << settings.durationSeconds
+            << ",\n    \"budgetPercent\": " << kCounterBudgetPercent
+            << "\n  },\n  \"machine\": {\n    \"hardwareThreads\": " << std::thread::hardware_concurrency()
+            << "\n  },\n  \"results\": {\n    \"frames\": " << result.frames
+            << ",\n    \"usPerFrameWithoutCounters\": " << result.offUsPerFrame
+            << ",\n    \"usPerFrameWithCounters\": " << result.onUsPerFrame
+            << ",\n    \"overheadPercent\": " << result.OverheadPercent()
+            << ",\n    \"withinBudget\": " << (result.OverheadPercent() < kCounterBudgetPercent ? "true" : "false")
+            << "\n  }\n}\n";
+    }
+
+    bool ReadLatencyFile(const std::string& path, std::vector<LatencyReport>& reports) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!file.good() && !file.eof()) {
+            fprintf(stderr, "Cannot read %s\n", path.c_str());
+            return false;
+        }
+        if (!DecodeLatencyReports(data, reports)) {
+            fprintf(stderr, "%s is not a latency histogram file from this build\n", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // One metric of one bridge, or of every bridge merged, in both files
+    struct CompareRow {
+        std::string bridge;
+        LatencyMetric metric = LatencyMetric::EndToEnd;
+        HistogramSnapshot a;
+        HistogramSnapshot b;
+    };
+
+    // Bridges are matched by name; "*" merges every bridge in a file, so runs
+    // with different bridges still compare
+    std::vector<CompareRow> CompareLatency(const std::vector<LatencyReport>& a, const std::vector<LatencyReport>& b) {
+        std::vector<CompareRow> rows;
+        for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+            CompareRow all;
+            all.bridge = "*";
+            all.metric = (LatencyMetric)m;
+            for (const LatencyReport& report : a) all.a.Merge(report.metrics[m]);
+            for (const LatencyReport& report : b) all.b.Merge(report.metrics[m]);
+            rows.push_back(all);
+        }
+        for (const LatencyReport& left : a) {
+            for (const LatencyReport& right : b) {
+                if (left.bridgeName != right.bridgeName) continue;
+                for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+                    CompareRow row;
+                    row.bridge = left.bridgeName;
+                    row.metric = (LatencyMetric)m;
+                    row.a = left.metrics[m];
+                    row.b = right.metrics[m];
+                    rows.push_back(row);
+                }
+                break;
+            }
+        }
+        return rows;
+    }
+
+    double PercentChange(uint64_t from, uint64_t to) {
+        return from ? 100.0 * ((double)to - (double)from) / (double)from : 0.0;
+    }
+
+    void WriteCompareJson(std::ostream& out, const BenchSettings& settings, const std::vector<CompareRow>& rows) {
+        auto writeSide = [&](const HistogramSnapshot& side) {
+            out << "{ \"count\": " << side.Count()
+                << ", \"p50Us\": " << side.ValueAtPercentile(50.0) / 1e3
+                << ", \"p99Us\": " << side.ValueAtPercentile(99.0) / 1e3
+                << ", \"p999Us\": " << side.ValueAtPercentile(99.9) / 1e3
+                << ", \"maxUs\": " << side.MaxNs() / 1e3 << " }";
+        };
+        out << "{\n  \"benchmark\": \"latency-compare\",\n  \"config\": {\n    \"a\": \"";
+        WriteEscaped(out, settings.comparePaths[0]);
+        out << "\",\n    \"b\": \"";
+        WriteEscaped(out, settings.comparePaths[1]);
+        out << "\"\n  },\n  \"results\": [";
+        for (size_t i = 0; i < rows.size(); i++) {
+            const CompareRow& r = rows[i];
+            out << (i ? "," : "") << "\n    {\n      \"bridge\": \"";
+            WriteEscaped(out, r.bridge);
+            out << "\",\n      \"metric\": \"" << LatencyMetricName(r.metric) << "\",\n      \"a\": ";
+            writeSide(r.a);
+            out << ",\n      \"b\": ";
+            writeSide(r.b);
+            out << ",\n      \"p50ChangePercent\": "
+                << PercentChange(r.a.ValueAtPercentile(50.0), r.b.ValueAtPercentile(50.0))
+                << ",\n      \"p99ChangePercent\": "
+                << PercentChange(r.a.ValueAtPercentile(99.0), r.b.ValueAtPercentile(99.0)) << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void WriteScalerJson(std::ostream& out, const BenchSettings& settings, const std::vector<ScalerResult>& results) {
+        out << "{\n  \"benchmark\": \"scaler\",\n  \"config\": {\n    \"secondsPerCase\": "
+            << settings.durationSeconds / 10
+            << "\n  },\n  \"machine\": {\n    \"hardwareThreads\": " << std::thread::hardware_concurrency()
+            << "\n  },\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const ScalerResult& r = results[i];
+            out << (i ? "," : "") << "\n    {\n      \"source\": \"" << r.srcWidth << "x" << r.srcHeight
+                << "\",\n      \"output\": \"" << r.dstWidth << "x" << r.dstHeight
+                << "\",\n      \"filter\": \"" << ScaleFilterName(r.filter)
+                << "\",\n      \"msPerFrame\": " << r.msPerFrame
+                << ",\n      \"msPerFrameThreaded\": " << r.msPerFrameThreaded
+                << ",\n      \"megapixelsPerSecond\": " << r.megapixelsPerSecond
+                << ",\n      \"psnrDb\": {";
+            for (size_t p = 0; p < r.psnr.size(); p++) {
+                out << (p ? ", " : " ") << "\"" << r.psnr[p].first << "\": " << r.psnr[p].second;
+            }
+            out << " }\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    // Measure with the same frame memory the bridge apps run with
+    Platform::EnableLargePages();
+
+    if (!settings.comparePaths[0].empty()) {
+        std::vector<LatencyReport> a, b;
+        if (!ReadLatencyFile(settings.comparePaths[0], a) || !ReadLatencyFile(settings.comparePaths[1], b)) {
+            return 1;
+        }
+        std::vector<CompareRow> rows = CompareLatency(a, b);
+        for (const CompareRow& row : rows) {
+            if (row.a.Count() == 0 && row.b.Count() == 0) continue;
+            fprintf(stderr, "%-16s %-14s p50 %8.1f -> %8.1f us (%+6.1f%%), p99 %8.1f -> %8.1f us (%+6.1f%%)\n",
+                    row.bridge.c_str(), LatencyMetricName(row.metric),
+                    row.a.ValueAtPercentile(50.0) / 1e3, row.b.ValueAtPercentile(50.0) / 1e3,
+                    PercentChange(row.a.ValueAtPercentile(50.0), row.b.ValueAtPercentile(50.0)),
+                    row.a.ValueAtPercentile(99.0) / 1e3, row.b.ValueAtPercentile(99.0) / 1e3,
+                    PercentChange(row.a.ValueAtPercentile(99.0), row.b.ValueAtPercentile(99.0)));
+        }
+        if (settings.outputPath.empty()) {
+            WriteCompareJson(std::cout, settings, rows);
+            return 0;
+        }
+        std::ofstream file(settings.outputPath);
+        WriteCompareJson(file, settings, rows);
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", settings.outputPath.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (settings.counters) {
+        CountersResult result = RunCounters(settings);
+        if (settings.outputPath.empty()) {
+            WriteCountersJson(std::cout, settings, result);
+            return 0;
+        }
+        std::ofstream file(settings.outputPath);
+        WriteCountersJson(file, settings, result);
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", settings.outputPath.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (settings.scaler) {
+        std::vector<ScalerResult> results = RunScaler(settings);
+        if (settings.outputPath.empty()) {
+            WriteScalerJson(std::cout, settings, results);
+            return 0;
+        }
+        std::ofstream file(settings.outputPath);
+        WriteScalerJson(file, settings, results);
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", settings.outputPath.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    std::vector<LevelResult> results;
+    for (unsigned int count : settings.bridgeCounts) {
+        bool metDeadlines = true;
+        // Each proxy rung and receive mode is measured watched, then with the unwatched share idle
+        size_t watchVariants = settings.unwatchedShare > 0.0 ? 2 : 1;
+        size_t variants = (settings.proxyOutputs + 1) * settings.bandwidths.size() * watchVariants;
+        for (size_t variant = 0; variant < variants; variant++) {
+            // Proxy rungs and receive modes never both vary
+            bool unwatched = variant % watchVariants == 1;
+            size_t mode = variant / watchVariants;
+            unsigned int rung = (unsigned int)(mode / settings.bandwidths.size());
+            ReceiveBandwidth bandwidth = settings.bandwidths[mode % settings.bandwidths.size()];
+            LevelResult result = RunLevel(settings, count, rung, bandwidth, unwatched ? settings.unwatchedShare : 0.0);
+            if (settings.changeBox > 0 && settings.dirtyTiles) {
+                BenchSettings wholeFrames = settings;
+                wholeFrames.dirtyTiles = false;
+                LevelResult baseline = RunLevel(wholeFrames, count, rung, bandwidth, 0.0);
+                result.tileSavedUsPerFrame = baseline.convertUsPerFrame - result.convertUsPerFrame;
+            }
+            if (settings.traceOverhead) {
+                Trace::Clear();
+                Trace::SetEnabled(true);
+                LevelResult traced = RunLevel(settings, count, rung, bandwidth, unwatched ? settings.unwatchedShare : 0.0);
+                Trace::SetEnabled(false);
+                Trace::Clear();
+                result.tracedCpuUsPerFrame = traced.cpuUsPerFrame;
+            }
+            if (rung > 0) {
+                const LevelResult& lower = results[results.size() - settings.bandwidths.size() * watchVariants];
+                result.rungCpuUsPerFrame = result.cpuUsPerFrame - lower.cpuUsPerFrame;
+            }
+            if (unwatched) {
+                result.idleCpuSavedCores = results.back().cpuCores - result.cpuCores;
+            }
+            fprintf(stderr, "%4u %s: fps min %.1f mean %.1f, %.1f us CPU/frame, %.0f MB/s, p99 %.2f ms, %u connections%s\n",
+                    result.bridges, settings.mosaic ? "tiles" : "bridges", result.minFps, result.meanFps,
+                    result.cpuUsPerFrame, result.bytesPerSecond / 1e6, result.latency.ValueAtPercentile(99.0) / 1e6,
+                    result.sourceConnections, result.metDeadlines ? "" : "  (missed deadlines)");
+            if (settings.mosaic) {
+                fprintf(stderr, "      mosaic: %.1f us compose/frame, %.1f us scale/tile frame, %.0f tile frames/s\n",
+                        result.composeUsPerFrame, result.scaleUsPerTileFrame, result.tileFramesPerSecond);
+            }
+            if (!settings.isSpoutToNDI && !settings.mosaic) {
+                fprintf(stderr, "      %s: %.3f cores and %.2f MB/s ingest per bridge\n", BandwidthName(bandwidth),
+                        result.cpuCores / count, result.ingestBytesPerSecond / count / 1e6);
+            }
+            if (settings.changeBox > 0 && settings.dirtyTiles) {
+                fprintf(stderr, "      dirty tiles: %.1f%% of pixels reused, %.1f us convert/frame, %.1f us saved against whole frames\n",
+                        result.tileReuseRatio * 100.0, result.convertUsPerFrame, result.tileSavedUsPerFrame);
+            }
+            if (settings.traceOverhead) {
+                fprintf(stderr, "      tracing: %.1f us CPU/frame on, %+.1f us against off\n",
+                        result.tracedCpuUsPerFrame, result.tracedCpuUsPerFrame - result.cpuUsPerFrame);
+            }
+            if (result.unwatched > 0) {
+                fprintf(stderr, "      %u unwatched: %.3f cores saved, %.3f per idle bridge\n", result.unwatched,
+                        result.idleCpuSavedCores, result.idleCpuSavedCores / result.unwatched);
+            }
+            if (rung > 0) {
+                fprintf(stderr, "      %u proxy outputs: %+.1f us CPU/frame for the last rung, %.1f us pyramid/frame\n",
+                        rung, result.rungCpuUsPerFrame, result.pyramidUsPerFrame);
+            }
+            metDeadlines = result.metDeadlines;
+            results.push_back(result);
+        }
+        if (!metDeadlines && !settings.keepGoing) {
+            break;
+        }
+    }
+
+    if (!settings.latencyPath.empty() && !results.empty()) {
+        std::vector<uint8_t> data = EncodeLatencyReports(results.back().latencyReports);
+        std::ofstream file(settings.latencyPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", settings.latencyPath.c_str());
+            return 1;
+        }
+    }
+
+    if (settings.outputPath.empty()) {
+        WriteJson(std::cout, settings, results);
+        return 0;
+    }
+    std::ofstream file(settings.outputPath);
+    WriteJson(file, settings, results);
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", settings.outputPath.c_str());
+        return 1;
+    }
+    return 0;
+}
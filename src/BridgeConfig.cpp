@@ -0,0 +1,569 @@
+#include "BridgeConfig.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#include "Utils.h"
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::string Trim(const std::string& value) {
+        size_t begin = value.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) return std::string();
+        size_t end = value.find_last_not_of(" \t\r\n");
+        return value.substr(begin, end - begin + 1);
+    }
+
+    std::string Lower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return (char)std::tolower(c); });
+        return value;
+    }
+
+    bool ParseBool(const std::string& value, bool& out) {
+        std::string v = Lower(value);
+        if (v == "true" || v == "yes" || v == "on" || v == "1") { out = true; return true; }
+        if (v == "false" || v == "no" || v == "off" || v == "0") { out = false; return true; }
+        return false;
+    }
+
+    bool ParseUnsigned(const std::string& value, unsigned int& out) {
+        if (value.empty() || value.size() > 9 ||
+            !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        out = (unsigned int)std::stoul(value);
+        return true;
+    }
+
+    bool ParseSize(const std::string& value, unsigned int& width, unsigned int& height) {
+        size_t x = Lower(value).find('x');
+        unsigned int w = 0, h = 0;
+        if (x == std::string::npos || !ParseUnsigned(value.substr(0, x), w) || !ParseUnsigned(value.substr(x + 1), h) ||
+            w < 16 || h < 16 || w > 16384 || h > 16384) {
+            return false;
+        }
+        width = w;
+        height = h;
+        return true;
+    }
+
+    // Whole frames per second, or N/D for rates such as 30000/1001
+    bool ParseRate(const std::string& value, int& n, int& d) {
+        size_t slash = value.find('/');
+        unsigned int un = 0, ud = 1;
+        bool parsed = slash == std::string::npos
+                    ? ParseUnsigned(value, un)
+                    : ParseUnsigned(value.substr(0, slash), un) && ParseUnsigned(value.substr(slash + 1), ud);
+        if (!parsed || un == 0 || ud == 0 || un / ud > 240) return false;
+        n = (int)un;
+        d = (int)ud;
+        return true;
+    }
+
+    bool ParseColorSpace(const std::string& value, ColorSpace& out) {
+        std::string v = Lower(value);
+        if (v == "rgba") { out = ColorSpace::RGBA; return true; }
+        if (v == "bgra") { out = ColorSpace::BGRA; return true; }
+        if (v == "uyvy") { out = ColorSpace::UYVY; return true; }
+        return false;
+    }
+
+    // Apply one key/value pair; returns an error message or empty on success
+    std::string ApplySetting(BridgeDefinition& bridge, const std::string& key, const std::string& value) {
+        DuplicateFilterSettings& duplicates = bridge.options.duplicateFilter;
+        if (key == "id") {
+            if (value.empty()) return "id must not be empty";
+            bridge.id = value;
+        }
+        else if (key == "name") {
+            bridge.name = value;
+        }
+        else if (key == "source") {
+            bridge.source = value;
+        }
+        else if (key == "direction") {
+            std::string v = Lower(value);
+            if (v == "spout_to_ndi") bridge.isSpoutToNDI = true;
+            else if (v == "ndi_to_spout") bridge.isSpoutToNDI = false;
+            else return "direction must be spout_to_ndi or ndi_to_spout";
+        }
+        else if (key == "color_space") {
+            if (!ParseColorSpace(value, bridge.colorSpace)) return "color_space must be rgba, bgra or uyvy";
+        }
+        else if (key == "duplicate_policy") {
+            std::string v = Lower(value);
+            if (v == "off") duplicates.policy = DuplicatePolicy::Off;
+            else if (v == "suppress") duplicates.policy = DuplicatePolicy::Suppress;
+            else if (v == "rate_limit") duplicates.policy = DuplicatePolicy::RateLimit;
+            else return "duplicate_policy must be off, suppress or rate_limit";
+        }
+        else if (key == "hash_mode") {
+            std::string v = Lower(value);
+            if (v == "full") duplicates.hashMode = FrameHash::Mode::Full;
+            else if (v == "sampled") duplicates.hashMode = FrameHash::Mode::Sampled;
+            else return "hash_mode must be full or sampled";
+        }
+        else if (key == "keep_alive_ms") {
+            if (!ParseUnsigned(value, duplicates.keepAliveMs)) return "keep_alive_ms must be a number";
+        }
+        else if (key == "rate_limit_ms") {
+            if (!ParseUnsigned(value, duplicates.rateLimitMs)) return "rate_limit_ms must be a number";
+        }
+        else if (key == "dirty_tiles") {
+            if (!ParseBool(value, bridge.options.dirtyTiles)) return "dirty_tiles must be true or false";
+        }
+        else if (key == "tile_size") {
+            if (!ParseUnsigned(value, bridge.options.tileSize) || bridge.options.tileSize == 0) {
+                return "tile_size must be a positive number";
+            }
+        }
+        else if (key == "cpu") {
+            unsigned int cpu = 0;
+            if (Lower(value) == "any") bridge.options.cpu = -1;
+            else if (ParseUnsigned(value, cpu) && cpu < 1024) bridge.options.cpu = (int)cpu;
+            else return "cpu must be a CPU number or any";
+        }
+        else if (key == "share_capture") {
+            if (!ParseBool(value, bridge.options.shareCapture)) return "share_capture must be true or false";
+        }
+        else if (key == "mosaic_size") {
+            if (!ParseSize(value, bridge.options.mosaic.width, bridge.options.mosaic.height)) {
+                return "mosaic_size must be WIDTHxHEIGHT";
+            }
+        }
+        else if (key == "mosaic_rate") {
+            if (!ParseRate(value, bridge.options.mosaic.frameRateN, bridge.options.mosaic.frameRateD)) {
+                return "mosaic_rate must be frames per second, or N/D";
+            }
+        }
+        else if (key == "mosaic_columns") {
+            if (!ParseUnsigned(value, bridge.options.mosaic.columns)) return "mosaic_columns must be a number";
+        }
+        else if (key == "mosaic_proxy") {
+            if (!ParseBool(value, bridge.options.mosaic.proxy)) return "mosaic_proxy must be true or false";
+        }
+        else if (key == "output_size") {
+            if (Lower(value) == "source") {
+                bridge.options.outputWidth = 0;
+                bridge.options.outputHeight = 0;
+            }
+            else if (!ParseSize(value, bridge.options.outputWidth, bridge.options.outputHeight)) {
+                return "output_size must be WIDTHxHEIGHT or source";
+            }
+        }
+        else if (key == "scale_filter") {
+            std::string v = Lower(value);
+            if (v == "box") bridge.options.scaleFilter = ScaleFilter::Box;
+            else if (v == "bilinear") bridge.options.scaleFilter = ScaleFilter::Bilinear;
+            else if (v == "lanczos") bridge.options.scaleFilter = ScaleFilter::Lanczos;
+            else return "scale_filter must be box, bilinear or lanczos";
+        }
+        else if (key == "proxy_outputs") {
+            if (!ParseUnsigned(value, bridge.options.proxyOutputs) ||
+                bridge.options.proxyOutputs > FramePyramid::kMaxLevels) {
+                return "proxy_outputs must be 0, 1 or 2";
+            }
+        }
+        else if (key == "idle_when_unwatched") {
+            if (!ParseBool(value, bridge.options.idleWhenUnwatched)) return "idle_when_unwatched must be true or false";
+        }
+        else if (key == "idle_frame_ms") {
+            if (!ParseUnsigned(value, bridge.options.idleFrameMs)) return "idle_frame_ms must be a number";
+        }
+        else if (key == "jitter_buffer") {
+            if (!ParseBool(value, bridge.options.jitterBuffer.enabled)) return "jitter_buffer must be true or false";
+        }
+        else if (key == "jitter_max_latency_ms") {
+            if (!ParseUnsigned(value, bridge.options.jitterBuffer.maxLatencyMs)) {
+                return "jitter_max_latency_ms must be a number";
+            }
+        }
+        else if (key == "time_base_corrector") {
+            if (!ParseBool(value, bridge.options.timeBase.enabled)) return "time_base_corrector must be true or false";
+        }
+        else if (key == "tbc_rate") {
+            if (Lower(value) == "source") {
+                bridge.options.timeBase.frameRateN = 0;
+                bridge.options.timeBase.frameRateD = 1;
+            }
+            else if (!ParseRate(value, bridge.options.timeBase.frameRateN, bridge.options.timeBase.frameRateD)) {
+                return "tbc_rate must be frames per second, N/D or source";
+            }
+        }
+        else if (key == "receive_bandwidth") {
+            std::string v = Lower(value);
+            if (v == "highest") bridge.options.receiveBandwidth = ReceiveBandwidth::Highest;
+            else if (v == "lowest") bridge.options.receiveBandwidth = ReceiveBandwidth::Lowest;
+            else if (v == "audio_only") bridge.options.receiveBandwidth = ReceiveBandwidth::AudioOnly;
+            else if (v == "metadata_only") bridge.options.receiveBandwidth = ReceiveBandwidth::MetadataOnly;
+            else return "receive_bandwidth must be highest, lowest, audio_only or metadata_only";
+        }
+        else if (key == "allow_fields") {
+            if (!ParseBool(value, bridge.options.allowFields)) return "allow_fields must be true or false";
+        }
+        else if (key == "receiver_name") {
+            bridge.options.receiverName = value;
+        }
+        else if (key == "queue_depth") {
+            if (!ParseUnsigned(value, bridge.options.subscription.queueDepth) ||
+                bridge.options.subscription.queueDepth == 0) {
+                return "queue_depth must be a positive number";
+            }
+        }
+        else if (key == "drop_policy") {
+            std::string v = Lower(value);
+            if (v == "drop_oldest") bridge.options.subscription.dropPolicy = QueueDropPolicy::DropOldest;
+            else if (v == "drop_newest") bridge.options.subscription.dropPolicy = QueueDropPolicy::DropNewest;
+            else return "drop_policy must be drop_oldest or drop_newest";
+        }
+        else {
+            return "unknown key '" + key + "'";
+        }
+        return std::string();
+    }
+
+    // Unquote a value and drop any trailing ';' comment; returns an error message or empty
+    std::string ParseValue(const std::string& raw, std::string& value) {
+        std::string text = Trim(raw);
+        if (text.empty() || text[0] != '"') {
+            // Only ';' starts a trailing comment so names like "Output #2" survive
+            value = Trim(text.substr(0, text.find(';')));
+            return std::string();
+        }
+
+        value.clear();
+        size_t i = 1;
+        for (; i < text.size() && text[i] != '"'; i++) {
+            if (text[i] == '\\' && i + 1 < text.size()) {
+                i++;
+            }
+            value += text[i];
+        }
+        if (i >= text.size()) {
+            return "unterminated quoted value";
+        }
+        std::string rest = Trim(text.substr(i + 1));
+        if (!rest.empty() && rest[0] != ';') {
+            return "unexpected text after quoted value";
+        }
+        return std::string();
+    }
+
+    // Quote values that would not survive an unquoted round trip
+    std::string FormatValue(const std::string& value) {
+        bool needsQuotes = value.empty() || value != Trim(value) ||
+                           value.find_first_of(";\"") != std::string::npos;
+        if (!needsQuotes) return value;
+
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"' || c == '\\') quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    const char* DuplicatePolicyKey(DuplicatePolicy policy) {
+        switch (policy) {
+            case DuplicatePolicy::Off:       return "off";
+            case DuplicatePolicy::RateLimit: return "rate_limit";
+            default:                         return "suppress";
+        }
+    }
+
+    const char* ReceiveBandwidthKey(ReceiveBandwidth bandwidth) {
+        switch (bandwidth) {
+            case ReceiveBandwidth::Lowest:       return "lowest";
+            case ReceiveBandwidth::AudioOnly:    return "audio_only";
+            case ReceiveBandwidth::MetadataOnly: return "metadata_only";
+            default:                             return "highest";
+        }
+    }
+
+    bool CreateParentDirectories(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        if (slash == std::string::npos || slash == 0) return true;
+        std::string parent = path.substr(0, slash);
+        if (!CreateParentDirectories(parent)) return false;
+#ifdef _WIN32
+        if (parent.size() == 2 && parent[1] == ':') return true;   // Drive root
+        return CreateDirectoryW(Utils::ToWide(parent).c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+        struct stat info;
+        return stat(parent.c_str(), &info) == 0 ? S_ISDIR(info.st_mode) : mkdir(parent.c_str(), 0755) == 0;
+#endif
+    }
+
+    void RemoveFile(const std::string& path) {
+#ifdef _WIN32
+        _wremove(Utils::ToWide(path).c_str());
+#else
+        remove(path.c_str());
+#endif
+    }
+
+    std::string CheckComplete(const BridgeDefinition& bridge) {
+        if (bridge.name.empty()) return "bridge is missing a name";
+        if (bridge.source.empty()) return "bridge '" + bridge.name + "' is missing a source";
+        return std::string();
+    }
+}
+
+bool ParseBridgeConfig(std::istream& input, std::vector<BridgeDefinition>& bridges, std::string& error) {
+    std::vector<BridgeDefinition> result;
+    bool inBridge = false;
+    int sectionLine = 0;
+    std::string line;
+
+    auto closeSection = [&]() {
+        if (!inBridge) return true;
+        std::string problem = CheckComplete(result.back());
+        if (!problem.empty()) {
+            error = "line " + std::to_string(sectionLine) + ": " + problem;
+            return false;
+        }
+        return true;
+    };
+
+    for (int lineNumber = 1; std::getline(input, line); lineNumber++) {
+        std::string text = Trim(line);
+        if (text.empty() || text[0] == '#' || text[0] == ';') {
+            continue;
+        }
+
+        if (text.front() == '[' && text.back() == ']') {
+            if (!closeSection()) return false;
+            std::string section = Lower(Trim(text.substr(1, text.size() - 2)));
+            if (section != "bridge") {
+                error = "line " + std::to_string(lineNumber) + ": unknown section [" + section + "]";
+                return false;
+            }
+            result.emplace_back();
+            inBridge = true;
+            sectionLine = lineNumber;
+            continue;
+        }
+
+        size_t equals = text.find('=');
+        if (equals == std::string::npos) {
+            error = "line " + std::to_string(lineNumber) + ": expected key = value";
+            return false;
+        }
+        std::string key = Lower(Trim(text.substr(0, equals)));
+        std::string value;
+        std::string problem = ParseValue(text.substr(equals + 1), value);
+
+        if (problem.empty() && !inBridge) {
+            // Only the format version may appear before the first section
+            unsigned int version = 0;
+            if (key != "version") {
+                problem = "setting outside a [bridge] section";
+            }
+            else if (!ParseUnsigned(value, version) || version == 0) {
+                problem = "version must be a positive number";
+            }
+            else if (version > (unsigned int)kBridgeConfigVersion) {
+                problem = "file is version " + value + " but this build reads up to version " +
+                          std::to_string(kBridgeConfigVersion);
+            }
+        }
+        else if (problem.empty()) {
+            problem = ApplySetting(result.back(), key, value);
+        }
+
+        if (!problem.empty()) {
+            error = "line " + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+    }
+
+    if (!closeSection()) return false;
+
+    // Explicit ids first, so derived ones steer around them
+    std::set<std::string> ids;
+    for (const BridgeDefinition& bridge : result) {
+        if (!bridge.id.empty() && !ids.insert(bridge.id).second) {
+            error = "duplicate bridge id '" + bridge.id + "'";
+            return false;
+        }
+    }
+    for (BridgeDefinition& bridge : result) {
+        if (bridge.id.empty()) {
+            bridge.id = bridge.name;
+            for (int suffix = 2; !ids.insert(bridge.id).second; suffix++) {
+                bridge.id = bridge.name + "-" + std::to_string(suffix);
+            }
+        }
+    }
+
+    bridges = std::move(result);
+    return true;
+}
+
+bool LoadBridgeConfig(const std::string& path, std::vector<BridgeDefinition>& bridges, std::string& error) {
+#ifdef _WIN32
+    std::ifstream file(Utils::ToWide(path));
+#else
+    std::ifstream file(path);
+#endif
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return ParseBridgeConfig(file, bridges, error);
+}
+
+void WriteBridgeConfig(std::ostream& output, const std::vector<BridgeDefinition>& bridges) {
+    output << "# NDI/Spout bridge configuration\n";
+    output << "version = " << kBridgeConfigVersion << "\n";
+
+    for (const BridgeDefinition& bridge : bridges) {
+        const DuplicateFilterSettings& duplicates = bridge.options.duplicateFilter;
+        std::string colorSpace = Lower(ColorSpaceName(bridge.colorSpace));
+        output << "\n[bridge]\n";
+        if (!bridge.id.empty()) {
+            output << "id = " << FormatValue(bridge.id) << "\n";
+        }
+        output << "name = " << FormatValue(bridge.name) << "\n";
+        output << "direction = " << (bridge.isSpoutToNDI ? "spout_to_ndi" : "ndi_to_spout") << "\n";
+        output << "source = " << FormatValue(bridge.source) << "\n";
+        output << "color_space = " << colorSpace << "\n";
+        output << "duplicate_policy = " << DuplicatePolicyKey(duplicates.policy) << "\n";
+        output << "hash_mode = " << (duplicates.hashMode == FrameHash::Mode::Sampled ? "sampled" : "full") << "\n";
+        output << "keep_alive_ms = " << duplicates.keepAliveMs << "\n";
+        output << "rate_limit_ms = " << duplicates.rateLimitMs << "\n";
+        output << "dirty_tiles = " << (bridge.options.dirtyTiles ? "true" : "false") << "\n";
+        output << "tile_size = " << bridge.options.tileSize << "\n";
+        if (bridge.options.cpu >= 0) {
+            output << "cpu = " << bridge.options.cpu << "\n";
+        }
+        output << "share_capture = " << (bridge.options.shareCapture ? "true" : "false") << "\n";
+        output << "queue_depth = " << bridge.options.subscription.queueDepth << "\n";
+        output << "drop_policy = "
+               << (bridge.options.subscription.dropPolicy == QueueDropPolicy::DropNewest ? "drop_newest" : "drop_oldest")
+               << "\n";
+        if (bridge.options.outputWidth > 0 && bridge.options.outputHeight > 0) {
+            output << "output_size = " << bridge.options.outputWidth << "x" << bridge.options.outputHeight << "\n";
+        }
+        else {
+            output << "output_size = source\n";
+        }
+        output << "scale_filter = " << ScaleFilterName(bridge.options.scaleFilter) << "\n";
+        output << "proxy_outputs = " << bridge.options.proxyOutputs << "\n";
+        if (bridge.isSpoutToNDI) {
+            output << "idle_when_unwatched = " << (bridge.options.idleWhenUnwatched ? "true" : "false") << "\n";
+            output << "idle_frame_ms = " << bridge.options.idleFrameMs << "\n";
+        }
+        if (!bridge.isSpoutToNDI) {
+            output << "receive_bandwidth = " << ReceiveBandwidthKey(bridge.options.receiveBandwidth) << "\n";
+            output << "allow_fields = " << (bridge.options.allowFields ? "true" : "false") << "\n";
+            if (!bridge.options.receiverName.empty()) {
+                output << "receiver_name = " << FormatValue(bridge.options.receiverName) << "\n";
+            }
+            output << "jitter_buffer = " << (bridge.options.jitterBuffer.enabled ? "true" : "false") << "\n";
+            output << "jitter_max_latency_ms = " << bridge.options.jitterBuffer.maxLatencyMs << "\n";
+            const TimeBaseSettings& timeBase = bridge.options.timeBase;
+            output << "time_base_corrector = " << (timeBase.enabled ? "true" : "false") << "\n";
+            if (timeBase.frameRateN > 0) {
+                output << "tbc_rate = " << timeBase.frameRateN;
+                if (timeBase.frameRateD != 1) output << "/" << timeBase.frameRateD;
+                output << "\n";
+            }
+            else {
+                output << "tbc_rate = source\n";
+            }
+        }
+        if (IsMosaicSourceName(bridge.source)) {
+            const MosaicSettings& mosaic = bridge.options.mosaic;
+            output << "mosaic_size = " << mosaic.width << "x" << mosaic.height << "\n";
+            output << "mosaic_rate = " << mosaic.frameRateN;
+            if (mosaic.frameRateD != 1) output << "/" << mosaic.frameRateD;
+            output << "\n";
+            output << "mosaic_columns = " << mosaic.columns << "\n";
+            output << "mosaic_proxy = " << (mosaic.proxy ? "true" : "false") << "\n";
+        }
+    }
+}
+
+bool SaveBridgeConfig(const std::string& path, const std::vector<BridgeDefinition>& bridges, std::string& error) {
+    std::ostringstream text;
+    WriteBridgeConfig(text, bridges);
+    std::string contents = text.str();
+
+    if (!CreateParentDirectories(path)) {
+        error = "cannot create the directory for " + path;
+        return false;
+    }
+
+    std::string tempPath = path + ".tmp";
+#ifdef _WIN32
+    FILE* file = _wfopen(Utils::ToWide(tempPath).c_str(), L"wb");
+#else
+    FILE* file = fopen(tempPath.c_str(), "wb");
+#endif
+    if (!file) {
+        error = "cannot write " + tempPath;
+        return false;
+    }
+
+    bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size() && fflush(file) == 0;
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        RemoveFile(tempPath);
+        error = "failed writing " + tempPath;
+        return false;
+    }
+
+#ifdef _WIN32
+    bool replaced = MoveFileExW(Utils::ToWide(tempPath).c_str(), Utils::ToWide(path).c_str(),
+                                MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    bool replaced = rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+    if (!replaced) {
+        RemoveFile(tempPath);
+        error = "cannot replace " + path;
+        return false;
+    }
+    return true;
+}
+
+std::string GenerateBridgeId() {
+    static std::mutex mutex;
+    static std::mt19937_64 generator(((uint64_t)std::random_device()() << 32) ^ (uint64_t)std::random_device()());
+    std::lock_guard<std::mutex> lock(mutex);
+    char id[17];
+    snprintf(id, sizeof(id), "%016llx", (unsigned long long)generator());
+    return id;
+}
+
+std::string GetDefaultConfigPath() {
+#ifdef _WIN32
+    // Paths are UTF-8 throughout; convert from the wide environment
+    const wchar_t* appData = _wgetenv(L"APPDATA");
+    std::string base = appData && *appData ? Utils::ToNarrow(appData) : ".";
+    return base + "\\NDISpoutBridge\\bridges.ini";
+#else
+    const char* xdg = getenv("XDG_CONFIG_HOME");
+    const char* home = getenv("HOME");
+    std::string base = xdg && *xdg ? xdg : (home && *home ? std::string(home) + "/.config" : std::string("."));
+    return base + "/ndispoutbridge/bridges.ini";
+#endif
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "BridgeInstance.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One bridge as described in a configuration file
+struct BridgeDefinition {
+    std::string id;              // Stable across renames; matches running bridges on reload
+    std::string name;
+    std::string source;
+    bool isSpoutToNDI = true;
+    ColorSpace colorSpace = ColorSpace::RGBA;
+    BridgeOptions options;
+};
+
+// Format version written by this build; files from newer builds are rejected
+const int kBridgeConfigVersion = 2;
+
+// Bridge definitions in a plain INI-style file, one [bridge] section each:
+//
+//   version = 2
+//
+//   [bridge]
+//   id = 5f3a9c0e12b47d86
+//   name = Stage Left
+//   direction = spout_to_ndi        ; or ndi_to_spout
+//   source = Resolume Output
+//   color_space = rgba              ; rgba, bgra or uyvy
+//   duplicate_policy = suppress     ; off, suppress or rate_limit
+//   hash_mode = full                ; full or sampled
+//   keep_alive_ms = 1000
+//   rate_limit_ms = 100
+//   dirty_tiles = true
+//   tile_size = 64
+//   cpu = 2                         ; pin the bridge thread, or any
+//   share_capture = false           ; one capture for all bridges on this source, but no dirty tiles
+//   queue_depth = 1                 ; frames queued for this bridge on a shared capture
+//   drop_policy = drop_oldest       ; or drop_newest, when that queue is full
+//   output_size = 1280x720          ; resize before sending, or source to keep the size
+//   scale_filter = bilinear         ; box, bilinear or lanczos
+//   proxy_outputs = 0               ; spout_to_ndi: also send "<name> 1/2" (1) and "<name> 1/4" (2)
+//   idle_when_unwatched = true      ; spout_to_ndi: stop capturing while no receiver is connected
+//   idle_frame_ms = 1000            ; spout_to_ndi: but send a frame this often while idle; 0 none
+//   receive_bandwidth = highest     ; ndi_to_spout: highest, lowest, audio_only or metadata_only
+//   allow_fields = false            ; ndi_to_spout: take interlaced sources as separate fields
+//   receiver_name = Preview Wall    ; ndi_to_spout: receiver name shown to senders
+//   jitter_buffer = false           ; ndi_to_spout: release frames on a steady clock
+//   jitter_max_latency_ms = 50      ; ndi_to_spout: most the jitter buffer may delay a frame
+//   time_base_corrector = false     ; ndi_to_spout: steady output rate; repeat or drop for clock drift
+//   tbc_rate = source               ; ndi_to_spout: that rate, N or N/D, or source for the sender's rate
+//
+// A bridge whose source is "mosaic:" followed by '|'-separated source
+// names composites them into one grid (Mosaic.h) and also takes:
+//
+//   mosaic_size = 1920x1080
+//   mosaic_rate = 30                ; or N/D, e.g. 30000/1001
+//   mosaic_columns = 0              ; tiles per row; 0 for a square grid
+//   mosaic_proxy = true             ; receive NDI sources as low-bandwidth proxies
+//
+// Only name, direction and source are required; a missing version means 1.
+// Version 1 files have no ids, so a bridge without one is identified by its
+// name (made unique with a -2, -3... suffix); explicit ids must be unique.
+// Lines starting with # or ; are comments, as is anything after a ';' on a
+// value line. Values may be double-quoted to keep ';', '"' or edge spaces,
+// with \" and \\ escapes. On failure, error names the offending line.
+bool ParseBridgeConfig(std::istream& input, std::vector<BridgeDefinition>& bridges, std::string& error);
+bool LoadBridgeConfig(const std::string& path, std::vector<BridgeDefinition>& bridges, std::string& error);
+
+void WriteBridgeConfig(std::ostream& output, const std::vector<BridgeDefinition>& bridges);
+
+// Write to a temporary file next to path, flush it to disk, then rename it
+// over path so a crash never leaves a half-written configuration. Creates
+// the parent directory if needed.
+bool SaveBridgeConfig(const std::string& path, const std::vector<BridgeDefinition>& bridges, std::string& error);
+
+// Random id for a bridge created by hand
+std::string GenerateBridgeId();
+
+// Per-user configuration file: %APPDATA%\NDISpoutBridge\bridges.ini on
+// Windows, $XDG_CONFIG_HOME (or ~/.config)/ndispoutbridge/bridges.ini elsewhere
+std::string GetDefaultConfigPath();
@@ -1,15 +1,111 @@
 #include "BridgeInstance.h"
+#include "FrameFanOut.h"
+#include "Mosaic.h"
+#include "Scaler.h"
+#include "SDKIncludes.h"
+#include "Trace.h"
+#include <algorithm>
 #include <stdexcept>
+#include <chrono>
+#include <system_error>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    inline uint64_t ElapsedNs(Clock::time_point start, Clock::time_point end) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    // Same value Platform::NowNs() gives for that instant
+    inline uint64_t ToNs(Clock::time_point t) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    // Longest a capture blocks, so stop requests and setting changes are seen promptly
+    const unsigned int kCaptureTimeoutMs = 100;
+    const unsigned int kConnectionCheckMs = 500;   // How often a watched output checks it still has receivers
+
+    // A bridge's capture end, shared with the other bridges on the same source
+    // unless its options say otherwise, or a mosaic of several sources.
+    // Bridges capture RGBA and swap to BGRA on the way out.
+    std::unique_ptr<FrameSource> CreateBridgeSource(const std::shared_ptr<FrameBackend>& backend, FrameEndpoint endpoint,
+                                                    const std::string& sourceName, const BridgeOptions& options) {
+        if (IsMosaicSourceName(sourceName)) {
+            return CreateMosaicSource(backend, endpoint, ParseMosaicSourceName(sourceName), options.mosaic);
+        }
+        ReceiveSettings receive;
+        receive.format = PixelFormat::RGBA;
+        if (endpoint == FrameEndpoint::NDI) {
+            receive.bandwidth = options.receiveBandwidth;
+            receive.allowFields = options.allowFields;
+            receive.receiverName = options.receiverName;
+        }
+        if (options.shareCapture) {
+            return CreateSharedSource(backend, endpoint, sourceName, receive, options.subscription);
+        }
+        return backend->CreateSource(endpoint, sourceName, receive);
+    }
+
+    // Resize output to the bridge's output size, into pixels, unless it is
+    // already that size. The scaler is made on first use so bridges that
+    // keep the source size never start its workers. Given the source rows
+    // that changed, pixels keeps the last output and only the rows those
+    // reach are rescaled.
+    bool ScaleOutput(std::unique_ptr<FrameScaler>& scaler, const BridgeOptions& options, VideoFrame& output,
+                     Platform::FrameBuffer& pixels, uint64_t frameId, const std::vector<bool>* dirtyRows = nullptr) {
+        unsigned int width = options.outputWidth;
+        unsigned int height = options.outputHeight;
+        if (width == 0 || height == 0 || (width == output.width && height == output.height)) {
+            return false;
+        }
+        TRACE_SCOPE(Trace::Event::Scale, frameId);
+        if (!scaler) {
+            scaler = std::make_unique<FrameScaler>();
+        }
+        size_t strideBytes = (size_t)width * 4;
+        pixels.resize(strideBytes * height);
+        if (!scaler->Scale(output, options.scaleFilter, pixels.data(), width, height, strideBytes, dirtyRows)) {
+            return false;
+        }
+        output.data = pixels.data();
+        output.width = width;
+        output.height = height;
+        output.strideBytes = strideBytes;
+        return true;
+    }
+
+    // How long a capture may block before something due at dueNs, at most
+    // limitMs; limitMs when nothing is due (dueNs 0)
+    unsigned int WaitUntilMs(uint64_t dueNs, uint64_t nowNs, unsigned int limitMs) {
+        if (dueNs == 0) return limitMs;
+        if (dueNs <= nowNs) return 0;
+        return (unsigned int)std::min<uint64_t>(limitMs, (dueNs - nowNs + 999999) / 1000000);
+    }
+}
+
+std::string ProxyOutputName(const std::string& bridgeName, unsigned int level) {
+    return bridgeName + " 1/" + std::to_string(1u << level);
+}
+
+const char* ColorSpaceName(ColorSpace colorSpace) {
+    switch (colorSpace) {
+        case ColorSpace::RGBA: return "RGBA";
+        case ColorSpace::BGRA: return "BGRA";
+        case ColorSpace::UYVY: return "UYVY";
+        default:               return "";
+    }
+}
 
 BridgeInstance::BridgeInstance()
     : isSpoutToNDI(false)
     , colorSpace(ColorSpace::RGBA)
     , isRunning(false)
-    , spout(nullptr)
-    , ndiSender(nullptr)
-    , ndiReceiver(nullptr)
-    , conversionThread(nullptr)
+    , backend(GetDefaultFrameBackend())
     , shouldStop(false)
+    , stopEvent(true)
+    , metrics(std::make_shared<BridgeMetrics>())
+    , settingsChanged(false)
 {
     // Ensure NDI runtime is loaded
     if (!NDIlib_initialize()) {
@@ -22,52 +118,102 @@ BridgeInstance::~BridgeInstance() {
     NDIlib_destroy();
 }
 
-bool BridgeInstance::Start(const char* sourceName, const char* bridgeName, bool isSpoutToNDI, ColorSpace colorSpace) {
+bool BridgeInstance::Start(const char* sourceName, const char* bridgeName, bool isSpoutToNDI, ColorSpace colorSpace,
+                           const BridgeOptions& options) {
     if (!sourceName || !bridgeName) {
         return false;
     }
 
+    if (isRunning) {
+        Stop();
+    }
+
     this->sourceName = sourceName;
     this->bridgeName = bridgeName;
     this->isSpoutToNDI = isSpoutToNDI;
     this->colorSpace = colorSpace;
+    this->options = options;
     this->shouldStop = false;
+    stopEvent.Reset();
 
-    conversionThread = CreateThread(
-        NULL, 0,
-        isSpoutToNDI ? SpoutToNDIThread : NDIToSpoutThread,
-        this, 0, NULL
-    );
+    // Fresh metrics per run; labels are fixed before anyone else can see them
+    ResetMetrics();
+    PublishSettings();
 
-    if (conversionThread) {
-        isRunning = true;
-        return true;
+    try {
+        conversionThread = std::thread(isSpoutToNDI ? SpoutToNDIThread : NDIToSpoutThread, this);
     }
-    return false;
+    catch (const std::system_error&) {
+        return false;
+    }
+
+    isRunning = true;
+    MetricsRegistry::Register(metrics);
+    return true;
 }
 
 void BridgeInstance::Stop() {
     if (isRunning) {
-        shouldStop = true;
-        if (conversionThread) {
-            WaitForSingleObject(conversionThread, INFINITE);
-            CloseHandle(conversionThread);
-            conversionThread = nullptr;
+        RequestStop();
+        if (conversionThread.joinable()) {
+            conversionThread.join();
         }
+        MetricsRegistry::Unregister(metrics.get());
         isRunning = false;
     }
 }
 
-NDIlib_FourCC_video_type_e BridgeInstance::GetNDIColorSpace() const {
-    return NDIlib_FourCC_video_type_RGBA;
+bool BridgeInstance::Update(const char* bridgeName, ColorSpace colorSpace, const BridgeOptions& options) {
+    if (!bridgeName || !isRunning) {
+        return false;
+    }
+
+    if (this->bridgeName != bridgeName) {
+        // Labels never change once published, so a new name is a new series
+        MetricsRegistry::Unregister(metrics.get());
+        this->bridgeName = bridgeName;
+        ResetMetrics();
+        MetricsRegistry::Register(metrics);
+    }
+    this->colorSpace = colorSpace;
+    this->options = options;
+    PublishSettings();
+    return true;
 }
 
-NDIlib_recv_color_format_e BridgeInstance::GetNDIReceiverColorSpace() const {
-    return NDIlib_recv_color_format_RGBX_RGBA;
+void BridgeInstance::ResetMetrics() {
+    metrics = std::make_shared<BridgeMetrics>();
+    metrics->bridgeId = id;
+    metrics->bridgeName = bridgeName;
+    metrics->sourceName = sourceName;
+    metrics->direction = isSpoutToNDI ? "spout_to_ndi" : "ndi_to_spout";
+}
+
+void BridgeInstance::PublishSettings() {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    pendingSettings.bridgeName = bridgeName;
+    pendingSettings.options = options;
+    pendingSettings.metrics = metrics;
+    settingsChanged = true;
+}
+
+bool BridgeInstance::TakeSettings(LiveSettings& settings) {
+    // Cheap enough to poll once per frame
+    if (!settingsChanged.exchange(false)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    settings = pendingSettings;
+    return true;
 }
 
-GLenum BridgeInstance::GetGLColorSpace() const {
-    return GL_RGBA;
+LatencyReport BridgeInstance::GetLatencyReport() const {
+    LatencyReport report;
+    report.bridgeName = bridgeName;
+    for (int i = 0; i < (int)LatencyMetric::Count; i++) {
+        report.metrics[i] = metrics->latency[i].Snapshot();
+    }
+    return report;
 }
 
 void BridgeInstance::ConvertPixelFormat(unsigned char* pixels, size_t numPixels) {
@@ -80,143 +226,648 @@ void BridgeInstance::ConvertPixelFormat(unsigned char* pixels, size_t numPixels)
     }
 }
 
-DWORD WINAPI BridgeInstance::SpoutToNDIThread(LPVOID param) {
-    BridgeInstance* instance = static_cast<BridgeInstance*>(param);
-    if (!instance) return 1;
-    
-    // Setup NDI sender with bridge name
-    NDIlib_send_create_t NDI_send_create_desc = { instance->bridgeName.c_str(), NULL, TRUE, FALSE };
-    instance->ndiSender = NDIlib_send_create(&NDI_send_create_desc);
-    if (!instance->ndiSender) {
-        return 1;
+void BridgeInstance::ConvertFrame(VideoFrame& frame) {
+    // Rows may be padded; convert each one in place
+    if (frame.strideBytes == (size_t)frame.width * 4) {
+        ConvertPixelFormat(frame.data, (size_t)frame.width * frame.height);
+        return;
     }
-    
-    // Get Spout receiver
-    instance->spout = CreateSpoutInstance();
-    if (!instance->spout) {
-        NDIlib_send_destroy(instance->ndiSender);
-        instance->ndiSender = nullptr;
-        return 1;
+    for (unsigned int y = 0; y < frame.height; y++) {
+        ConvertPixelFormat(frame.data + y * frame.strideBytes, frame.width);
     }
+}
 
-    char* sourceName = const_cast<char*>(instance->sourceName.c_str());
-    unsigned int width = 0, height = 0;
-    
+void BridgeInstance::ConvertPixelRegion(const unsigned char* src, unsigned char* dst, size_t strideBytes,
+                                        unsigned int x, unsigned int y, unsigned int w, unsigned int h) {
+    // Same R/B swap as ConvertPixelFormat, copying one tile from src into dst
+    for (unsigned int row = y; row < y + h; row++) {
+        const unsigned char* s = src + row * strideBytes + x * 4;
+        unsigned char* d = dst + row * strideBytes + x * 4;
+        for (unsigned int i = 0; i < w * 4; i += 4) {
+            d[i] = s[i + 2];
+            d[i + 1] = s[i + 1];
+            d[i + 2] = s[i];
+            d[i + 3] = s[i + 3];
+        }
+    }
+}
+
+bool BridgeInstance::OpenSource(BridgeInstance* instance, FrameSource& source) {
     // Create receiver connection with retry
     int retryCount = 0;
     const int maxRetries = 10;
     while (retryCount < maxRetries && !instance->shouldStop) {
-        if (instance->spout->CreateReceiver(sourceName, width, height)) {
-            break;
+        if (source.Open()) {
+            return true;
         }
-        Sleep(100); // Wait 100ms before retry
+        instance->stopEvent.Wait(100); // Wait 100ms before retry
         retryCount++;
     }
+    return false;
+}
+
+void BridgeInstance::SpoutToNDIThread(BridgeInstance* instance) {
+    LiveSettings settings;
+    instance->TakeSettings(settings);
 
-    if (retryCount >= maxRetries || instance->shouldStop) {
-        instance->spout->Release();
-        instance->spout = nullptr;
-        NDIlib_send_destroy(instance->ndiSender);
-        instance->ndiSender = nullptr;
-        return 1;
+    // Setup NDI sender with bridge name
+    std::unique_ptr<FrameSink> sink = instance->backend->CreateSink(FrameEndpoint::NDI);
+    if (!sink || !sink->Open(settings.bridgeName)) {
+        return;
     }
 
-    // Validate dimensions
-    if (width == 0 || height == 0) {
-        instance->spout->ReleaseReceiver();
-        instance->spout->Release();
-        instance->spout = nullptr;
-        NDIlib_send_destroy(instance->ndiSender);
-        instance->ndiSender = nullptr;
-        return 1;
+    // Get Spout receiver
+    std::unique_ptr<FrameSource> source = CreateBridgeSource(instance->backend, FrameEndpoint::Spout,
+                                                             instance->sourceName, settings.options);
+    if (!source || !OpenSource(instance, *source)) {
+        return;
     }
 
-    // Create buffers for pixel data
-    std::vector<unsigned char> pixels(width * height * 4);
+    // With dirty tiles enabled, conversion writes into a persistent output
+    // frame and only changed tiles are reconverted. Otherwise the captured
+    // frame is converted in place. Frames from a shared capture are read-only
+    // and come converted from the source, once for all bridges on it.
+    const bool sharedFrames = source->IsShared();
+    bool useDirtyTiles = settings.options.dirtyTiles && !sharedFrames;
+    Platform::FrameBuffer outputPixels;
+    Platform::FrameBuffer scaledPixels;         // Output resized to the bridge's output size
+    std::unique_ptr<FrameScaler> scaler;
+    FramePyramid pyramid;                       // Proxy output levels
+    TileTracker tileTracker(settings.options.tileSize);
+    std::vector<bool> dirtyRows;                // Source rows under the last frame's dirty tiles
+    DuplicateFilter duplicateFilter(settings.options.duplicateFilter);
+    std::shared_ptr<BridgeMetrics> metrics = settings.metrics;
+    BridgeCounters* counters = &metrics->counters;
+
+    unsigned int width = 0, height = 0;
+    size_t strideBytes = 0;
+    uint64_t frameId = 0;
 
-    // Setup NDI video frame
-    NDIlib_video_frame_v2_t NDI_video_frame = {0};
-    NDI_video_frame.xres = width;
-    NDI_video_frame.yres = height;
-    NDI_video_frame.FourCC = instance->GetNDIColorSpace();
-    NDI_video_frame.p_data = pixels.data();
-    NDI_video_frame.line_stride_in_bytes = width * 4;
-    NDI_video_frame.frame_rate_N = 60000;
-    NDI_video_frame.frame_rate_D = 1000;
-    NDI_video_frame.picture_aspect_ratio = (float)width / (float)height;
+    auto poolBytes = [&]() {
+        return strideBytes * height + outputPixels.size() + scaledPixels.size() +
+               (scaler ? scaler->GetMemoryBytes() : 0) + pyramid.GetMemoryBytes();
+    };
+
+    auto allocateBuffers = [&]() {
+        TRACE_SCOPE(Trace::Event::PoolAlloc, frameId);
+        outputPixels.assign(useDirtyTiles ? strideBytes * height : 0, 0);
+        counters->SetPoolBytes(poolBytes());
+        tileTracker.Invalidate();
+        duplicateFilter.Reset();
+    };
+
+    // One NDI sender per proxy level; a proxy that fails to open is left
+    // out rather than stopping the bridge
+    std::vector<std::unique_ptr<FrameSink>> proxySinks;
+    auto openProxies = [&](const std::string& bridgeName, unsigned int count) {
+        for (auto& proxySink : proxySinks) {
+            if (proxySink) proxySink->Close();
+        }
+        proxySinks.clear();
+        for (unsigned int level = 1; level <= std::min(count, FramePyramid::kMaxLevels); level++) {
+            std::unique_ptr<FrameSink> proxySink = instance->backend->CreateSink(FrameEndpoint::NDI);
+            if (proxySink && !proxySink->Open(ProxyOutputName(bridgeName, level))) {
+                proxySink.reset();
+            }
+            proxySinks.push_back(std::move(proxySink));
+        }
+        if (proxySinks.empty()) {
+            pyramid = FramePyramid();
+        }
+    };
+    openProxies(settings.bridgeName, settings.options.proxyOutputs);
+
+    // Whether anyone receives the output or one of its proxies. Outputs
+    // that can't tell count as watched. The output waits up to waitMs for a
+    // first receiver; the proxies are only asked.
+    auto isWatched = [&](unsigned int waitMs) {
+        if (sink->GetConnections(waitMs) != 0) return true;
+        for (auto& proxySink : proxySinks) {
+            if (proxySink && proxySink->GetConnections(0) != 0) return true;
+        }
+        return false;
+    };
+
+    // Idle: nobody is watching, so frames are neither captured nor sent,
+    // apart from one every idleFrameMs. Coming back, the first frame is
+    // converted and sent in full even if it has not changed.
+    bool idle = false;
+    Clock::time_point nextConnectionCheck = Clock::now();
+    Clock::time_point idleTick;
+    Clock::time_point lastIdleFrame;
+    int64_t lastSequence = -1;
+    auto setIdle = [&](bool nextIdle, Clock::time_point now) {
+        idle = nextIdle;
+        idleTick = now;
+        lastIdleFrame = Clock::time_point();
+        source->SetPaused(idle);
+        counters->SetIdle(idle);
+        if (!idle) {
+            duplicateFilter.Reset();
+            tileTracker.Invalidate();
+            lastSequence = -1;
+        }
+    };
+
+    Trace::SetThreadName("Spout->NDI " + settings.bridgeName);
+    Platform::SetCurrentThreadName("Spout->NDI " + settings.bridgeName);
+    Platform::SetCurrentThreadAffinity(settings.options.cpu);
 
     while (!instance->shouldStop) {
-        // Try to receive the texture data directly into our pixel buffer
-        if (instance->spout->ReceiveImage(pixels.data(), instance->GetGLColorSpace(), false)) {
-            // Convert pixel format before sending
-            instance->ConvertPixelFormat(pixels.data(), width * height);
-            NDIlib_send_send_video_v2(instance->ndiSender, &NDI_video_frame);
+        frameId++;
+
+        // Apply a rename or retune between frames; the Spout receiver stays connected
+        LiveSettings next;
+        if (instance->TakeSettings(next)) {
+            if (next.bridgeName != settings.bridgeName) {
+                sink->Close();
+                if (!sink->Open(next.bridgeName)) {
+                    break;
+                }
+                Trace::SetThreadName("Spout->NDI " + next.bridgeName);
+                Platform::SetCurrentThreadName("Spout->NDI " + next.bridgeName);
+            }
+            if (next.bridgeName != settings.bridgeName || next.options.proxyOutputs != settings.options.proxyOutputs) {
+                openProxies(next.bridgeName, next.options.proxyOutputs);
+            }
+            if (next.options.cpu != settings.options.cpu) {
+                Platform::SetCurrentThreadAffinity(next.options.cpu);
+            }
+            metrics = next.metrics;
+            counters = &metrics->counters;
+            // A rename or other retune keeps the duplicate history
+            if (next.options.duplicateFilter != settings.options.duplicateFilter) {
+                duplicateFilter = DuplicateFilter(next.options.duplicateFilter);
+            }
+            bool nextDirtyTiles = next.options.dirtyTiles && !sharedFrames;
+            if (nextDirtyTiles != useDirtyTiles || next.options.tileSize != tileTracker.GetTileSize()) {
+                useDirtyTiles = nextDirtyTiles;
+                tileTracker = TileTracker(next.options.tileSize);
+                allocateBuffers();
+            }
+            if (next.options.outputWidth == 0 || next.options.outputHeight == 0) {
+                Platform::FrameBuffer().swap(scaledPixels);
+                scaler.reset();
+            }
+            counters->SetPoolBytes(poolBytes());
+            counters->SetIdle(idle);
+            settings = std::move(next);
         }
-        Sleep(16); // ~60fps
-    }
 
-    instance->spout->ReleaseReceiver();
-    instance->spout->Release();
-    instance->spout = nullptr;
-    NDIlib_send_destroy(instance->ndiSender);
-    instance->ndiSender = nullptr;
-    return 0;
+        // Check for receivers now and then while watched. While idle the
+        // check is the wait, and it returns as soon as a receiver connects.
+        if (settings.options.idleWhenUnwatched && (idle || Clock::now() >= nextConnectionCheck)) {
+            bool watched;
+            {
+                TRACE_SCOPE(Trace::Event::Wait, frameId);
+                watched = isWatched(idle ? kCaptureTimeoutMs : 0);
+            }
+            Clock::time_point now = Clock::now();
+            nextConnectionCheck = now + std::chrono::milliseconds(kConnectionCheckMs);
+            if (watched == idle) {
+                setIdle(!watched, now);
+            }
+        }
+        else if (idle && !settings.options.idleWhenUnwatched) {
+            setIdle(false, Clock::now());
+        }
+        if (idle) {
+            Clock::time_point now = Clock::now();
+            counters->AddIdleNs(ElapsedNs(idleTick, now));
+            counters->UpdateRate(ToNs(now));
+            idleTick = now;
+            bool idleFrameDue = settings.options.idleFrameMs > 0 &&
+                                now - lastIdleFrame >= std::chrono::milliseconds(settings.options.idleFrameMs);
+            source->SetPaused(!idleFrameDue);
+            if (!idleFrameDue) {
+                continue;
+            }
+            // Still due until a frame actually goes out
+            duplicateFilter.Reset();
+        }
+
+        // Try to receive the next frame from the sender
+        Clock::time_point captureStart = Clock::now();
+        counters->UpdateRate(ToNs(captureStart));
+        VideoFrame frame;
+        CaptureResult result;
+        {
+            TRACE_SCOPE(Trace::Event::Capture, frameId);
+            result = source->Capture(frame, kCaptureTimeoutMs);
+        }
+        Clock::time_point captureEnd = Clock::now();
+        counters->SetQueueDepth(source->GetQueuedFrames());
+
+        // The sender changed size: the frame just read is not usable, retry at the new size
+        if (result == CaptureResult::FormatChanged) {
+            counters->AddReconnects();
+            continue;
+        }
+        if (result == CaptureResult::Disconnected) {
+            // Frames missed while the sender was away are not drops
+            lastSequence = -1;
+        }
+
+        if (result == CaptureResult::Frame) {
+            counters->AddFramesIn();
+            counters->RecordStage(PipelineStage::Capture, ElapsedNs(captureStart, captureEnd));
+            metrics->latency[(int)LatencyMetric::CaptureWait].Record(ElapsedNs(captureStart, captureEnd));
+
+            if (frame.width != width || frame.height != height || frame.strideBytes != strideBytes) {
+                width = frame.width;
+                height = frame.height;
+                strideBytes = frame.strideBytes;
+                allocateBuffers();
+            }
+
+            // Gaps in the sender's frame counter are frames we never saw
+            if (frame.sequence >= 0) {
+                if (lastSequence >= 0 && frame.sequence > lastSequence + 1) {
+                    counters->AddDrops(frame.sequence - lastSequence - 1);
+                }
+                lastSequence = frame.sequence;
+            }
+
+            // Skip unchanged frames before paying for conversion and encoding.
+            // The tile hashes double as the frame hash when dirty tiles are on.
+            bool send = true;
+            if (useDirtyTiles || duplicateFilter.IsEnabled()) {
+                TRACE_SCOPE(Trace::Event::Hash, frameId);
+                Clock::time_point hashStart = Clock::now();
+                uint64_t hash;
+                if (useDirtyTiles) {
+                    tileTracker.Update(frame.data, width, height, strideBytes);
+                    hash = tileTracker.GetFrameHash();
+                }
+                else {
+                    hash = FrameHash::HashImage(frame.data, width, height, strideBytes,
+                                                duplicateFilter.GetSettings().hashMode);
+                }
+                Clock::time_point hashEnd = Clock::now();
+                counters->RecordStage(PipelineStage::Hash, ElapsedNs(hashStart, hashEnd));
+                send = duplicateFilter.ShouldSend(hash, hashEnd);
+            }
+
+            if (send) {
+                Clock::time_point convertStart = Clock::now();
+                // Convert pixel format before sending
+                VideoFrame output = frame;
+                std::shared_ptr<const VideoFrame> converted;
+                if (sharedFrames) {
+                    TRACE_SCOPE(Trace::Event::Convert, frameId);
+                    // Same R/B swap as ConvertFrame, done by the first bridge to ask for it
+                    PixelFormat target = frame.format == PixelFormat::BGRA ? PixelFormat::RGBA : PixelFormat::BGRA;
+                    converted = source->Convert(frame, target);
+                    if (!converted) {
+                        source->Release(frame);
+                        continue;
+                    }
+                    output = *converted;
+                }
+                else if (useDirtyTiles) {
+                    TRACE_SCOPE(Trace::Event::Convert, frameId);
+                    size_t converted = 0;
+                    dirtyRows.assign(height, false);
+                    tileTracker.ForEachDirtyTile([&](unsigned int x, unsigned int y, unsigned int w, unsigned int h) {
+                        ConvertPixelRegion(frame.data, outputPixels.data(), strideBytes, x, y, w, h);
+                        converted += (size_t)w * h;
+                        std::fill(dirtyRows.begin() + y, dirtyRows.begin() + y + h, true);
+                    });
+                    counters->AddTiles(tileTracker.GetTileCount(), tileTracker.GetDirtyCount());
+                    counters->AddPixels(converted, (size_t)width * height - converted);
+                    output.data = outputPixels.data();
+                }
+                else {
+                    TRACE_SCOPE(Trace::Event::Convert, frameId);
+                    ConvertFrame(output);
+                    counters->AddPixels((size_t)width * height, 0);
+                }
+                Clock::time_point sendStart = Clock::now();
+                counters->RecordStage(PipelineStage::Convert, ElapsedNs(convertStart, sendStart));
+                metrics->latency[(int)LatencyMetric::Conversion].Record(ElapsedNs(convertStart, sendStart));
+
+                if (ScaleOutput(scaler, settings.options, output, scaledPixels, frameId,
+                                useDirtyTiles ? &dirtyRows : nullptr)) {
+                    Clock::time_point scaleEnd = Clock::now();
+                    counters->RecordStage(PipelineStage::Scale, ElapsedNs(sendStart, scaleEnd));
+                    counters->SetPoolBytes(poolBytes());
+                    sendStart = scaleEnd;
+                }
+
+                {
+                    TRACE_SCOPE(Trace::Event::Send, frameId);
+                    sink->Send(output);
+                }
+                Clock::time_point sendEnd = Clock::now();
+                uint64_t sendNs = ElapsedNs(sendStart, sendEnd);
+                if (idle) {
+                    lastIdleFrame = sendEnd;
+                }
+
+                // Proxies go out after the full-size output so they never delay it
+                if (!proxySinks.empty()) {
+                    bool built;
+                    {
+                        TRACE_SCOPE(Trace::Event::Scale, frameId);
+                        size_t pyramidBytes = pyramid.GetMemoryBytes();
+                        built = pyramid.Build(output, (unsigned int)proxySinks.size());
+                        if (pyramid.GetMemoryBytes() != pyramidBytes) {
+                            counters->SetPoolBytes(poolBytes());
+                        }
+                    }
+                    Clock::time_point pyramidEnd = Clock::now();
+                    counters->RecordStage(PipelineStage::Scale, ElapsedNs(sendEnd, pyramidEnd));
+                    if (built) {
+                        TRACE_SCOPE(Trace::Event::Send, frameId);
+                        for (size_t i = 0; i < proxySinks.size(); i++) {
+                            if (proxySinks[i]) proxySinks[i]->Send(pyramid.GetLevel((unsigned int)i + 1));
+                        }
+                    }
+                    sendEnd = Clock::now();
+                    sendNs += ElapsedNs(pyramidEnd, sendEnd);
+                }
+                counters->RecordStage(PipelineStage::Send, sendNs);
+                metrics->latency[(int)LatencyMetric::Send].Record(sendNs);
+                metrics->latency[(int)LatencyMetric::EndToEnd].Record(ElapsedNs(captureStart, sendEnd));
+                counters->AddFramesOut();
+                counters->SetFirstFrameOut(ToNs(sendEnd));
+                counters->AddBytesProcessed((uint64_t)width * height * 4);
+                converted.reset();
+            }
+            else {
+                counters->AddDuplicates();
+            }
+            source->Release(frame);
+        }
+
+        TRACE_SCOPE(Trace::Event::Wait, frameId);
+        instance->stopEvent.Wait(source->GetPollIntervalMs()); // ~60fps; returns early on a stop request
+    }
 }
 
-DWORD WINAPI BridgeInstance::NDIToSpoutThread(LPVOID param) {
-    BridgeInstance* instance = static_cast<BridgeInstance*>(param);
-    if (!instance) return 1;
-    
+void BridgeInstance::NDIToSpoutThread(BridgeInstance* instance) {
+    LiveSettings settings;
+    instance->TakeSettings(settings);
+
     // Setup NDI receiver
-    NDIlib_recv_create_v3_t NDI_recv_create_desc = { 0 };
-    NDIlib_source_t source;
-    source.p_ndi_name = instance->sourceName.c_str();
-    NDI_recv_create_desc.source_to_connect_to = source;
-    NDI_recv_create_desc.color_format = instance->GetNDIReceiverColorSpace();
-    instance->ndiReceiver = NDIlib_recv_create_v3(&NDI_recv_create_desc);
-    if (!instance->ndiReceiver) {
-        return 1;
-    }
-    
+    std::unique_ptr<FrameSource> source = CreateBridgeSource(instance->backend, FrameEndpoint::NDI,
+                                                             instance->sourceName, settings.options);
+    if (!source || !OpenSource(instance, *source)) {
+        return;
+    }
+
     // Get Spout sender
-    instance->spout = CreateSpoutInstance();
-    if (!instance->spout) {
-        NDIlib_recv_destroy(instance->ndiReceiver);
-        instance->ndiReceiver = nullptr;
-        return 1;
+    std::unique_ptr<FrameSink> sink = instance->backend->CreateSink(FrameEndpoint::Spout);
+    if (!sink || !sink->Open(settings.bridgeName)) {
+        return;
     }
 
-    char* targetName = const_cast<char*>(instance->bridgeName.c_str());
-    
-    NDIlib_video_frame_v2_t video_frame;
+    std::shared_ptr<BridgeMetrics> metrics = settings.metrics;
+    BridgeCounters* counters = &metrics->counters;
+    const bool sharedFrames = source->IsShared();
+    Platform::FrameBuffer scaledPixels;         // Output resized to the bridge's output size
+    std::unique_ptr<FrameScaler> scaler;
+    std::unique_ptr<JitterBuffer> jitter;       // Holds converted frames until their release time
+    std::unique_ptr<TimeBaseCorrector> timeBase;  // Or paces them on our clock instead
+    auto createBuffers = [&](const BridgeOptions& options) {
+        jitter.reset();
+        timeBase.reset();
+        if (options.timeBase.enabled) {
+            timeBase = std::make_unique<TimeBaseCorrector>(options.timeBase);
+        }
+        else if (options.jitterBuffer.enabled) {
+            jitter = std::make_unique<JitterBuffer>(options.jitterBuffer);
+        }
+    };
+    createBuffers(settings.options);
+    auto nextDueNs = [&]() -> uint64_t {
+        return jitter ? jitter->GetNextReleaseNs() : timeBase ? timeBase->GetNextTickNs() : 0;
+    };
+    unsigned int senderWidth = 0, senderHeight = 0;
+    uint64_t frameId = 0;
+    int64_t lastSequence = -1;
+    ReceiverStats lastReceiverStats;
+
+    auto updatePoolBytes = [&]() {
+        counters->SetPoolBytes(scaledPixels.size() + (scaler ? scaler->GetMemoryBytes() : 0) +
+                               (jitter ? jitter->GetMemoryBytes() : 0) + (timeBase ? timeBase->GetMemoryBytes() : 0));
+    };
+
+    // Hand a converted frame to Spout; endToEndNs is the time it spent in
+    // the bridge before sendStart, bytes the pixel bytes it was made from
+    auto sendOutput = [&](const VideoFrame& output, Clock::time_point sendStart, uint64_t endToEndNs, uint64_t bytes) {
+        // A new geometry means the Spout sender is recreated
+        if (senderWidth != 0 && (output.width != senderWidth || output.height != senderHeight)) {
+            counters->AddReconnects();
+        }
+        senderWidth = output.width;
+        senderHeight = output.height;
+
+        {
+            TRACE_SCOPE(Trace::Event::Send, frameId);
+            sink->Send(output);
+        }
+        Clock::time_point sendEnd = Clock::now();
+        counters->RecordStage(PipelineStage::Send, ElapsedNs(sendStart, sendEnd));
+        metrics->latency[(int)LatencyMetric::Send].Record(ElapsedNs(sendStart, sendEnd));
+        metrics->latency[(int)LatencyMetric::EndToEnd].Record(endToEndNs + ElapsedNs(sendStart, sendEnd));
+        counters->AddFramesOut();
+        counters->SetFirstFrameOut(ToNs(sendEnd));
+        counters->AddBytesProcessed(bytes);
+    };
+
+    Trace::SetThreadName("NDI->Spout " + settings.bridgeName);
+    Platform::SetCurrentThreadName("NDI->Spout " + settings.bridgeName);
+    Platform::SetCurrentThreadAffinity(settings.options.cpu);
+
     while (!instance->shouldStop) {
-        switch (NDIlib_recv_capture_v2(instance->ndiReceiver, &video_frame, nullptr, nullptr, 1000)) {
-            case NDIlib_frame_type_video: {
-                if (video_frame.xres > 0 && video_frame.yres > 0) {
-                    // Create or update the sender with the current frame dimensions
-                    if (!instance->spout->CreateSender(targetName, video_frame.xres, video_frame.yres)) {
-                        instance->spout->UpdateSender(targetName, video_frame.xres, video_frame.yres);
+        frameId++;
+
+        // Apply a rename between frames; the NDI receiver stays connected
+        LiveSettings next;
+        if (instance->TakeSettings(next)) {
+            if (next.bridgeName != settings.bridgeName) {
+                // The next frame creates the sender under its new name
+                sink->Close();
+                if (!sink->Open(next.bridgeName)) {
+                    break;
+                }
+                senderWidth = 0;
+                senderHeight = 0;
+                Trace::SetThreadName("NDI->Spout " + next.bridgeName);
+                Platform::SetCurrentThreadName("NDI->Spout " + next.bridgeName);
+            }
+            if (next.options.cpu != settings.options.cpu) {
+                Platform::SetCurrentThreadAffinity(next.options.cpu);
+            }
+            if (next.options.outputWidth == 0 || next.options.outputHeight == 0) {
+                Platform::FrameBuffer().swap(scaledPixels);
+                scaler.reset();
+            }
+            // New buffers drop the frames the old ones held
+            const JitterBufferSettings& jb = next.options.jitterBuffer;
+            const TimeBaseSettings& tb = next.options.timeBase;
+            if (jb.enabled != settings.options.jitterBuffer.enabled ||
+                jb.maxLatencyMs != settings.options.jitterBuffer.maxLatencyMs ||
+                tb.enabled != settings.options.timeBase.enabled || tb.frameRateN != settings.options.timeBase.frameRateN ||
+                tb.frameRateD != settings.options.timeBase.frameRateD) {
+                createBuffers(next.options);
+            }
+            metrics = next.metrics;
+            counters = &metrics->counters;
+            counters->SetJitterBuffer(0, 0);
+            counters->SetClockDrift(0.0);
+            updatePoolBytes();
+            settings = std::move(next);
+        }
+
+        // Take the newest frame the receiver has, passing over any backlog,
+        // and wait only when nothing is queued. A jitter buffer or time-base
+        // corrector takes every frame instead, and the wait ends when its
+        // next frame or output tick is due.
+        Clock::time_point captureStart = Clock::now();
+        counters->UpdateRate(ToNs(captureStart));
+        VideoFrame frame;
+        CaptureResult result;
+        uint64_t skipped = 0;
+        {
+            TRACE_SCOPE(Trace::Event::Capture, frameId);
+            if (jitter || timeBase) {
+                result = source->Capture(frame, WaitUntilMs(nextDueNs(), ToNs(captureStart), kCaptureTimeoutMs));
+            }
+            else {
+                result = CaptureNewest(*source, frame, kCaptureTimeoutMs, skipped);
+            }
+        }
+        counters->SetQueueDepth(source->GetQueuedFrames());
+
+        // Receiver totals start over when it reconnects
+        ReceiverStats receiverStats = source->GetReceiverStats();
+        uint64_t receiverDrops = receiverStats.framesDropped >= lastReceiverStats.framesDropped
+                                     ? receiverStats.framesDropped - lastReceiverStats.framesDropped
+                                     : receiverStats.framesDropped;
+        lastReceiverStats = receiverStats;
+        counters->AddReceiverDrops(receiverDrops);
+        counters->AddSkippedFrames(skipped);
+        // Frames with a counter show both as gaps below
+        if (result != CaptureResult::Frame || frame.sequence < 0) {
+            counters->AddDrops(receiverDrops + skipped);
+        }
+
+        if (result == CaptureResult::Frame) {
+            Clock::time_point captureEnd = Clock::now();
+            counters->AddFramesIn();
+            counters->RecordStage(PipelineStage::Capture, ElapsedNs(captureStart, captureEnd));
+            metrics->latency[(int)LatencyMetric::CaptureWait].Record(ElapsedNs(captureStart, captureEnd));
+
+            // NDI frames carry no counter; a shared capture numbers them, so
+            // frames this bridge's queue dropped show up as gaps
+            if (frame.sequence >= 0) {
+                if (lastSequence >= 0 && frame.sequence > lastSequence + 1) {
+                    counters->AddDrops(frame.sequence - lastSequence - 1);
+                }
+                lastSequence = frame.sequence;
+            }
+
+            if (frame.width > 0 && frame.height > 0) {
+                // Convert pixel format before sending; shared frames come
+                // converted from the source, once for all its bridges
+                Clock::time_point convertStart = Clock::now();
+                VideoFrame output = frame;
+                std::shared_ptr<const VideoFrame> converted;
+                if (sharedFrames) {
+                    TRACE_SCOPE(Trace::Event::Convert, frameId);
+                    PixelFormat target = frame.format == PixelFormat::BGRA ? PixelFormat::RGBA : PixelFormat::BGRA;
+                    converted = source->Convert(frame, target);
+                    if (!converted) {
+                        source->Release(frame);
+                        continue;
                     }
-                    
-                    // Convert pixel format before sending
-                    instance->ConvertPixelFormat((unsigned char*)video_frame.p_data, video_frame.xres * video_frame.yres);
-                    
-                    // Send the frame data
-                    instance->spout->SendImage(video_frame.p_data, video_frame.xres, video_frame.yres, instance->GetGLColorSpace());
+                    output = *converted;
+                }
+                else {
+                    TRACE_SCOPE(Trace::Event::Convert, frameId);
+                    ConvertFrame(output);
+                    counters->AddPixels((uint64_t)frame.width * frame.height, 0);
+                }
+                Clock::time_point sendStart = Clock::now();
+                counters->RecordStage(PipelineStage::Convert, ElapsedNs(convertStart, sendStart));
+                metrics->latency[(int)LatencyMetric::Conversion].Record(ElapsedNs(convertStart, sendStart));
+
+                if (ScaleOutput(scaler, settings.options, output, scaledPixels, frameId)) {
+                    Clock::time_point scaleEnd = Clock::now();
+                    counters->RecordStage(PipelineStage::Scale, ElapsedNs(sendStart, scaleEnd));
+                    updatePoolBytes();
+                    sendStart = scaleEnd;
+                }
+
+                if (jitter) {
+                    // Queued by arrival time; the copy frees the receiver's buffer at once
+                    JitterPush pushed = jitter->Push(output, ToNs(captureEnd), ElapsedNs(captureStart, captureEnd));
+                    if (pushed == JitterPush::Late) {
+                        counters->AddJitterUnderruns();
+                    }
+                    else if (pushed == JitterPush::Stale) {
+                        counters->AddDrops();
+                    }
+                    updatePoolBytes();
+                }
+                else if (timeBase) {
+                    timeBase->Push(output, ToNs(captureEnd), ElapsedNs(captureStart, captureEnd));
+                    updatePoolBytes();
+                }
+                else {
+                    sendOutput(output, sendStart, ElapsedNs(captureStart, sendStart),
+                               (uint64_t)frame.width * frame.height * 4);
                 }
-                NDIlib_recv_free_video_v2(instance->ndiReceiver, &video_frame);
-                break;
             }
+            source->Release(frame);
+        }
+        else if (result == CaptureResult::Disconnected) {
+            lastSequence = -1;
+        }
+        else if (result == CaptureResult::FormatChanged) {
+            // Counted as a reconnect when the first frame at the new size arrives
+            continue;
+        }
+
+        unsigned int waitMs = source->GetPollIntervalMs();
+        if (jitter) {
+            // Send the newest frame that is due; any older due ones are passed over
+            Clock::time_point popTime = Clock::now();
+            uint64_t waitedNs = 0, latencyNs = 0, passedOver = 0;
+            if (const VideoFrame* due = jitter->Pop(ToNs(popTime), waitedNs, latencyNs, passedOver)) {
+                counters->AddSkippedFrames(passedOver);
+                counters->AddDrops(passedOver);
+                metrics->latency[(int)LatencyMetric::JitterBuffer].Record(waitedNs);
+                sendOutput(*due, popTime, latencyNs, (uint64_t)due->width * due->height * 4);
+            }
+            counters->SetJitterBuffer(jitter->GetFrameCount(), jitter->GetDelayNs());
+            waitMs = WaitUntilMs(nextDueNs(), ToNs(Clock::now()), waitMs);
+        }
+        else if (timeBase) {
+            // One frame per tick of our clock, repeated or passed over as the sender drifts
+            Clock::time_point tickTime = Clock::now();
+            uint64_t tickNs = timeBase->GetNextTickNs();
+            if (tickNs != 0 && ToNs(tickTime) >= tickNs) {
+                TimeBaseTick tick = timeBase->Tick(ToNs(tickTime));
+                if (tick.frame) {
+                    if (tick.repeated) {
+                        counters->AddSyncRepeats();
+                    }
+                    counters->AddSyncDrops(tick.dropped);
+                    counters->AddDrops(tick.dropped);
+                    sendOutput(*tick.frame, tickTime, tick.latencyNs,
+                               (uint64_t)tick.frame->width * tick.frame->height * 4);
+                }
+            }
+            counters->SetClockDrift(timeBase->GetDriftPpm());
+            waitMs = WaitUntilMs(nextDueNs(), ToNs(Clock::now()), waitMs);
         }
-        Sleep(16); // ~60fps
-    }
 
-    instance->spout->ReleaseSender();
-    instance->spout->Release();
-    instance->spout = nullptr;
-    NDIlib_recv_destroy(instance->ndiReceiver);
-    instance->ndiReceiver = nullptr;
-    return 0;
+        TRACE_SCOPE(Trace::Event::Wait, frameId);
+        instance->stopEvent.Wait(waitMs); // ~60fps; returns early on a stop request
+    }
 }
 
 // Initialize the global instances vector
@@ -1,7 +1,21 @@
 #pragma once
 
-// Include SDK headers first to ensure proper definitions
-#include "SDKIncludes.h"
+#include "DuplicateFilter.h"
+#include "DirtyTiles.h"
+#include "BridgeMetrics.h"
+#include "FrameFanOut.h"
+#include "FrameIO.h"
+#include "JitterBuffer.h"
+#include "Mosaic.h"
+#include "Platform.h"
+#include "Scaler.h"
+#include "TimeBaseCorrector.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Color space options
 enum class ColorSpace {
@@ -10,41 +24,122 @@ enum class ColorSpace {
     UYVY = 2
 };
 
+const char* ColorSpaceName(ColorSpace colorSpace);
+
+// Optional per-bridge tuning
+struct BridgeOptions {
+    DuplicateFilterSettings duplicateFilter;
+    bool dirtyTiles = true;          // Reconvert only tiles that changed since the last frame
+    unsigned int tileSize = 64;
+    int cpu = -1;                    // Pin the bridge thread to this logical CPU; -1 lets the OS schedule it
+    bool shareCapture = false;       // Share one capture and conversion with other bridges on the same source;
+                                     // shared frames are converted whole, without dirty tiles
+    SubscriptionSettings subscription;  // This bridge's queue on a shared capture
+    MosaicSettings mosaic;           // Output of a bridge on a "mosaic:" source
+    unsigned int outputWidth = 0;    // Resize frames to this before sending; 0 keeps the source size
+    unsigned int outputHeight = 0;
+    ScaleFilter scaleFilter = ScaleFilter::Bilinear;
+    unsigned int proxyOutputs = 0;   // Spout to NDI: extra senders at 1/2 and 1/4 of the output size, 0-2
+    bool idleWhenUnwatched = true;   // Spout to NDI: stop capturing while no NDI receiver is connected
+    unsigned int idleFrameMs = 1000; // Spout to NDI: while idle, still send a frame this often; 0 sends none
+    ReceiveBandwidth receiveBandwidth = ReceiveBandwidth::Highest;  // NDI to Spout: which stream to pull
+    bool allowFields = false;        // NDI to Spout: take interlaced sources as separate fields
+    std::string receiverName;        // NDI to Spout: receiver name shown to senders; empty for the default
+    JitterBufferSettings jitterBuffer;  // NDI to Spout: smooth out network arrival jitter
+    TimeBaseSettings timeBase;       // NDI to Spout: send at our own clock's rate; replaces the jitter buffer
+};
+
+// Name of the NDI sender for proxy output level (1 is half size) of a bridge
+std::string ProxyOutputName(const std::string& bridgeName, unsigned int level);
+
 class BridgeInstance {
 public:
     BridgeInstance();
     ~BridgeInstance();
 
-    bool Start(const char* sourceName, const char* bridgeName, bool isSpoutToNDI, ColorSpace colorSpace);
+    bool Start(const char* sourceName, const char* bridgeName, bool isSpoutToNDI, ColorSpace colorSpace,
+               const BridgeOptions& options = BridgeOptions());
     void Stop();
 
+    // Change the output name, color space and tuning of a running bridge
+    // without restarting it. The bridge thread picks the change up between
+    // frames; renaming recreates only the output and starts a fresh metrics
+    // series under the new name. Returns false if the bridge is not running.
+    bool Update(const char* bridgeName, ColorSpace colorSpace, const BridgeOptions& options);
+
+    // Capture and output backend for the next Start(); the process default unless set
+    void SetBackend(std::shared_ptr<FrameBackend> backend) { this->backend = std::move(backend); }
+
+    // Stable identity used to match the bridge against configuration changes;
+    // also labels the bridge's metrics from the next Start()
+    const std::string& GetId() const { return id; }
+    void SetId(const std::string& id) { this->id = id; }
+
+    // Ask the bridge thread to finish without waiting for it. Calling this on
+    // every bridge before Stop() lets them all shut down in parallel.
+    void RequestStop() {
+        shouldStop = true;
+        stopEvent.Set();
+    }
+
     bool IsRunning() const { return isRunning; }
     const std::string& GetSourceName() const { return sourceName; }
     const std::string& GetBridgeName() const { return bridgeName; }
     bool IsSpoutToNDI() const { return isSpoutToNDI; }
     ColorSpace GetColorSpace() const { return colorSpace; }
+    const BridgeOptions& GetOptions() const { return options; }
+
+    // Lock-free snapshot of the bridge's counters; callable from any thread
+    BridgeStats GetStats() const { return metrics->counters.Snapshot(); }
+
+    // Latency distributions; snapshot or roll a LatencyWindow over them from any thread
+    const LatencyHistogram& GetLatencyHistogram(LatencyMetric metric) const { return metrics->latency[(int)metric]; }
+    LatencyReport GetLatencyReport() const;
+
+    // Shared with the metrics registry while the bridge is running
+    std::shared_ptr<const BridgeMetrics> GetMetrics() const { return metrics; }
 
 private:
-    static DWORD WINAPI SpoutToNDIThread(LPVOID param);
-    static DWORD WINAPI NDIToSpoutThread(LPVOID param);
-    
-    NDIlib_FourCC_video_type_e GetNDIColorSpace() const;
-    NDIlib_recv_color_format_e GetNDIReceiverColorSpace() const;
-    GLenum GetGLColorSpace() const;
+    // What the bridge thread may be told to change while it runs
+    struct LiveSettings {
+        std::string bridgeName;
+        BridgeOptions options;
+        std::shared_ptr<BridgeMetrics> metrics;
+    };
 
+    void ResetMetrics();
+    void PublishSettings();
+    bool TakeSettings(LiveSettings& settings);
+
+    static bool OpenSource(BridgeInstance* instance, FrameSource& source);
+    static void SpoutToNDIThread(BridgeInstance* instance);
+    static void NDIToSpoutThread(BridgeInstance* instance);
+    
     // Pixel format conversion
-    void ConvertPixelFormat(unsigned char* pixels, size_t numPixels);
+    static void ConvertPixelFormat(unsigned char* pixels, size_t numPixels);
+    static void ConvertFrame(VideoFrame& frame);
+    static void ConvertPixelRegion(const unsigned char* src, unsigned char* dst, size_t strideBytes,
+                                   unsigned int x, unsigned int y, unsigned int w, unsigned int h);
 
+    std::string id;
     bool isSpoutToNDI;
     std::string sourceName;
     std::string bridgeName;
     ColorSpace colorSpace;
+    BridgeOptions options;
     bool isRunning;
-    SPOUTHANDLE spout;
-    NDIlib_send_instance_t ndiSender;
-    NDIlib_recv_instance_t ndiReceiver;
-    HANDLE conversionThread;
-    bool shouldStop;
+    std::shared_ptr<FrameBackend> backend;
+    std::thread conversionThread;
+    std::atomic<bool> shouldStop;
+    Platform::Event stopEvent;       // Wakes the bridge thread out of its pacing wait
+
+    std::shared_ptr<BridgeMetrics> metrics;
+
+    // Handed from the controlling thread to the bridge thread; the bridge
+    // thread only reads its name, options and metrics through here
+    std::mutex settingsMutex;
+    LiveSettings pendingSettings;
+    std::atomic<bool> settingsChanged;
 };
 
 // Global instances vector
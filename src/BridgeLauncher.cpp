@@ -0,0 +1,152 @@
+#include "BridgeLauncher.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Fallback launch time when the OS can't tell us: static initialisation
+    const Clock::time_point staticInitTime = Clock::now();
+
+    uint64_t ToNs(Clock::time_point t) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    bool QueryProcessUptimeNs(uint64_t& uptimeNs) {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user, now;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+            return false;
+        }
+        GetSystemTimeAsFileTime(&now);
+        auto ticks = [](const FILETIME& ft) { return ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime; };
+        if (ticks(now) < ticks(creation)) return false;
+        uptimeNs = (ticks(now) - ticks(creation)) * 100;
+        return true;
+#elif defined(__linux__)
+        // Field 22 of /proc/self/stat is the start time in clock ticks since boot
+        std::ifstream stat("/proc/self/stat");
+        std::string content((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+        size_t pos = content.rfind(')');
+        if (pos == std::string::npos) return false;
+        unsigned long long startTicks = 0;
+        if (sscanf(content.c_str() + pos + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+                   &startTicks) != 1) {
+            return false;
+        }
+        timespec boot;
+        long ticksPerSecond = sysconf(_SC_CLK_TCK);
+        if (ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &boot) != 0) return false;
+        uint64_t nowNs = (uint64_t)boot.tv_sec * 1000000000ull + (uint64_t)boot.tv_nsec;
+        uint64_t startNs = startTicks * (1000000000ull / (uint64_t)ticksPerSecond);
+        if (nowNs < startNs) return false;
+        uptimeNs = nowNs - startNs;
+        return true;
+#else
+        (void)uptimeNs;
+        return false;
+#endif
+    }
+
+    // Process launch on the steady clock used by the bridge counters
+    uint64_t ProcessStartNs() {
+        Clock::time_point now = Clock::now();
+        uint64_t uptimeNs = 0;
+        if (!QueryProcessUptimeNs(uptimeNs) || uptimeNs > ToNs(now)) {
+            return ToNs(staticInitTime);
+        }
+        return ToNs(now) - uptimeNs;
+    }
+}
+
+BridgeList StartBridges(const std::vector<BridgeDefinition>& definitions, std::vector<std::string>& errors) {
+    std::vector<std::unique_ptr<BridgeInstance>> slots(definitions.size());
+    std::vector<std::string> slotErrors(definitions.size());
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < definitions.size(); i = next++) {
+            const BridgeDefinition& definition = definitions[i];
+            try {
+                auto bridge = std::make_unique<BridgeInstance>();
+                bridge->SetId(definition.id.empty() ? GenerateBridgeId() : definition.id);
+                if (bridge->Start(definition.source.c_str(), definition.name.c_str(), definition.isSpoutToNDI,
+                                  definition.colorSpace, definition.options)) {
+                    slots[i] = std::move(bridge);
+                }
+                else {
+                    slotErrors[i] = "Failed to start " + definition.name;
+                }
+            }
+            catch (const std::exception& e) {
+                slotErrors[i] = "Failed to create " + definition.name + ": " + e.what();
+            }
+        }
+    };
+
+    size_t workerCount = std::min<size_t>(definitions.size(), std::max(4u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+
+    BridgeList bridges;
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i]) {
+            bridges.push_back(std::move(slots[i]));
+        }
+        else {
+            errors.push_back(slotErrors[i]);
+        }
+    }
+    return bridges;
+}
+
+BridgeDefinition DescribeBridge(const BridgeInstance& bridge) {
+    BridgeDefinition definition;
+    definition.id = bridge.GetId();
+    definition.name = bridge.GetBridgeName();
+    definition.source = bridge.GetSourceName();
+    definition.isSpoutToNDI = bridge.IsSpoutToNDI();
+    definition.colorSpace = bridge.GetColorSpace();
+    definition.options = bridge.GetOptions();
+    return definition;
+}
+
+std::vector<BridgeDefinition> DescribeBridges(const BridgeList& bridges) {
+    std::vector<BridgeDefinition> definitions;
+    definitions.reserve(bridges.size());
+    for (const auto& bridge : bridges) {
+        definitions.push_back(DescribeBridge(*bridge));
+    }
+    return definitions;
+}
+
+double TimeToAllStreamingMs(const BridgeList& bridges) {
+    uint64_t lastFirstFrameNs = 0;
+    for (const auto& bridge : bridges) {
+        uint64_t firstFrameNs = bridge->GetStats().firstFrameOutNs;
+        if (!firstFrameNs) return -1.0;
+        lastFirstFrameNs = std::max(lastFirstFrameNs, firstFrameNs);
+    }
+    uint64_t startNs = ProcessStartNs();
+    return lastFirstFrameNs > startNs ? (lastFirstFrameNs - startNs) / 1e6 : 0.0;
+}
+
+double ProcessUptimeMs() {
+    return (ToNs(Clock::now()) - ProcessStartNs()) / 1e6;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "BridgeConfig.h"
+#include "BridgeInstance.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using BridgeList = std::vector<std::unique_ptr<BridgeInstance>>;
+
+// Create and start bridges on a small worker pool so SDK initialisation for
+// one bridge never waits on another. Returns the bridges that started, in
+// definition order; failures are described in errors.
+BridgeList StartBridges(const std::vector<BridgeDefinition>& definitions, std::vector<std::string>& errors);
+
+// Current parameters of running bridges, for saving
+BridgeDefinition DescribeBridge(const BridgeInstance& bridge);
+std::vector<BridgeDefinition> DescribeBridges(const BridgeList& bridges);
+
+// Milliseconds from process launch until the last bridge sent its first
+// frame, or a negative value while any bridge has not streamed yet
+double TimeToAllStreamingMs(const BridgeList& bridges);
+
+// Milliseconds since the OS created this process
+double ProcessUptimeMs();
@@ -0,0 +1,102 @@
+#include "BridgeListModel.h"
+#include <cstdio>
+#include <unordered_map>
+
+namespace {
+    std::string FormatNumber(const char* format, double value) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), format, value);
+        return buffer;
+    }
+}
+
+void BridgeListModel::Reset(const std::vector<BridgeListEntry>& entries) {
+    // Carry live state across for bridges that are still the same run
+    std::unordered_map<const BridgeMetrics*, Row*> previous;
+    for (Row& row : rows) {
+        if (row.entry.metrics) {
+            previous[row.entry.metrics.get()] = &row;
+        }
+    }
+
+    std::vector<Row> updated(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        Row& row = updated[i];
+        auto it = previous.find(entries[i].metrics.get());
+        if (it != previous.end()) {
+            row = std::move(*it->second);
+            previous.erase(it);
+        }
+        row.entry = entries[i];
+        FormatStatic(row);
+        FormatLive(row);
+    }
+    rows = std::move(updated);
+}
+
+std::vector<int> BridgeListModel::Refresh() {
+    std::vector<int> changed;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (FormatLive(rows[i])) {
+            changed.push_back((int)i);
+        }
+    }
+    return changed;
+}
+
+const std::string& BridgeListModel::GetText(int row, BridgeListColumn column) const {
+    static const std::string empty;
+    if (row < 0 || row >= (int)rows.size() || column >= BridgeListColumn::Count) {
+        return empty;
+    }
+    return rows[row].text[(int)column];
+}
+
+void BridgeListModel::FormatStatic(Row& row) {
+    const BridgeMetrics* metrics = row.entry.metrics.get();
+    std::string* text = row.text;
+    text[(int)BridgeListColumn::Name] = metrics ? metrics->bridgeName : std::string();
+    text[(int)BridgeListColumn::Type] = metrics && metrics->direction == "spout_to_ndi" ? u8"Spout → NDI" : u8"NDI → Spout";
+    text[(int)BridgeListColumn::Source] = metrics ? metrics->sourceName : std::string();
+    text[(int)BridgeListColumn::ColorSpace] = row.entry.colorSpace;
+}
+
+bool BridgeListModel::FormatLive(Row& row) {
+    std::string fps = "-", latency = "-", drops = "-", skipped = "-", state = "Stopped";
+
+    if (row.entry.metrics) {
+        BridgeStats stats = row.entry.metrics->counters.Snapshot();
+        HistogramSnapshot window = row.latencyWindow.Roll(row.entry.metrics->latency[(int)LatencyMetric::EndToEnd]);
+
+        if (row.entry.running) {
+            // A running bridge with no new input since the last refresh is waiting on
+            // its source, unless it is resting for lack of receivers
+            state = stats.idle ? "Idle" : stats.framesIn != row.lastFramesIn ? "Streaming" : "Waiting";
+            fps = FormatNumber("%.1f", stats.outputFps);
+            if (window.Count()) {
+                latency = FormatNumber("%.1f ms", window.ValueAtPercentile(99.0) / 1e6);
+            }
+        }
+        drops = std::to_string(stats.drops);
+        if (stats.framesIn) {
+            skipped = FormatNumber("%.0f%%", stats.DuplicatePercent()) +
+                      FormatNumber(" (%.1f s)", stats.DuplicateCpuSavedMs() / 1e3);
+        }
+        row.lastFramesIn = stats.framesIn;
+    }
+
+    std::string* text = row.text;
+    bool changed = text[(int)BridgeListColumn::Fps] != fps ||
+                   text[(int)BridgeListColumn::Latency] != latency ||
+                   text[(int)BridgeListColumn::Drops] != drops ||
+                   text[(int)BridgeListColumn::Skipped] != skipped ||
+                   text[(int)BridgeListColumn::State] != state;
+    if (changed) {
+        text[(int)BridgeListColumn::Fps] = std::move(fps);
+        text[(int)BridgeListColumn::Latency] = std::move(latency);
+        text[(int)BridgeListColumn::Drops] = std::move(drops);
+        text[(int)BridgeListColumn::Skipped] = std::move(skipped);
+        text[(int)BridgeListColumn::State] = std::move(state);
+    }
+    return changed;
+}
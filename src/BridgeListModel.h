@@ -0,0 +1,56 @@
+#pragma once
+
+#include "BridgeMetrics.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Columns of the bridge list, in display order
+enum class BridgeListColumn {
+    Name = 0,
+    Type,
+    Source,
+    ColorSpace,
+    Fps,
+    Latency,
+    Drops,
+    Skipped,      // Unchanged frames skipped, and the CPU time that saved
+    State,
+    Count
+};
+
+// What the list needs to know about one bridge
+struct BridgeListEntry {
+    std::shared_ptr<const BridgeMetrics> metrics;
+    std::string colorSpace;
+    bool running = false;
+};
+
+// Snapshot model behind the virtual (owner-data) bridge list. All cell text is
+// formatted up front on the UI thread, so the view only looks strings up when
+// it paints. Free of Win32 so it can be driven and checked on its own.
+class BridgeListModel {
+public:
+    // Replace the rows after a bridge is added, edited or removed. Rows whose
+    // metrics object is unchanged keep their rolling latency window.
+    void Reset(const std::vector<BridgeListEntry>& entries);
+
+    // Re-sample the live columns; returns the rows whose text changed
+    std::vector<int> Refresh();
+
+    int GetRowCount() const { return (int)rows.size(); }
+    const std::string& GetText(int row, BridgeListColumn column) const;
+
+private:
+    struct Row {
+        BridgeListEntry entry;
+        LatencyWindow latencyWindow;
+        uint64_t lastFramesIn = 0;
+        std::string text[(int)BridgeListColumn::Count];
+    };
+
+    static void FormatStatic(Row& row);
+    static bool FormatLive(Row& row);
+
+    std::vector<Row> rows;
+};
@@ -0,0 +1,34 @@
+#include "BridgeMetrics.h"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+    // Writers serialize on the mutex and publish a fresh list; readers only
+    // ever do an atomic shared_ptr load.
+    std::mutex g_writeMutex;
+    std::shared_ptr<const MetricsRegistry::List> g_list = std::make_shared<const MetricsRegistry::List>();
+}
+
+namespace MetricsRegistry {
+    void Register(const std::shared_ptr<const BridgeMetrics>& metrics) {
+        if (!metrics) return;
+
+        std::lock_guard<std::mutex> lock(g_writeMutex);
+        auto next = std::make_shared<List>(*std::atomic_load(&g_list));
+        next->push_back(metrics);
+        std::atomic_store(&g_list, std::shared_ptr<const List>(std::move(next)));
+    }
+
+    void Unregister(const BridgeMetrics* metrics) {
+        std::lock_guard<std::mutex> lock(g_writeMutex);
+        auto next = std::make_shared<List>(*std::atomic_load(&g_list));
+        next->erase(std::remove_if(next->begin(), next->end(),
+            [metrics](const std::shared_ptr<const BridgeMetrics>& m) { return m.get() == metrics; }),
+            next->end());
+        std::atomic_store(&g_list, std::shared_ptr<const List>(std::move(next)));
+    }
+
+    std::shared_ptr<const List> Snapshot() {
+        return std::atomic_load(&g_list);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "BridgeStats.h"
+#include "LatencyHistogram.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Everything a bridge publishes about itself. Shared between the bridge and
+// metric readers so a reader can keep rendering a bridge that was just deleted.
+// Labels are fixed before the metrics are registered and never change after.
+struct BridgeMetrics {
+    std::string bridgeId;    // Tells apart bridges that share a name
+    std::string bridgeName;
+    std::string sourceName;
+    std::string direction;   // "spout_to_ndi" or "ndi_to_spout"
+
+    BridgeCounters counters;
+    LatencyHistogram latency[(int)LatencyMetric::Count];
+};
+
+// Process-wide list of live bridge metrics. Bridges add and remove themselves
+// on start/stop; readers get an immutable copy-on-write list without taking the
+// registry mutex. Bridge threads never touch the registry while streaming.
+namespace MetricsRegistry {
+    using List = std::vector<std::shared_ptr<const BridgeMetrics>>;
+
+    void Register(const std::shared_ptr<const BridgeMetrics>& metrics);
+    void Unregister(const BridgeMetrics* metrics);
+
+    // Current list; never observes a half-updated list
+    std::shared_ptr<const List> Snapshot();
+}
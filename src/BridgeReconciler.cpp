@@ -0,0 +1,196 @@
+#include "BridgeReconciler.h"
+#include <unordered_map>
+
+namespace {
+    bool SameMosaic(const MosaicSettings& a, const MosaicSettings& b) {
+        return a.width == b.width && a.height == b.height && a.frameRateN == b.frameRateN &&
+               a.frameRateD == b.frameRateD && a.columns == b.columns && a.proxy == b.proxy;
+    }
+
+    bool SameReceiver(const BridgeOptions& a, const BridgeOptions& b) {
+        return a.receiveBandwidth == b.receiveBandwidth && a.allowFields == b.allowFields &&
+               a.receiverName == b.receiverName;
+    }
+
+    bool SameOptions(const BridgeOptions& a, const BridgeOptions& b) {
+        return a.duplicateFilter == b.duplicateFilter &&
+               a.dirtyTiles == b.dirtyTiles && a.tileSize == b.tileSize && a.cpu == b.cpu &&
+               a.shareCapture == b.shareCapture && a.subscription.queueDepth == b.subscription.queueDepth &&
+               a.subscription.dropPolicy == b.subscription.dropPolicy && SameMosaic(a.mosaic, b.mosaic) &&
+               a.outputWidth == b.outputWidth && a.outputHeight == b.outputHeight && a.scaleFilter == b.scaleFilter &&
+               a.proxyOutputs == b.proxyOutputs && a.idleWhenUnwatched == b.idleWhenUnwatched &&
+               a.idleFrameMs == b.idleFrameMs && SameReceiver(a, b) &&
+               a.jitterBuffer.enabled == b.jitterBuffer.enabled &&
+               a.jitterBuffer.maxLatencyMs == b.jitterBuffer.maxLatencyMs &&
+               a.timeBase.enabled == b.timeBase.enabled && a.timeBase.frameRateN == b.timeBase.frameRateN &&
+               a.timeBase.frameRateD == b.timeBase.frameRateD;
+    }
+}
+
+const char* BridgeChangeName(BridgeChange change) {
+    switch (change) {
+        case BridgeChange::Unchanged: return "unchanged";
+        case BridgeChange::Update:    return "update";
+        case BridgeChange::Restart:   return "restart";
+        case BridgeChange::Add:       return "add";
+        case BridgeChange::Remove:    return "remove";
+        default:                      return "";
+    }
+}
+
+BridgeChange ClassifyBridgeChange(const BridgeDefinition& current, const BridgeDefinition& desired) {
+    // The capture side is bound to the source, direction, capture sharing,
+    // queue, mosaic layout and NDI receiver settings; everything else lives on the bridge thread and
+    // can change between frames
+    const SubscriptionSettings& cs = current.options.subscription;
+    const SubscriptionSettings& ds = desired.options.subscription;
+    if (current.source != desired.source || current.isSpoutToNDI != desired.isSpoutToNDI ||
+        current.options.shareCapture != desired.options.shareCapture ||
+        cs.queueDepth != ds.queueDepth || cs.dropPolicy != ds.dropPolicy ||
+        !SameMosaic(current.options.mosaic, desired.options.mosaic) ||
+        !SameReceiver(current.options, desired.options)) {
+        return BridgeChange::Restart;
+    }
+    if (current.name != desired.name || current.colorSpace != desired.colorSpace ||
+        !SameOptions(current.options, desired.options)) {
+        return BridgeChange::Update;
+    }
+    return BridgeChange::Unchanged;
+}
+
+std::vector<BridgeChangeStep> PlanBridgeChanges(const std::vector<BridgeDefinition>& current,
+                                                const std::vector<BridgeDefinition>& desired) {
+    std::unordered_map<std::string, int> currentById;
+    for (int i = 0; i < (int)current.size(); i++) {
+        if (!current[i].id.empty()) {
+            currentById.emplace(current[i].id, i);
+        }
+    }
+
+    std::vector<BridgeChangeStep> steps;
+    std::vector<bool> matched(current.size(), false);
+    for (int i = 0; i < (int)desired.size(); i++) {
+        const BridgeDefinition& definition = desired[i];
+        auto it = definition.id.empty() ? currentById.end() : currentById.find(definition.id);
+        if (it == currentById.end() || matched[it->second]) {
+            steps.push_back({ BridgeChange::Add, definition.id, -1, i });
+            continue;
+        }
+        matched[it->second] = true;
+        steps.push_back({ ClassifyBridgeChange(current[it->second], definition), definition.id, it->second, i });
+    }
+    for (int i = 0; i < (int)current.size(); i++) {
+        if (!matched[i]) {
+            steps.push_back({ BridgeChange::Remove, current[i].id, i, -1 });
+        }
+    }
+    return steps;
+}
+
+bool ApplyBridgeDefinition(BridgeInstance& bridge, const BridgeDefinition& definition) {
+    BridgeChange change = ClassifyBridgeChange(DescribeBridge(bridge), definition);
+    if (change == BridgeChange::Restart || !bridge.IsRunning()) {
+        return bridge.Start(definition.source.c_str(), definition.name.c_str(), definition.isSpoutToNDI,
+                            definition.colorSpace, definition.options);
+    }
+    if (change == BridgeChange::Update) {
+        return bridge.Update(definition.name.c_str(), definition.colorSpace, definition.options);
+    }
+    return true;
+}
+
+ReconcileSummary ReconcileBridges(BridgeList& bridges, const std::vector<BridgeDefinition>& desired) {
+    ReconcileSummary summary;
+    std::vector<BridgeChangeStep> steps = PlanBridgeChanges(DescribeBridges(bridges), desired);
+
+    // Signal everything that has to stop first so they all wind down together
+    for (const BridgeChangeStep& step : steps) {
+        if (step.change == BridgeChange::Remove || step.change == BridgeChange::Restart) {
+            bridges[step.currentIndex]->RequestStop();
+        }
+    }
+
+    std::vector<BridgeDefinition> additions;
+    for (const BridgeChangeStep& step : steps) {
+        if (step.change == BridgeChange::Remove) {
+            bridges[step.currentIndex]->Stop();
+            summary.removed++;
+        }
+        else if (step.change == BridgeChange::Add) {
+            // New bridges need an id up front so they can be found after starting
+            additions.push_back(desired[step.desiredIndex]);
+            if (additions.back().id.empty()) {
+                additions.back().id = GenerateBridgeId();
+            }
+        }
+    }
+
+    BridgeList started = StartBridges(additions, summary.errors);
+    std::unordered_map<std::string, std::unique_ptr<BridgeInstance>*> startedById;
+    for (auto& bridge : started) {
+        startedById.emplace(bridge->GetId(), &bridge);
+    }
+
+    BridgeList result;
+    size_t additionIndex = 0;
+    for (const BridgeChangeStep& step : steps) {
+        // A stopped bridge with nothing to change still has to be started again
+        BridgeChange change = step.change;
+        if (change == BridgeChange::Unchanged && !bridges[step.currentIndex]->IsRunning()) {
+            change = BridgeChange::Restart;
+        }
+        switch (change) {
+            case BridgeChange::Unchanged:
+                result.push_back(std::move(bridges[step.currentIndex]));
+                summary.unchanged++;
+                break;
+            case BridgeChange::Update:
+            case BridgeChange::Restart: {
+                // A bridge that fails stays in the list, stopped or as it was, so
+                // its definition is still there to save and retry
+                const BridgeDefinition& definition = desired[step.desiredIndex];
+                bool applied = ApplyBridgeDefinition(*bridges[step.currentIndex], definition);
+                result.push_back(std::move(bridges[step.currentIndex]));
+                if (!applied) {
+                    summary.errors.push_back(std::string("Failed to ") +
+                                             (change == BridgeChange::Update ? "update " : "restart ") +
+                                             definition.name);
+                    break;
+                }
+                (change == BridgeChange::Update ? summary.updated : summary.restarted)++;
+                break;
+            }
+            case BridgeChange::Add: {
+                auto it = startedById.find(additions[additionIndex++].id);
+                if (it != startedById.end()) {
+                    result.push_back(std::move(*it->second));
+                    summary.added++;
+                }
+                break;
+            }
+            case BridgeChange::Remove:
+                break;
+        }
+    }
+
+    bridges = std::move(result);
+    return summary;
+}
+
+std::string FormatReconcileSummary(const ReconcileSummary& summary) {
+    std::string text;
+    auto append = [&text](size_t count, const char* what) {
+        if (!count) return;
+        if (!text.empty()) text += ", ";
+        text += std::to_string(count) + " " + what;
+    };
+    append(summary.updated, "updated");
+    append(summary.restarted, "restarted");
+    append(summary.added, "added");
+    append(summary.removed, "removed");
+    if (text.empty()) {
+        return "no changes";
+    }
+    append(summary.unchanged, "unchanged");
+    return text;
+}
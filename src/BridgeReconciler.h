@@ -0,0 +1,55 @@
+#pragma once
+
+#include "BridgeLauncher.h"
+#include <string>
+#include <vector>
+
+// What it takes to bring one bridge in line with the desired configuration
+enum class BridgeChange {
+    Unchanged = 0,  // Identical definition; the bridge is not touched
+    Update,         // Name, color space or tuning changed; applied while running
+    Restart,        // Source or direction changed; the bridge is stopped and started
+    Add,            // Only in the desired set
+    Remove          // Only in the running set
+};
+
+const char* BridgeChangeName(BridgeChange change);
+
+// How a running bridge described by current must change to match desired
+// (both with the same id)
+BridgeChange ClassifyBridgeChange(const BridgeDefinition& current, const BridgeDefinition& desired);
+
+struct BridgeChangeStep {
+    BridgeChange change;
+    std::string id;
+    int currentIndex;   // Into the running definitions, or -1 for Add
+    int desiredIndex;   // Into the desired definitions, or -1 for Remove
+};
+
+// Diff running against desired by bridge id: one step per desired bridge in
+// desired order, followed by the removals. Pure, so it can be checked on its own.
+std::vector<BridgeChangeStep> PlanBridgeChanges(const std::vector<BridgeDefinition>& current,
+                                                const std::vector<BridgeDefinition>& desired);
+
+// Bring one running bridge in line with its new definition, restarting it
+// only when the source or direction changed. Returns false if a restart failed.
+bool ApplyBridgeDefinition(BridgeInstance& bridge, const BridgeDefinition& definition);
+
+struct ReconcileSummary {
+    size_t unchanged = 0;
+    size_t updated = 0;
+    size_t restarted = 0;
+    size_t added = 0;
+    size_t removed = 0;
+    std::vector<std::string> errors;
+};
+
+// Make bridges match desired, touching only the bridges whose definition
+// changed. Removed and restarted bridges are stopped in parallel and new
+// ones started on the launcher's worker pool. Afterwards bridges is in
+// desired order, minus any new bridge that failed to start; an existing
+// bridge whose update or restart failed is kept and reported in errors.
+ReconcileSummary ReconcileBridges(BridgeList& bridges, const std::vector<BridgeDefinition>& desired);
+
+// "1 updated, 1 added" style one-liner; "no changes" when nothing happened
+std::string FormatReconcileSummary(const ReconcileSummary& summary);
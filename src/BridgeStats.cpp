@@ -0,0 +1,118 @@
+#include "BridgeStats.h"
+
+const char* PipelineStageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Capture: return "capture";
+        case PipelineStage::Hash:    return "hash";
+        case PipelineStage::Convert: return "convert";
+        case PipelineStage::Send:    return "send";
+        case PipelineStage::Scale:   return "scale";
+        default:                     return "unknown";
+    }
+}
+
+double BridgeStats::DuplicateCpuSavedMs() const {
+    // Each skipped frame saves one average conversion + send
+    const StageTiming& convert = Stage(PipelineStage::Convert);
+    const StageTiming& send = Stage(PipelineStage::Send);
+    if (send.count == 0) return 0.0;
+
+    double avgProcessNs = (double)(convert.totalNs + send.totalNs) / send.count;
+    double savedNs = avgProcessNs * duplicates - (double)Stage(PipelineStage::Hash).totalNs;
+    return savedNs / 1e6;
+}
+
+double BridgeStats::DirtyTileSavedMs() const {
+    // Clean tiles would have cost the measured per-pixel conversion time
+    if (pixelsConverted == 0) return 0.0;
+
+    double nsPerPixel = (double)Stage(PipelineStage::Convert).totalNs / pixelsConverted;
+    return nsPerPixel * pixelsReused / 1e6;
+}
+
+BridgeCounters::BridgeCounters()
+    : framesIn(0)
+    , framesOut(0)
+    , duplicates(0)
+    , drops(0)
+    , receiverDrops(0)
+    , skippedFrames(0)
+    , reconnects(0)
+    , bytesProcessed(0)
+    , tilesTotal(0)
+    , tilesDirty(0)
+    , pixelsConverted(0)
+    , pixelsReused(0)
+    , queueDepth(0)
+    , poolBytes(0)
+    , firstFrameOutNs(0)
+    , idle(0)
+    , idleNs(0)
+    , jitterFrames(0)
+    , jitterDelayNs(0)
+    , jitterUnderruns(0)
+    , syncRepeats(0)
+    , syncDrops(0)
+    , outputFps(0.0)
+    , clockDriftPpm(0.0)
+    , rateWindowStartNs(0)
+    , rateWindowFrames(0)
+{
+    for (Stage& s : stages) {
+        s.count.store(0, std::memory_order_relaxed);
+        s.totalNs.store(0, std::memory_order_relaxed);
+        s.maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void BridgeCounters::UpdateRate(uint64_t nowNs) {
+    const uint64_t windowNs = 1000000000ull;
+    uint64_t frames = framesOut.load(std::memory_order_relaxed);
+    if (rateWindowStartNs == 0) {
+        rateWindowStartNs = nowNs;
+        rateWindowFrames = frames;
+        return;
+    }
+
+    uint64_t elapsed = nowNs - rateWindowStartNs;
+    if (elapsed >= windowNs) {
+        outputFps.store((double)(frames - rateWindowFrames) * 1e9 / elapsed, std::memory_order_relaxed);
+        rateWindowStartNs = nowNs;
+        rateWindowFrames = frames;
+    }
+}
+
+BridgeStats BridgeCounters::Snapshot() const {
+    BridgeStats stats;
+    stats.framesIn = framesIn.load(std::memory_order_relaxed);
+    stats.framesOut = framesOut.load(std::memory_order_relaxed);
+    stats.duplicates = duplicates.load(std::memory_order_relaxed);
+    stats.drops = drops.load(std::memory_order_relaxed);
+    stats.receiverDrops = receiverDrops.load(std::memory_order_relaxed);
+    stats.skippedFrames = skippedFrames.load(std::memory_order_relaxed);
+    stats.reconnects = reconnects.load(std::memory_order_relaxed);
+    stats.bytesProcessed = bytesProcessed.load(std::memory_order_relaxed);
+    stats.outputFps = outputFps.load(std::memory_order_relaxed);
+    stats.queueDepth = queueDepth.load(std::memory_order_relaxed);
+    stats.poolBytes = poolBytes.load(std::memory_order_relaxed);
+    stats.firstFrameOutNs = firstFrameOutNs.load(std::memory_order_relaxed);
+    stats.idle = idle.load(std::memory_order_relaxed);
+    stats.idleNs = idleNs.load(std::memory_order_relaxed);
+    stats.jitterFrames = jitterFrames.load(std::memory_order_relaxed);
+    stats.jitterDelayNs = jitterDelayNs.load(std::memory_order_relaxed);
+    stats.jitterUnderruns = jitterUnderruns.load(std::memory_order_relaxed);
+    stats.syncRepeats = syncRepeats.load(std::memory_order_relaxed);
+    stats.syncDrops = syncDrops.load(std::memory_order_relaxed);
+    stats.clockDriftPpm = clockDriftPpm.load(std::memory_order_relaxed);
+    stats.tilesTotal = tilesTotal.load(std::memory_order_relaxed);
+    stats.tilesDirty = tilesDirty.load(std::memory_order_relaxed);
+    stats.pixelsConverted = pixelsConverted.load(std::memory_order_relaxed);
+    stats.pixelsReused = pixelsReused.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < (int)PipelineStage::Count; i++) {
+        stats.stages[i].count = stages[i].count.load(std::memory_order_relaxed);
+        stats.stages[i].totalNs = stages[i].totalNs.load(std::memory_order_relaxed);
+        stats.stages[i].maxNs = stages[i].maxNs.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Pipeline stages timed per bridge
+enum class PipelineStage {
+    Capture = 0,   // Waiting for / receiving a frame from the source
+    Hash = 1,      // Duplicate and dirty-tile hashing
+    Convert = 2,   // Pixel format conversion
+    Send = 3,      // Handing the frame to the output
+    Scale = 4,     // Resizing to the bridge's output size
+    Count
+};
+
+const char* PipelineStageName(PipelineStage stage);
+
+struct StageTiming {
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+
+    double AverageMs() const { return count ? (double)totalNs / count / 1e6 : 0.0; }
+};
+
+// Point-in-time copy of a bridge's counters. Plain data, safe to pass around.
+struct BridgeStats {
+    uint64_t framesIn = 0;         // Frames received from the source
+    uint64_t framesOut = 0;        // Frames sent to the output
+    uint64_t duplicates = 0;       // Frames skipped as unchanged
+    uint64_t drops = 0;            // Frames lost before or inside the bridge
+    uint64_t receiverDrops = 0;    // Frames the source's receiver threw away, also in drops
+    uint64_t skippedFrames = 0;    // Queued frames passed over for a newer one, also in drops
+    uint64_t reconnects = 0;       // Source reconnects or format changes
+    uint64_t bytesProcessed = 0;   // Pixel bytes converted and sent
+    double outputFps = 0.0;        // Frames out per second over the last ~1 s
+    uint64_t queueDepth = 0;       // Frames waiting inside or in front of the bridge
+    uint64_t poolBytes = 0;        // Frame buffer memory held by the bridge
+    uint64_t firstFrameOutNs = 0;  // Steady-clock time the first frame was sent; 0 until then
+    uint64_t idle = 0;             // 1 while the bridge rests because nobody receives its output
+    uint64_t idleNs = 0;           // Time spent resting that way
+    uint64_t jitterFrames = 0;     // Frames waiting in the jitter buffer
+    uint64_t jitterDelayNs = 0;    // Delay the jitter buffer currently adds
+    uint64_t jitterUnderruns = 0;  // Frames that reached the jitter buffer after their release time
+    uint64_t syncRepeats = 0;      // Time-base corrector: ticks that showed the last frame again
+    uint64_t syncDrops = 0;        // Time-base corrector: frames passed over, also in drops
+    double clockDriftPpm = 0.0;    // Time-base corrector: sender clock against ours, + when fast
+
+    // Dirty-tile detection. Pixels count only conversions the bridge does
+    // itself; frames from a shared capture arrive converted and count neither.
+    uint64_t tilesTotal = 0;
+    uint64_t tilesDirty = 0;
+    uint64_t pixelsConverted = 0;
+    uint64_t pixelsReused = 0;
+
+    StageTiming stages[(int)PipelineStage::Count];
+
+    const StageTiming& Stage(PipelineStage stage) const { return stages[(int)stage]; }
+
+    double DuplicatePercent() const {
+        return framesIn ? 100.0 * duplicates / framesIn : 0.0;
+    }
+
+    double DirtyTileRatio() const {
+        return tilesTotal ? (double)tilesDirty / tilesTotal : 0.0;
+    }
+
+    // Estimated conversion + send time avoided by skipping duplicates, net of hashing
+    double DuplicateCpuSavedMs() const;
+
+    // Estimated conversion time avoided by reusing clean tiles
+    double DirtyTileSavedMs() const;
+};
+
+// Per-bridge counters. Only the bridge thread writes them, so updates are
+// plain relaxed load/store pairs with no locked instructions; any other
+// thread may call Snapshot() at any time without blocking the writer.
+class BridgeCounters {
+public:
+    BridgeCounters();
+
+    void AddFramesIn(uint64_t n = 1) { Add(framesIn, n); }
+    void AddFramesOut(uint64_t n = 1) { Add(framesOut, n); }
+    void AddDuplicates(uint64_t n = 1) { Add(duplicates, n); }
+    void AddDrops(uint64_t n = 1) { Add(drops, n); }
+    void AddReceiverDrops(uint64_t n) { Add(receiverDrops, n); }
+    void AddSkippedFrames(uint64_t n) { Add(skippedFrames, n); }
+    void AddReconnects(uint64_t n = 1) { Add(reconnects, n); }
+    void AddBytesProcessed(uint64_t n) { Add(bytesProcessed, n); }
+
+    void AddTiles(uint64_t total, uint64_t dirty) {
+        Add(tilesTotal, total);
+        Add(tilesDirty, dirty);
+    }
+
+    void AddPixels(uint64_t converted, uint64_t reused) {
+        Add(pixelsConverted, converted);
+        Add(pixelsReused, reused);
+    }
+
+    void SetQueueDepth(uint64_t depth) { queueDepth.store(depth, std::memory_order_relaxed); }
+    void SetPoolBytes(uint64_t bytes) { poolBytes.store(bytes, std::memory_order_relaxed); }
+    void SetIdle(bool isIdle) { idle.store(isIdle ? 1 : 0, std::memory_order_relaxed); }
+    void AddIdleNs(uint64_t ns) { Add(idleNs, ns); }
+
+    void SetJitterBuffer(uint64_t frames, uint64_t delayNs) {
+        jitterFrames.store(frames, std::memory_order_relaxed);
+        jitterDelayNs.store(delayNs, std::memory_order_relaxed);
+    }
+    void AddJitterUnderruns(uint64_t n = 1) { Add(jitterUnderruns, n); }
+    void AddSyncRepeats(uint64_t n = 1) { Add(syncRepeats, n); }
+    void AddSyncDrops(uint64_t n) { Add(syncDrops, n); }
+    void SetClockDrift(double ppm) { clockDriftPpm.store(ppm, std::memory_order_relaxed); }
+
+    // Remember when the bridge started streaming; later calls are ignored
+    void SetFirstFrameOut(uint64_t nowNs) {
+        if (!firstFrameOutNs.load(std::memory_order_relaxed)) {
+            firstFrameOutNs.store(nowNs, std::memory_order_relaxed);
+        }
+    }
+
+    // Recompute the output frame rate; cheap enough to call every loop iteration
+    void UpdateRate(uint64_t nowNs);
+
+    void RecordStage(PipelineStage stage, uint64_t ns) {
+        Stage& s = stages[(int)stage];
+        Add(s.count, 1);
+        Add(s.totalNs, ns);
+        if (ns > s.maxNs.load(std::memory_order_relaxed)) {
+            s.maxNs.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    BridgeStats Snapshot() const;
+
+private:
+    static void Add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    struct Stage {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxNs;
+    };
+
+    // Kept on its own cache line so readers don't share with neighbouring data
+    alignas(64) std::atomic<uint64_t> framesIn;
+    std::atomic<uint64_t> framesOut;
+    std::atomic<uint64_t> duplicates;
+    std::atomic<uint64_t> drops;
+    std::atomic<uint64_t> receiverDrops;
+    std::atomic<uint64_t> skippedFrames;
+    std::atomic<uint64_t> reconnects;
+    std::atomic<uint64_t> bytesProcessed;
+    std::atomic<uint64_t> tilesTotal;
+    std::atomic<uint64_t> tilesDirty;
+    std::atomic<uint64_t> pixelsConverted;
+    std::atomic<uint64_t> pixelsReused;
+    Stage stages[(int)PipelineStage::Count];
+    std::atomic<uint64_t> queueDepth;
+    std::atomic<uint64_t> poolBytes;
+    std::atomic<uint64_t> firstFrameOutNs;
+    std::atomic<uint64_t> idle;
+    std::atomic<uint64_t> idleNs;
+    std::atomic<uint64_t> jitterFrames;
+    std::atomic<uint64_t> jitterDelayNs;
+    std::atomic<uint64_t> jitterUnderruns;
+    std::atomic<uint64_t> syncRepeats;
+    std::atomic<uint64_t> syncDrops;
+    std::atomic<double> outputFps;
+    std::atomic<double> clockDriftPpm;
+
+    // Rate window, touched only by the writer
+    uint64_t rateWindowStartNs;
+    uint64_t rateWindowFrames;
+};
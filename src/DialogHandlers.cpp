@@ -1,9 +1,11 @@
 #include "DialogHandlers.h"
 #include "resource.h"
 #include "BridgeInstance.h"
+#include "BridgeReconciler.h"
 #include "ListView.h"
 #include "Utils.h"
 #include "SDKIncludes.h"
+#include "TestPattern.h"
 #include <mutex>
 
 // Mutex for thread-safe bridge instance management
@@ -93,6 +95,11 @@ void PopulateSourceList(HWND hList, bool isSpoutSource) {
         }
     }
 
+    // Built-in test patterns work in either direction
+    for (const std::string& name : GetPatternSourceNames()) {
+        SendMessageA(hList, LB_ADDSTRING, 0, (LPARAM)name.c_str());
+    }
+
     // Select first item if any exist
     if (SendMessage(hList, LB_GETCOUNT, 0, 0) > 0) {
         SendMessage(hList, LB_SETCURSEL, 0, 0);
@@ -228,10 +235,22 @@ INT_PTR CALLBACK CreateBridge(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPa
                             ColorSpace colorSpace = static_cast<ColorSpace>(colorSpaceIdx);
 
                             std::lock_guard<std::mutex> lock(g_instancesMutex);
-                            
+
                             if (isEditing && editIndex < g_instances.size()) {
-                                // Stop the existing bridge
-                                g_instances.erase(g_instances.begin() + editIndex);
+                                // Update the bridge in place; it restarts only for a new source
+                                BridgeInstance& instance = *g_instances[editIndex];
+                                BridgeDefinition definition = DescribeBridge(instance);
+                                definition.name = bridgeName;
+                                definition.source = sourceName;
+                                definition.colorSpace = colorSpace;
+                                if (ApplyBridgeDefinition(instance, definition)) {
+                                    ListView::RefreshList();
+                                    EndDialog(hDlg, IDOK);
+                                }
+                                else {
+                                    MessageBoxW(hDlg, L"Failed to restart bridge", L"Error", MB_OK | MB_ICONERROR);
+                                }
+                                return (INT_PTR)TRUE;
                             }
 
                             // Create and start the new bridge
@@ -241,6 +260,7 @@ INT_PTR CALLBACK CreateBridge(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPa
                                 return (INT_PTR)TRUE;
                             }
 
+                            instance->SetId(GenerateBridgeId());
                             if (instance->Start(sourceName, bridgeName, isSpoutToNDI, colorSpace)) {
                                 g_instances.push_back(std::move(instance));
                                 ListView::RefreshList();
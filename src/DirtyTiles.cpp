@@ -0,0 +1,61 @@
+#include "DirtyTiles.h"
+#include "FrameHash.h"
+
+TileTracker::TileTracker(unsigned int tileSize)
+    : tileSize(tileSize ? tileSize : 64)
+    , width(0)
+    , height(0)
+    , tilesX(0)
+    , tilesY(0)
+    , valid(false)
+    , dirtyCount(0)
+    , frameHash(0)
+{
+}
+
+size_t TileTracker::Update(const unsigned char* pixels, unsigned int width, unsigned int height, size_t strideBytes) {
+    if (!pixels || width == 0 || height == 0) {
+        dirtyCount = 0;
+        return 0;
+    }
+
+    // Geometry change: start over with every tile dirty
+    if (width != this->width || height != this->height) {
+        this->width = width;
+        this->height = height;
+        tilesX = (width + tileSize - 1) / tileSize;
+        tilesY = (height + tileSize - 1) / tileSize;
+        tileHashes.assign((size_t)tilesX * tilesY, 0);
+        dirty.assign(tileHashes.size(), 1);
+        valid = false;
+    }
+
+    dirtyCount = 0;
+    uint64_t combined = (uint64_t)width << 32 | height;
+
+    for (unsigned int ty = 0; ty < tilesY; ty++) {
+        unsigned int y = ty * tileSize;
+        unsigned int h = TileExtent(y, height);
+        for (unsigned int tx = 0; tx < tilesX; tx++) {
+            unsigned int x = tx * tileSize;
+            unsigned int w = TileExtent(x, width);
+            const unsigned char* tile = pixels + (size_t)y * strideBytes + (size_t)x * 4;
+
+            // Tile rows are strided, so hash them as a sub-image
+            uint64_t hash = FrameHash::HashImage(tile, w, h, strideBytes, FrameHash::Mode::Full);
+
+            size_t index = (size_t)ty * tilesX + tx;
+            bool changed = !valid || hash != tileHashes[index];
+            tileHashes[index] = hash;
+            dirty[index] = changed ? 1 : 0;
+            dirtyCount += changed ? 1 : 0;
+
+            combined = (combined ^ hash) * 0x9E3779B185EBCA87ull;
+            combined ^= combined >> 29;
+        }
+    }
+
+    frameHash = combined;
+    valid = true;
+    return dirtyCount;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tile-level change detection for mostly static sources.
+// Each frame is split into square tiles; a tile is dirty when its content hash
+// differs from the previous frame. Per-pixel stages can then reprocess only the
+// dirty tiles into a persistent output frame.
+class TileTracker {
+public:
+    explicit TileTracker(unsigned int tileSize = 64);
+
+    // Hash every tile of a 4-byte-per-pixel image and mark changed tiles.
+    // A size change (or Invalidate) marks every tile dirty. Returns the dirty count.
+    size_t Update(const unsigned char* pixels, unsigned int width, unsigned int height, size_t strideBytes);
+
+    // Mark every tile dirty on the next Update
+    void Invalidate() { valid = false; }
+
+    // Call fn(x, y, w, h) in pixels for every dirty tile of the last Update
+    template <typename Fn>
+    void ForEachDirtyTile(Fn fn) const {
+        for (unsigned int ty = 0; ty < tilesY; ty++) {
+            for (unsigned int tx = 0; tx < tilesX; tx++) {
+                if (dirty[ty * tilesX + tx]) {
+                    unsigned int x = tx * tileSize;
+                    unsigned int y = ty * tileSize;
+                    fn(x, y, TileExtent(x, width), TileExtent(y, height));
+                }
+            }
+        }
+    }
+
+    unsigned int GetTileSize() const { return tileSize; }
+    size_t GetTileCount() const { return tileHashes.size(); }
+    size_t GetDirtyCount() const { return dirtyCount; }
+    double GetDirtyRatio() const { return tileHashes.empty() ? 0.0 : (double)dirtyCount / tileHashes.size(); }
+
+    // Whole-frame hash derived from the tile hashes, usable for duplicate detection
+    uint64_t GetFrameHash() const { return frameHash; }
+
+private:
+    unsigned int TileExtent(unsigned int start, unsigned int limit) const {
+        return start + tileSize <= limit ? tileSize : limit - start;
+    }
+
+    unsigned int tileSize;
+    unsigned int width;
+    unsigned int height;
+    unsigned int tilesX;
+    unsigned int tilesY;
+    bool valid;
+    size_t dirtyCount;
+    uint64_t frameHash;
+    std::vector<uint64_t> tileHashes;
+    std::vector<unsigned char> dirty;
+};
@@ -0,0 +1,37 @@
+#include "DuplicateFilter.h"
+
+DuplicateFilter::DuplicateFilter(const DuplicateFilterSettings& settings)
+    : settings(settings)
+    , hasLastFrame(false)
+    , lastHash(0)
+{
+}
+
+bool DuplicateFilter::ShouldSend(uint64_t hash, Clock::time_point now) {
+    if (settings.policy == DuplicatePolicy::Off) {
+        return true;
+    }
+
+    // New content always goes out immediately
+    if (!hasLastFrame || hash != lastHash) {
+        hasLastFrame = true;
+        lastHash = hash;
+        lastSendTime = now;
+        return true;
+    }
+
+    // Identical content: only resend once the interval has elapsed
+    unsigned int intervalMs = settings.policy == DuplicatePolicy::Suppress
+        ? settings.keepAliveMs
+        : settings.rateLimitMs;
+    if (now - lastSendTime >= std::chrono::milliseconds(intervalMs)) {
+        lastSendTime = now;
+        return true;
+    }
+    return false;
+}
+
+void DuplicateFilter::Reset() {
+    hasLastFrame = false;
+    lastHash = 0;
+}
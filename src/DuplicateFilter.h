@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FrameHash.h"
+#include <chrono>
+#include <cstdint>
+
+// What to do with a frame whose content hash matches the previous frame
+enum class DuplicatePolicy {
+    Off = 0,        // Always send every captured frame
+    Suppress = 1,   // Drop identical frames, resend only as a keep-alive
+    RateLimit = 2   // Let identical frames through at a reduced rate
+};
+
+struct DuplicateFilterSettings {
+    DuplicatePolicy policy = DuplicatePolicy::Suppress;
+    FrameHash::Mode hashMode = FrameHash::Mode::Full;
+    unsigned int keepAliveMs = 1000;   // Suppress: resend an unchanged frame at least this often
+    unsigned int rateLimitMs = 100;    // RateLimit: minimum spacing between identical frames
+};
+
+inline bool operator==(const DuplicateFilterSettings& a, const DuplicateFilterSettings& b) {
+    return a.policy == b.policy && a.hashMode == b.hashMode && a.keepAliveMs == b.keepAliveMs &&
+           a.rateLimitMs == b.rateLimitMs;
+}
+
+inline bool operator!=(const DuplicateFilterSettings& a, const DuplicateFilterSettings& b) {
+    return !(a == b);
+}
+
+// Decides per frame whether identical content should be sent again.
+// Not thread-safe; each bridge thread owns its own filter.
+class DuplicateFilter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit DuplicateFilter(const DuplicateFilterSettings& settings = DuplicateFilterSettings());
+
+    bool IsEnabled() const { return settings.policy != DuplicatePolicy::Off; }
+    const DuplicateFilterSettings& GetSettings() const { return settings; }
+
+    // Returns true if a frame with this hash should be processed and sent
+    bool ShouldSend(uint64_t hash, Clock::time_point now);
+
+    // Forget the last frame, e.g. after a resolution change
+    void Reset();
+
+private:
+    DuplicateFilterSettings settings;
+    bool hasLastFrame;
+    uint64_t lastHash;
+    Clock::time_point lastSendTime;
+};
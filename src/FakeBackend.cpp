@@ -0,0 +1,492 @@
+#include "FakeBackend.h"
+#include "Platform.h"
+#include "TestPattern.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace {
+    // Well-mixed 64-bit value per (seed, index), so jitter does not depend on call order
+    uint64_t SplitMix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    void FillPattern(unsigned char* pixels, unsigned int width, unsigned int height, uint64_t step,
+                     unsigned int boxSize) {
+        if (boxSize > 0) {
+            // The box steps a box width at a time, row by row, so each change
+            // touches the old and new spots and nothing else
+            unsigned int boxWidth = std::min(boxSize, width);
+            unsigned int boxHeight = std::min(boxSize, height);
+            uint64_t columns = width / boxWidth;
+            uint64_t rows = height / boxHeight;
+            unsigned int boxX = (unsigned int)(step % columns) * boxWidth;
+            unsigned int boxY = (unsigned int)(step / columns % rows) * boxHeight;
+            memset(pixels, 0x40, (size_t)width * height * 4);
+            for (unsigned int y = boxY; y < boxY + boxHeight; y++) {
+                memset(pixels + ((size_t)y * width + boxX) * 4, 0xFF, (size_t)boxWidth * 4);
+            }
+            return;
+        }
+
+        const unsigned int barWidth = std::min(32u, width);
+        unsigned int barX = (unsigned int)((step * 8) % (width - barWidth + 1));
+        for (unsigned int y = 0; y < height; y++) {
+            unsigned char* row = pixels + (size_t)y * width * 4;
+            memset(row, 0x40, (size_t)width * 4);
+            memset(row + (size_t)barX * 4, 0xFF, (size_t)barWidth * 4);
+        }
+    }
+
+    // NDI proxy streams are roughly 640 pixels wide; halve until the width fits
+    void ProxySize(unsigned int& width, unsigned int& height) {
+        while (width > 640 && height >= 32) {
+            width = (width / 2 + 1) & ~1u;
+            height = (height / 2 + 1) & ~1u;
+        }
+    }
+
+    // Network model: compressed NDI video runs around 1 bit per pixel
+    // (~125 Mbit/s at 1080p60); audio is 48 kHz stereo 32-bit float; tally
+    // and status metadata are a few small XML messages a second
+    const double kVideoBitsPerPixel = 1.0;
+    const uint64_t kAudioBytesPerSecond = 48000 * 2 * 4;
+    const uint64_t kMetadataBytesPerSecond = 1000;
+
+    // What an audio- or metadata-only receiver sees: a connection that never carries video
+    class NoVideoFrameSource : public FrameSource {
+    public:
+        bool Open() override { return true; }
+        void Close() override {}
+
+        CaptureResult Capture(VideoFrame&, unsigned int timeoutMs) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return CaptureResult::Timeout;
+        }
+
+        void Release(VideoFrame& frame) override { frame.data = nullptr; }
+
+        unsigned int GetPollIntervalMs() const override { return 0; }
+    };
+
+    class FakeFrameSource : public FrameSource {
+    public:
+        explicit FakeFrameSource(const FakeSourceSettings& settings)
+            : settings(settings)
+            , open(false)
+            , startNs(0)
+            , nextIndex(0)
+            , framesDropped(0)
+            , largeSize(false)
+            , width(settings.width)
+            , height(settings.height)
+            , patternStep(UINT64_MAX)
+        {
+            double rate = settings.frameRate > 0 ? settings.frameRate : 60.0;
+            periodNs = (uint64_t)(1e9 / rate);
+            localPeriodNs = (double)periodNs / (1.0 + settings.clockDriftPpm * 1e-6);
+        }
+
+        bool Open() override {
+            if (width == 0 || height == 0) return false;
+            open = true;
+            startNs = Platform::NowNs();
+            nextIndex = 0;
+            framesDropped = 0;
+            return true;
+        }
+
+        void Close() override { open = false; }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) override {
+            if (!open) return CaptureResult::Disconnected;
+
+            // Switch size on schedule; the switch is announced before the first frame at the new size
+            bool wantLarge = settings.resizeEvery && (nextIndex / settings.resizeEvery) % 2 == 1;
+            if (wantLarge != largeSize) {
+                largeSize = wantLarge;
+                width = largeSize ? settings.resizeWidth : settings.width;
+                height = largeSize ? settings.resizeHeight : settings.height;
+                patternStep = UINT64_MAX;
+                return CaptureResult::FormatChanged;
+            }
+
+            uint64_t dueNs = DueNs(nextIndex);
+            if (settings.realTime) {
+                uint64_t now = Platform::NowNs();
+                if (dueNs > now) {
+                    uint64_t waitNs = std::min<uint64_t>(dueNs - now, (uint64_t)timeoutMs * 1000000ull);
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+                    if (Platform::NowNs() < dueNs) return CaptureResult::Timeout;
+                }
+            }
+
+            // A full receive queue has thrown away its oldest frames, counting
+            // a whole burst that arrived while we waited
+            size_t queued = QueuedAt(Platform::NowNs());
+            if (settings.receiveQueueFrames && queued > settings.receiveQueueFrames) {
+                nextIndex += queued - settings.receiveQueueFrames;
+                framesDropped += queued - settings.receiveQueueFrames;
+                dueNs = std::max(dueNs, DueNs(nextIndex));
+            }
+
+            uint64_t index = nextIndex++;
+            if (settings.disconnectEvery &&
+                index % settings.disconnectEvery >= settings.disconnectEvery - std::min(settings.disconnectFrames, settings.disconnectEvery)) {
+                return CaptureResult::Disconnected;
+            }
+
+            // Regenerate the pattern only when the content moves; deliver a fresh copy
+            // every time since the consumer may convert the frame in place
+            uint64_t step = index / std::max(1u, settings.changeEvery);
+            size_t bytes = (size_t)width * height * 4;
+            if (step != patternStep || pattern.size() != bytes) {
+                pattern.resize(bytes);
+                FillPattern(pattern.data(), width, height, step, settings.changeBoxSize);
+                patternStep = step;
+            }
+            pixels.resize(bytes);
+            memcpy(pixels.data(), pattern.data(), bytes);
+
+            frame = VideoFrame();
+            frame.data = pixels.data();
+            frame.width = width;
+            frame.height = height;
+            frame.strideBytes = (size_t)width * 4;
+            frame.frameRateN = (int)(settings.frameRate * 1000.0 + 0.5);
+            frame.frameRateD = 1000;
+            frame.timestampNs = dueNs;
+            frame.sequence = (int64_t)index + 1;
+            frame.sourceTimeNs = (int64_t)(startNs + index * periodNs);
+            if (settings.stampFrames) {
+                FrameStamp stamp;
+                stamp.sequence = (uint64_t)frame.sequence;
+                stamp.timestampNs = Platform::NowNs();
+                WriteFrameStamp(frame, stamp);
+            }
+            return CaptureResult::Frame;
+        }
+
+        void Release(VideoFrame& frame) override { frame.data = nullptr; }
+
+        unsigned int GetPollIntervalMs() const override { return settings.pollIntervalMs; }
+
+        size_t GetQueuedFrames() const override {
+            if (!open) return 0;
+            size_t queued = QueuedAt(Platform::NowNs());
+            return settings.receiveQueueFrames ? std::min<size_t>(queued, settings.receiveQueueFrames) : queued;
+        }
+
+        ReceiverStats GetReceiverStats() const override {
+            ReceiverStats stats;
+            if (!open) return stats;
+            stats.framesReceived = nextIndex + GetQueuedFrames();
+            stats.framesDropped = framesDropped;
+            return stats;
+        }
+
+    private:
+        // Frames in a burst are all due with the last of them
+        uint64_t ArrivalIndex(uint64_t index) const {
+            if (settings.burstFrames <= 1) return index;
+            return index / settings.burstFrames * settings.burstFrames + settings.burstFrames - 1;
+        }
+
+        // Frames due by now but not captured yet, ignoring jitter; nothing
+        // queues when frames are made on demand
+        size_t QueuedAt(uint64_t now) const {
+            if (!settings.realTime || now < startNs) return 0;
+            uint64_t arrived = (uint64_t)((double)(now - startNs) / localPeriodNs) + 1;
+            if (settings.burstFrames > 1) arrived = arrived / settings.burstFrames * settings.burstFrames;
+            return arrived > nextIndex ? (size_t)(arrived - nextIndex) : 0;
+        }
+
+        uint64_t DueNs(uint64_t index) const {
+            int64_t jitterNs = 0;
+            if (settings.jitterMs > 0) {
+                double unit = (double)(SplitMix(settings.seed ^ (index * 0x100000001B3ull)) >> 11) / (double)(1ull << 53);
+                jitterNs = (int64_t)((unit * 2.0 - 1.0) * settings.jitterMs * 1e6);
+            }
+            int64_t due = (int64_t)(startNs + (uint64_t)((double)ArrivalIndex(index) * localPeriodNs)) + jitterNs;
+            return due > (int64_t)startNs ? (uint64_t)due : startNs;
+        }
+
+        FakeSourceSettings settings;
+        bool open;
+        uint64_t periodNs;                // On the sender's clock
+        double localPeriodNs;             // The same period on ours
+        uint64_t startNs;
+        uint64_t nextIndex;
+        uint64_t framesDropped;           // Thrown away by a full receive queue
+        bool largeSize;
+        unsigned int width;
+        unsigned int height;
+        uint64_t patternStep;
+        std::vector<unsigned char> pattern;
+        Platform::FrameBuffer pixels;
+    };
+
+    // Counts the connections made for one source name and what they pull
+    // over the network: video per frame received, audio and metadata for as
+    // long as the connection is open
+    class CountingFrameSource : public FrameSource {
+    public:
+        CountingFrameSource(std::unique_ptr<FrameSource> source, std::shared_ptr<FakeBackend::SourceState> state,
+                            uint64_t streamBytesPerSecond)
+            : source(std::move(source))
+            , state(std::move(state))
+            , open(false)
+            , streamBytesPerSecond(streamBytesPerSecond)
+            , streamNs(0)
+        {
+            this->state->created++;
+        }
+
+        ~CountingFrameSource() override { Close(); }
+
+        bool Open() override {
+            if (open) return true;
+            if (!source->Open()) return false;
+            open = true;
+            state->opens++;
+            state->openNow++;
+            streamNs = Platform::NowNs();
+            return true;
+        }
+
+        void Close() override {
+            source->Close();
+            if (open) {
+                open = false;
+                state->openNow--;
+            }
+        }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) override {
+            CaptureResult result = source->Capture(frame, timeoutMs);
+            uint64_t bytes = 0;
+            if (result == CaptureResult::Frame) {
+                bytes += (uint64_t)((double)frame.width * frame.height * kVideoBitsPerPixel / 8.0);
+            }
+            if (open && streamBytesPerSecond) {
+                // Whole bytes only; the remainder carries over to the next call
+                uint64_t streamBytes = (Platform::NowNs() - streamNs) * streamBytesPerSecond / 1000000000ull;
+                streamNs += streamBytes * 1000000000ull / streamBytesPerSecond;
+                bytes += streamBytes;
+            }
+            state->ingestBytes.fetch_add(bytes, std::memory_order_relaxed);
+            return result;
+        }
+
+        void Release(VideoFrame& frame) override { source->Release(frame); }
+
+        unsigned int GetPollIntervalMs() const override { return source->GetPollIntervalMs(); }
+        size_t GetQueuedFrames() const override { return source->GetQueuedFrames(); }
+        ReceiverStats GetReceiverStats() const override { return source->GetReceiverStats(); }
+
+    private:
+        std::unique_ptr<FrameSource> source;
+        std::shared_ptr<FakeBackend::SourceState> state;
+        bool open;
+        uint64_t streamBytesPerSecond;
+        uint64_t streamNs;                // Audio and metadata are accounted up to here
+    };
+
+    class FakeFrameSink : public FrameSink {
+    public:
+        FakeFrameSink(const FakeSinkSettings& settings, std::shared_ptr<FakeBackend::SinkState> state,
+                      std::shared_ptr<FakeBackend::ConnectionState> connections)
+            : settings(settings)
+            , state(std::move(state))
+            , connections(std::move(connections))
+            , open(false)
+        {
+        }
+
+        bool Open(const std::string& name) override {
+            {
+                std::lock_guard<std::mutex> lock(state->nameMutex);
+                state->name = name;
+            }
+            this->name = name;
+            state->opens++;
+            tracker.Reset();
+            open = true;
+            return true;
+        }
+
+        void Close() override { open = false; }
+
+        bool Send(const VideoFrame& frame) override {
+            if (!open) return false;
+            if (settings.sendCostUs) {
+                uint64_t until = Platform::NowNs() + (uint64_t)settings.sendCostUs * 1000ull;
+                while (Platform::NowNs() < until) {
+                }
+            }
+            state->frames.fetch_add(1, std::memory_order_relaxed);
+            state->bytes.fetch_add((uint64_t)frame.strideBytes * frame.height, std::memory_order_relaxed);
+            state->width.store(frame.width, std::memory_order_relaxed);
+            state->height.store(frame.height, std::memory_order_relaxed);
+            state->lastTimestampNs.store(frame.timestampNs, std::memory_order_relaxed);
+            state->lastSequence.store(frame.sequence, std::memory_order_relaxed);
+            if (frame.data && frame.height > 0) {
+                size_t rowBytes = (size_t)frame.width * (frame.format == PixelFormat::UYVY ? 2 : 4);
+                const unsigned char* row = frame.data + (size_t)(frame.height - 1) * frame.strideBytes;
+                std::lock_guard<std::mutex> lock(state->rowMutex);
+                state->lastRow.assign(row, row + rowBytes);
+            }
+
+            FrameStamp stamp;
+            if (ReadFrameStamp(frame, stamp)) {
+                StampTracker::Observation seen = tracker.Observe(stamp);
+                uint64_t now = Platform::NowNs();
+                uint64_t latencyNs = now > stamp.timestampNs ? now - stamp.timestampNs : 0;
+                state->stamped.fetch_add(1, std::memory_order_relaxed);
+                state->missed.fetch_add(seen.missed, std::memory_order_relaxed);
+                if (seen.reordered) state->reordered.fetch_add(1, std::memory_order_relaxed);
+                if (seen.repeated) state->repeated.fetch_add(1, std::memory_order_relaxed);
+                state->latency.Record(latencyNs);
+            }
+            return true;
+        }
+
+        int GetConnections(unsigned int timeoutMs) override {
+            if (!open) return 0;
+            std::unique_lock<std::mutex> lock(connections->mutex);
+            auto count = [&]() {
+                auto it = connections->byName.find(name);
+                return it != connections->byName.end() ? it->second : connections->otherwise;
+            };
+            connections->changed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return count() != 0; });
+            return count();
+        }
+
+    private:
+        FakeSinkSettings settings;
+        std::shared_ptr<FakeBackend::SinkState> state;
+        std::shared_ptr<FakeBackend::ConnectionState> connections;
+        std::string name;
+        bool open;
+        StampTracker tracker;
+    };
+}
+
+FakeBackend::FakeBackend(const FakeSourceSettings& sourceSettings, const FakeSinkSettings& sinkSettings)
+    : sourceSettings(sourceSettings)
+    , sinkSettings(sinkSettings)
+    , connections(std::make_shared<ConnectionState>())
+{
+    connections->otherwise = sinkSettings.connections;
+}
+
+std::unique_ptr<FrameSource> FakeBackend::CreateSource(FrameEndpoint endpoint, const std::string& sourceName,
+                                                       const ReceiveSettings& settings) {
+    // Only NDI has a proxy stream, fields, and audio and metadata beside the video
+    bool ndi = endpoint == FrameEndpoint::NDI;
+    bool proxy = ndi && settings.bandwidth == ReceiveBandwidth::Lowest;
+    uint64_t streamBytesPerSecond = !ndi ? 0
+                                  : settings.bandwidth == ReceiveBandwidth::MetadataOnly ? kMetadataBytesPerSecond
+                                  : kAudioBytesPerSecond + kMetadataBytesPerSecond;
+    std::unique_ptr<FrameSource> source;
+    if (ndi && !ReceivesVideo(settings.bandwidth)) {
+        source = std::make_unique<NoVideoFrameSource>();
+    }
+    else if (IsPatternSourceName(sourceName)) {
+        PatternSettings pattern;
+        std::string error;
+        if (!ParsePatternSourceName(sourceName, pattern, error) || pattern.format == PixelFormat::UYVY) {
+            return nullptr;
+        }
+        if (proxy) ProxySize(pattern.width, pattern.height);
+        source = CreatePatternSource(pattern);
+    }
+    else {
+        FakeSourceSettings fake = sourceSettings;
+        if (ndi && fake.interlaced && settings.allowFields) {
+            fake.height /= 2;
+            fake.resizeHeight /= 2;
+            fake.frameRate *= 2.0;
+        }
+        if (proxy) {
+            ProxySize(fake.width, fake.height);
+            ProxySize(fake.resizeWidth, fake.resizeHeight);
+        }
+        source = std::make_unique<FakeFrameSource>(fake);
+    }
+
+    std::shared_ptr<SourceState> state;
+    {
+        std::lock_guard<std::mutex> lock(sourcesMutex);
+        std::shared_ptr<SourceState>& entry = sources[sourceName];
+        if (!entry) entry = std::make_shared<SourceState>();
+        state = entry;
+    }
+    return std::make_unique<CountingFrameSource>(std::move(source), state, streamBytesPerSecond);
+}
+
+std::unique_ptr<FrameSink> FakeBackend::CreateSink(FrameEndpoint) {
+    auto state = std::make_shared<SinkState>();
+    {
+        std::lock_guard<std::mutex> lock(sinksMutex);
+        sinks.push_back(state);
+    }
+    return std::make_unique<FakeFrameSink>(sinkSettings, state, connections);
+}
+
+void FakeBackend::SetSinkConnections(const std::string& name, int count) {
+    {
+        std::lock_guard<std::mutex> lock(connections->mutex);
+        connections->byName[name] = count;
+    }
+    connections->changed.notify_all();
+}
+
+std::vector<FakeSinkReport> FakeBackend::GetSinkReports() const {
+    std::lock_guard<std::mutex> lock(sinksMutex);
+    std::vector<FakeSinkReport> reports;
+    for (const auto& state : sinks) {
+        FakeSinkReport report;
+        {
+            std::lock_guard<std::mutex> nameLock(state->nameMutex);
+            report.name = state->name;
+        }
+        report.opens = state->opens.load(std::memory_order_relaxed);
+        report.frames = state->frames.load(std::memory_order_relaxed);
+        report.bytes = state->bytes.load(std::memory_order_relaxed);
+        report.width = state->width.load(std::memory_order_relaxed);
+        report.height = state->height.load(std::memory_order_relaxed);
+        report.lastTimestampNs = state->lastTimestampNs.load(std::memory_order_relaxed);
+        report.lastSequence = state->lastSequence.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> rowLock(state->rowMutex);
+            report.lastRow = state->lastRow;
+        }
+        report.stamped = state->stamped.load(std::memory_order_relaxed);
+        report.missed = state->missed.load(std::memory_order_relaxed);
+        report.reordered = state->reordered.load(std::memory_order_relaxed);
+        report.repeated = state->repeated.load(std::memory_order_relaxed);
+        report.latency = state->latency.Snapshot();
+        reports.push_back(report);
+    }
+    return reports;
+}
+
+std::vector<FakeSourceReport> FakeBackend::GetSourceReports() const {
+    std::lock_guard<std::mutex> lock(sourcesMutex);
+    std::vector<FakeSourceReport> reports;
+    for (const auto& entry : sources) {
+        FakeSourceReport report;
+        report.name = entry.first;
+        report.created = entry.second->created.load();
+        report.opens = entry.second->opens.load();
+        report.openNow = entry.second->openNow.load();
+        report.ingestBytes = entry.second->ingestBytes.load();
+        reports.push_back(report);
+    }
+    return reports;
+}
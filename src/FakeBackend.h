@@ -0,0 +1,145 @@
+#pragma once
+
+#include "FrameIO.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Synthetic source: a grey field with a white bar, or a small white box,
+// that moves each time the content changes. Everything, including jitter, follows from the settings
+// and the frame index, so two runs with the same settings see the same frames.
+struct FakeSourceSettings {
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    double frameRate = 60.0;
+    double jitterMs = 0.0;            // Each frame is due up to this much early or late
+    double clockDriftPpm = 0.0;       // The sender's clock runs this much fast (+) or slow (-) against ours
+    bool realTime = true;             // false: deliver frames as fast as they are asked for
+    unsigned int changeEvery = 1;     // Frames per content change; higher is a more static source
+    unsigned int changeBoxSize = 0;   // Each change moves only a box this many pixels square over a still
+                                      // field, as a cursor or clock would; 0 moves a full-height bar
+    unsigned int resizeEvery = 0;     // Switch between the two sizes every N frames; 0 never
+    unsigned int resizeWidth = 1920;
+    unsigned int resizeHeight = 1080;
+    unsigned int disconnectEvery = 0; // Drop out for disconnectFrames of every N frames; 0 never
+    unsigned int disconnectFrames = 30;
+    unsigned int pollIntervalMs = 0;  // Pause the bridge takes after each capture
+    unsigned int burstFrames = 0;     // Frames arrive in groups of this many at once; 0 or 1 evenly spaced
+    unsigned int receiveQueueFrames = 0; // Frames the receiver holds before dropping the oldest; 0 no limit
+    bool interlaced = false;          // Receivers that allow fields get half-height fields at twice the rate
+    bool stampFrames = false;         // Write a frame stamp (TestPattern.h) into every frame
+    uint64_t seed = 1;
+};
+
+struct FakeSinkSettings {
+    unsigned int sendCostUs = 0;      // Busy time per frame, standing in for encode and transmit
+    int connections = -1;             // Receivers every sink reports unless set by name; -1 can't tell
+};
+
+// What one fake sink has seen; readable from any thread while bridges run
+struct FakeSinkReport {
+    std::string name;
+    uint64_t opens = 0;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    uint64_t lastTimestampNs = 0;
+    int64_t lastSequence = -1;
+    std::vector<unsigned char> lastRow;   // Bottom row of the last frame, as sent
+
+    // Frames carrying a readable frame stamp, and what the stamps showed
+    uint64_t stamped = 0;
+    uint64_t missed = 0;              // Gaps in the stamped sequence
+    uint64_t reordered = 0;
+    uint64_t repeated = 0;
+    HistogramSnapshot latency;        // Stamp time to send, per stamped frame
+};
+
+// What one source name has been asked for
+struct FakeSourceReport {
+    std::string name;
+    uint64_t created = 0;             // Sources made for this name
+    uint64_t opens = 0;               // Successful Open calls; one per receiver connection
+    uint64_t openNow = 0;             // Connections open at the moment
+    uint64_t ingestBytes = 0;         // Modelled network bytes received, all connections
+};
+
+// In-process stand-in for both Spout and NDI. Sources named "pattern:..."
+// come from the test-pattern generator (TestPattern.h); any other name
+// produces the synthetic pattern. NDI sources received at the lowest
+// bandwidth come at a proxy size about 640 wide; audio- and metadata-only
+// receivers connect but never see video. Every source models what its
+// connections would pull over the network (about 1 bit per video pixel,
+// 48 kHz stereo float audio and a trickle of metadata), and every sink
+// counts what it is sent, keeps the bottom row of the last frame for pixel
+// checks and reports the receivers it is told it has.
+class FakeBackend : public FrameBackend {
+public:
+    explicit FakeBackend(const FakeSourceSettings& sourceSettings = FakeSourceSettings(),
+                         const FakeSinkSettings& sinkSettings = FakeSinkSettings());
+
+    std::unique_ptr<FrameSource> CreateSource(FrameEndpoint endpoint, const std::string& sourceName,
+                                              const ReceiveSettings& settings) override;
+    std::unique_ptr<FrameSink> CreateSink(FrameEndpoint endpoint) override;
+
+    // One report per sink created so far, in creation order
+    std::vector<FakeSinkReport> GetSinkReports() const;
+
+    // One report per source name asked for, in name order
+    std::vector<FakeSourceReport> GetSourceReports() const;
+
+    // Receivers connected to the sink opened under name, now and for sinks
+    // opened later; a sink waiting for its first receiver wakes at once
+    void SetSinkConnections(const std::string& name, int connections);
+
+    // Shared between a sink and the backend so reports outlive the bridge
+    struct SinkState {
+        std::mutex nameMutex;
+        std::string name;
+        std::atomic<uint64_t> opens{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<unsigned int> width{0};
+        std::atomic<unsigned int> height{0};
+        std::atomic<uint64_t> lastTimestampNs{0};
+        std::atomic<int64_t> lastSequence{-1};
+        std::mutex rowMutex;
+        std::vector<unsigned char> lastRow;
+        std::atomic<uint64_t> stamped{0};
+        std::atomic<uint64_t> missed{0};
+        std::atomic<uint64_t> reordered{0};
+        std::atomic<uint64_t> repeated{0};
+        LatencyHistogram latency;     // Written only by the sink's bridge thread
+    };
+
+    struct ConnectionState {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<std::string, int> byName;
+        int otherwise = -1;
+    };
+
+    struct SourceState {
+        std::atomic<uint64_t> created{0};
+        std::atomic<uint64_t> opens{0};
+        std::atomic<uint64_t> openNow{0};
+        std::atomic<uint64_t> ingestBytes{0};
+    };
+
+private:
+    FakeSourceSettings sourceSettings;
+    FakeSinkSettings sinkSettings;
+
+    mutable std::mutex sinksMutex;
+    std::vector<std::shared_ptr<SinkState>> sinks;
+
+    std::shared_ptr<ConnectionState> connections;
+
+    mutable std::mutex sourcesMutex;
+    std::map<std::string, std::shared_ptr<SourceState>> sources;
+};
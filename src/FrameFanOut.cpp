@@ -0,0 +1,468 @@
+#include "FrameFanOut.h"
+#include "Platform.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+    const unsigned int kCaptureTimeoutMs = 100;
+    const unsigned int kOpenRetryMs = 100;
+
+    // One captured frame and whatever conversions of it were asked for.
+    // Conversions are handed out as aliases of the owning pointer, so the
+    // use count covers every reference into the frame.
+    struct CapturedFrame {
+        VideoFrame frame;
+        Platform::FrameBuffer pixels;
+
+        std::mutex convertMutex;
+        struct Conversion {
+            bool ready = false;
+            bool failed = false;
+            VideoFrame frame;
+            Platform::FrameBuffer pixels;
+        } conversions[3];    // By PixelFormat
+    };
+
+    struct QueueEntry {
+        CaptureResult result;
+        std::shared_ptr<CapturedFrame> frame;    // For CaptureResult::Frame
+    };
+
+    // One subscriber's view of a capture; guarded by the hub's mutex
+    struct Subscription {
+        SubscriptionSettings settings;
+        std::deque<QueueEntry> queue;
+        size_t queuedFrames = 0;
+        bool paused = false;
+    };
+
+    class CaptureHub {
+    public:
+        CaptureHub(std::shared_ptr<FrameBackend> backend, FrameEndpoint endpoint, const std::string& sourceName,
+                   const ReceiveSettings& settings)
+            : backend(std::move(backend))
+            , endpoint(endpoint)
+            , sourceName(sourceName)
+            , settings(settings)
+            , opened(false)
+            , stopping(false)
+            , receiverReceived(0)
+            , receiverDropped(0)
+            , framesCaptured(0)
+            , stopEvent(true)
+        {
+            thread = std::thread(&CaptureHub::Run, this);
+        }
+
+        ~CaptureHub() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            stopEvent.Set();
+            changed.notify_all();
+            if (thread.joinable()) thread.join();
+        }
+
+        // Wait up to timeoutMs for the source to open
+        bool WaitOpen(unsigned int timeoutMs) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return opened || stopping; });
+            return opened;
+        }
+
+        // Start delivering to subscription, beginning with the newest frame
+        void Subscribe(Subscription* subscription) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                subscribers.push_back(subscription);
+                if (latest) {
+                    Deliver(*subscription, { CaptureResult::Frame, latest });
+                }
+            }
+            changed.notify_all();
+        }
+
+        void Unsubscribe(Subscription* subscription) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), subscription), subscribers.end());
+                subscription->queue.clear();
+                subscription->queuedFrames = 0;
+            }
+            changed.notify_all();
+        }
+
+        // A paused subscriber gets nothing queued; the capture rests while
+        // every subscriber is paused and resumes when one comes back
+        void SetPaused(Subscription* subscription, bool paused) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (subscription->paused == paused) return;
+                subscription->paused = paused;
+                if (paused) {
+                    subscription->queue.clear();
+                    subscription->queuedFrames = 0;
+                }
+            }
+            changed.notify_all();
+        }
+
+        // Take the next entry of subscription's queue, waiting up to timeoutMs for one
+        bool Next(Subscription* subscription, unsigned int timeoutMs, QueueEntry& entry) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] {
+                return stopping || !subscription->queue.empty();
+            });
+            if (subscription->queue.empty()) return false;
+            entry = std::move(subscription->queue.front());
+            subscription->queue.pop_front();
+            if (entry.result == CaptureResult::Frame) subscription->queuedFrames--;
+            return true;
+        }
+
+        size_t QueuedFrames(const Subscription* subscription) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return subscription->queuedFrames;
+        }
+
+        std::shared_ptr<const VideoFrame> Convert(const std::shared_ptr<CapturedFrame>& captured, PixelFormat format) {
+            int index = (int)format;
+            if (index < 0 || index >= 3) return nullptr;
+            CapturedFrame::Conversion& conversion = captured->conversions[index];
+
+            // The first subscriber to ask converts; the rest wait for it and share the result
+            std::lock_guard<std::mutex> lock(captured->convertMutex);
+            if (!conversion.ready && !conversion.failed) {
+                const VideoFrame& src = captured->frame;
+                size_t stride = (size_t)src.width * 4;
+                conversion.pixels.resize(stride * src.height);
+                if (ConvertFramePixels(src, format, conversion.pixels.data(), stride)) {
+                    conversion.frame = src;
+                    conversion.frame.data = conversion.pixels.data();
+                    conversion.frame.strideBytes = stride;
+                    conversion.frame.format = format;
+                    conversion.ready = true;
+                }
+                else {
+                    conversion.failed = true;
+                }
+            }
+            if (!conversion.ready) return nullptr;
+            return std::shared_ptr<const VideoFrame>(captured, &conversion.frame);
+        }
+
+        ReceiverStats GetReceiverStats() const {
+            ReceiverStats stats;
+            stats.framesReceived = receiverReceived.load(std::memory_order_relaxed);
+            stats.framesDropped = receiverDropped.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        void Run() {
+            Platform::SetCurrentThreadName("Capture " + sourceName);
+
+            std::unique_ptr<FrameSource> source = backend->CreateSource(endpoint, sourceName, settings);
+            if (!source) return;
+            while (!IsStopping() && !source->Open()) {
+                stopEvent.Wait(kOpenRetryMs);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                opened = !stopping;
+            }
+            changed.notify_all();
+
+            ReceiverStats lastStats;
+            while (!IsStopping()) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return stopping || !AllPaused(); });
+                }
+
+                VideoFrame frame;
+                uint64_t skipped = 0;
+                CaptureResult result = CaptureNewest(*source, frame, kCaptureTimeoutMs, skipped);
+                ReceiverStats stats = source->GetReceiverStats();
+                receiverReceived.store(stats.framesReceived, std::memory_order_relaxed);
+                receiverDropped.store(stats.framesDropped, std::memory_order_relaxed);
+                // Frames skipped here or dropped by the receiver still take a
+                // number, so subscribers see them as gaps
+                framesCaptured += skipped + (stats.framesDropped - std::min(stats.framesDropped, lastStats.framesDropped));
+                lastStats = stats;
+                if (result == CaptureResult::Frame) {
+                    std::shared_ptr<CapturedFrame> captured = TakeFreeFrame();
+                    Copy(frame, *captured);
+                    source->Release(frame);
+                    framesCaptured++;
+                    if (captured->frame.sequence < 0) {
+                        captured->frame.sequence = (int64_t)framesCaptured;
+                    }
+                    Publish({ CaptureResult::Frame, captured });
+                }
+                else if (result != CaptureResult::Timeout) {
+                    Publish({ result, nullptr });
+                }
+                stopEvent.Wait(source->GetPollIntervalMs());
+            }
+            source->Close();
+        }
+
+        bool IsStopping() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return stopping;
+        }
+
+        // Call with the mutex held
+        bool AllPaused() const {
+            return !subscribers.empty() &&
+                   std::all_of(subscribers.begin(), subscribers.end(), [](const Subscription* s) { return s->paused; });
+        }
+
+        void Publish(const QueueEntry& entry) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                // After a disconnect or size change the last frame is stale for new subscribers
+                latest = entry.frame;
+                for (Subscription* subscription : subscribers) {
+                    if (!subscription->paused) Deliver(*subscription, entry);
+                }
+            }
+            changed.notify_all();
+        }
+
+        // Queue one entry for a subscriber under its drop policy. Events are
+        // never dropped, but a repeat of the last queued event is redundant.
+        static void Deliver(Subscription& subscription, const QueueEntry& entry) {
+            std::deque<QueueEntry>& queue = subscription.queue;
+            if (entry.result != CaptureResult::Frame) {
+                if (queue.empty() || queue.back().result != entry.result) queue.push_back(entry);
+                return;
+            }
+            unsigned int depth = std::max(1u, subscription.settings.queueDepth);
+            if (subscription.queuedFrames >= depth) {
+                if (subscription.settings.dropPolicy == QueueDropPolicy::DropNewest) return;
+                auto oldest = std::find_if(queue.begin(), queue.end(),
+                                           [](const QueueEntry& e) { return e.result == CaptureResult::Frame; });
+                queue.erase(oldest);
+                subscription.queuedFrames--;
+            }
+            queue.push_back(entry);
+            subscription.queuedFrames++;
+        }
+
+        // A pooled frame nobody references any more, or a new one. Queued and
+        // held frames are referenced, and so is the newest frame.
+        std::shared_ptr<CapturedFrame> TakeFreeFrame() {
+            for (auto& frame : pool) {
+                if (frame.use_count() == 1) {
+                    for (auto& conversion : frame->conversions) {
+                        conversion.ready = false;
+                        conversion.failed = false;
+                    }
+                    return frame;
+                }
+            }
+            pool.push_back(std::make_shared<CapturedFrame>());
+            return pool.back();
+        }
+
+        static void Copy(const VideoFrame& src, CapturedFrame& dst) {
+            size_t rowBytes = (size_t)src.width * (src.format == PixelFormat::UYVY ? 2 : 4);
+            dst.pixels.resize(rowBytes * src.height);
+            if (src.strideBytes == rowBytes) {
+                memcpy(dst.pixels.data(), src.data, rowBytes * src.height);
+            }
+            else {
+                for (unsigned int y = 0; y < src.height; y++) {
+                    memcpy(dst.pixels.data() + y * rowBytes, src.data + y * src.strideBytes, rowBytes);
+                }
+            }
+            dst.frame = src;
+            dst.frame.data = dst.pixels.data();
+            dst.frame.strideBytes = rowBytes;
+        }
+
+        std::shared_ptr<FrameBackend> backend;
+        FrameEndpoint endpoint;
+        std::string sourceName;
+        ReceiveSettings settings;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool opened;
+        bool stopping;
+        std::vector<Subscription*> subscribers;
+        std::shared_ptr<CapturedFrame> latest;
+
+        // Written by the capture thread, read by subscribers
+        std::atomic<uint64_t> receiverReceived;
+        std::atomic<uint64_t> receiverDropped;
+
+        // Capture thread only
+        uint64_t framesCaptured;
+        std::vector<std::shared_ptr<CapturedFrame>> pool;
+        Platform::Event stopEvent;
+        std::thread thread;
+    };
+
+    class SharedFrameSource : public FrameSource {
+    public:
+        SharedFrameSource(std::shared_ptr<CaptureHub> hub, const SubscriptionSettings& settings)
+            : hub(std::move(hub))
+            , subscribed(false)
+        {
+            subscription.settings = settings;
+        }
+
+        ~SharedFrameSource() override { Close(); }
+
+        bool Open() override {
+            if (!hub->WaitOpen(kOpenRetryMs)) return false;
+            if (!subscribed) {
+                hub->Subscribe(&subscription);
+                subscribed = true;
+            }
+            return true;
+        }
+
+        void Close() override {
+            held.reset();
+            if (subscribed) {
+                hub->Unsubscribe(&subscription);
+                subscribed = false;
+            }
+        }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) override {
+            QueueEntry entry;
+            if (!subscribed || !hub->Next(&subscription, timeoutMs, entry)) {
+                return CaptureResult::Timeout;
+            }
+            if (entry.result != CaptureResult::Frame) {
+                return entry.result;
+            }
+            held = std::move(entry.frame);
+            frame = held->frame;
+            return CaptureResult::Frame;
+        }
+
+        void Release(VideoFrame& frame) override {
+            held.reset();
+            frame.data = nullptr;
+        }
+
+        // Capture blocks until the shared capture has something new
+        unsigned int GetPollIntervalMs() const override { return 0; }
+
+        size_t GetQueuedFrames() const override {
+            return subscribed ? hub->QueuedFrames(&subscription) : 0;
+        }
+
+        ReceiverStats GetReceiverStats() const override { return hub->GetReceiverStats(); }
+
+        void SetPaused(bool paused) override {
+            if (subscribed) hub->SetPaused(&subscription, paused);
+            else subscription.paused = paused;
+        }
+
+        bool IsShared() const override { return true; }
+
+        std::shared_ptr<const VideoFrame> Convert(const VideoFrame& frame, PixelFormat format) override {
+            if (!held || frame.data != held->frame.data) return nullptr;
+            return hub->Convert(held, format);
+        }
+
+    private:
+        std::shared_ptr<CaptureHub> hub;
+        Subscription subscription;
+        bool subscribed;
+        std::shared_ptr<CapturedFrame> held;
+    };
+
+    using HubKey = std::tuple<const FrameBackend*, FrameEndpoint, std::string, PixelFormat, ReceiveBandwidth, bool,
+                              std::string>;
+
+    std::mutex g_hubsMutex;
+    std::map<HubKey, std::weak_ptr<CaptureHub>> g_hubs;
+}
+
+std::unique_ptr<FrameSource> CreateSharedSource(const std::shared_ptr<FrameBackend>& backend,
+                                                FrameEndpoint endpoint, const std::string& sourceName,
+                                                const ReceiveSettings& settings, const SubscriptionSettings& subscription) {
+    if (!backend) return nullptr;
+    std::lock_guard<std::mutex> lock(g_hubsMutex);
+    for (auto it = g_hubs.begin(); it != g_hubs.end();) {
+        it = it->second.expired() ? g_hubs.erase(it) : std::next(it);
+    }
+
+    std::weak_ptr<CaptureHub>& entry = g_hubs[HubKey(backend.get(), endpoint, sourceName, settings.format, settings.bandwidth,
+                                                     settings.allowFields, settings.receiverName)];
+    std::shared_ptr<CaptureHub> hub = entry.lock();
+    if (!hub) {
+        hub = std::make_shared<CaptureHub>(backend, endpoint, sourceName, settings);
+        entry = hub;
+    }
+    return std::make_unique<SharedFrameSource>(hub, subscription);
+}
+
+size_t GetSharedCaptureCount() {
+    std::lock_guard<std::mutex> lock(g_hubsMutex);
+    size_t count = 0;
+    for (const auto& entry : g_hubs) {
+        if (!entry.second.expired()) count++;
+    }
+    return count;
+}
+
+CaptureResult CaptureNewest(FrameSource& source, VideoFrame& frame, unsigned int timeoutMs, uint64_t& skipped) {
+    skipped = 0;
+    if (source.IsShared()) return source.Capture(frame, timeoutMs);
+
+    CaptureResult result = source.Capture(frame, source.GetQueuedFrames() > 0 ? 0 : timeoutMs);
+    while (result == CaptureResult::Frame && source.GetQueuedFrames() > 0) {
+        VideoFrame newer;
+        CaptureResult next = source.Capture(newer, 0);
+        if (next == CaptureResult::Timeout) break;
+        source.Release(frame);
+        if (next != CaptureResult::Frame) return next;
+        frame = newer;
+        skipped++;
+    }
+    return result;
+}
+
+bool ConvertFramePixels(const VideoFrame& src, PixelFormat format, unsigned char* dst, size_t dstStride) {
+    if (src.format == format) {
+        size_t rowBytes = (size_t)src.width * (format == PixelFormat::UYVY ? 2 : 4);
+        for (unsigned int y = 0; y < src.height; y++) {
+            memcpy(dst + y * dstStride, src.data + y * src.strideBytes, rowBytes);
+        }
+        return true;
+    }
+    if (src.format == PixelFormat::UYVY || format == PixelFormat::UYVY) {
+        return false;
+    }
+
+    // RGBA <-> BGRA: swap bytes 0 and 2 of every pixel, a word at a time
+    for (unsigned int y = 0; y < src.height; y++) {
+        const unsigned char* s = src.data + y * src.strideBytes;
+        unsigned char* d = dst + y * dstStride;
+        for (unsigned int x = 0; x < src.width; x++) {
+            uint32_t pixel;
+            memcpy(&pixel, s + x * 4, 4);
+            pixel = (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFFu) | ((pixel & 0xFFu) << 16);
+            memcpy(d + x * 4, &pixel, 4);
+        }
+    }
+    return true;
+}
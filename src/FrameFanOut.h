@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FrameIO.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What a subscriber's full queue gives up when another frame arrives
+enum class QueueDropPolicy {
+    DropOldest = 0,   // Keep the newest frames; lowest latency
+    DropNewest        // Keep the queued frames in order; newer ones are lost
+};
+
+// Per-subscriber delivery from a shared capture
+struct SubscriptionSettings {
+    unsigned int queueDepth = 1;    // Frames held for the subscriber; 1 always hands out the newest
+    QueueDropPolicy dropPolicy = QueueDropPolicy::DropOldest;
+};
+
+// Shared capture stage. Every bridge that asks for the same source, with the
+// same receive settings and from the same backend, subscribes to one capture
+// thread, so N bridges cost one receiver connection, one capture and one
+// copy per frame instead of N. Each subscriber has its own queue and drop
+// policy, so a slow bridge loses frames without holding up the others.
+// Frames are read-only (FrameSource::IsShared) and FrameSource::Convert
+// produces each target format once per frame for all subscribers. Frames
+// and their conversions are reference counted and recycled once nobody
+// holds them. A paused subscriber (FrameSource::SetPaused) gets nothing
+// queued, and the capture rests while every subscriber is paused. The
+// capture stops when the last subscriber is destroyed.
+// Frames from sources without a frame counter are numbered by the capture,
+// so subscribers can count what their queue dropped.
+std::unique_ptr<FrameSource> CreateSharedSource(const std::shared_ptr<FrameBackend>& backend,
+                                                FrameEndpoint endpoint, const std::string& sourceName,
+                                                const ReceiveSettings& settings,
+                                                const SubscriptionSettings& subscription = SubscriptionSettings());
+
+// Capture threads currently running for shared sources
+size_t GetSharedCaptureCount();
+
+// Capture the newest frame a source has. Waits up to timeoutMs only while
+// the source's queue is empty; otherwise takes everything queued without
+// waiting and keeps the last, releasing the ones before it. skipped is set
+// to the number of frames passed over. A disconnect or format change met
+// while draining releases the frame in hand and is returned instead.
+// Shared sources are read one entry at a time, since their queue depth and
+// drop policy are the subscriber's choice.
+CaptureResult CaptureNewest(FrameSource& source, VideoFrame& frame, unsigned int timeoutMs, uint64_t& skipped);
+
+// Copy src into dst (dstStride bytes per row) as format: an R/B swap between
+// RGBA and BGRA, a plain copy when the formats match. Returns false for
+// conversions to or from UYVY.
+bool ConvertFramePixels(const VideoFrame& src, PixelFormat format, unsigned char* dst, size_t dstStride);
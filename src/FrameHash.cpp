@@ -0,0 +1,180 @@
+#include "FrameHash.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAMEHASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Per-lane keys and the per-stripe key step. The step makes every 32-byte
+    // stripe hash differently depending on its position, so content that moves
+    // across a uniform background still changes the hash.
+    const uint64_t kKeys[4] = {
+        0x9E3779B185EBCA87ull, 0xC2B2AE3D27D4EB4Full,
+        0x165667B19E3779F9ull, 0x85EBCA77C2B2AE63ull
+    };
+    const uint64_t kKeyStep = 0x27D4EB2F165667C5ull;
+    const size_t kStripeBytes = 32;
+
+    inline uint64_t Read64(const unsigned char* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint64_t Avalanche(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Accumulate whole 32-byte stripes; returns the number of bytes consumed
+    using AccumulateFn = size_t (*)(uint64_t acc[4], const unsigned char* p, size_t size, uint64_t seed);
+
+    size_t AccumulateStripesScalar(uint64_t acc[4], const unsigned char* p, size_t size, uint64_t seed) {
+        const size_t stripes = size / kStripeBytes;
+        if (stripes == 0) return 0;
+
+        uint64_t keys[4];
+        for (int i = 0; i < 4; i++) {
+            keys[i] = kKeys[i] + seed;
+        }
+
+        for (size_t s = 0; s < stripes; s++) {
+            const unsigned char* src = p + s * kStripeBytes;
+            for (int i = 0; i < 4; i++) {
+                uint64_t v = Read64(src + i * 8);
+                uint64_t dk = v ^ keys[i];
+                acc[i ^ 1] += v;
+                acc[i] += (dk & 0xFFFFFFFFull) * (dk >> 32);
+                keys[i] += kKeyStep;
+            }
+        }
+        return stripes * kStripeBytes;
+    }
+
+#ifdef FRAMEHASH_SSE2
+    size_t AccumulateStripesSse2(uint64_t acc[4], const unsigned char* p, size_t size, uint64_t seed) {
+        const size_t stripes = size / kStripeBytes;
+        if (stripes == 0) return 0;
+
+        __m128i acc0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc));
+        __m128i acc1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2));
+        __m128i key0 = _mm_set_epi64x(static_cast<long long>(kKeys[1] + seed), static_cast<long long>(kKeys[0] + seed));
+        __m128i key1 = _mm_set_epi64x(static_cast<long long>(kKeys[3] + seed), static_cast<long long>(kKeys[2] + seed));
+        const __m128i step = _mm_set1_epi64x(static_cast<long long>(kKeyStep));
+
+        for (size_t s = 0; s < stripes; s++) {
+            const __m128i* src = reinterpret_cast<const __m128i*>(p + s * kStripeBytes);
+            __m128i d0 = _mm_loadu_si128(src);
+            __m128i d1 = _mm_loadu_si128(src + 1);
+
+            // lo32(data ^ key) * hi32(data ^ key) per 64-bit lane
+            __m128i dk0 = _mm_xor_si128(d0, key0);
+            __m128i dk1 = _mm_xor_si128(d1, key1);
+            __m128i prod0 = _mm_mul_epu32(dk0, _mm_shuffle_epi32(dk0, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i prod1 = _mm_mul_epu32(dk1, _mm_shuffle_epi32(dk1, _MM_SHUFFLE(0, 3, 0, 1)));
+
+            // Raw data is added to the neighbouring lane
+            __m128i swap0 = _mm_shuffle_epi32(d0, _MM_SHUFFLE(1, 0, 3, 2));
+            __m128i swap1 = _mm_shuffle_epi32(d1, _MM_SHUFFLE(1, 0, 3, 2));
+            acc0 = _mm_add_epi64(acc0, _mm_add_epi64(prod0, swap0));
+            acc1 = _mm_add_epi64(acc1, _mm_add_epi64(prod1, swap1));
+
+            key0 = _mm_add_epi64(key0, step);
+            key1 = _mm_add_epi64(key1, step);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), acc0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2), acc1);
+        return stripes * kStripeBytes;
+    }
+
+    const AccumulateFn kAccumulateStripes = AccumulateStripesSse2;
+#else
+    const AccumulateFn kAccumulateStripes = AccumulateStripesScalar;
+#endif
+
+    uint64_t HashWith(AccumulateFn accumulate, const void* data, size_t size, uint64_t seed) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        uint64_t acc[4] = { seed, ~seed, seed ^ kKeyStep, seed + kKeyStep };
+
+        size_t done = accumulate(acc, p, size, seed);
+
+        // Tail: remaining 8-byte words, then single bytes
+        uint64_t tail = 0;
+        int lane = 0;
+        for (; done + 8 <= size; done += 8) {
+            acc[lane] = (acc[lane] ^ Read64(p + done)) * 0x9E3779B185EBCA87ull;
+            lane = (lane + 1) & 3;
+        }
+        for (int shift = 0; done < size; done++, shift += 8) {
+            tail |= static_cast<uint64_t>(p[done]) << shift;
+        }
+
+        uint64_t h = static_cast<uint64_t>(size) * 0x9E3779B185EBCA87ull ^ seed;
+        h ^= Avalanche(acc[0]) + tail;
+        h = (h << 27 | h >> 37) * 0xC2B2AE3D27D4EB4Full ^ Avalanche(acc[1]);
+        h = (h << 31 | h >> 33) * 0x165667B19E3779F9ull ^ Avalanche(acc[2]);
+        h = (h << 29 | h >> 35) * 0x85EBCA77C2B2AE63ull ^ Avalanche(acc[3]);
+        return Avalanche(h);
+    }
+
+    uint64_t HashImageWith(AccumulateFn accumulate, const unsigned char* pixels, unsigned int width,
+                           unsigned int height, size_t strideBytes, FrameHash::Mode mode, unsigned int rowStep) {
+        if (!pixels || width == 0 || height == 0) return 0;
+
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+
+        // Tightly packed full frames can be hashed in one go
+        if (mode == FrameHash::Mode::Full && strideBytes == rowBytes) {
+            return HashWith(accumulate, pixels, rowBytes * height, 0);
+        }
+
+        if (mode == FrameHash::Mode::Full || rowStep == 0) {
+            rowStep = 1;
+        }
+
+        // Chain row hashes; the last row is always included so edges are covered
+        uint64_t h = 0;
+        for (unsigned int y = 0; y < height; y += rowStep) {
+            h = HashWith(accumulate, pixels + y * strideBytes, rowBytes, h ^ y);
+        }
+        if ((height - 1) % rowStep != 0) {
+            h = HashWith(accumulate, pixels + (height - 1) * strideBytes, rowBytes, h ^ (height - 1));
+        }
+        return h;
+    }
+}
+
+namespace FrameHash {
+    uint64_t Hash(const void* data, size_t size, uint64_t seed) {
+        return HashWith(kAccumulateStripes, data, size, seed);
+    }
+
+    uint64_t HashImage(const unsigned char* pixels, unsigned int width, unsigned int height,
+                       size_t strideBytes, Mode mode, unsigned int rowStep) {
+        return HashImageWith(kAccumulateStripes, pixels, width, height, strideBytes, mode, rowStep);
+    }
+
+    uint64_t HashScalar(const void* data, size_t size, uint64_t seed) {
+        return HashWith(AccumulateStripesScalar, data, size, seed);
+    }
+
+    uint64_t HashImageScalar(const unsigned char* pixels, unsigned int width, unsigned int height,
+                             size_t strideBytes, Mode mode, unsigned int rowStep) {
+        return HashImageWith(AccumulateStripesScalar, pixels, width, height, strideBytes, mode, rowStep);
+    }
+
+    bool IsAccelerated() {
+#ifdef FRAMEHASH_SSE2
+        return true;
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Fast content hashing for captured frames.
+// Uses SSE2 on x86/x64 and a bit-exact scalar path elsewhere (e.g. ARM64),
+// so the same pixels always produce the same hash regardless of the CPU.
+namespace FrameHash {
+    enum class Mode {
+        Full = 0,     // Hash every byte of the frame
+        Sampled = 1   // Hash every Nth row only (cheaper, may miss tiny changes)
+    };
+
+    // Hash a contiguous block of memory
+    uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+
+    // Hash a 2D image; in Sampled mode only every rowStep-th row is read
+    uint64_t HashImage(const unsigned char* pixels, unsigned int width, unsigned int height,
+                       size_t strideBytes, Mode mode, unsigned int rowStep = 8);
+
+    // Hash and HashImage on the portable scalar path whatever the CPU; the
+    // SIMD path must match them bit for bit
+    uint64_t HashScalar(const void* data, size_t size, uint64_t seed = 0);
+    uint64_t HashImageScalar(const unsigned char* pixels, unsigned int width, unsigned int height,
+                             size_t strideBytes, Mode mode, unsigned int rowStep = 8);
+
+    // True when the SIMD path is compiled in
+    bool IsAccelerated();
+}
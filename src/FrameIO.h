@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Layout of the pixels in a VideoFrame
+enum class PixelFormat {
+    RGBA = 0,
+    BGRA = 1,
+    UYVY = 2
+};
+
+// One captured or outgoing frame. The pixels belong to whoever produced the
+// frame: a captured frame stays valid, and may be modified in place, until
+// it is handed back with FrameSource::Release or the next Capture.
+struct VideoFrame {
+    unsigned char* data = nullptr;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    size_t strideBytes = 0;
+    PixelFormat format = PixelFormat::RGBA;
+    int frameRateN = 60000;
+    int frameRateD = 1000;
+    uint64_t timestampNs = 0;   // When the source produced it, on the Platform::NowNs timeline
+    int64_t sequence = -1;      // Source frame counter for drop detection, or -1 if the source has none
+    int64_t sourceTimeNs = -1;  // When the sender sent it, on the sender's own clock, or -1 if unknown
+};
+
+enum class CaptureResult {
+    Frame,          // frame is filled in and must be released
+    Timeout,        // Nothing new within the timeout
+    FormatChanged,  // Geometry changed; the frame just read is unusable, capture again
+    Disconnected    // The sender went away; keep capturing to pick it up again
+};
+
+// What a source's receiver has taken in and thrown away since it opened,
+// counting frames that never reached Capture
+struct ReceiverStats {
+    uint64_t framesReceived = 0;
+    uint64_t framesDropped = 0;
+};
+
+// Where frames come from. Open may be retried until it succeeds; Close is
+// idempotent and also done by the destructor.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+
+    // Wait up to timeoutMs for the next frame; sources that can only poll return at once
+    virtual CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) = 0;
+    virtual void Release(VideoFrame& frame) = 0;
+
+    // Pause the bridge takes after each capture, for sources without a blocking wait
+    virtual unsigned int GetPollIntervalMs() const = 0;
+
+    // Frames captured but not handed out yet, for sources that queue
+    virtual size_t GetQueuedFrames() const { return 0; }
+
+    // Totals from the receiver behind the source, for sources that have one
+    virtual ReceiverStats GetReceiverStats() const { return ReceiverStats(); }
+
+    // The consumer stops capturing for a while. A shared source stops
+    // queueing frames for it, and rests once none of its consumers want any.
+    virtual void SetPaused(bool paused) { (void)paused; }
+
+    // A shared source hands the same frames to several bridges, so they are
+    // read-only. Instead of converting in place, ask the source for the
+    // frame in the target format; it converts once for all its consumers.
+    virtual bool IsShared() const { return false; }
+
+    // The frame from the last Capture with its pixels in format, valid for
+    // as long as the pointer is held; nullptr if this source can't convert
+    virtual std::shared_ptr<const VideoFrame> Convert(const VideoFrame& frame, PixelFormat format) {
+        (void)frame;
+        (void)format;
+        return nullptr;
+    }
+};
+
+// Where frames go. Opening again under a new name renames the output.
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    virtual bool Open(const std::string& name) = 0;
+    virtual void Close() = 0;
+
+    // Synchronous: the frame's pixels may be reused as soon as this returns
+    virtual bool Send(const VideoFrame& frame) = 0;
+
+    // Receivers connected to this output. With none, waits up to timeoutMs
+    // for the first and returns as soon as it connects. -1 for outputs that
+    // can't tell.
+    virtual int GetConnections(unsigned int timeoutMs) {
+        (void)timeoutMs;
+        return -1;
+    }
+};
+
+enum class FrameEndpoint {
+    Spout,
+    NDI
+};
+
+// Which stream an NDI receiver pulls; other sources have only one
+enum class ReceiveBandwidth {
+    Highest = 0,    // Full resolution
+    Lowest,         // The sender's low-bandwidth proxy, where it offers one
+    AudioOnly,      // No video; the receiver stays connected for audio, tally and metadata
+    MetadataOnly    // No video or audio; tally and metadata only
+};
+
+inline bool ReceivesVideo(ReceiveBandwidth bandwidth) {
+    return bandwidth == ReceiveBandwidth::Highest || bandwidth == ReceiveBandwidth::Lowest;
+}
+
+// What to ask a source for
+struct ReceiveSettings {
+    // Pixel layout to ask for; sources that always deliver one layout
+    // (Spout, test patterns) report theirs in VideoFrame::format
+    PixelFormat format = PixelFormat::RGBA;
+    ReceiveBandwidth bandwidth = ReceiveBandwidth::Highest;
+    bool allowFields = false;       // NDI: deliver interlaced video as separate half-height fields
+    std::string receiverName;       // NDI: how the receiver shows up to senders; empty for the SDK default
+};
+
+// Creates the capture and output ends of a bridge
+class FrameBackend {
+public:
+    virtual ~FrameBackend() = default;
+
+    virtual std::unique_ptr<FrameSource> CreateSource(FrameEndpoint endpoint, const std::string& sourceName,
+                                                      const ReceiveSettings& settings) = 0;
+    virtual std::unique_ptr<FrameSink> CreateSink(FrameEndpoint endpoint) = 0;
+};
+
+// The real Spout and NDI SDKs (or the stand-ins on platforms without them)
+std::shared_ptr<FrameBackend> GetSdkBackend();
+
+// Backend given to newly created bridges; the SDK backend unless replaced
+std::shared_ptr<FrameBackend> GetDefaultFrameBackend();
+void SetDefaultFrameBackend(std::shared_ptr<FrameBackend> backend);
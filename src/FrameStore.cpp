@@ -0,0 +1,49 @@
+#include "FrameStore.h"
+#include <cstring>
+#include <utility>
+
+int64_t FramePeriodNs(const VideoFrame& frame) {
+    return frame.frameRateN > 0 && frame.frameRateD > 0 ? (int64_t)(1e9 * frame.frameRateD / frame.frameRateN)
+                                                        : kDefaultFramePeriodNs;
+}
+
+int64_t SenderTimeNs(const VideoFrame& frame, uint64_t arrivalNs, bool continuing, int64_t previousNs) {
+    if (frame.sourceTimeNs >= 0) return frame.sourceTimeNs;
+    return continuing ? previousNs + FramePeriodNs(frame) : (int64_t)arrivalNs;
+}
+
+FrameStore::FrameStore()
+    : storedBytes(0)
+    , spareBytes(0)
+{
+}
+
+StoredFrame FrameStore::Store(const VideoFrame& frame, uint64_t arrivalNs, uint64_t priorNs) {
+    StoredFrame stored;
+    if (!spare.empty()) {
+        stored.pixels = std::move(spare.back());
+        spare.pop_back();
+        spareBytes -= stored.pixels.capacity();
+    }
+    size_t rowBytes = (size_t)frame.width * (frame.format == PixelFormat::UYVY ? 2 : 4);
+    stored.pixels.resize(rowBytes * frame.height);
+    for (unsigned int y = 0; y < frame.height; y++) {
+        memcpy(stored.pixels.data() + y * rowBytes, frame.data + y * frame.strideBytes, rowBytes);
+    }
+    stored.frame = frame;
+    stored.frame.data = stored.pixels.data();
+    stored.frame.strideBytes = rowBytes;
+    stored.arrivalNs = arrivalNs;
+    stored.priorNs = priorNs;
+    storedBytes += stored.pixels.capacity();
+    return stored;
+}
+
+void FrameStore::Recycle(StoredFrame& stored) {
+    size_t bytes = stored.pixels.capacity();
+    if (bytes == 0) return;
+    storedBytes -= bytes;
+    spareBytes += bytes;
+    spare.push_back(std::move(stored.pixels));
+    stored = StoredFrame();
+}
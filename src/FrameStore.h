@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FrameIO.h"
+#include "Platform.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Period assumed for frames that carry no frame rate
+const int64_t kDefaultFramePeriodNs = 16666667;
+
+// Nominal frame period from the frame's rate
+int64_t FramePeriodNs(const VideoFrame& frame);
+
+// When the sender sent frame, on the sender's clock: its timestamp, or
+// without one, a period after previousNs as if the sender keeps to its
+// frame rate. The first frame of a stream (continuing false) without a
+// timestamp counts as sent when it arrived.
+int64_t SenderTimeNs(const VideoFrame& frame, uint64_t arrivalNs, bool continuing, int64_t previousNs);
+
+// A received frame copied into a buffer of its own
+struct StoredFrame {
+    VideoFrame frame;                 // Points into pixels, rows packed
+    Platform::FrameBuffer pixels;
+    uint64_t arrivalNs = 0;           // Platform::NowNs timeline
+    uint64_t priorNs = 0;             // Time the bridge spent on it before arrivalNs
+
+    // Time the frame has spent in the bridge by nowNs
+    uint64_t LatencyNs(uint64_t nowNs) const { return priorNs + (nowNs > arrivalNs ? nowNs - arrivalNs : 0); }
+};
+
+// Copies received frames out of the receiver's buffers so they can be held
+// past the next capture, reusing the buffers of frames handed back. Used by
+// the jitter buffer and the time-base corrector. Not thread-safe.
+class FrameStore {
+public:
+    FrameStore();
+
+    // A packed copy of frame, which arrived at arrivalNs after priorNs in the bridge
+    StoredFrame Store(const VideoFrame& frame, uint64_t arrivalNs, uint64_t priorNs);
+
+    // Take back a stored frame's buffer for reuse; stored is left empty
+    void Recycle(StoredFrame& stored);
+
+    // Buffers handed out and spare
+    size_t GetMemoryBytes() const { return storedBytes + spareBytes; }
+
+private:
+    std::vector<Platform::FrameBuffer> spare;
+    size_t storedBytes;
+    size_t spareBytes;
+};
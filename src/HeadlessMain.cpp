@@ -0,0 +1,329 @@
+// Headless bridge runner: starts every bridge from a configuration file and
+// keeps them running until asked to stop. Runs as a console application on
+// any platform, or as a Windows service when started with --service. The
+// configuration is reloaded on SIGHUP (or a service parameter change) and
+// only the bridges whose definition changed are touched.
+
+#include "BridgeConfig.h"
+#include "BridgeLauncher.h"
+#include "BridgeReconciler.h"
+#include "FakeBackend.h"
+#include "MetricsServer.h"
+#include "Platform.h"
+#include "SDKIncludes.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct HeadlessSettings {
+        std::string configPath;
+        bool serveMetrics = false;
+        uint16_t metricsPort = MetricsServer::kDefaultPort;
+        unsigned int statusIntervalSeconds = 0;
+        bool runAsService = false;
+        bool fakeSources = false;
+    };
+
+    // Set from signal handlers, the console control handler or the service
+    // control handler; lock-free so it is safe to touch from any of them
+    std::atomic<bool> shutdownRequested(false);
+    std::atomic<bool> shutdownComplete(false);
+    std::atomic<bool> reloadRequested(false);
+
+    double ElapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void PrintUsage(const char* program) {
+        fprintf(stderr,
+            "Usage: %s [options] <config-file>\n"
+            "  --metrics-port <port>    Serve OpenMetrics on 127.0.0.1:<port>/metrics\n"
+            "  --status-interval <sec>  Print per-bridge statistics every <sec> seconds\n"
+            "  --fake-sources           Use synthetic in-process sources and sinks instead of Spout and NDI\n"
+#ifdef _WIN32
+            "  --service                Run under the Windows service control manager\n"
+            "Reload the configuration with: sc control NDISpoutBridge paramchange\n"
+#else
+            "Reload the configuration with SIGHUP\n"
+#endif
+            , program);
+    }
+
+    bool ParseArguments(int argc, char* argv[], HeadlessSettings& settings) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--metrics-port" && i + 1 < argc) {
+                int port = atoi(argv[++i]);
+                if (port <= 0 || port > 65535) return false;
+                settings.serveMetrics = true;
+                settings.metricsPort = (uint16_t)port;
+            }
+            else if (arg == "--status-interval" && i + 1 < argc) {
+                settings.statusIntervalSeconds = (unsigned int)atoi(argv[++i]);
+            }
+            else if (arg == "--fake-sources") {
+                settings.fakeSources = true;
+            }
+#ifdef _WIN32
+            else if (arg == "--service") {
+                settings.runAsService = true;
+            }
+#endif
+            else if (arg == "--config" && i + 1 < argc) {
+                settings.configPath = argv[++i];
+            }
+            else if (!arg.empty() && arg[0] != '-' && settings.configPath.empty()) {
+                settings.configPath = arg;
+            }
+            else {
+                return false;
+            }
+        }
+        return !settings.configPath.empty();
+    }
+
+    void PrintStatus(const BridgeList& bridges) {
+        for (const auto& bridge : bridges) {
+            BridgeStats stats = bridge->GetStats();
+            printf("  %-24s in=%llu out=%llu dup=%llu (%.1f%%, %.0f ms saved) drop=%llu fps=%.1f",
+                   bridge->GetBridgeName().c_str(),
+                   (unsigned long long)stats.framesIn, (unsigned long long)stats.framesOut,
+                   (unsigned long long)stats.duplicates, stats.DuplicatePercent(), stats.DuplicateCpuSavedMs(),
+                   (unsigned long long)stats.drops, stats.outputFps);
+            if (stats.tilesTotal > 0) {
+                printf(" dirty=%.1f%% (%.0f ms saved)", 100.0 * stats.DirtyTileRatio(), stats.DirtyTileSavedMs());
+            }
+            printf("%s\n", stats.idle ? " idle" : "");
+        }
+        fflush(stdout);
+    }
+
+    // Apply an edited configuration file to the running bridges. A file that
+    // fails to parse leaves everything running as it was.
+    void ReloadBridges(const HeadlessSettings& settings, BridgeList& bridges) {
+        std::vector<BridgeDefinition> definitions;
+        std::string error;
+        if (!LoadBridgeConfig(settings.configPath, definitions, error)) {
+            fprintf(stderr, "Reload skipped: %s\n", error.c_str());
+            return;
+        }
+
+        Clock::time_point reloadStart = Clock::now();
+        ReconcileSummary summary = ReconcileBridges(bridges, definitions);
+        for (const std::string& message : summary.errors) {
+            fprintf(stderr, "%s\n", message.c_str());
+        }
+        printf("Reloaded %s: %s in %.1f ms\n", settings.configPath.c_str(),
+               FormatReconcileSummary(summary).c_str(), ElapsedMs(reloadStart));
+        fflush(stdout);
+    }
+
+    int RunBridges(const HeadlessSettings& settings) {
+        std::vector<BridgeDefinition> definitions;
+        std::string error;
+        if (!LoadBridgeConfig(settings.configPath, definitions, error)) {
+            fprintf(stderr, "Configuration error: %s\n", error.c_str());
+            return 2;
+        }
+        if (definitions.empty()) {
+            fprintf(stderr, "No bridges defined in %s\n", settings.configPath.c_str());
+            return 2;
+        }
+
+        if (!NDIlib_initialize()) {
+            fprintf(stderr, "Cannot initialize NDI\n");
+            return 1;
+        }
+
+        // Before the first bridge allocates its frame buffers
+        Platform::EnableLargePages();
+
+        if (settings.fakeSources) {
+            SetDefaultFrameBackend(std::make_shared<FakeBackend>());
+        }
+
+        Clock::time_point startTime = Clock::now();
+        std::vector<std::string> errors;
+        BridgeList bridges = StartBridges(definitions, errors);
+        for (const std::string& message : errors) {
+            fprintf(stderr, "%s\n", message.c_str());
+        }
+        for (const auto& bridge : bridges) {
+            printf("Started %s: %s %s -> %s (%s)\n", bridge->GetBridgeName().c_str(),
+                   bridge->IsSpoutToNDI() ? "Spout" : "NDI", bridge->GetSourceName().c_str(),
+                   bridge->IsSpoutToNDI() ? "NDI" : "Spout", ColorSpaceName(bridge->GetColorSpace()));
+        }
+        printf("%zu of %zu bridges started in %.1f ms\n", bridges.size(), definitions.size(), ElapsedMs(startTime));
+        fflush(stdout);
+
+        MetricsServer metricsServer;
+        if (settings.serveMetrics) {
+            if (metricsServer.Start(settings.metricsPort)) {
+                printf("Serving metrics on http://127.0.0.1:%u/metrics\n", metricsServer.GetPort());
+            }
+            else {
+                fprintf(stderr, "Cannot listen on 127.0.0.1:%u; metrics disabled\n", settings.metricsPort);
+            }
+            fflush(stdout);
+        }
+
+        Clock::time_point lastStatus = Clock::now();
+        bool allStreaming = bridges.empty();
+        while (!shutdownRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            if (reloadRequested.exchange(false)) {
+                ReloadBridges(settings, bridges);
+            }
+            if (!allStreaming) {
+                double streamingMs = TimeToAllStreamingMs(bridges);
+                if (streamingMs >= 0) {
+                    allStreaming = true;
+                    printf("All %zu bridges streaming %.1f ms after launch\n", bridges.size(), streamingMs);
+                    fflush(stdout);
+                }
+            }
+            if (settings.statusIntervalSeconds &&
+                Clock::now() - lastStatus >= std::chrono::seconds(settings.statusIntervalSeconds)) {
+                lastStatus = Clock::now();
+                PrintStatus(bridges);
+            }
+        }
+
+        // Signal every bridge first so they wind down in parallel, then join
+        Clock::time_point stopTime = Clock::now();
+        printf("Stopping %zu bridges\n", bridges.size());
+        fflush(stdout);
+        metricsServer.Stop();
+        for (auto& bridge : bridges) {
+            bridge->RequestStop();
+        }
+        for (auto& bridge : bridges) {
+            bridge->Stop();
+        }
+        PrintStatus(bridges);
+        bridges.clear();
+        NDIlib_destroy();
+        printf("Stopped in %.1f ms\n", ElapsedMs(stopTime));
+        fflush(stdout);
+        return 0;
+    }
+
+#ifdef _WIN32
+    HeadlessSettings serviceSettings;
+    SERVICE_STATUS_HANDLE serviceStatusHandle = nullptr;
+    SERVICE_STATUS serviceStatus = {};
+
+    // serviceExitCode is reported with ERROR_SERVICE_SPECIFIC_ERROR, where
+    // the service control manager looks for it
+    void ReportServiceStatus(DWORD state, DWORD exitCode, DWORD waitHintMs, DWORD serviceExitCode = 0) {
+        static DWORD checkPoint = 1;
+        serviceStatus.dwServiceType = SERVICE_WIN32_OWN_PROCESS;
+        serviceStatus.dwCurrentState = state;
+        serviceStatus.dwWin32ExitCode = exitCode;
+        serviceStatus.dwServiceSpecificExitCode = serviceExitCode;
+        serviceStatus.dwWaitHint = waitHintMs;
+        serviceStatus.dwControlsAccepted = state == SERVICE_START_PENDING ? 0 :
+            SERVICE_ACCEPT_STOP | SERVICE_ACCEPT_SHUTDOWN | SERVICE_ACCEPT_PARAMCHANGE;
+        serviceStatus.dwCheckPoint = (state == SERVICE_RUNNING || state == SERVICE_STOPPED) ? 0 : checkPoint++;
+        SetServiceStatus(serviceStatusHandle, &serviceStatus);
+    }
+
+    DWORD WINAPI ServiceControlHandler(DWORD control, DWORD, LPVOID, LPVOID) {
+        switch (control) {
+            case SERVICE_CONTROL_STOP:
+            case SERVICE_CONTROL_SHUTDOWN:
+                ReportServiceStatus(SERVICE_STOP_PENDING, NO_ERROR, 5000);
+                shutdownRequested = true;
+                return NO_ERROR;
+            case SERVICE_CONTROL_PARAMCHANGE:
+                reloadRequested = true;
+                return NO_ERROR;
+            case SERVICE_CONTROL_INTERROGATE:
+                return NO_ERROR;
+            default:
+                return ERROR_CALL_NOT_IMPLEMENTED;
+        }
+    }
+
+    void WINAPI ServiceMain(DWORD, LPWSTR*) {
+        serviceStatusHandle = RegisterServiceCtrlHandlerExW(L"NDISpoutBridge", ServiceControlHandler, nullptr);
+        if (!serviceStatusHandle) return;
+
+        ReportServiceStatus(SERVICE_START_PENDING, NO_ERROR, 5000);
+        ReportServiceStatus(SERVICE_RUNNING, NO_ERROR, 0);
+        int result = RunBridges(serviceSettings);
+        ReportServiceStatus(SERVICE_STOPPED, result == 0 ? NO_ERROR : ERROR_SERVICE_SPECIFIC_ERROR, 0, (DWORD)result);
+    }
+
+    BOOL WINAPI ConsoleControlHandler(DWORD control) {
+        shutdownRequested = true;
+        // Ctrl+C and Ctrl+Break leave the process running, so main shuts down
+        // at its own pace
+        if (control == CTRL_C_EVENT || control == CTRL_BREAK_EVENT) {
+            return TRUE;
+        }
+        // Windows ends the process when this returns for close/logoff/shutdown;
+        // give the bridges a moment to release their senders first
+        for (int i = 0; i < 100 && !shutdownComplete; i++) {
+            Sleep(50);
+        }
+        return TRUE;
+    }
+#else
+    extern "C" void HandleShutdownSignal(int) {
+        shutdownRequested = true;
+    }
+
+    extern "C" void HandleReloadSignal(int) {
+        reloadRequested = true;
+    }
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    HeadlessSettings settings;
+    if (!ParseArguments(argc, argv, settings)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+#ifdef _WIN32
+    if (settings.runAsService) {
+        serviceSettings = settings;
+        wchar_t serviceName[] = L"NDISpoutBridge";
+        SERVICE_TABLE_ENTRYW serviceTable[] = {
+            { serviceName, ServiceMain },
+            { nullptr, nullptr }
+        };
+        if (!StartServiceCtrlDispatcherW(serviceTable)) {
+            fprintf(stderr, "Not started by the service control manager (error %lu)\n", GetLastError());
+            return 1;
+        }
+        return 0;
+    }
+    SetConsoleCtrlHandler(ConsoleControlHandler, TRUE);
+#else
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = HandleShutdownSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    action.sa_handler = HandleReloadSignal;
+    sigaction(SIGHUP, &action, nullptr);
+#endif
+
+    int result = RunBridges(settings);
+    shutdownComplete = true;
+    return result;
+}
@@ -0,0 +1,128 @@
+#include "JitterBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const uint64_t kWindowFrames = 120;        // Transit minimum is taken over this many frames
+    const double kJitterMultiplier = 4.0;      // Delay in units of measured jitter
+    const uint64_t kDelayDecay = 256;          // Excess delay given back per frame, as a fraction
+    const int64_t kRestartNs = 1000000000;     // Transit jump that means a new stream
+}
+
+JitterBuffer::JitterBuffer(const JitterBufferSettings& settings)
+    : settings(settings)
+    , measuring(false)
+    , frameIndex(0)
+    , lastSourceNs(0)
+    , lastReleasedSourceNs(0)
+    , hasReleased(false)
+    , lastTransitNs(0)
+    , jitterNs(0.0)
+    , delayNs(0)
+    , lastScheduledNs(0)
+{
+}
+
+JitterPush JitterBuffer::Push(const VideoFrame& frame, uint64_t arrivalNs, uint64_t priorNs) {
+    int64_t sourceNs = SenderTimeNs(frame, arrivalNs, measuring, lastSourceNs);
+    int64_t transitNs = (int64_t)arrivalNs - sourceNs;
+
+    if (measuring && std::llabs(transitNs - MinTransit()) > kRestartNs) {
+        Reset();
+        sourceNs = SenderTimeNs(frame, arrivalNs, false, 0);
+        transitNs = (int64_t)arrivalNs - sourceNs;
+    }
+    if (hasReleased && sourceNs <= lastReleasedSourceNs) {
+        return JitterPush::Stale;
+    }
+
+    if (measuring) {
+        double difference = std::fabs((double)(transitNs - lastTransitNs));
+        jitterNs += (difference - jitterNs) / 16.0;
+    }
+    measuring = true;
+    lastTransitNs = transitNs;
+    lastSourceNs = std::max(lastSourceNs, sourceNs);
+
+    while (!window.empty() && window.back().second >= transitNs) window.pop_back();
+    window.emplace_back(frameIndex, transitNs);
+    while (window.front().first + kWindowFrames <= frameIndex) window.pop_front();
+    frameIndex++;
+
+    // Follow the jitter up at once and down slowly, never past the cap
+    uint64_t capNs = (uint64_t)settings.maxLatencyMs * 1000000ull;
+    uint64_t wantNs = std::min(capNs, (uint64_t)(kJitterMultiplier * jitterNs));
+    if (wantNs > delayNs) delayNs = wantNs;
+    else delayNs -= (delayNs - wantNs) / kDelayDecay;
+    delayNs = std::min(delayNs, capNs);
+
+    int64_t releaseNs = sourceNs + MinTransit() + (int64_t)delayNs;
+    JitterPush result = JitterPush::Queued;
+    if (releaseNs < (int64_t)arrivalNs) {
+        // The output ran dry waiting for this one; wait that much longer from now on
+        delayNs = std::min(capNs, delayNs + (uint64_t)((int64_t)arrivalNs - releaseNs));
+        releaseNs = (int64_t)arrivalNs;
+        result = JitterPush::Late;
+    }
+    // Release times rise through the queue like sender times, so Pop need
+    // only look at the front: a frame the network delivered after newer
+    // ones goes out no later than they do
+    auto position = queue.end();
+    while (position != queue.begin() && std::prev(position)->sourceNs > sourceNs) --position;
+    uint64_t releaseAt = std::min((uint64_t)releaseNs, arrivalNs + capNs);
+    if (position != queue.begin()) {
+        releaseAt = std::max(releaseAt, std::prev(position)->releaseNs);
+    }
+    if (position == queue.end()) {
+        releaseAt = std::max(releaseAt, lastScheduledNs);
+        lastScheduledNs = releaseAt;
+    }
+    else {
+        releaseAt = std::min(releaseAt, position->releaseNs);
+    }
+
+    Entry entry;
+    entry.stored = store.Store(frame, arrivalNs, priorNs);
+    entry.sourceNs = sourceNs;
+    entry.releaseNs = releaseAt;
+    queue.insert(position, std::move(entry));
+    return result;
+}
+
+const VideoFrame* JitterBuffer::Pop(uint64_t nowNs, uint64_t& waitedNs, uint64_t& latencyNs, uint64_t& skipped) {
+    waitedNs = 0;
+    latencyNs = 0;
+    skipped = 0;
+    if (queue.empty() || queue.front().releaseNs > nowNs) {
+        return nullptr;
+    }
+
+    store.Recycle(released.stored);
+    released = std::move(queue.front());
+    queue.pop_front();
+    while (!queue.empty() && queue.front().releaseNs <= nowNs) {
+        store.Recycle(released.stored);
+        released = std::move(queue.front());
+        queue.pop_front();
+        skipped++;
+    }
+
+    hasReleased = true;
+    lastReleasedSourceNs = released.sourceNs;
+    const StoredFrame& stored = released.stored;
+    waitedNs = nowNs > stored.arrivalNs ? nowNs - stored.arrivalNs : 0;
+    latencyNs = stored.LatencyNs(nowNs);
+    return &stored.frame;
+}
+
+void JitterBuffer::Reset() {
+    for (Entry& entry : queue) store.Recycle(entry.stored);
+    queue.clear();
+    window.clear();
+    measuring = false;
+    frameIndex = 0;
+    hasReleased = false;
+    jitterNs = 0.0;
+    delayNs = 0;
+    lastScheduledNs = 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "FrameIO.h"
+#include "FrameStore.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+struct JitterBufferSettings {
+    bool enabled = false;
+    unsigned int maxLatencyMs = 50;   // Hard cap on the delay the buffer adds to any frame
+};
+
+// What Push did with a frame
+enum class JitterPush {
+    Queued,    // Held until its release time
+    Late,      // Arrived after its release time; queued for release at once
+    Stale      // Older than a frame already released; dropped
+};
+
+// Holds received frames briefly so they go out on a steady local clock
+// instead of with the network's arrival jitter. Each frame is released at
+// its sender timestamp (VideoFrame::sourceTimeNs, or a cadence from the
+// frame rate when the sender has none) plus the fastest transit seen over
+// the last couple of seconds plus a playout delay. The delay follows the
+// measured transit jitter (RFC 3550 style, x4), grows at once by however
+// late a frame arrived, shrinks slowly, and never exceeds maxLatencyMs.
+// Frames are copied in, kept in sender-time order and never overtake each
+// other. A jump of over a second in transit (a restarted sender) starts
+// the measurements over. Not thread-safe; one per bridge thread.
+class JitterBuffer {
+public:
+    explicit JitterBuffer(const JitterBufferSettings& settings = JitterBufferSettings());
+
+    const JitterBufferSettings& GetSettings() const { return settings; }
+
+    // Queue a copy of frame, which arrived at arrivalNs (Platform::NowNs
+    // timeline) after the bridge had already spent priorNs capturing it
+    JitterPush Push(const VideoFrame& frame, uint64_t arrivalNs, uint64_t priorNs = 0);
+
+    // The newest frame due by nowNs, or nullptr. Older due frames are
+    // dropped and counted in skipped; waitedNs is how long the returned
+    // frame was held since it arrived and latencyNs that plus its priorNs.
+    // Valid until the next Push, Pop or Reset.
+    const VideoFrame* Pop(uint64_t nowNs, uint64_t& waitedNs, uint64_t& latencyNs, uint64_t& skipped);
+
+    // Release time of the oldest queued frame; 0 when empty
+    uint64_t GetNextReleaseNs() const { return queue.empty() ? 0 : queue.front().releaseNs; }
+
+    size_t GetFrameCount() const { return queue.size(); }
+    uint64_t GetDelayNs() const { return delayNs; }
+    uint64_t GetJitterNs() const { return (uint64_t)jitterNs; }
+
+    // Frame buffers held, queued or free
+    size_t GetMemoryBytes() const { return store.GetMemoryBytes(); }
+
+    // Drop every frame and start measuring again
+    void Reset();
+
+private:
+    struct Entry {
+        StoredFrame stored;
+        int64_t sourceNs = 0;
+        uint64_t releaseNs = 0;
+    };
+
+    // Smallest transit over the last kWindowFrames frames
+    int64_t MinTransit() const { return window.front().second; }
+
+    JitterBufferSettings settings;
+    FrameStore store;
+    std::deque<Entry> queue;             // By sourceNs, and so by releaseNs
+    Entry released;                      // The frame last handed out by Pop
+
+    bool measuring;
+    uint64_t frameIndex;
+    int64_t lastSourceNs;                // Newest frame seen, for synthesized timestamps and staleness
+    int64_t lastReleasedSourceNs;
+    bool hasReleased;
+    int64_t lastTransitNs;
+    double jitterNs;
+    uint64_t delayNs;
+    uint64_t lastScheduledNs;            // Release time given to the newest queued frame
+    std::deque<std::pair<uint64_t, int64_t>> window;  // (frame index, transit), increasing transit
+};
@@ -0,0 +1,230 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const uint8_t kReportMagic[4] = { 'N', 'S', 'L', 'H' };
+    const uint8_t kReportVersion = 2;     // 2: jitter_buffer metric added
+
+    void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    bool GetVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= size) return false;
+            uint8_t byte = data[pos++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+const char* LatencyMetricName(LatencyMetric metric) {
+    switch (metric) {
+        case LatencyMetric::CaptureWait: return "capture_wait";
+        case LatencyMetric::Conversion:  return "conversion";
+        case LatencyMetric::Send:        return "send";
+        case LatencyMetric::EndToEnd:    return "end_to_end";
+        case LatencyMetric::JitterBuffer: return "jitter_buffer";
+        default:                         return "unknown";
+    }
+}
+
+HistogramSnapshot::HistogramSnapshot()
+    : buckets(HistogramLayout::kBucketCount, 0)
+    , count(0)
+    , sumNs(0)
+    , maxNs(0)
+{
+}
+
+uint64_t HistogramSnapshot::ValueAtPercentile(double percentile) const {
+    if (count == 0) return 0;
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t target = (uint64_t)std::ceil(percentile / 100.0 * count);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HistogramLayout::kBucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::min(HistogramLayout::BucketHigh(i), maxNs);
+        }
+    }
+    return maxNs;
+}
+
+uint64_t HistogramSnapshot::CountAtOrBelow(uint64_t ns) const {
+    uint64_t total = 0;
+    for (int i = 0; i < HistogramLayout::kBucketCount && HistogramLayout::BucketHigh(i) <= ns; i++) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+HistogramSnapshot HistogramSnapshot::Since(const HistogramSnapshot& earlier) const {
+    HistogramSnapshot delta;
+    int highest = -1;
+    for (int i = 0; i < HistogramLayout::kBucketCount; i++) {
+        delta.buckets[i] = buckets[i] >= earlier.buckets[i] ? buckets[i] - earlier.buckets[i] : 0;
+        if (delta.buckets[i]) highest = i;
+    }
+    delta.count = count >= earlier.count ? count - earlier.count : 0;
+    delta.sumNs = sumNs >= earlier.sumNs ? sumNs - earlier.sumNs : 0;
+
+    // The exact maximum isn't recoverable per window; bound it by the top bucket
+    delta.maxNs = highest >= 0 ? std::min(HistogramLayout::BucketHigh(highest), maxNs) : 0;
+    return delta;
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+    for (int i = 0; i < HistogramLayout::kBucketCount; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumNs += other.sumNs;
+    maxNs = std::max(maxNs, other.maxNs);
+}
+
+std::vector<uint8_t> HistogramSnapshot::Encode() const {
+    std::vector<uint8_t> out;
+    PutVarint(out, count);
+    PutVarint(out, sumNs);
+    PutVarint(out, maxNs);
+
+    uint64_t nonZero = 0;
+    for (uint64_t c : buckets) {
+        nonZero += c ? 1 : 0;
+    }
+    PutVarint(out, nonZero);
+
+    // (gap from previous non-zero bucket, count) pairs
+    int previous = -1;
+    for (int i = 0; i < HistogramLayout::kBucketCount; i++) {
+        if (buckets[i]) {
+            PutVarint(out, (uint64_t)(i - previous - 1));
+            PutVarint(out, buckets[i]);
+            previous = i;
+        }
+    }
+    return out;
+}
+
+bool HistogramSnapshot::Decode(const uint8_t* data, size_t size, HistogramSnapshot& out, size_t* consumed) {
+    HistogramSnapshot result;
+    size_t pos = 0;
+    uint64_t nonZero = 0;
+    if (!GetVarint(data, size, pos, result.count) ||
+        !GetVarint(data, size, pos, result.sumNs) ||
+        !GetVarint(data, size, pos, result.maxNs) ||
+        !GetVarint(data, size, pos, nonZero)) {
+        return false;
+    }
+
+    int64_t index = -1;
+    for (uint64_t n = 0; n < nonZero; n++) {
+        uint64_t gap = 0, value = 0;
+        if (!GetVarint(data, size, pos, gap) || !GetVarint(data, size, pos, value)) {
+            return false;
+        }
+        if (gap >= (uint64_t)HistogramLayout::kBucketCount) return false;
+        index += (int64_t)gap + 1;
+        if (index >= HistogramLayout::kBucketCount) return false;
+        result.buckets[(size_t)index] = value;
+    }
+
+    out = std::move(result);
+    if (consumed) *consumed = pos;
+    return true;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : count(0)
+    , sumNs(0)
+    , maxNs(0)
+{
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const {
+    HistogramSnapshot snapshot;
+    for (int i = 0; i < HistogramLayout::kBucketCount; i++) {
+        snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count = count.load(std::memory_order_relaxed);
+    snapshot.sumNs = sumNs.load(std::memory_order_relaxed);
+    snapshot.maxNs = maxNs.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+HistogramSnapshot LatencyWindow::Roll(const LatencyHistogram& histogram) {
+    HistogramSnapshot current = histogram.Snapshot();
+    HistogramSnapshot window = current.Since(last);
+    last = std::move(current);
+    return window;
+}
+
+std::vector<uint8_t> EncodeLatencyReports(const std::vector<LatencyReport>& reports) {
+    // Header records the bucket layout so files from different builds can be checked
+    std::vector<uint8_t> out(kReportMagic, kReportMagic + 4);
+    out.push_back(kReportVersion);
+    out.push_back((uint8_t)HistogramLayout::kSubBucketBits);
+    out.push_back((uint8_t)HistogramLayout::kMaxExponent);
+    out.push_back((uint8_t)LatencyMetric::Count);
+    PutVarint(out, reports.size());
+
+    for (const LatencyReport& report : reports) {
+        PutVarint(out, report.bridgeName.size());
+        out.insert(out.end(), report.bridgeName.begin(), report.bridgeName.end());
+        for (const HistogramSnapshot& metric : report.metrics) {
+            std::vector<uint8_t> encoded = metric.Encode();
+            out.insert(out.end(), encoded.begin(), encoded.end());
+        }
+    }
+    return out;
+}
+
+bool DecodeLatencyReports(const std::vector<uint8_t>& data, std::vector<LatencyReport>& reports) {
+    const uint8_t* p = data.data();
+    size_t size = data.size();
+    if (size < 8 || !std::equal(kReportMagic, kReportMagic + 4, p)) return false;
+    if (p[4] != kReportVersion ||
+        p[5] != HistogramLayout::kSubBucketBits ||
+        p[6] != HistogramLayout::kMaxExponent ||
+        p[7] != (uint8_t)LatencyMetric::Count) {
+        return false;
+    }
+
+    size_t pos = 8;
+    uint64_t reportCount = 0;
+    if (!GetVarint(p, size, pos, reportCount)) return false;
+
+    std::vector<LatencyReport> result;
+    for (uint64_t r = 0; r < reportCount; r++) {
+        LatencyReport report;
+        uint64_t nameLength = 0;
+        if (!GetVarint(p, size, pos, nameLength) || nameLength > size - pos) return false;
+        report.bridgeName.assign(reinterpret_cast<const char*>(p + pos), (size_t)nameLength);
+        pos += (size_t)nameLength;
+
+        for (HistogramSnapshot& metric : report.metrics) {
+            size_t consumed = 0;
+            if (!HistogramSnapshot::Decode(p + pos, size - pos, metric, &consumed)) return false;
+            pos += consumed;
+        }
+        result.push_back(std::move(report));
+    }
+
+    reports = std::move(result);
+    return true;
+}
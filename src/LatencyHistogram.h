@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Latencies tracked per bridge
+enum class LatencyMetric {
+    CaptureWait = 0,   // Waiting for the source to deliver a frame
+    Conversion = 1,    // Pixel format conversion
+    Send = 2,          // Handing the frame to the output
+    EndToEnd = 3,      // Capture start to send complete
+    JitterBuffer = 4,  // Time a frame was held back by the jitter buffer
+    Count
+};
+
+const char* LatencyMetricName(LatencyMetric metric);
+
+// HDR-style log-bucketed layout shared by the live histogram and its snapshots.
+// Values are nanoseconds. Each power of two is split into 32 linear sub-buckets,
+// giving ~3% worst-case relative error from 32 ns up to ~68 s.
+namespace HistogramLayout {
+    const int kSubBucketBits = 5;
+    const int kSubBuckets = 1 << kSubBucketBits;
+    const int kMaxExponent = 36;   // Values >= 2^36 ns land in the last bucket
+    const int kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    inline int BucketIndex(uint64_t ns) {
+        if (ns < (uint64_t)kSubBuckets) return (int)ns;
+        if (ns >> kMaxExponent) return kBucketCount - 1;
+
+        int exponent = 63;
+        while (!(ns >> exponent)) exponent--;
+        int shift = exponent - kSubBucketBits;
+        int sub = (int)(ns >> shift) - kSubBuckets;
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    // Smallest and largest value that map to a bucket
+    inline uint64_t BucketLow(int index) {
+        if (index < kSubBuckets) return (uint64_t)index;
+        int shift = index / kSubBuckets - 1;
+        return (uint64_t)(kSubBuckets + index % kSubBuckets) << shift;
+    }
+
+    inline uint64_t BucketHigh(int index) {
+        if (index < kSubBuckets) return (uint64_t)index;
+        int shift = index / kSubBuckets - 1;
+        return BucketLow(index) + ((uint64_t)1 << shift) - 1;
+    }
+}
+
+// Plain copy of a histogram, used for queries, rolling windows and export
+class HistogramSnapshot {
+public:
+    HistogramSnapshot();
+
+    uint64_t Count() const { return count; }
+    uint64_t MaxNs() const { return maxNs; }
+    uint64_t SumNs() const { return sumNs; }
+    double MeanNs() const { return count ? (double)sumNs / count : 0.0; }
+
+    // Samples whose bucket lies entirely at or below ns (for fixed-boundary export)
+    uint64_t CountAtOrBelow(uint64_t ns) const;
+
+    // Value at or below which the given percentage of samples fall (e.g. 99.9)
+    uint64_t ValueAtPercentile(double percentile) const;
+
+    // Samples recorded since an earlier snapshot of the same histogram
+    HistogramSnapshot Since(const HistogramSnapshot& earlier) const;
+
+    // Fold in another histogram's samples, e.g. to combine several bridges
+    void Merge(const HistogramSnapshot& other);
+
+    // Compact binary form: header, then run-length encoded bucket counts
+    std::vector<uint8_t> Encode() const;
+    static bool Decode(const uint8_t* data, size_t size, HistogramSnapshot& out, size_t* consumed = nullptr);
+
+private:
+    friend class LatencyHistogram;
+
+    std::vector<uint64_t> buckets;
+    uint64_t count;
+    uint64_t sumNs;
+    uint64_t maxNs;
+};
+
+// Lock-free histogram with a single writer (the bridge thread).
+// Readers take snapshots at any time without blocking the writer.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void Record(uint64_t ns) {
+        Add(buckets[HistogramLayout::BucketIndex(ns)], 1);
+        Add(count, 1);
+        Add(sumNs, ns);
+        if (ns > maxNs.load(std::memory_order_relaxed)) {
+            maxNs.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    HistogramSnapshot Snapshot() const;
+
+private:
+    static void Add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets[HistogramLayout::kBucketCount];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sumNs;
+    std::atomic<uint64_t> maxNs;
+};
+
+// Rolling window over a cumulative histogram. Each Roll() returns the samples
+// recorded since the previous Roll(), so readers get periodic resets without
+// ever writing to the live histogram.
+class LatencyWindow {
+public:
+    HistogramSnapshot Roll(const LatencyHistogram& histogram);
+
+private:
+    HistogramSnapshot last;
+};
+
+// All latency histograms of one bridge, for export and comparison between runs
+struct LatencyReport {
+    std::string bridgeName;
+    HistogramSnapshot metrics[(int)LatencyMetric::Count];
+};
+
+std::vector<uint8_t> EncodeLatencyReports(const std::vector<LatencyReport>& reports);
+bool DecodeLatencyReports(const std::vector<uint8_t>& data, std::vector<LatencyReport>& reports);
@@ -1,6 +1,7 @@
 #include "ListView.h"
 #include "resource.h"
 #include "BridgeInstance.h"
+#include "BridgeListModel.h"
 #include "Utils.h"
 #include <CommCtrl.h>
 
@@ -9,6 +10,11 @@ namespace {
     HWND hList = NULL;
     HWND hEditButton = NULL;
     HWND hDeleteButton = NULL;
+    BridgeListModel model;
+
+    // Live columns are re-sampled at most this often
+    const UINT_PTR kRefreshTimerId = 1;
+    const UINT kRefreshIntervalMs = 500;
 
     // Forward declarations of internal functions
     void RefreshList();
@@ -19,7 +25,7 @@ namespace {
             WS_EX_CLIENTEDGE,  // Add border
             WC_LISTVIEWW,
             L"",
-            WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL,
+            WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL | LVS_OWNERDATA,
             10, 10,  // x, y with margin
             560, 300,  // width, height - reduced size
             hParent,
@@ -33,11 +39,16 @@ namespace {
             L"Bridge Name",
             L"Type",
             L"Source",
-            L"Color Space"
+            L"Color Space",
+            L"FPS",
+            L"Latency (p99)",
+            L"Drops",
+            L"Skipped (CPU saved)",
+            L"State"
         };
-        static const int widths[] = { 150, 100, 200, 100 }; // Reduced widths
+        static const int widths[] = { 100, 80, 120, 70, 50, 80, 50, 90, 70 }; // Reduced widths
 
-        for (int i = 0; i < 4; i++) {
+        for (int i = 0; i < (int)BridgeListColumn::Count; i++) {
             LVCOLUMNW lvc = { 0 };
             lvc.mask = LVCF_TEXT | LVCF_WIDTH | LVCF_SUBITEM;
             lvc.iSubItem = i;
@@ -73,9 +84,10 @@ namespace {
 
         // Enable full row select and gridlines
         ListView_SetExtendedListViewStyle(hList, 
-            LVS_EX_FULLROWSELECT | LVS_EX_GRIDLINES);
+            LVS_EX_FULLROWSELECT | LVS_EX_GRIDLINES | LVS_EX_DOUBLEBUFFER);
 
         RefreshList();
+        SetTimer(hParent, kRefreshTimerId, kRefreshIntervalMs, NULL);
     }
 
     void UpdateLayout(const RECT& rcClient) {
@@ -108,61 +120,67 @@ namespace {
 
         // Update column widths proportionally
         int totalWidth = listWidth - GetSystemMetrics(SM_CXVSCROLL) - 4;  // Account for borders
-        ListView_SetColumnWidth(hList, 0, totalWidth * 25/100);  // Bridge Name: 25%
-        ListView_SetColumnWidth(hList, 1, totalWidth * 20/100);  // Type: 20%
-        ListView_SetColumnWidth(hList, 2, totalWidth * 35/100);  // Source: 35%
-        ListView_SetColumnWidth(hList, 3, totalWidth * 20/100);  // Color Space: 20%
+        ListView_SetColumnWidth(hList, 0, totalWidth * 15/100);  // Bridge Name: 15%
+        ListView_SetColumnWidth(hList, 1, totalWidth * 10/100);  // Type: 10%
+        ListView_SetColumnWidth(hList, 2, totalWidth * 18/100);  // Source: 18%
+        ListView_SetColumnWidth(hList, 3, totalWidth * 9/100);   // Color Space: 9%
+        ListView_SetColumnWidth(hList, 4, totalWidth * 7/100);   // FPS: 7%
+        ListView_SetColumnWidth(hList, 5, totalWidth * 11/100);  // Latency: 11%
+        ListView_SetColumnWidth(hList, 6, totalWidth * 7/100);   // Drops: 7%
+        ListView_SetColumnWidth(hList, 7, totalWidth * 12/100);  // Skipped: 12%
+        ListView_SetColumnWidth(hList, 8, totalWidth * 11/100);  // State: 11%
     }
 
     void RefreshList() {
-        ListView_DeleteAllItems(hList);
-
-        for (size_t i = 0; i < g_instances.size(); i++) {
-            auto& instance = g_instances[i];
-            
-            // Create a buffer for wide strings that won't be destroyed
-            static std::wstring bridgeName, sourceName;
-            bridgeName = Utils::ToWide(instance->GetBridgeName());
-            sourceName = Utils::ToWide(instance->GetSourceName());
-
-            // Bridge Name
-            LVITEMW lvi = { 0 };
-            lvi.mask = LVIF_TEXT;
-            lvi.iItem = (int)i;
-            lvi.iSubItem = 0;
-            lvi.pszText = (LPWSTR)bridgeName.c_str();
-            SendMessageW(hList, LVM_INSERTITEMW, 0, reinterpret_cast<LPARAM>(&lvi));
-
-            // Type
-            lvi.iSubItem = 1;
-            static const wchar_t* typeSpoutToNDI = L"Spout → NDI";
-            static const wchar_t* typeNDIToSpout = L"NDI → Spout";
-            lvi.pszText = (LPWSTR)(instance->IsSpoutToNDI() ? typeSpoutToNDI : typeNDIToSpout);
-            SendMessageW(hList, LVM_SETITEMW, 0, reinterpret_cast<LPARAM>(&lvi));
-
-            // Source
-            lvi.iSubItem = 2;
-            lvi.pszText = (LPWSTR)sourceName.c_str();
-            SendMessageW(hList, LVM_SETITEMW, 0, reinterpret_cast<LPARAM>(&lvi));
-
-            // Color Space
-            lvi.iSubItem = 3;
-            static const wchar_t* colorSpaceRGBA = L"RGBA";
-            static const wchar_t* colorSpaceBGRA = L"BGRA";
-            static const wchar_t* colorSpaceUYVY = L"UYVY";
-            switch (instance->GetColorSpace()) {
-                case ColorSpace::RGBA:
-                    lvi.pszText = (LPWSTR)colorSpaceRGBA;
-                    break;
-                case ColorSpace::BGRA:
-                    lvi.pszText = (LPWSTR)colorSpaceBGRA;
-                    break;
-                case ColorSpace::UYVY:
-                    lvi.pszText = (LPWSTR)colorSpaceUYVY;
-                    break;
+        std::vector<BridgeListEntry> entries;
+        entries.reserve(g_instances.size());
+        for (const auto& instance : g_instances) {
+            BridgeListEntry entry;
+            entry.metrics = instance->GetMetrics();
+            entry.colorSpace = ColorSpaceName(instance->GetColorSpace());
+            entry.running = instance->IsRunning();
+            entries.push_back(std::move(entry));
+        }
+        model.Reset(entries);
+
+        // Virtual list: only the count is stored in the control, text comes from the model
+        ListView_SetItemCountEx(hList, model.GetRowCount(), LVSICF_NOSCROLL);
+        InvalidateRect(hList, NULL, FALSE);
+    }
+
+    void RefreshStats() {
+        // Repaint only rows whose text changed, in contiguous runs
+        std::vector<int> changed = model.Refresh();
+        for (size_t i = 0; i < changed.size();) {
+            size_t j = i;
+            while (j + 1 < changed.size() && changed[j + 1] == changed[j] + 1) {
+                j++;
             }
-            SendMessageW(hList, LVM_SETITEMW, 0, reinterpret_cast<LPARAM>(&lvi));
+            ListView_RedrawItems(hList, changed[i], changed[j]);
+            i = j + 1;
+        }
+    }
+
+    bool HandleNotify(LPARAM lParam) {
+        NMHDR* header = reinterpret_cast<NMHDR*>(lParam);
+        if (header->hwndFrom != hList || header->code != LVN_GETDISPINFOW) {
+            return false;
+        }
+
+        LVITEMW& item = reinterpret_cast<NMLVDISPINFOW*>(lParam)->item;
+        if ((item.mask & LVIF_TEXT) && item.pszText && item.cchTextMax > 0) {
+            std::wstring text = Utils::ToWide(model.GetText(item.iItem, (BridgeListColumn)item.iSubItem));
+            wcsncpy_s(item.pszText, item.cchTextMax, text.c_str(), _TRUNCATE);
+        }
+        return true;
+    }
+
+    bool HandleTimer(WPARAM timerId) {
+        if (timerId != kRefreshTimerId) {
+            return false;
         }
+        RefreshStats();
+        return true;
     }
 
     int GetSelectedIndex() {
@@ -175,5 +193,8 @@ namespace ListView {
     void Init(HWND hParent, HINSTANCE hInst) { ::Init(hParent, hInst); }
     void UpdateLayout(const RECT& rcClient) { ::UpdateLayout(rcClient); }
     void RefreshList() { ::RefreshList(); }
+    void RefreshStats() { ::RefreshStats(); }
+    bool HandleNotify(LPARAM lParam) { return ::HandleNotify(lParam); }
+    bool HandleTimer(WPARAM timerId) { return ::HandleTimer(timerId); }
     int GetSelectedIndex() { return ::GetSelectedIndex(); }
 }
@@ -13,6 +13,13 @@ namespace ListView {
     // Get the index of the selected item
     int GetSelectedIndex();
     
-    // Refresh the list view contents
+    // Refresh the list view contents after bridges are added, edited or removed
     void RefreshList();
+
+    // Re-sample the live statistics columns and repaint rows that changed
+    void RefreshStats();
+
+    // Route WM_NOTIFY and WM_TIMER here; true if the message was handled
+    bool HandleNotify(LPARAM lParam);
+    bool HandleTimer(WPARAM timerId);
 };
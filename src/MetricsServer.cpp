@@ -0,0 +1,375 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "MetricsServer.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+#ifdef _WIN32
+    typedef SOCKET socket_t;
+    const socket_t kInvalidSocket = INVALID_SOCKET;
+    void CloseSocket(socket_t s) { closesocket(s); }
+#else
+    typedef int socket_t;
+    const socket_t kInvalidSocket = -1;
+    void CloseSocket(socket_t s) { close(s); }
+#endif
+
+    const char* kContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    // Fixed histogram boundaries (seconds) exported from the fine-grained HDR buckets
+    const double kLatencyBounds[] = {
+        0.0005, 0.001, 0.002, 0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5
+    };
+
+    // True if the socket becomes readable within timeoutMs
+    bool WaitReadable(socket_t s, int timeoutMs) {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(s, &readSet);
+        timeval timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        return select((int)s + 1, &readSet, nullptr, nullptr, &timeout) > 0;
+    }
+
+    std::string EscapeLabel(const std::string& value) {
+        std::string out;
+        out.reserve(value.size());
+        for (char c : value) {
+            if (c == '\\') out += "\\\\";
+            else if (c == '"') out += "\\\"";
+            else if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        return out;
+    }
+
+    std::string FormatDouble(double value) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.9g", value);
+        return buffer;
+    }
+
+    std::string BridgeLabels(const BridgeMetrics& metrics) {
+        return "bridge=\"" + EscapeLabel(metrics.bridgeName) +
+               "\",bridge_id=\"" + EscapeLabel(metrics.bridgeId) +
+               "\",source=\"" + EscapeLabel(metrics.sourceName) +
+               "\",direction=\"" + EscapeLabel(metrics.direction) + "\"";
+    }
+
+    void Family(std::string& out, const char* name, const char* type, const char* help, const char* unit = nullptr) {
+        out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+        if (unit) {
+            out += "# UNIT "; out += name; out += ' '; out += unit; out += '\n';
+        }
+        out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+    }
+
+    void Sample(std::string& out, const std::string& name, const std::string& labels, const std::string& value) {
+        out += name;
+        if (!labels.empty()) {
+            out += '{'; out += labels; out += '}';
+        }
+        out += ' '; out += value; out += '\n';
+    }
+}
+
+std::string RenderOpenMetrics(const MetricsRegistry::List& bridges, double processCpuSeconds) {
+    // Snapshot every bridge once so all families agree with each other
+    std::vector<BridgeStats> stats;
+    std::vector<std::string> labels;
+    for (const auto& bridge : bridges) {
+        stats.push_back(bridge->counters.Snapshot());
+        labels.push_back(BridgeLabels(*bridge));
+    }
+
+    struct CounterFamily {
+        const char* name;
+        const char* help;
+        uint64_t BridgeStats::*field;
+    };
+    static const CounterFamily counters[] = {
+        { "ndispout_bridge_frames_in", "Frames received from the source.", &BridgeStats::framesIn },
+        { "ndispout_bridge_frames_out", "Frames sent to the output.", &BridgeStats::framesOut },
+        { "ndispout_bridge_duplicate_frames", "Frames skipped as unchanged.", &BridgeStats::duplicates },
+        { "ndispout_bridge_dropped_frames", "Frames lost before or inside the bridge.", &BridgeStats::drops },
+        { "ndispout_bridge_receiver_dropped_frames", "Frames the source's receiver threw away before capture.",
+          &BridgeStats::receiverDrops },
+        { "ndispout_bridge_skipped_frames", "Queued frames passed over to show the newest.", &BridgeStats::skippedFrames },
+        { "ndispout_bridge_jitter_buffer_underruns", "Frames that reached the jitter buffer after their release time.",
+          &BridgeStats::jitterUnderruns },
+        { "ndispout_bridge_sync_repeated_frames", "Output ticks the time-base corrector filled by repeating a frame.",
+          &BridgeStats::syncRepeats },
+        { "ndispout_bridge_sync_dropped_frames", "Frames the time-base corrector passed over.", &BridgeStats::syncDrops },
+        { "ndispout_bridge_reconnects", "Source reconnects or format changes.", &BridgeStats::reconnects },
+        { "ndispout_bridge_processed_bytes", "Pixel bytes converted and sent.", &BridgeStats::bytesProcessed },
+    };
+
+    std::string out;
+    out.reserve(4096 + bridges.size() * 8192);
+
+    for (const CounterFamily& family : counters) {
+        Family(out, family.name, "counter", family.help);
+        for (size_t i = 0; i < stats.size(); i++) {
+            Sample(out, std::string(family.name) + "_total", labels[i], std::to_string(stats[i].*family.field));
+        }
+    }
+
+    Family(out, "ndispout_bridge_output_fps", "gauge", "Frames out per second over the last second.");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_output_fps", labels[i], FormatDouble(stats[i].outputFps));
+    }
+
+    Family(out, "ndispout_bridge_queue_depth", "gauge", "Frames waiting inside or in front of the bridge.");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_queue_depth", labels[i], std::to_string(stats[i].queueDepth));
+    }
+
+    Family(out, "ndispout_bridge_pool_bytes", "gauge", "Frame buffer memory held by the bridge.", "bytes");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_pool_bytes", labels[i], std::to_string(stats[i].poolBytes));
+    }
+
+    Family(out, "ndispout_bridge_idle", "gauge", "1 while the bridge rests because nobody receives its output.");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_idle", labels[i], std::to_string(stats[i].idle));
+    }
+
+    Family(out, "ndispout_bridge_idle_seconds", "counter", "Time spent resting with nobody receiving the output.",
+           "seconds");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_idle_seconds_total", labels[i], FormatDouble(stats[i].idleNs / 1e9));
+    }
+
+    Family(out, "ndispout_bridge_duplicate_percent", "gauge", "Share of frames in skipped as unchanged, in percent.");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_duplicate_percent", labels[i], FormatDouble(stats[i].DuplicatePercent()));
+    }
+
+    Family(out, "ndispout_bridge_duplicate_cpu_saved_seconds", "gauge",
+           "Estimated conversion and send time avoided by skipping unchanged frames, net of hashing.", "seconds");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_duplicate_cpu_saved_seconds", labels[i],
+               FormatDouble(stats[i].DuplicateCpuSavedMs() / 1e3));
+    }
+
+    Family(out, "ndispout_bridge_dirty_tile_ratio", "gauge", "Share of tiles reconverted because they changed.", "ratio");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_dirty_tile_ratio", labels[i], FormatDouble(stats[i].DirtyTileRatio()));
+    }
+
+    Family(out, "ndispout_bridge_dirty_tile_saved_seconds", "gauge",
+           "Estimated conversion time avoided by reusing unchanged tiles.", "seconds");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_dirty_tile_saved_seconds", labels[i], FormatDouble(stats[i].DirtyTileSavedMs() / 1e3));
+    }
+
+    Family(out, "ndispout_bridge_jitter_buffer_frames", "gauge", "Frames waiting in the jitter buffer.");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_jitter_buffer_frames", labels[i], std::to_string(stats[i].jitterFrames));
+    }
+
+    Family(out, "ndispout_bridge_jitter_buffer_delay_seconds", "gauge", "Delay the jitter buffer currently adds.",
+           "seconds");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_jitter_buffer_delay_seconds", labels[i], FormatDouble(stats[i].jitterDelayNs / 1e9));
+    }
+
+    Family(out, "ndispout_bridge_clock_drift_ppm", "gauge",
+           "Sender clock against ours as measured by the time-base corrector, in parts per million.");
+    for (size_t i = 0; i < stats.size(); i++) {
+        Sample(out, "ndispout_bridge_clock_drift_ppm", labels[i], FormatDouble(stats[i].clockDriftPpm));
+    }
+
+    Family(out, "ndispout_bridge_latency_seconds", "histogram", "Per-stage frame latency.", "seconds");
+    for (size_t i = 0; i < bridges.size(); i++) {
+        for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+            HistogramSnapshot snapshot = bridges[i]->latency[m].Snapshot();
+            std::string stageLabels = labels[i] + ",stage=\"" + LatencyMetricName((LatencyMetric)m) + "\"";
+            for (double bound : kLatencyBounds) {
+                Sample(out, "ndispout_bridge_latency_seconds_bucket", stageLabels + ",le=\"" + FormatDouble(bound) + "\"",
+                       std::to_string(snapshot.CountAtOrBelow((uint64_t)(bound * 1e9))));
+            }
+            Sample(out, "ndispout_bridge_latency_seconds_bucket", stageLabels + ",le=\"+Inf\"", std::to_string(snapshot.Count()));
+            Sample(out, "ndispout_bridge_latency_seconds_count", stageLabels, std::to_string(snapshot.Count()));
+            Sample(out, "ndispout_bridge_latency_seconds_sum", stageLabels, FormatDouble(snapshot.SumNs() / 1e9));
+        }
+    }
+
+    Family(out, "ndispout_process_cpu_seconds", "counter", "User and kernel CPU time used by the process.", "seconds");
+    Sample(out, "ndispout_process_cpu_seconds_total", "", FormatDouble(processCpuSeconds));
+
+    out += "# EOF\n";
+    return out;
+}
+
+double GetProcessCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    auto toSeconds = [](const FILETIME& ft) {
+        return (double)(((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime) / 1e7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+MetricsServer::MetricsServer()
+    : listenSocket((intptr_t)kInvalidSocket)
+    , port(0)
+    , running(false)
+    , shouldStop(false)
+{
+}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+bool MetricsServer::Start(uint16_t port) {
+    if (running) return true;
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        return false;
+    }
+#endif
+
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == kInvalidSocket) {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    // Loopback only: metrics are for the local scraper, not the network
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    if (bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(s, 8) != 0) {
+        CloseSocket(s);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    // Port 0 asks the OS for a free port; report the one we got
+    socklen_t length = sizeof(address);
+    if (getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        port = ntohs(address.sin_port);
+    }
+
+    listenSocket = (intptr_t)s;
+    this->port = port;
+    shouldStop = false;
+    running = true;
+    thread = std::thread(&MetricsServer::ServeLoop, this);
+    return true;
+}
+
+void MetricsServer::Stop() {
+    if (!running) return;
+
+    shouldStop = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    CloseSocket((socket_t)listenSocket);
+    listenSocket = (intptr_t)kInvalidSocket;
+    running = false;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void MetricsServer::ServeLoop() {
+    socket_t s = (socket_t)listenSocket;
+    while (!shouldStop) {
+        // Poll so Stop() is noticed within a fraction of a second
+        if (!WaitReadable(s, 200)) {
+            continue;
+        }
+        socket_t client = accept(s, nullptr, nullptr);
+        if (client != kInvalidSocket) {
+            HandleClient((intptr_t)client);
+            CloseSocket(client);
+        }
+    }
+}
+
+void MetricsServer::HandleClient(intptr_t clientHandle) {
+    socket_t client = (socket_t)clientHandle;
+
+    // Read until the end of the request headers; bodies are not expected
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        if (!WaitReadable(client, 2000)) return;
+        int received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) return;
+        request.append(buffer, received);
+    }
+
+    std::string status;
+    std::string contentType = "text/plain; charset=utf-8";
+    std::string body;
+    bool isGet = request.compare(0, 4, "GET ") == 0;
+    size_t pathEnd = request.find(' ', 4);
+    std::string path = isGet && pathEnd != std::string::npos ? request.substr(4, pathEnd - 4) : "";
+
+    if (!isGet) {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported\n";
+    }
+    else if (path == "/metrics" || path.compare(0, 9, "/metrics?") == 0) {
+        status = "200 OK";
+        contentType = kContentType;
+        body = RenderOpenMetrics(*MetricsRegistry::Snapshot(), GetProcessCpuSeconds());
+    }
+    else {
+        status = "404 Not Found";
+        body = "Metrics are served at /metrics\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: " + contentType + "\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        int n = send(client, response.data() + sent, (int)(response.size() - sent), 0);
+        if (n <= 0) break;
+        sent += n;
+    }
+}
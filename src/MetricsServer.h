@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BridgeMetrics.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Render all registered bridges plus process CPU in OpenMetrics text format.
+// Reads only lock-free snapshots, so it never stalls a bridge thread.
+std::string RenderOpenMetrics(const MetricsRegistry::List& bridges, double processCpuSeconds);
+
+// User + kernel CPU time consumed by this process so far
+double GetProcessCpuSeconds();
+
+// Minimal HTTP listener on 127.0.0.1 serving GET /metrics for Prometheus.
+// Requests are handled one at a time on a single background thread.
+class MetricsServer {
+public:
+    static const uint16_t kDefaultPort = 9464;
+
+    MetricsServer();
+    ~MetricsServer();
+
+    // Bind and start serving; false if the port can't be bound
+    bool Start(uint16_t port = kDefaultPort);
+    void Stop();
+
+    bool IsRunning() const { return running; }
+    uint16_t GetPort() const { return port; }
+
+private:
+    void ServeLoop();
+    void HandleClient(intptr_t client);
+
+    intptr_t listenSocket;
+    uint16_t port;
+    bool running;
+    std::atomic<bool> shouldStop;
+    std::thread thread;
+};
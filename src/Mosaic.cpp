@@ -0,0 +1,374 @@
+#include "Mosaic.h"
+#include "FrameFanOut.h"
+#include "Platform.h"
+#include "Scaler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+    const unsigned int kTileCaptureTimeoutMs = 100;
+    const unsigned int kTileOpenRetryMs = 500;
+
+    std::atomic<uint64_t> g_outputFrames{0};
+    std::atomic<uint64_t> g_tileFrames{0};
+    std::atomic<uint64_t> g_scaleNs{0};
+    std::atomic<uint64_t> g_composeNs{0};
+
+    struct Rect {
+        unsigned int x = 0;
+        unsigned int y = 0;
+        unsigned int width = 0;
+        unsigned int height = 0;
+    };
+
+    void FillBlack(unsigned char* row, unsigned int pixels) {
+        for (unsigned int i = 0; i < pixels; i++) {
+            unsigned char* p = row + i * 4;
+            p[0] = 0; p[1] = 0; p[2] = 0; p[3] = 255;
+        }
+    }
+
+    // One source's cell. The tile thread scales into back and swaps it with
+    // front; the output copies front into the composite when it changed.
+    struct Tile {
+        std::string sourceName;
+        Rect cell;
+        std::unique_ptr<FrameSource> source;
+        std::thread thread;
+
+        std::mutex mutex;
+        Platform::FrameBuffer front;
+        bool updated = false;
+
+        // Tile thread only
+        Platform::FrameBuffer back;
+
+        // Output thread only: changed in the composite since the last Convert
+        bool convertPending = false;
+    };
+
+    class MosaicFrameSource : public FrameSource {
+    public:
+        MosaicFrameSource(std::shared_ptr<FrameBackend> backend, FrameEndpoint endpoint,
+                          const std::vector<std::string>& sources, const MosaicSettings& settings)
+            : backend(std::move(backend))
+            , endpoint(endpoint)
+            , sourceNames(sources)
+            , settings(settings)
+            , open(false)
+            , stopping(false)
+            , stopEvent(true)
+            , startNs(0)
+            , nextIndex(0)
+        {
+        }
+
+        ~MosaicFrameSource() override { Close(); }
+
+        bool Open() override {
+            if (open) return true;
+            if (sourceNames.empty() || !settings.width || !settings.height ||
+                settings.frameRateN <= 0 || settings.frameRateD <= 0) {
+                return false;
+            }
+
+            size_t stride = (size_t)settings.width * 4;
+            canvas.resize(stride * settings.height);
+            for (unsigned int y = 0; y < settings.height; y++) {
+                FillBlack(canvas.data() + y * stride, settings.width);
+            }
+            canvasFrame = VideoFrame();
+            canvasFrame.data = canvas.data();
+            canvasFrame.width = settings.width;
+            canvasFrame.height = settings.height;
+            canvasFrame.strideBytes = stride;
+            canvasFrame.format = PixelFormat::RGBA;
+            canvasFrame.frameRateN = settings.frameRateN;
+            canvasFrame.frameRateD = settings.frameRateD;
+            converted.clear();
+
+            // Near-square grid unless the columns are given
+            unsigned int count = (unsigned int)sourceNames.size();
+            unsigned int columns = settings.columns ? std::min(settings.columns, count)
+                                                    : (unsigned int)std::ceil(std::sqrt((double)count));
+            unsigned int rows = (count + columns - 1) / columns;
+            unsigned int cellWidth = std::max(1u, settings.width / columns);
+            unsigned int cellHeight = std::max(1u, settings.height / rows);
+
+            ReceiveSettings receive;
+            receive.format = PixelFormat::RGBA;
+            receive.bandwidth = settings.proxy ? ReceiveBandwidth::Lowest : ReceiveBandwidth::Highest;
+
+            stopping = false;
+            stopEvent.Reset();
+            for (unsigned int i = 0; i < count; i++) {
+                auto tile = std::make_unique<Tile>();
+                tile->sourceName = sourceNames[i];
+                tile->cell.x = (i % columns) * cellWidth;
+                tile->cell.y = (i / columns) * cellHeight;
+                tile->cell.width = std::min(cellWidth, settings.width - tile->cell.x);
+                tile->cell.height = std::min(cellHeight, settings.height - tile->cell.y);
+                tile->source = CreateSharedSource(backend, endpoint, sourceNames[i], receive);
+                tile->front.resize((size_t)tile->cell.width * tile->cell.height * 4);
+                tile->back.resize(tile->front.size());
+                tiles.push_back(std::move(tile));
+            }
+            for (auto& tile : tiles) {
+                if (tile->source) {
+                    tile->thread = std::thread(&MosaicFrameSource::RunTile, this, tile.get());
+                }
+            }
+
+            startNs = Platform::NowNs();
+            nextIndex = 0;
+            open = true;
+            return true;
+        }
+
+        void Close() override {
+            if (!open) return;
+            stopping = true;
+            stopEvent.Set();
+            for (auto& tile : tiles) {
+                if (tile->thread.joinable()) tile->thread.join();
+            }
+            tiles.clear();
+            open = false;
+        }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) override {
+            if (!open) return CaptureResult::Disconnected;
+
+            // Fixed cadence; an output that falls behind skips to the current frame
+            uint64_t now = Platform::NowNs();
+            uint64_t current = IndexAt(now - startNs);
+            if (current > nextIndex) nextIndex = current;
+            uint64_t dueNs = startNs + OffsetNs(nextIndex);
+            if (dueNs > now) {
+                uint64_t waitNs = std::min<uint64_t>(dueNs - now, (uint64_t)timeoutMs * 1000000ull);
+                std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+                if (Platform::NowNs() < dueNs) return CaptureResult::Timeout;
+            }
+
+            uint64_t composeStart = Platform::NowNs();
+            for (auto& tile : tiles) {
+                std::lock_guard<std::mutex> lock(tile->mutex);
+                if (!tile->updated) continue;
+                CopyCell(tile->front.data(), (size_t)tile->cell.width * 4, canvas.data(), canvasFrame.strideBytes,
+                         tile->cell);
+                tile->updated = false;
+                tile->convertPending = true;
+            }
+            uint64_t composeEnd = Platform::NowNs();
+            g_composeNs.fetch_add(composeEnd - composeStart, std::memory_order_relaxed);
+            g_outputFrames.fetch_add(1, std::memory_order_relaxed);
+
+            frame = canvasFrame;
+            frame.timestampNs = composeEnd;
+            frame.sequence = (int64_t)++nextIndex;
+            return CaptureResult::Frame;
+        }
+
+        void Release(VideoFrame& frame) override { frame.data = nullptr; }
+
+        // Capture itself waits for the next output frame
+        unsigned int GetPollIntervalMs() const override { return 0; }
+
+        // The composite persists from frame to frame
+        bool IsShared() const override { return true; }
+
+        // Valid until the next Capture
+        std::shared_ptr<const VideoFrame> Convert(const VideoFrame& frame, PixelFormat format) override {
+            if (!open || frame.data != canvas.data()) return nullptr;
+            if (format == PixelFormat::RGBA) {
+                return std::shared_ptr<const VideoFrame>(std::shared_ptr<const VideoFrame>(), &canvasFrame);
+            }
+            if (format != PixelFormat::BGRA) return nullptr;
+
+            uint64_t convertStart = Platform::NowNs();
+            if (converted.size() != canvas.size()) {
+                // Cells and the black gaps between them swap to themselves
+                converted = canvas;
+                for (auto& tile : tiles) tile->convertPending = true;
+            }
+            size_t stride = canvasFrame.strideBytes;
+            for (auto& tile : tiles) {
+                if (!tile->convertPending) continue;
+                const Rect& cell = tile->cell;
+                VideoFrame region = canvasFrame;
+                region.data = canvas.data() + cell.y * stride + cell.x * 4;
+                region.width = cell.width;
+                region.height = cell.height;
+                ConvertFramePixels(region, PixelFormat::BGRA, converted.data() + cell.y * stride + cell.x * 4, stride);
+                tile->convertPending = false;
+            }
+            g_composeNs.fetch_add(Platform::NowNs() - convertStart, std::memory_order_relaxed);
+
+            convertedFrame = frame;
+            convertedFrame.data = converted.data();
+            convertedFrame.format = PixelFormat::BGRA;
+            return std::shared_ptr<const VideoFrame>(std::shared_ptr<const VideoFrame>(), &convertedFrame);
+        }
+
+    private:
+        // Copy a cell-sized block from src (srcStride per row) to cell's place in dst
+        static void CopyCell(const unsigned char* src, size_t srcStride, unsigned char* dst, size_t dstStride,
+                             const Rect& cell) {
+            for (unsigned int y = 0; y < cell.height; y++) {
+                memcpy(dst + (cell.y + y) * dstStride + cell.x * 4, src + y * srcStride, (size_t)cell.width * 4);
+            }
+        }
+
+        void RunTile(Tile* tile) {
+            Platform::SetCurrentThreadName("Mosaic " + tile->sourceName);
+            bool opened = false;
+            while (!stopping) {
+                if (!opened) {
+                    opened = tile->source->Open();
+                    if (!opened) {
+                        stopEvent.Wait(kTileOpenRetryMs);
+                        continue;
+                    }
+                }
+
+                // A tile only ever shows its newest frame
+                VideoFrame frame;
+                uint64_t skipped = 0;
+                CaptureResult result = CaptureNewest(*tile->source, frame, kTileCaptureTimeoutMs, skipped);
+                if (result == CaptureResult::Frame) {
+                    uint64_t scaleStart = Platform::NowNs();
+                    bool scaled = ScaleIntoCell(frame, tile);
+                    tile->source->Release(frame);
+                    if (scaled) {
+                        g_scaleNs.fetch_add(Platform::NowNs() - scaleStart, std::memory_order_relaxed);
+                        g_tileFrames.fetch_add(1, std::memory_order_relaxed);
+                        Publish(tile);
+                    }
+                }
+                else if (result == CaptureResult::Disconnected) {
+                    size_t stride = (size_t)tile->cell.width * 4;
+                    for (unsigned int y = 0; y < tile->cell.height; y++) {
+                        FillBlack(tile->back.data() + y * stride, tile->cell.width);
+                    }
+                    Publish(tile);
+                }
+
+                unsigned int pollMs = tile->source->GetPollIntervalMs();
+                if (pollMs) stopEvent.Wait(pollMs);
+            }
+            tile->source->Close();
+        }
+
+        // Fit frame into the tile's back buffer, letterboxed in black
+        static bool ScaleIntoCell(const VideoFrame& frame, Tile* tile) {
+            if (frame.format == PixelFormat::UYVY || !frame.width || !frame.height) return false;
+            const Rect& cell = tile->cell;
+            double scale = std::min((double)cell.width / frame.width, (double)cell.height / frame.height);
+            unsigned int width = std::min(cell.width, std::max(1u, (unsigned int)(frame.width * scale + 0.5)));
+            unsigned int height = std::min(cell.height, std::max(1u, (unsigned int)(frame.height * scale + 0.5)));
+            unsigned int left = (cell.width - width) / 2;
+            unsigned int top = (cell.height - height) / 2;
+
+            size_t stride = (size_t)cell.width * 4;
+            unsigned char* pixels = tile->back.data();
+            for (unsigned int y = 0; y < cell.height; y++) {
+                unsigned char* row = pixels + y * stride;
+                if (y < top || y >= top + height) {
+                    FillBlack(row, cell.width);
+                }
+                else {
+                    FillBlack(row, left);
+                    FillBlack(row + (left + width) * 4, cell.width - left - width);
+                }
+            }
+
+            unsigned char* image = pixels + top * stride + left * 4;
+            if (!BoxScale(frame, image, width, height, stride)) return false;
+            if (frame.format == PixelFormat::BGRA) {
+                // In place: each pixel is read before it is written
+                VideoFrame scaled = frame;
+                scaled.data = image;
+                scaled.width = width;
+                scaled.height = height;
+                scaled.strideBytes = stride;
+                ConvertFramePixels(scaled, PixelFormat::RGBA, image, stride);
+            }
+            return true;
+        }
+
+        static void Publish(Tile* tile) {
+            std::lock_guard<std::mutex> lock(tile->mutex);
+            tile->front.swap(tile->back);
+            tile->updated = true;
+        }
+
+        // Exact for rational rates such as 30000/1001
+        uint64_t OffsetNs(uint64_t index) const {
+            uint64_t n = (uint64_t)settings.frameRateN, d = (uint64_t)settings.frameRateD;
+            return index / n * d * 1000000000ull + index % n * d * 1000000000ull / n;
+        }
+
+        uint64_t IndexAt(uint64_t elapsedNs) const {
+            return (uint64_t)((long double)elapsedNs * settings.frameRateN / (settings.frameRateD * 1e9L));
+        }
+
+        std::shared_ptr<FrameBackend> backend;
+        FrameEndpoint endpoint;
+        std::vector<std::string> sourceNames;
+        MosaicSettings settings;
+
+        bool open;
+        std::atomic<bool> stopping;
+        Platform::Event stopEvent;
+        std::vector<std::unique_ptr<Tile>> tiles;
+
+        uint64_t startNs;
+        uint64_t nextIndex;
+        Platform::FrameBuffer canvas;
+        VideoFrame canvasFrame;
+        Platform::FrameBuffer converted;
+        VideoFrame convertedFrame;
+    };
+}
+
+bool IsMosaicSourceName(const std::string& name) {
+    return name.compare(0, strlen(kMosaicSourcePrefix), kMosaicSourcePrefix) == 0;
+}
+
+std::vector<std::string> ParseMosaicSourceName(const std::string& name) {
+    std::vector<std::string> sources;
+    if (!IsMosaicSourceName(name)) return sources;
+    size_t begin = strlen(kMosaicSourcePrefix);
+    while (begin <= name.size()) {
+        size_t end = name.find('|', begin);
+        if (end == std::string::npos) end = name.size();
+        std::string source = name.substr(begin, end - begin);
+        size_t first = source.find_first_not_of(" \t");
+        if (first != std::string::npos) {
+            sources.push_back(source.substr(first, source.find_last_not_of(" \t") - first + 1));
+        }
+        begin = end + 1;
+    }
+    return sources;
+}
+
+std::unique_ptr<FrameSource> CreateMosaicSource(const std::shared_ptr<FrameBackend>& backend, FrameEndpoint endpoint,
+                                                const std::vector<std::string>& sources,
+                                                const MosaicSettings& settings) {
+    if (!backend || sources.empty()) return nullptr;
+    return std::make_unique<MosaicFrameSource>(backend, endpoint, sources, settings);
+}
+
+MosaicStats GetMosaicStats() {
+    MosaicStats stats;
+    stats.outputFrames = g_outputFrames.load(std::memory_order_relaxed);
+    stats.tileFrames = g_tileFrames.load(std::memory_order_relaxed);
+    stats.scaleNs = g_scaleNs.load(std::memory_order_relaxed);
+    stats.composeNs = g_composeNs.load(std::memory_order_relaxed);
+    return stats;
+}
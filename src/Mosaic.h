@@ -0,0 +1,45 @@
+#pragma once
+
+#include "FrameIO.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Composite output of a mosaic bridge
+struct MosaicSettings {
+    unsigned int width = 1920;
+    unsigned int height = 1080;
+    int frameRateN = 30;
+    int frameRateD = 1;
+    unsigned int columns = 0;    // Tiles per row; 0 picks the smallest square grid
+    bool proxy = true;           // Receive NDI sources as their low-bandwidth proxy streams
+};
+
+// Bridges whose source name starts with "mosaic:" composite several sources
+// into one grid instead of relaying one. The rest of the name lists the
+// sources, separated by '|', e.g. "mosaic:STUDIO (Cam 1)|STUDIO (Cam 2)".
+const char* const kMosaicSourcePrefix = "mosaic:";
+bool IsMosaicSourceName(const std::string& name);
+std::vector<std::string> ParseMosaicSourceName(const std::string& name);
+
+// Multiviewer source. Each tile captures through a shared source
+// (FrameFanOut.h) on its own thread and is box-scaled into its cell, aspect
+// kept, as its frames arrive; a cell holds its last picture until the next
+// one and goes black while its source is disconnected. Capture hands out
+// the composite at the settings' rate, so slow or missing sources never
+// hold up the others. Frames are read-only (IsShared); Convert reconverts
+// only the cells that changed.
+std::unique_ptr<FrameSource> CreateMosaicSource(const std::shared_ptr<FrameBackend>& backend, FrameEndpoint endpoint,
+                                                const std::vector<std::string>& sources,
+                                                const MosaicSettings& settings);
+
+// Work done by every mosaic in the process so far
+struct MosaicStats {
+    uint64_t outputFrames = 0;
+    uint64_t tileFrames = 0;     // Source frames scaled into a cell
+    uint64_t scaleNs = 0;        // Scaling source frames into cells
+    uint64_t composeNs = 0;      // Copying changed cells into the output and converting them
+};
+
+MosaicStats GetMosaicStats();
@@ -0,0 +1,289 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#else
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "Platform.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace Platform {
+#ifdef _WIN32
+    namespace {
+        typedef HRESULT (WINAPI *SetThreadDescriptionFn)(HANDLE, PCWSTR);
+
+        // Set by EnableLargePages once the privilege is held
+        std::atomic<size_t> largePageSize(0);
+    }
+
+    uint64_t ProcessCpuTimeNs() {
+        FILETIME created, exited, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+        // 100 ns units
+        uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+        uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+        return (k + u) * 100ull;
+    }
+
+    void SetCurrentThreadName(const std::string& name) {
+        // Windows 10 1607 and later; look it up so older systems still run
+        static SetThreadDescriptionFn setThreadDescription = reinterpret_cast<SetThreadDescriptionFn>(
+            GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+        if (!setThreadDescription || name.empty()) return;
+        int length = MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, NULL, 0);
+        std::wstring wide(length, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, &wide[0], length);
+        setThreadDescription(GetCurrentThread(), wide.c_str());
+    }
+
+    bool SetCurrentThreadAffinity(int cpu) {
+        DWORD_PTR processMask, systemMask;
+        if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) return false;
+        DWORD_PTR mask = processMask;
+        if (cpu >= 0) {
+            if (cpu >= (int)(sizeof(DWORD_PTR) * 8)) return false;
+            mask = (DWORD_PTR)1 << cpu;
+        }
+        return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+    }
+
+    Event::Event(bool manualReset)
+        : handle(CreateEventW(NULL, manualReset ? TRUE : FALSE, FALSE, NULL))
+    {
+        if (!handle) throw std::runtime_error("Failed to create event");
+    }
+
+    Event::~Event() {
+        CloseHandle(handle);
+    }
+
+    void Event::Set() {
+        SetEvent(handle);
+    }
+
+    void Event::Reset() {
+        ResetEvent(handle);
+    }
+
+    bool Event::Wait(unsigned int timeoutMs) {
+        return WaitForSingleObject(handle, timeoutMs) == WAIT_OBJECT_0;
+    }
+
+    bool EnableLargePages() {
+        // Large pages need the "Lock pages in memory" right, which must also
+        // be granted to the account
+        size_t minimum = GetLargePageMinimum();
+        HANDLE token;
+        if (!minimum || !OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+            return false;
+        }
+        TOKEN_PRIVILEGES privileges = {};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        bool granted = LookupPrivilegeValueW(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+                       AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL) &&
+                       GetLastError() == ERROR_SUCCESS;
+        CloseHandle(token);
+        if (granted) largePageSize = minimum;
+        return granted;
+    }
+
+    size_t GetLargePageSize() {
+        return largePageSize;
+    }
+
+    void* AllocatePages(size_t bytes) {
+        size_t largePage = GetLargePageSize();
+        if (largePage && bytes >= largePage) {
+            size_t rounded = (bytes + largePage - 1) / largePage * largePage;
+            void* memory = VirtualAlloc(NULL, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (memory) return memory;
+        }
+        return VirtualAlloc(NULL, bytes ? bytes : 1, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    void FreePages(void* memory, size_t) {
+        if (memory) VirtualFree(memory, 0, MEM_RELEASE);
+    }
+
+    ProcessResources GetProcessResources() {
+        ProcessResources resources;
+        PROCESS_MEMORY_COUNTERS memory = {};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+            resources.residentBytes = memory.WorkingSetSize;
+        }
+        DWORD handles = 0;
+        if (GetProcessHandleCount(GetCurrentProcess(), &handles)) {
+            resources.handles = handles;
+        }
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+        if (snapshot != INVALID_HANDLE_VALUE) {
+            DWORD process = GetCurrentProcessId();
+            THREADENTRY32 entry = {};
+            entry.dwSize = sizeof(entry);
+            for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+                if (entry.th32OwnerProcessID == process) resources.threads++;
+            }
+            CloseHandle(snapshot);
+        }
+        return resources;
+    }
+#else
+    namespace {
+        const size_t kHugePageSize = 2 * 1024 * 1024;
+
+        // Set by EnableLargePages
+        std::atomic<size_t> largePageSize(0);
+
+        size_t RoundToPages(size_t bytes) {
+            static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+            return ((bytes ? bytes : 1) + pageSize - 1) / pageSize * pageSize;
+        }
+    }
+
+    uint64_t ProcessCpuTimeNs() {
+        timespec used;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &used) != 0) return 0;
+        return (uint64_t)used.tv_sec * 1000000000ull + (uint64_t)used.tv_nsec;
+    }
+
+    void SetCurrentThreadName(const std::string& name) {
+#if defined(__APPLE__)
+        pthread_setname_np(name.substr(0, 63).c_str());
+#elif defined(__linux__)
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    bool SetCurrentThreadAffinity(int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpu >= 0) {
+            if (cpu >= CPU_SETSIZE) return false;
+            CPU_SET(cpu, &set);
+        }
+        else {
+            // Everything the process was started with
+            if (sched_getaffinity(0, sizeof(set), &set) != 0) return false;
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        // No portable way to pin threads here; unpinned is the only state
+        return cpu < 0;
+#endif
+    }
+
+    Event::Event(bool manualReset)
+        : manualReset(manualReset)
+        , signalled(false)
+    {
+    }
+
+    Event::~Event() {
+    }
+
+    void Event::Set() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            signalled = true;
+        }
+        if (manualReset) condition.notify_all();
+        else condition.notify_one();
+    }
+
+    void Event::Reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        signalled = false;
+    }
+
+    bool Event::Wait(unsigned int timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return signalled; })) {
+            return false;
+        }
+        if (!manualReset) signalled = false;
+        return true;
+    }
+
+    bool EnableLargePages() {
+#ifdef MADV_HUGEPAGE
+        largePageSize = kHugePageSize;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    size_t GetLargePageSize() {
+        return largePageSize;
+    }
+
+    void* AllocatePages(size_t bytes) {
+        size_t rounded = RoundToPages(bytes);
+        void* memory = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+        // Only a hint; the kernel backs what it can with huge pages
+        size_t largePage = GetLargePageSize();
+        if (largePage && rounded >= largePage) {
+            madvise(memory, rounded, MADV_HUGEPAGE);
+        }
+#endif
+        return memory;
+    }
+
+    void FreePages(void* memory, size_t bytes) {
+        if (memory) munmap(memory, RoundToPages(bytes));
+    }
+
+    ProcessResources GetProcessResources() {
+        // procfs; other POSIX systems report zeros
+        ProcessResources resources;
+        if (FILE* statm = fopen("/proc/self/statm", "r")) {
+            unsigned long long size = 0, resident = 0;
+            if (fscanf(statm, "%llu %llu", &size, &resident) == 2) {
+                resources.residentBytes = resident * (uint64_t)sysconf(_SC_PAGESIZE);
+            }
+            fclose(statm);
+        }
+        if (FILE* status = fopen("/proc/self/status", "r")) {
+            char line[256];
+            while (fgets(line, sizeof(line), status)) {
+                if (strncmp(line, "Threads:", 8) == 0) {
+                    resources.threads = strtoull(line + 8, nullptr, 10);
+                    break;
+                }
+            }
+            fclose(status);
+        }
+        if (DIR* fds = opendir("/proc/self/fd")) {
+            while (dirent* entry = readdir(fds)) {
+                if (entry->d_name[0] != '.') resources.handles++;
+            }
+            closedir(fds);
+            resources.handles--;    // The directory stream itself
+        }
+        return resources;
+    }
+#endif
+
+    uint64_t NowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
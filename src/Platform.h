@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Thin portability layer for the bridge engine. Everything OS-specific the
+// engine needs beyond the standard library lives behind these calls, with a
+// Win32 backend and a POSIX backend in Platform.cpp.
+namespace Platform {
+    // The engine's one clock: std::chrono::steady_clock in nanoseconds, so
+    // NowNs() and steady_clock time points share a timeline and can be mixed
+    uint64_t NowNs();
+
+    // User plus kernel CPU time consumed by every thread of this process
+    uint64_t ProcessCpuTimeNs();
+
+    // Name the calling thread for debuggers and profilers. Linux keeps only
+    // the first 15 bytes.
+    void SetCurrentThreadName(const std::string& name);
+
+    // Pin the calling thread to one logical CPU, or let it run on any CPU
+    // the process may use when cpu is negative. Returns false if the OS refused.
+    bool SetCurrentThreadAffinity(int cpu);
+
+    // Signalled/unsignalled flag a thread can block on with a timeout.
+    // A manual-reset event stays set until Reset(); an auto-reset event
+    // releases one waiter and clears itself.
+    class Event {
+    public:
+        explicit Event(bool manualReset = false);
+        ~Event();
+        Event(const Event&) = delete;
+        Event& operator=(const Event&) = delete;
+
+        void Set();
+        void Reset();
+
+        // Returns true if the event was set within timeoutMs
+        bool Wait(unsigned int timeoutMs);
+
+    private:
+#ifdef _WIN32
+        void* handle;
+#else
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool manualReset;
+        bool signalled;
+#endif
+    };
+
+    // Let AllocatePages back big buffers with large pages from now on. On
+    // Windows this enables SeLockMemoryPrivilege for the process, so call it
+    // once at startup, before any bridge allocates. Returns false if the OS
+    // refused; allocations then keep using normal pages.
+    bool EnableLargePages();
+
+    // Large page size AllocatePages uses, or 0 until EnableLargePages succeeded
+    size_t GetLargePageSize();
+
+    // Page-aligned memory straight from the OS for large, long-lived buffers.
+    // Allocations of at least GetLargePageSize() bytes use large pages where
+    // the OS grants them (locked large pages on Windows, transparent huge
+    // pages on Linux) and fall back to normal pages otherwise.
+    void* AllocatePages(size_t bytes);
+    void FreePages(void* memory, size_t bytes);
+
+    // std::allocator replacement backed by AllocatePages
+    template <typename T>
+    struct PageAllocator {
+        using value_type = T;
+
+        PageAllocator() = default;
+        template <typename U>
+        PageAllocator(const PageAllocator<U>&) {}
+
+        T* allocate(size_t count) {
+            void* memory = AllocatePages(count * sizeof(T));
+            if (!memory) throw std::bad_alloc();
+            return static_cast<T*>(memory);
+        }
+        void deallocate(T* memory, size_t count) { FreePages(memory, count * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const PageAllocator<U>&) const { return true; }
+        template <typename U>
+        bool operator!=(const PageAllocator<U>&) const { return false; }
+    };
+
+    // Resource usage of this process, for leak and growth checks. Counts
+    // the OS can't report are zero.
+    struct ProcessResources {
+        uint64_t residentBytes = 0;
+        uint64_t threads = 0;
+        uint64_t handles = 0;     // Kernel handles on Windows, open file descriptors elsewhere
+    };
+    ProcessResources GetProcessResources();
+
+    // Pixel storage for whole frames
+    using FrameBuffer = std::vector<unsigned char, PageAllocator<unsigned char>>;
+}
@@ -11,12 +11,14 @@
 #include <memory>
 #include <stdexcept>
 
+#ifdef _WIN32
 // OpenGL includes
 #include <GL/GL.h>
 
 // DirectX includes - must come first and outside any extern blocks
 #include <d3d11.h>
 #include <dxgi.h>
+#endif
 
 // Forward declarations
 struct SPOUTLIBRARY;
@@ -0,0 +1,717 @@
+#include "Scaler.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCALER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Source positions [begin, end) that one output position averages
+    struct Span {
+        unsigned int begin;
+        unsigned int end;
+    };
+
+    std::vector<Span> BoxSpans(unsigned int srcSize, unsigned int dstSize) {
+        std::vector<Span> spans(dstSize);
+        for (unsigned int i = 0; i < dstSize; i++) {
+            unsigned int begin = (unsigned int)((uint64_t)i * srcSize / dstSize);
+            unsigned int end = (unsigned int)((uint64_t)(i + 1) * srcSize / dstSize);
+            spans[i] = { begin, std::max(end, begin + 1) };
+        }
+        return spans;
+    }
+
+    // n / area for any 16-bit n, as multiply-high and shifts so it vectorizes:
+    // t = n * multiplier >> 16, then n / area = (t + ((n - t) >> 1)) >> shift
+    // (Granlund and Montgomery's round-down division). Needs area in [2, 256].
+    struct Divisor {
+        unsigned int area = 1;
+        unsigned int multiplier = 0;
+        int shift = 0;
+
+        explicit Divisor(unsigned int area = 1)
+            : area(area)
+        {
+            int bits = 0;
+            while ((1u << bits) < area) bits++;
+            if (bits == 0) return;
+            multiplier = (((1u << bits) - area) << 16) / area + 1;
+            shift = bits - 1;
+        }
+    };
+
+    const int kWeightBits = 14;
+    const int kIntermediateBits = 6;    // Horizontally filtered values keep 6 fraction bits
+
+    // Two adjacent 16-bit weights as one 32-bit lane for _mm_madd_epi16; in
+    // memory they already are one, low weight first
+    inline int32_t WeightPair(const int16_t* weights) {
+        int32_t pair;
+        memcpy(&pair, weights, sizeof(pair));
+        return pair;
+    }
+
+    // Box and filter kernels on plain integers; compiled everywhere, and the
+    // SSE2 ones below must match them bit for bit
+    struct ScalarKernels {
+        // Add a row of 8-bit channels into 16-bit sums, or start them when first
+        static void AccumulateRow16(const unsigned char* row, uint16_t* sums, size_t count, bool first) {
+            for (size_t i = 0; i < count; i++) {
+                sums[i] = (uint16_t)(first ? row[i] : sums[i] + row[i]);
+            }
+        }
+
+        // Same with 32-bit sums, for boxes too large for 16
+        static void AccumulateRow32(const unsigned char* row, uint32_t* sums, size_t count, bool first) {
+            for (size_t i = 0; i < count; i++) {
+                sums[i] = first ? row[i] : sums[i] + row[i];
+            }
+        }
+
+        // Rounded mean of 16-bit pixel sums over span, (sum + area / 2) / area.
+        // Needs the box at most 256 pixels, so the sum fits in 16 bits.
+        static void StorePixel16(const uint16_t* sums, Span span, const Divisor& divisor, unsigned char* out) {
+            for (int c = 0; c < 4; c++) {
+                unsigned int total = divisor.area / 2;
+                for (unsigned int x = span.begin; x < span.end; x++) {
+                    total += sums[x * 4 + c];
+                }
+                out[c] = (unsigned char)(total / divisor.area);
+            }
+        }
+
+        // Rounded mean of 32-bit pixel sums over span
+        static void StorePixel32(const uint32_t* sums, Span span, unsigned int area, unsigned char* out) {
+            for (int c = 0; c < 4; c++) {
+                uint32_t total = area / 2;
+                for (unsigned int x = span.begin; x < span.end; x++) {
+                    total += sums[x * 4 + c];
+                }
+                out[c] = (unsigned char)(total / area);
+            }
+        }
+
+        // One source row through the horizontal bank into 16-bit values with
+        // kIntermediateBits fraction bits
+        static void FilterRow(const unsigned char* src, const int* offsets, const int16_t* weights, unsigned int taps,
+                              unsigned int dstWidth, int16_t* out) {
+            const int shift = kWeightBits - kIntermediateBits;
+            for (unsigned int x = 0; x < dstWidth; x++) {
+                const unsigned char* p = src + offsets[x] * 4;
+                const int16_t* w = weights + (size_t)x * taps;
+                for (int c = 0; c < 4; c++) {
+                    int32_t total = 0;
+                    for (unsigned int k = 0; k < taps; k++) {
+                        total += p[k * 4 + c] * w[k];
+                    }
+                    total = (total + (1 << (shift - 1))) >> shift;
+                    out[x * 4 + c] = (int16_t)std::min(32767, std::max(-32768, total));
+                }
+            }
+        }
+
+        // taps filtered rows through one vertical weight set into 8-bit channels
+        static void FilterColumns(const int16_t* const* rows, const int16_t* weights, unsigned int taps, size_t count,
+                                  unsigned char* out) {
+            const int shift = kWeightBits + kIntermediateBits;
+            for (size_t i = 0; i < count; i++) {
+                int32_t total = 0;
+                for (unsigned int k = 0; k < taps; k++) {
+                    total += rows[k][i] * weights[k];
+                }
+                total = (total + (1 << (shift - 1))) >> shift;
+                out[i] = (unsigned char)std::min(255, std::max(0, total));
+            }
+        }
+    };
+
+#ifdef SCALER_SSE2
+    struct Sse2Kernels {
+        static void AccumulateRow16(const unsigned char* row, uint16_t* sums, size_t count, bool first) {
+            size_t i = 0;
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= count; i += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                __m128i* s = reinterpret_cast<__m128i*>(sums + i);
+                if (!first) {
+                    lo = _mm_add_epi16(lo, _mm_loadu_si128(s));
+                    hi = _mm_add_epi16(hi, _mm_loadu_si128(s + 1));
+                }
+                _mm_storeu_si128(s, lo);
+                _mm_storeu_si128(s + 1, hi);
+            }
+            ScalarKernels::AccumulateRow16(row + i, sums + i, count - i, first);
+        }
+
+        static void AccumulateRow32(const unsigned char* row, uint32_t* sums, size_t count, bool first) {
+            size_t i = 0;
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= count; i += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                __m128i v[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                                 _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+                __m128i* s = reinterpret_cast<__m128i*>(sums + i);
+                for (int k = 0; k < 4; k++) {
+                    _mm_storeu_si128(s + k, first ? v[k] : _mm_add_epi32(v[k], _mm_loadu_si128(s + k)));
+                }
+            }
+            ScalarKernels::AccumulateRow32(row + i, sums + i, count - i, first);
+        }
+
+        static void StorePixel16(const uint16_t* sums, Span span, const Divisor& divisor, unsigned char* out) {
+            __m128i total = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(sums + span.begin * 4));
+            for (unsigned int x = span.begin + 1; x < span.end; x++) {
+                total = _mm_add_epi16(total, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(sums + x * 4)));
+            }
+            total = _mm_add_epi16(total, _mm_set1_epi16((short)(divisor.area / 2)));
+            __m128i high = _mm_mulhi_epu16(total, _mm_set1_epi16((short)divisor.multiplier));
+            __m128i value = _mm_add_epi16(high, _mm_srli_epi16(_mm_sub_epi16(total, high), 1));
+            value = _mm_srl_epi16(value, _mm_cvtsi32_si128(divisor.shift));
+            value = _mm_packus_epi16(value, value);
+            int32_t pixel = _mm_cvtsi128_si32(value);
+            memcpy(out, &pixel, 4);
+        }
+
+        // Sums four channels at once; the division is rare enough to leave scalar
+        static void StorePixel32(const uint32_t* sums, Span span, unsigned int area, unsigned char* out) {
+            __m128i total = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + span.begin * 4));
+            for (unsigned int x = span.begin + 1; x < span.end; x++) {
+                total = _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x * 4)));
+            }
+            uint32_t totals[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(totals), total);
+            for (int c = 0; c < 4; c++) {
+                out[c] = (unsigned char)((totals[c] + area / 2) / area);
+            }
+        }
+
+        static void FilterRow(const unsigned char* src, const int* offsets, const int16_t* weights, unsigned int taps,
+                              unsigned int dstWidth, int16_t* out) {
+            const int shift = kWeightBits - kIntermediateBits;
+            const __m128i zero = _mm_setzero_si128();
+            for (unsigned int x = 0; x < dstWidth; x++) {
+                const unsigned char* p = src + offsets[x] * 4;
+                const int16_t* w = weights + (size_t)x * taps;
+                __m128i total = _mm_setzero_si128();
+                unsigned int k = 0;
+                for (; k + 4 <= taps; k += 4) {
+                    // p0 p1 p2 p3 -> r0 r1 g0 g1 b0 b1 a0 a1 and r2 r3 ..., then one multiply-add per tap pair
+                    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k * 4));
+                    __m128i first = _mm_unpacklo_epi8(pixels, zero);
+                    __m128i second = _mm_unpackhi_epi8(pixels, zero);
+                    first = _mm_unpacklo_epi16(first, _mm_srli_si128(first, 8));
+                    second = _mm_unpacklo_epi16(second, _mm_srli_si128(second, 8));
+                    total = _mm_add_epi32(total, _mm_madd_epi16(first, _mm_set1_epi32(WeightPair(w + k))));
+                    total = _mm_add_epi32(total, _mm_madd_epi16(second, _mm_set1_epi32(WeightPair(w + k + 2))));
+                }
+                if (k < taps) {
+                    __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * 4)), zero);
+                    pixels = _mm_unpacklo_epi16(pixels, _mm_srli_si128(pixels, 8));
+                    total = _mm_add_epi32(total, _mm_madd_epi16(pixels, _mm_set1_epi32(WeightPair(w + k))));
+                }
+                total = _mm_srai_epi32(_mm_add_epi32(total, _mm_set1_epi32(1 << (shift - 1))), shift);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packs_epi32(total, total));
+            }
+        }
+
+        static void FilterColumns(const int16_t* const* rows, const int16_t* weights, unsigned int taps, size_t count,
+                                  unsigned char* out) {
+            const int shift = kWeightBits + kIntermediateBits;
+            const __m128i round = _mm_set1_epi32(1 << (shift - 1));
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m128i lo = _mm_setzero_si128();
+                __m128i hi = _mm_setzero_si128();
+                for (unsigned int k = 0; k < taps; k += 2) {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i));
+                    __m128i w = _mm_set1_epi32(WeightPair(weights + k));
+                    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+                    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+                }
+                lo = _mm_srai_epi32(_mm_add_epi32(lo, round), shift);
+                hi = _mm_srai_epi32(_mm_add_epi32(hi, round), shift);
+                __m128i words = _mm_packs_epi32(lo, hi);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words));
+            }
+            for (; i < count; i++) {
+                int32_t total = 0;
+                for (unsigned int k = 0; k < taps; k++) {
+                    total += rows[k][i] * weights[k];
+                }
+                total = (total + (1 << (shift - 1))) >> shift;
+                out[i] = (unsigned char)std::min(255, std::max(0, total));
+            }
+        }
+    };
+
+    using Kernels = Sse2Kernels;
+#else
+    using Kernels = ScalarKernels;
+#endif
+
+    unsigned int Length(Span span) { return span.end - span.begin; }
+
+    // One output row of a 2x2 average: each pixel is the rounded mean of the
+    // four source pixels under it, exact in every channel
+    void HalveRow(const unsigned char* top, const unsigned char* bottom, unsigned char* out, unsigned int width) {
+        unsigned int x = 0;
+#ifdef SCALER_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i two = _mm_set1_epi16(2);
+        for (; x + 4 <= width; x += 4) {
+            __m128i sums[2];
+            for (int half = 0; half < 2; half++) {
+                // Four source pixels per row: vertical sums of pixels 0,1 and 2,3,
+                // then each horizontal pair added into one pixel
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x * 8 + half * 16));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x * 8 + half * 16));
+                __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                __m128i total = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+                sums[half] = _mm_srli_epi16(_mm_add_epi16(total, two), 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sums[0], sums[1]));
+        }
+#endif
+        for (; x < width; x++) {
+            const unsigned char* a = top + x * 8;
+            const unsigned char* b = bottom + x * 8;
+            for (int c = 0; c < 4; c++) {
+                out[x * 4 + c] = (unsigned char)((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+            }
+        }
+    }
+
+    template <class K>
+    bool BoxScaleWith(const VideoFrame& src, unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight,
+                      size_t dstStride) {
+        if (!src.data || !dst || src.format == PixelFormat::UYVY || !src.width || !src.height ||
+            !dstWidth || !dstHeight) {
+            return false;
+        }
+
+        // Sum each output row's source rows, then average each output pixel's
+        // columns. Boxes of up to 256 pixels sum in 16 bits, twice as many
+        // channels per instruction; a 1x1 box is a copy.
+        std::vector<Span> columns = BoxSpans(src.width, dstWidth);
+        std::vector<Span> rows = BoxSpans(src.height, dstHeight);
+        unsigned int maxColumns = 1, maxRows = 1;
+        for (const Span& span : columns) maxColumns = std::max(maxColumns, Length(span));
+        for (const Span& span : rows) maxRows = std::max(maxRows, Length(span));
+        const bool narrow = maxColumns * maxRows <= 256;
+
+        size_t channels = (size_t)src.width * 4;
+        std::vector<uint16_t> sums16(narrow ? channels : 0);
+        std::vector<uint32_t> sums32(narrow ? 0 : channels);
+        Divisor divisors[257];
+        for (unsigned int area = 2; area <= 256; area++) {
+            divisors[area] = Divisor(area);
+        }
+
+        for (unsigned int y = 0; y < dstHeight; y++) {
+            unsigned char* out = dst + y * dstStride;
+            Span rowSpan = rows[y];
+            if (y > 0 && rowSpan.begin == rows[y - 1].begin && rowSpan.end == rows[y - 1].end) {
+                // Growing vertically: same source rows as the row above
+                memcpy(out, out - dstStride, (size_t)dstWidth * 4);
+                continue;
+            }
+
+            unsigned int rowCount = Length(rowSpan);
+            for (unsigned int sy = rowSpan.begin; sy < rowSpan.end; sy++) {
+                const unsigned char* row = src.data + sy * src.strideBytes;
+                if (narrow) K::AccumulateRow16(row, sums16.data(), channels, sy == rowSpan.begin);
+                else K::AccumulateRow32(row, sums32.data(), channels, sy == rowSpan.begin);
+            }
+
+            for (unsigned int x = 0; x < dstWidth; x++) {
+                unsigned int area = rowCount * Length(columns[x]);
+                if (area == 1) {
+                    const unsigned char* pixel = src.data + rowSpan.begin * src.strideBytes + columns[x].begin * 4;
+                    memcpy(out + x * 4, pixel, 4);
+                }
+                else if (narrow) {
+                    K::StorePixel16(sums16.data(), columns[x], divisors[area], out + x * 4);
+                }
+                else {
+                    K::StorePixel32(sums32.data(), columns[x], area, out + x * 4);
+                }
+            }
+        }
+        return true;
+    }
+}
+
+bool BoxScale(const VideoFrame& src, unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight,
+              size_t dstStride) {
+    return BoxScaleWith<Kernels>(src, dst, dstWidth, dstHeight, dstStride);
+}
+
+bool BoxScaleScalar(const VideoFrame& src, unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight,
+                    size_t dstStride) {
+    return BoxScaleWith<ScalarKernels>(src, dst, dstWidth, dstHeight, dstStride);
+}
+
+const char* ScaleFilterName(ScaleFilter filter) {
+    switch (filter) {
+        case ScaleFilter::Box:      return "box";
+        case ScaleFilter::Bilinear: return "bilinear";
+        case ScaleFilter::Lanczos:  return "lanczos";
+        default:                    return "";
+    }
+}
+
+double ScaleKernelRadius(ScaleFilter filter) {
+    switch (filter) {
+        case ScaleFilter::Bilinear: return 1.0;
+        case ScaleFilter::Lanczos:  return 3.0;
+        default:                    return 0.5;
+    }
+}
+
+double ScaleKernel(ScaleFilter filter, double t) {
+    const double pi = 3.14159265358979323846;
+    t = std::fabs(t);
+    switch (filter) {
+        case ScaleFilter::Bilinear:
+            return t < 1.0 ? 1.0 - t : 0.0;
+        case ScaleFilter::Lanczos:
+            if (t < 1e-9) return 1.0;
+            if (t >= 3.0) return 0.0;
+            return 3.0 * std::sin(pi * t) * std::sin(pi * t / 3.0) / (pi * pi * t * t);
+        default:
+            // Half weight on a pixel exactly on the box edge keeps integer ratios exact
+            return t < 0.5 ? 1.0 : t == 0.5 ? 0.5 : 0.0;
+    }
+}
+
+// Runs stripe jobs on a few persistent threads; the caller works too
+class FrameScaler::Workers {
+public:
+    explicit Workers(unsigned int count) {
+        for (unsigned int i = 0; i < count; i++) {
+            threads.emplace_back(&Workers::Run, this);
+        }
+    }
+
+    ~Workers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    unsigned int GetCount() const { return (unsigned int)threads.size(); }
+
+    // Run job(0) .. job(jobs - 1) and return when all have finished
+    void Execute(unsigned int jobs, const std::function<void(unsigned int)>& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &job;
+            nextJob = 0;
+            jobCount = jobs;
+            pending = jobs;
+            generation++;
+        }
+        wake.notify_all();
+        Work();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+        current = nullptr;
+    }
+
+private:
+    void Run() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            lock.unlock();
+            Work();
+            lock.lock();
+        }
+    }
+
+    // Take jobs until none are left
+    void Work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (current && nextJob < jobCount) {
+            unsigned int index = nextJob++;
+            const std::function<void(unsigned int)>& job = *current;
+            lock.unlock();
+            job(index);
+            lock.lock();
+            if (--pending == 0) done.notify_all();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(unsigned int)>* current = nullptr;
+    unsigned int nextJob = 0;
+    unsigned int jobCount = 0;
+    unsigned int pending = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+FrameScaler::FrameScaler(int threads) {
+    if (threads < 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threads = (int)std::min(3u, hardware > 1 ? hardware - 1 : 0u);
+    }
+    if (threads > 0) {
+        workers = std::make_unique<Workers>((unsigned int)threads);
+    }
+}
+
+FrameScaler::~FrameScaler() = default;
+
+void FrameScaler::BuildBank(FilterBank& bank, unsigned int srcSize, unsigned int dstSize, ScaleFilter filter) {
+    // Shrinking stretches the kernel over the source so it also filters out
+    // detail the output can't hold
+    double scale = (double)srcSize / dstSize;
+    double stretch = std::max(1.0, scale);
+    double radius = ScaleKernelRadius(filter) * stretch;
+
+    // Weights per output position first, with positions past the edges
+    // folded onto the edge pixels, so taps can be the widest real span
+    std::vector<int> firsts(dstSize);
+    std::vector<std::vector<double>> spans(dstSize);
+    unsigned int taps = 2;
+    for (unsigned int i = 0; i < dstSize; i++) {
+        double center = (i + 0.5) * scale - 0.5;
+        int low = std::max(0, (int)std::floor(center - radius));
+        int high = std::min((int)srcSize - 1, (int)std::ceil(center + radius));
+        std::vector<double>& weights = spans[i];
+        weights.assign(high - low + 1, 0.0);
+        double sum = 0.0;
+        for (int x = (int)std::floor(center - radius); x <= (int)std::ceil(center + radius); x++) {
+            double weight = ScaleKernel(filter, (x - center) / stretch);
+            weights[std::max(low, std::min(x, high)) - low] += weight;
+            sum += weight;
+        }
+        if (sum == 0.0) {
+            weights[std::max(low, std::min((int)std::lround(center), high)) - low] = sum = 1.0;
+        }
+        for (double& weight : weights) weight /= sum;
+
+        size_t first = 0;
+        size_t last = weights.size() - 1;
+        while (first < last && weights[first] == 0.0) first++;
+        while (last > first && weights[last] == 0.0) last--;
+        weights = std::vector<double>(weights.begin() + first, weights.begin() + last + 1);
+        firsts[i] = low + (int)first;
+        taps = std::max(taps, (unsigned int)weights.size());
+    }
+    // Even for the paired multiply-adds, and never wider than the source
+    taps = std::min((taps + 1) & ~1u, srcSize & ~1u);
+
+    bank.taps = taps;
+    bank.offsets.assign(dstSize, 0);
+    bank.weights.assign((size_t)dstSize * taps, 0);
+    for (unsigned int i = 0; i < dstSize; i++) {
+        int offset = std::max(0, std::min(firsts[i], (int)(srcSize - taps)));
+        std::vector<double> slots(taps, 0.0);
+        for (size_t k = 0; k < spans[i].size(); k++) {
+            slots[std::min((size_t)taps - 1, (size_t)(firsts[i] - offset) + k)] += spans[i][k];
+        }
+
+        // Quantize, then put the rounding error on the largest weight so each set sums exactly to one
+        int16_t* quantized = &bank.weights[(size_t)i * taps];
+        int total = 0;
+        unsigned int largest = 0;
+        for (unsigned int k = 0; k < taps; k++) {
+            quantized[k] = (int16_t)std::lround(slots[k] * (1 << kWeightBits));
+            total += quantized[k];
+            if (std::abs(quantized[k]) > std::abs(quantized[largest])) largest = k;
+        }
+        quantized[largest] = (int16_t)(quantized[largest] + (1 << kWeightBits) - total);
+        bank.offsets[i] = offset;
+    }
+}
+
+bool FrameScaler::Scale(const VideoFrame& src, ScaleFilter filter, unsigned char* dst, unsigned int dstWidth,
+                        unsigned int dstHeight, size_t dstStride, const std::vector<bool>* dirtyRows) {
+    return ScaleWith(src, filter, dst, dstWidth, dstHeight, dstStride, dirtyRows, false);
+}
+
+bool FrameScaler::ScaleScalar(const VideoFrame& src, ScaleFilter filter, unsigned char* dst, unsigned int dstWidth,
+                              unsigned int dstHeight, size_t dstStride, const std::vector<bool>* dirtyRows) {
+    return ScaleWith(src, filter, dst, dstWidth, dstHeight, dstStride, dirtyRows, true);
+}
+
+bool FrameScaler::ScaleWith(const VideoFrame& src, ScaleFilter filter, unsigned char* dst, unsigned int dstWidth,
+                            unsigned int dstHeight, size_t dstStride, const std::vector<bool>* dirtyRows,
+                            bool scalar) {
+    if (!src.data || !dst || src.format == PixelFormat::UYVY || src.width < 2 || src.height < 2 ||
+        dstWidth < 2 || dstHeight < 2) {
+        return false;
+    }
+
+    if (src.width != srcWidth || src.height != srcHeight || dstWidth != this->dstWidth ||
+        dstHeight != this->dstHeight || filter != this->filter || stripes.empty()) {
+        srcWidth = src.width;
+        srcHeight = src.height;
+        this->dstWidth = dstWidth;
+        this->dstHeight = dstHeight;
+        this->filter = filter;
+        BuildBank(horizontal, srcWidth, dstWidth, filter);
+        BuildBank(vertical, srcHeight, dstHeight, filter);
+
+        // Stripes of at least 16 rows, one per thread
+        unsigned int threads = workers ? workers->GetCount() + 1 : 1;
+        unsigned int count = std::max(1u, std::min(threads, dstHeight / 16));
+        stripes.assign(count, Stripe());
+        for (unsigned int i = 0; i < count; i++) {
+            stripes[i].firstRow = (unsigned int)((uint64_t)dstHeight * i / count);
+            stripes[i].endRow = (unsigned int)((uint64_t)dstHeight * (i + 1) / count);
+            stripes[i].ring.assign((size_t)vertical.taps * dstWidth * 4, 0);
+        }
+        dirtyRows = nullptr;
+    }
+
+    // Running count of dirty source rows, so whether an output row's taps
+    // reach one is a subtraction
+    const std::vector<unsigned int>* before = nullptr;
+    if (dirtyRows && dirtyRows->size() == srcHeight) {
+        dirtyBefore.resize(srcHeight + 1);
+        dirtyBefore[0] = 0;
+        for (unsigned int y = 0; y < srcHeight; y++) {
+            dirtyBefore[y + 1] = dirtyBefore[y] + ((*dirtyRows)[y] ? 1 : 0);
+        }
+        before = &dirtyBefore;
+    }
+
+    if (stripes.size() == 1) {
+        RunStripe(stripes[0], src, dst, dstStride, before, scalar);
+    }
+    else {
+        workers->Execute((unsigned int)stripes.size(), [&](unsigned int index) {
+            RunStripe(stripes[index], src, dst, dstStride, before, scalar);
+        });
+    }
+    rowsScaled = 0;
+    for (const Stripe& stripe : stripes) {
+        rowsScaled += stripe.rowsScaled;
+    }
+    return true;
+}
+
+void FrameScaler::RunStripe(Stripe& stripe, const VideoFrame& src, unsigned char* dst, size_t dstStride,
+                            const std::vector<unsigned int>* dirtyBefore, bool scalar) {
+    const unsigned int taps = vertical.taps;
+    const size_t rowValues = (size_t)dstWidth * 4;
+    std::vector<const int16_t*> rows(taps);
+
+    // Each source row is filtered horizontally once, the first time an
+    // output row needs it; the ring holds the taps rows in use. Offsets
+    // never decrease, so rows skipped as clean leave the ring valid.
+    int nextRow = -1;
+    stripe.rowsScaled = 0;
+    for (unsigned int y = stripe.firstRow; y < stripe.endRow; y++) {
+        int offset = vertical.offsets[y];
+        if (dirtyBefore && (*dirtyBefore)[offset + taps] == (*dirtyBefore)[offset]) {
+            continue;
+        }
+        for (int row = std::max(nextRow, offset); row < offset + (int)taps; row++) {
+            const unsigned char* line = src.data + row * src.strideBytes;
+            int16_t* out = &stripe.ring[(row % taps) * rowValues];
+            if (scalar) {
+                ScalarKernels::FilterRow(line, horizontal.offsets.data(), horizontal.weights.data(), horizontal.taps,
+                                         dstWidth, out);
+            }
+            else {
+                Kernels::FilterRow(line, horizontal.offsets.data(), horizontal.weights.data(), horizontal.taps,
+                                   dstWidth, out);
+            }
+        }
+        nextRow = offset + (int)taps;
+
+        for (unsigned int k = 0; k < taps; k++) {
+            rows[k] = &stripe.ring[((offset + k) % taps) * rowValues];
+        }
+        const int16_t* weights = &vertical.weights[(size_t)y * taps];
+        if (scalar) {
+            ScalarKernels::FilterColumns(rows.data(), weights, taps, rowValues, dst + y * dstStride);
+        }
+        else {
+            Kernels::FilterColumns(rows.data(), weights, taps, rowValues, dst + y * dstStride);
+        }
+        stripe.rowsScaled++;
+    }
+}
+
+size_t FrameScaler::GetMemoryBytes() const {
+    size_t bytes = (horizontal.weights.size() + vertical.weights.size()) * sizeof(int16_t) +
+                   (horizontal.offsets.size() + vertical.offsets.size()) * sizeof(int);
+    for (const Stripe& stripe : stripes) {
+        bytes += stripe.ring.size() * sizeof(int16_t);
+    }
+    return bytes + dirtyBefore.size() * sizeof(unsigned int);
+}
+
+bool FramePyramid::Build(const VideoFrame& src, unsigned int levels) {
+    levels = std::min(levels, kMaxLevels);
+    if (!src.data || src.format == PixelFormat::UYVY || levels == 0 ||
+        (src.width >> levels) == 0 || (src.height >> levels) == 0) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < levels; i++) {
+        VideoFrame& frame = frames[i];
+        frame = src;
+        frame.width = src.width >> (i + 1);
+        frame.height = src.height >> (i + 1);
+        frame.strideBytes = (size_t)frame.width * 4;
+        pixels[i].resize(frame.strideBytes * frame.height);
+        frame.data = pixels[i].data();
+    }
+    this->levels = levels;
+
+    // Top down in one sweep: as soon as two rows of a level exist, the row
+    // below them in the next level is made, while they are still in cache
+    const VideoFrame& half = frames[0];
+    for (unsigned int y = 0; y < half.height; y++) {
+        HalveRow(src.data + (size_t)y * 2 * src.strideBytes, src.data + ((size_t)y * 2 + 1) * src.strideBytes,
+                 half.data + y * half.strideBytes, half.width);
+        unsigned int row = y;
+        for (unsigned int i = 1; i < levels && (row & 1) && (row >> 1) < frames[i].height; i++) {
+            const VideoFrame& above = frames[i - 1];
+            row >>= 1;
+            HalveRow(above.data + (size_t)row * 2 * above.strideBytes,
+                     above.data + ((size_t)row * 2 + 1) * above.strideBytes,
+                     frames[i].data + row * frames[i].strideBytes, frames[i].width);
+        }
+    }
+    return true;
+}
+
+size_t FramePyramid::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& level : pixels) {
+        bytes += level.size();
+    }
+    return bytes;
+}
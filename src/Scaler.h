@@ -0,0 +1,129 @@
+#pragma once
+
+#include "FrameIO.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Area-average resize of a 4-byte-per-pixel frame into dst, dstWidth x
+// dstHeight pixels with dstStride bytes per row. Every output pixel is the
+// rounded mean of the source pixels its box covers; growing along an axis
+// repeats source pixels. Channel order is kept. Uses SSE2 on x86/x64 and a
+// scalar path elsewhere. Returns false for UYVY or empty frames.
+bool BoxScale(const VideoFrame& src, unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight,
+              size_t dstStride);
+
+// BoxScale on the portable scalar path whatever the CPU; the SIMD path must
+// match it bit for bit
+bool BoxScaleScalar(const VideoFrame& src, unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight,
+                    size_t dstStride);
+
+enum class ScaleFilter {
+    Box = 0,      // Area average; cheapest, blocky when growing
+    Bilinear,     // Triangle; widened when shrinking so every source pixel counts
+    Lanczos       // Lanczos-3; sharpest, slight ringing at hard edges
+};
+
+const char* ScaleFilterName(ScaleFilter filter);
+
+// The continuous kernel behind each filter, in output-pixel units when
+// shrinking and source-pixel units when growing; zero outside +-radius
+double ScaleKernel(ScaleFilter filter, double t);
+double ScaleKernelRadius(ScaleFilter filter);
+
+// Separable polyphase resize of 4-byte-per-pixel frames, channel order
+// kept. Each axis gets a bank of 14-bit fixed-point weights per output
+// position, built once per geometry and filter, so a frame costs only
+// multiply-adds: rows are filtered horizontally into a small ring of
+// 16-bit rows, which are then filtered vertically (SSE2 on x86/x64, scalar
+// elsewhere). Output rows are split into stripes run on a worker pool; each
+// stripe filters just the source rows it needs, so stripes share nothing.
+// One scaler per bridge; not thread-safe.
+class FrameScaler {
+public:
+    // threads: stripe workers besides the caller; -1 picks up to 3 from the hardware
+    explicit FrameScaler(int threads = -1);
+    ~FrameScaler();
+
+    FrameScaler(const FrameScaler&) = delete;
+    FrameScaler& operator=(const FrameScaler&) = delete;
+
+    // Resize src into dst, dstWidth x dstHeight pixels with dstStride bytes
+    // per row. Returns false for UYVY, empty frames or sizes under 2 pixels.
+    // With dirtyRows, one flag per source row, only the output rows whose
+    // filter reads a dirty row are redone; the others must still hold this
+    // scaler's last output. New sizes or a new filter redo every row.
+    bool Scale(const VideoFrame& src, ScaleFilter filter, unsigned char* dst, unsigned int dstWidth,
+               unsigned int dstHeight, size_t dstStride, const std::vector<bool>* dirtyRows = nullptr);
+
+    // Scale on the portable scalar kernels whatever the CPU; the SIMD path
+    // must match it bit for bit
+    bool ScaleScalar(const VideoFrame& src, ScaleFilter filter, unsigned char* dst, unsigned int dstWidth,
+                     unsigned int dstHeight, size_t dstStride, const std::vector<bool>* dirtyRows = nullptr);
+
+    // Output rows the last Scale wrote
+    unsigned int GetRowsScaled() const { return rowsScaled; }
+
+    // Bytes held by filter banks and stripe buffers
+    size_t GetMemoryBytes() const;
+
+private:
+    // Weights for one axis: output i reads taps source positions from offsets[i]
+    struct FilterBank {
+        unsigned int taps = 0;              // Even; padded with zero weights
+        std::vector<int> offsets;
+        std::vector<int16_t> weights;       // taps per output, each set sums to 1 << 14
+    };
+
+    struct Stripe {
+        unsigned int firstRow = 0;
+        unsigned int endRow = 0;
+        std::vector<int16_t> ring;          // Horizontally filtered source rows, by row % taps
+        unsigned int rowsScaled = 0;
+    };
+
+    class Workers;
+
+    static void BuildBank(FilterBank& bank, unsigned int srcSize, unsigned int dstSize, ScaleFilter filter);
+    bool ScaleWith(const VideoFrame& src, ScaleFilter filter, unsigned char* dst, unsigned int dstWidth,
+                   unsigned int dstHeight, size_t dstStride, const std::vector<bool>* dirtyRows, bool scalar);
+    void RunStripe(Stripe& stripe, const VideoFrame& src, unsigned char* dst, size_t dstStride,
+                   const std::vector<unsigned int>* dirtyBefore, bool scalar);
+
+    unsigned int srcWidth = 0;
+    unsigned int srcHeight = 0;
+    unsigned int dstWidth = 0;
+    unsigned int dstHeight = 0;
+    ScaleFilter filter = ScaleFilter::Box;
+    FilterBank horizontal;
+    FilterBank vertical;
+    std::vector<Stripe> stripes;
+    std::vector<unsigned int> dirtyBefore;  // Dirty source rows above each row, for partial rescales
+    unsigned int rowsScaled = 0;
+    std::unique_ptr<Workers> workers;
+};
+
+// Half and quarter size copies of a frame for proxy outputs. Each level is
+// a 2x2 average of the one above, computed in a single top-down pass that
+// makes each level's rows right after the rows they come from, instead of
+// one pass per level. An odd last row or column is dropped.
+class FramePyramid {
+public:
+    static constexpr unsigned int kMaxLevels = 2;
+
+    // Fill levels 1 (half size) .. levels (at most kMaxLevels) from src.
+    // Returns false for UYVY frames or frames too small to halve that often.
+    bool Build(const VideoFrame& src, unsigned int levels);
+
+    // Level 1 is half size; valid until the next Build
+    const VideoFrame& GetLevel(unsigned int level) const { return frames[level - 1]; }
+    unsigned int GetLevelCount() const { return levels; }
+
+    size_t GetMemoryBytes() const;
+
+private:
+    unsigned int levels = 0;
+    VideoFrame frames[kMaxLevels];
+    std::vector<unsigned char> pixels[kMaxLevels];
+};
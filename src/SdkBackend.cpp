@@ -0,0 +1,322 @@
+#include "FrameIO.h"
+#include "Platform.h"
+#include "SDKIncludes.h"
+#include "TestPattern.h"
+#include <cstring>
+#include <mutex>
+
+namespace {
+    // Spout sender read back into system memory
+    class SpoutFrameSource : public FrameSource {
+    public:
+        explicit SpoutFrameSource(const std::string& senderName)
+            : spout(nullptr)
+            , width(0)
+            , height(0)
+        {
+            strncpy(this->senderName, senderName.c_str(), sizeof(this->senderName) - 1);
+            this->senderName[sizeof(this->senderName) - 1] = '\0';
+        }
+
+        ~SpoutFrameSource() override { Close(); }
+
+        bool Open() override {
+            if (!spout) {
+                spout = CreateSpoutInstance();
+                if (!spout) return false;
+            }
+            if (!spout->CreateReceiver(senderName, width, height)) {
+                return false;
+            }
+            // Validate dimensions
+            if (width == 0 || height == 0) {
+                spout->ReleaseReceiver();
+                return false;
+            }
+            pixels.assign((size_t)width * height * 4, 0);
+            return true;
+        }
+
+        void Close() override {
+            if (spout) {
+                spout->ReleaseReceiver();
+                spout->Release();
+                spout = nullptr;
+            }
+        }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int) override {
+            // Receive the texture data directly into our pixel buffer
+            if (!spout || !spout->ReceiveImage(pixels.data(), GL_RGBA, false)) {
+                return CaptureResult::Timeout;
+            }
+
+            // The sender changed size: the frame just read is not usable
+            if (spout->IsUpdated()) {
+                unsigned int newWidth = spout->GetSenderWidth();
+                unsigned int newHeight = spout->GetSenderHeight();
+                if (newWidth > 0 && newHeight > 0) {
+                    width = newWidth;
+                    height = newHeight;
+                    pixels.assign((size_t)width * height * 4, 0);
+                }
+                return CaptureResult::FormatChanged;
+            }
+
+            frame = VideoFrame();
+            frame.data = pixels.data();
+            frame.width = width;
+            frame.height = height;
+            frame.strideBytes = (size_t)width * 4;
+            frame.timestampNs = Platform::NowNs();
+            frame.sequence = spout->GetSenderFrame();
+            return CaptureResult::Frame;
+        }
+
+        void Release(VideoFrame&) override {}
+
+        unsigned int GetPollIntervalMs() const override { return 16; }   // ~60fps
+
+    private:
+        SPOUTHANDLE spout;
+        char senderName[256];
+        unsigned int width;
+        unsigned int height;
+        Platform::FrameBuffer pixels;
+    };
+
+    class SpoutFrameSink : public FrameSink {
+    public:
+        SpoutFrameSink() : spout(nullptr) {}
+        ~SpoutFrameSink() override {
+            Close();
+            if (spout) spout->Release();
+        }
+
+        bool Open(const std::string& name) override {
+            if (!spout) {
+                spout = CreateSpoutInstance();
+                if (!spout) return false;
+            }
+            // The sender itself is created with the first frame's size
+            senderName = name;
+            return true;
+        }
+
+        void Close() override {
+            if (spout) spout->ReleaseSender();
+        }
+
+        bool Send(const VideoFrame& frame) override {
+            if (!spout) return false;
+            // Create or update the sender with the current frame dimensions
+            if (!spout->CreateSender(senderName.c_str(), frame.width, frame.height)) {
+                spout->UpdateSender(senderName.c_str(), frame.width, frame.height);
+            }
+            return spout->SendImage(frame.data, frame.width, frame.height, GL_RGBA);
+        }
+
+    private:
+        SPOUTHANDLE spout;
+        std::string senderName;
+    };
+
+    class NDIFrameSource : public FrameSource {
+    public:
+        NDIFrameSource(const std::string& sourceName, const ReceiveSettings& settings)
+            : sourceName(sourceName)
+            , settings(settings)
+            , receiver(nullptr)
+        {
+        }
+
+        ~NDIFrameSource() override { Close(); }
+
+        bool Open() override {
+            if (receiver) return true;
+            NDIlib_recv_create_v3_t NDI_recv_create_desc = { 0 };
+            NDIlib_source_t source = { 0 };
+            source.p_ndi_name = sourceName.c_str();
+            NDI_recv_create_desc.source_to_connect_to = source;
+            NDI_recv_create_desc.color_format = settings.format == PixelFormat::BGRA ? NDIlib_recv_color_format_BGRX_BGRA
+                                              : settings.format == PixelFormat::UYVY ? NDIlib_recv_color_format_UYVY_BGRA
+                                              : NDIlib_recv_color_format_RGBX_RGBA;
+            NDI_recv_create_desc.bandwidth = settings.bandwidth == ReceiveBandwidth::Lowest ? NDIlib_recv_bandwidth_lowest
+                                           : settings.bandwidth == ReceiveBandwidth::AudioOnly ? NDIlib_recv_bandwidth_audio_only
+                                           : settings.bandwidth == ReceiveBandwidth::MetadataOnly ? NDIlib_recv_bandwidth_metadata_only
+                                           : NDIlib_recv_bandwidth_highest;
+            NDI_recv_create_desc.allow_video_fields = settings.allowFields;
+            NDI_recv_create_desc.p_ndi_recv_name = settings.receiverName.empty() ? nullptr : settings.receiverName.c_str();
+            receiver = NDIlib_recv_create_v3(&NDI_recv_create_desc);
+            return receiver != nullptr;
+        }
+
+        void Close() override {
+            if (receiver) {
+                for (int slot = 0; slot < 2; slot++) {
+                    if (held[slot]) NDIlib_recv_free_video_v2(receiver, &videoFrames[slot]);
+                    held[slot] = false;
+                }
+                NDIlib_recv_destroy(receiver);
+                receiver = nullptr;
+            }
+        }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) override {
+            if (!receiver) return CaptureResult::Disconnected;
+            // Two slots, so a newer frame can be taken while the caller still holds the last one
+            int slot = held[0] ? 1 : 0;
+            if (held[slot]) return CaptureResult::Timeout;
+            NDIlib_video_frame_v2_t& videoFrame = videoFrames[slot];
+            if (NDIlib_recv_capture_v2(receiver, &videoFrame, nullptr, nullptr, timeoutMs) != NDIlib_frame_type_video) {
+                return CaptureResult::Timeout;
+            }
+            held[slot] = true;
+
+            frame = VideoFrame();
+            frame.data = videoFrame.p_data;
+            frame.width = videoFrame.xres > 0 ? (unsigned int)videoFrame.xres : 0;
+            frame.height = videoFrame.yres > 0 ? (unsigned int)videoFrame.yres : 0;
+            frame.strideBytes = videoFrame.line_stride_in_bytes > 0 ? (size_t)videoFrame.line_stride_in_bytes
+                                                                    : (size_t)frame.width * 4;
+            // UYVY_BGRA still delivers BGRA for frames with alpha
+            frame.format = videoFrame.FourCC == NDIlib_FourCC_video_type_UYVY ? PixelFormat::UYVY
+                         : videoFrame.FourCC == NDIlib_FourCC_video_type_BGRA ||
+                           videoFrame.FourCC == NDIlib_FourCC_video_type_BGRX ? PixelFormat::BGRA
+                         : PixelFormat::RGBA;
+            // With fields allowed, each field arrives as its own half-height
+            // frame and is passed on as one
+            frame.frameRateN = videoFrame.frame_rate_N;
+            frame.frameRateD = videoFrame.frame_rate_D;
+            frame.timestampNs = Platform::NowNs();
+            if (videoFrame.timestamp != NDIlib_recv_timestamp_undefined) {
+                frame.sourceTimeNs = videoFrame.timestamp * 100;
+            }
+            return CaptureResult::Frame;
+        }
+
+        void Release(VideoFrame& frame) override {
+            for (int slot = 0; slot < 2; slot++) {
+                if (held[slot] && videoFrames[slot].p_data == frame.data) {
+                    NDIlib_recv_free_video_v2(receiver, &videoFrames[slot]);
+                    held[slot] = false;
+                }
+            }
+            frame.data = nullptr;
+        }
+
+        // Capture waits inside the SDK until a frame arrives, and returns at
+        // once while frames are queued, so no pause is needed between captures
+        unsigned int GetPollIntervalMs() const override { return 0; }
+
+        size_t GetQueuedFrames() const override {
+            if (!receiver) return 0;
+            NDIlib_recv_queue_t queue = { 0 };
+            NDIlib_recv_get_queue(receiver, &queue);
+            return queue.video_frames > 0 ? (size_t)queue.video_frames : 0;
+        }
+
+        ReceiverStats GetReceiverStats() const override {
+            ReceiverStats stats;
+            if (!receiver) return stats;
+            NDIlib_recv_performance_t total = { 0 };
+            NDIlib_recv_performance_t dropped = { 0 };
+            NDIlib_recv_get_performance(receiver, &total, &dropped);
+            stats.framesReceived = total.video_frames > 0 ? (uint64_t)total.video_frames : 0;
+            stats.framesDropped = dropped.video_frames > 0 ? (uint64_t)dropped.video_frames : 0;
+            return stats;
+        }
+
+    private:
+        std::string sourceName;
+        ReceiveSettings settings;
+        NDIlib_recv_instance_t receiver;
+        NDIlib_video_frame_v2_t videoFrames[2];
+        bool held[2] = { false, false };
+    };
+
+    class NDIFrameSink : public FrameSink {
+    public:
+        NDIFrameSink() : sender(nullptr) {}
+        ~NDIFrameSink() override { Close(); }
+
+        bool Open(const std::string& name) override {
+            Close();
+            NDIlib_send_create_t NDI_send_create_desc = { name.c_str(), NULL, true, false };
+            sender = NDIlib_send_create(&NDI_send_create_desc);
+            return sender != nullptr;
+        }
+
+        void Close() override {
+            if (sender) {
+                NDIlib_send_destroy(sender);
+                sender = nullptr;
+            }
+        }
+
+        bool Send(const VideoFrame& frame) override {
+            if (!sender) return false;
+            NDIlib_video_frame_v2_t NDI_video_frame = {0};
+            NDI_video_frame.FourCC = NDIlib_FourCC_video_type_RGBA;
+            NDI_video_frame.xres = (int)frame.width;
+            NDI_video_frame.yres = (int)frame.height;
+            NDI_video_frame.frame_rate_N = frame.frameRateN;
+            NDI_video_frame.frame_rate_D = frame.frameRateD;
+            NDI_video_frame.picture_aspect_ratio = (float)frame.width / (float)frame.height;
+            NDI_video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
+            NDI_video_frame.p_data = frame.data;
+            NDI_video_frame.line_stride_in_bytes = (int)frame.strideBytes;
+            NDIlib_send_send_video_v2(sender, &NDI_video_frame);
+            return true;
+        }
+
+        int GetConnections(unsigned int timeoutMs) override {
+            if (!sender) return 0;
+            return NDIlib_send_get_no_connections(sender, timeoutMs);
+        }
+
+    private:
+        NDIlib_send_instance_t sender;
+    };
+
+    class SdkBackend : public FrameBackend {
+    public:
+        std::unique_ptr<FrameSource> CreateSource(FrameEndpoint endpoint, const std::string& sourceName,
+                                                  const ReceiveSettings& settings) override {
+            if (IsPatternSourceName(sourceName)) {
+                // Bridges carry 4-byte pixels; UYVY patterns are for direct consumers
+                PatternSettings pattern;
+                std::string error;
+                if (!ParsePatternSourceName(sourceName, pattern, error) || pattern.format == PixelFormat::UYVY) {
+                    return nullptr;
+                }
+                return CreatePatternSource(pattern);
+            }
+            if (endpoint == FrameEndpoint::Spout) return std::make_unique<SpoutFrameSource>(sourceName);
+            return std::make_unique<NDIFrameSource>(sourceName, settings);
+        }
+
+        std::unique_ptr<FrameSink> CreateSink(FrameEndpoint endpoint) override {
+            if (endpoint == FrameEndpoint::Spout) return std::make_unique<SpoutFrameSink>();
+            return std::make_unique<NDIFrameSink>();
+        }
+    };
+
+    std::mutex g_defaultMutex;
+    std::shared_ptr<FrameBackend> g_defaultBackend;
+}
+
+std::shared_ptr<FrameBackend> GetSdkBackend() {
+    static std::shared_ptr<FrameBackend> backend = std::make_shared<SdkBackend>();
+    return backend;
+}
+
+std::shared_ptr<FrameBackend> GetDefaultFrameBackend() {
+    std::lock_guard<std::mutex> lock(g_defaultMutex);
+    return g_defaultBackend ? g_defaultBackend : GetSdkBackend();
+}
+
+void SetDefaultFrameBackend(std::shared_ptr<FrameBackend> backend) {
+    std::lock_guard<std::mutex> lock(g_defaultMutex);
+    g_defaultBackend = std::move(backend);
+}
@@ -0,0 +1,319 @@
+// Soak and churn test for the bridge lifecycle. Drives the same calls the
+// GUI makes for operator edits, against the fake backend: create and Start()
+// a bridge, edit it through ApplyBridgeDefinition (in place, or a restart
+// when the source or its size changes) and delete it by erasing it from the
+// list. At every checkpoint all bridges are deleted and the process is
+// measured with nothing running, so resident memory, threads and handles
+// can be compared across the whole run. Exits non-zero if any of them, the
+// per-bridge frame pool or the per-frame latency keeps growing.
+
+#include "BridgeLauncher.h"
+#include "BridgeReconciler.h"
+#include "FakeBackend.h"
+#include "Platform.h"
+#include "TestPattern.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct SoakSettings {
+        double durationSeconds = 3600.0;
+        double checkpointSeconds = 60.0;
+        unsigned int maxBridges = 16;       // Live bridges between checkpoints
+        double opsPerSecond = 20.0;
+        uint64_t seed = 1;
+        double rssSlackMb = 32.0;           // Allowed resident growth, first to last third of the run
+        uint64_t threadSlack = 2;
+        uint64_t handleSlack = 8;
+        double latencyDriftRatio = 2.0;     // Allowed p99 growth, first to last third, once above 2 ms
+    };
+
+    // Pattern sizes the soak moves bridges between; the last is the largest
+    const char* const kSizes[] = { "320x180", "640x360", "960x540" };
+    const int kSizeCount = sizeof(kSizes) / sizeof(kSizes[0]);
+
+    // Sources that are not "pattern:" names come from the fake source, which
+    // also changes size by itself mid-stream
+    const char* const kResizingSource = "soak-resizing";
+
+    struct Checkpoint {
+        double elapsedSeconds = 0.0;
+        uint64_t operations = 0;
+        uint64_t created = 0;
+        Platform::ProcessResources resources;   // With no bridges running
+        uint64_t maxPoolBytesPerBridge = 0;     // Largest seen since the previous checkpoint
+        uint64_t p99LatencyNs = 0;              // Stamp to send, since the previous checkpoint
+        uint64_t frames = 0;
+    };
+
+    void PrintUsage(const char* program) {
+        fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --duration <sec>         Total run time (default 3600)\n"
+            "  --checkpoint <sec>       Time between measurements (default 60)\n"
+            "  --bridges <n>            Most bridges alive at once (default 16)\n"
+            "  --ops-per-second <n>     Create/edit/delete operations per second (default 20)\n"
+            "  --seed <n>               Operation sequence seed (default 1)\n"
+            "  --rss-slack-mb <mb>      Allowed resident memory growth (default 32)\n",
+            program);
+    }
+
+    bool ParseArguments(int argc, char* argv[], SoakSettings& settings) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--duration" && hasValue) settings.durationSeconds = atof(argv[++i]);
+            else if (arg == "--checkpoint" && hasValue) settings.checkpointSeconds = atof(argv[++i]);
+            else if (arg == "--bridges" && hasValue) settings.maxBridges = (unsigned int)atoi(argv[++i]);
+            else if (arg == "--ops-per-second" && hasValue) settings.opsPerSecond = atof(argv[++i]);
+            else if (arg == "--seed" && hasValue) settings.seed = strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--rss-slack-mb" && hasValue) settings.rssSlackMb = atof(argv[++i]);
+            else return false;
+        }
+        return settings.durationSeconds > 0 && settings.checkpointSeconds > 0 &&
+               settings.maxBridges > 0 && settings.opsPerSecond > 0;
+    }
+
+    std::shared_ptr<FakeBackend> CreateBackend() {
+        FakeSourceSettings source;
+        source.width = 320;
+        source.height = 180;
+        source.resizeEvery = 90;
+        source.resizeWidth = 640;
+        source.resizeHeight = 360;
+        source.stampFrames = true;
+        auto backend = std::make_shared<FakeBackend>(source);
+        SetDefaultFrameBackend(backend);
+        return backend;
+    }
+
+    class Soak {
+    public:
+        explicit Soak(const SoakSettings& settings)
+            : settings(settings)
+            , random(settings.seed)
+            , operations(0)
+            , created(0)
+            , nameCounter(0)
+            , maxPoolBytesPerBridge(0)
+        {
+        }
+
+        bool Run() {
+            backend = CreateBackend();
+            uint64_t startNs = Platform::NowNs();
+            uint64_t endNs = startNs + (uint64_t)(settings.durationSeconds * 1e9);
+            uint64_t opIntervalNs = (uint64_t)(1e9 / settings.opsPerSecond);
+            uint64_t nextCheckpointNs = startNs + (uint64_t)(settings.checkpointSeconds * 1e9);
+            uint64_t nextOpNs = startNs;
+
+            printf("%8s %9s %8s %9s %8s %8s %10s %9s %9s\n",
+                   "time_s", "ops", "created", "rss_mb", "threads", "handles", "pool_kb", "frames", "p99_ms");
+            for (;;) {
+                uint64_t now = Platform::NowNs();
+                if (now >= nextCheckpointNs || now >= endNs) {
+                    TakeCheckpoint((now - startNs) / 1e9);
+                    if (now >= endNs) break;
+                    nextCheckpointNs += (uint64_t)(settings.checkpointSeconds * 1e9);
+                    continue;
+                }
+                if (now >= nextOpNs) {
+                    Operate();
+                    nextOpNs += opIntervalNs;
+                    continue;
+                }
+                SamplePools();
+                uint64_t wakeNs = std::min(nextOpNs, nextCheckpointNs);
+                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<uint64_t>(wakeNs - now, 50000000ull)));
+            }
+            return Judge();
+        }
+
+    private:
+        std::string RandomSource() {
+            int pick = (int)(random() % (kSizeCount + 1));
+            if (pick == kSizeCount) return kResizingSource;
+            return std::string(kPatternSourcePrefix) + "moving_box," + kSizes[pick] + ",60";
+        }
+
+        // Same steps as the create dialog
+        void Create() {
+            auto instance = std::make_unique<BridgeInstance>();
+            instance->SetId(GenerateBridgeId());
+            std::string name = "Soak " + std::to_string(++nameCounter);
+            bool isSpoutToNDI = random() % 4 != 0;
+            ColorSpace colorSpace = (ColorSpace)(random() % 3);
+            if (instance->Start(RandomSource().c_str(), name.c_str(), isSpoutToNDI, colorSpace)) {
+                bridges.push_back(std::move(instance));
+                created++;
+            }
+            else {
+                fprintf(stderr, "Failed to start %s\n", name.c_str());
+            }
+        }
+
+        // Same steps as the edit dialog, optionally moving the bridge to another source
+        void Edit(bool changeSource) {
+            BridgeInstance& instance = *bridges[random() % bridges.size()];
+            BridgeDefinition definition = DescribeBridge(instance);
+            if (changeSource) {
+                definition.source = RandomSource();
+            }
+            else {
+                definition.name = "Soak " + std::to_string(++nameCounter);
+                definition.colorSpace = (ColorSpace)(random() % 3);
+                definition.options.dirtyTiles = random() % 2 == 0;
+                definition.options.tileSize = random() % 2 ? 32 : 64;
+            }
+            if (!ApplyBridgeDefinition(instance, definition)) {
+                fprintf(stderr, "Failed to apply an edit to %s\n", instance.GetBridgeName().c_str());
+            }
+        }
+
+        // Same as the delete button: erase and let the destructor stop it
+        void Delete() {
+            bridges.erase(bridges.begin() + (ptrdiff_t)(random() % bridges.size()));
+        }
+
+        void Operate() {
+            operations++;
+            unsigned int roll = (unsigned int)(random() % 100);
+            if (bridges.empty() || (roll < 35 && bridges.size() < settings.maxBridges)) Create();
+            else if (roll < 60) Edit(false);
+            else if (roll < 75) Edit(true);
+            else Delete();
+        }
+
+        void SamplePools() {
+            for (const auto& bridge : bridges) {
+                maxPoolBytesPerBridge = std::max(maxPoolBytesPerBridge, bridge->GetStats().poolBytes);
+            }
+        }
+
+        void TakeCheckpoint(double elapsedSeconds) {
+            SamplePools();
+            bridges.clear();
+
+            Checkpoint checkpoint;
+            HistogramSnapshot latency;
+            for (const FakeSinkReport& report : backend->GetSinkReports()) {
+                latency.Merge(report.latency);
+                checkpoint.frames += report.frames;
+            }
+            // A fresh backend per interval keeps the fake sinks' own records from piling up
+            backend = CreateBackend();
+
+            // Let exited threads be reaped before counting
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            checkpoint.elapsedSeconds = elapsedSeconds;
+            checkpoint.operations = operations;
+            checkpoint.created = created;
+            checkpoint.resources = Platform::GetProcessResources();
+            checkpoint.maxPoolBytesPerBridge = maxPoolBytesPerBridge;
+            checkpoint.p99LatencyNs = latency.ValueAtPercentile(99.0);
+            maxPoolBytesPerBridge = 0;
+            checkpoints.push_back(checkpoint);
+
+            printf("%8.0f %9llu %8llu %9.1f %8llu %8llu %10llu %9llu %9.2f\n",
+                   checkpoint.elapsedSeconds, (unsigned long long)checkpoint.operations,
+                   (unsigned long long)checkpoint.created, checkpoint.resources.residentBytes / 1048576.0,
+                   (unsigned long long)checkpoint.resources.threads, (unsigned long long)checkpoint.resources.handles,
+                   (unsigned long long)(checkpoint.maxPoolBytesPerBridge / 1024), (unsigned long long)checkpoint.frames,
+                   checkpoint.p99LatencyNs / 1e6);
+            fflush(stdout);
+        }
+
+        // Median of one field over checkpoints [begin, end)
+        template <typename Field>
+        double Median(size_t begin, size_t end, Field field) const {
+            std::vector<double> values;
+            for (size_t i = begin; i < end; i++) {
+                values.push_back((double)field(checkpoints[i]));
+            }
+            std::sort(values.begin(), values.end());
+            return values.empty() ? 0.0 : values[values.size() / 2];
+        }
+
+        bool Judge() const {
+            // The first checkpoint absorbs one-time initialisation and is the baseline
+            if (checkpoints.size() < 2) {
+                printf("Too few checkpoints to judge growth; run longer than two checkpoint intervals\n");
+                return true;
+            }
+            const Checkpoint& baseline = checkpoints.front();
+            bool passed = true;
+            auto fail = [&](const char* what, double before, double after) {
+                printf("FAIL: %s grew from %.2f to %.2f\n", what, before, after);
+                passed = false;
+            };
+
+            // Nothing is running at a checkpoint, so these return to the baseline
+            for (const Checkpoint& checkpoint : checkpoints) {
+                if (checkpoint.resources.threads > baseline.resources.threads + settings.threadSlack) {
+                    fail("Idle thread count", (double)baseline.resources.threads, (double)checkpoint.resources.threads);
+                    break;
+                }
+            }
+            for (const Checkpoint& checkpoint : checkpoints) {
+                if (checkpoint.resources.handles > baseline.resources.handles + settings.handleSlack) {
+                    fail("Idle handle count", (double)baseline.resources.handles, (double)checkpoint.resources.handles);
+                    break;
+                }
+            }
+
+            // Two frames (capture and converted output) of the largest source
+            uint64_t poolLimit = 2ull * 960 * 540 * 4;
+            for (const Checkpoint& checkpoint : checkpoints) {
+                if (checkpoint.maxPoolBytesPerBridge > poolLimit) {
+                    fail("Frame pool per bridge (KB)", poolLimit / 1024.0, checkpoint.maxPoolBytesPerBridge / 1024.0);
+                    break;
+                }
+            }
+
+            // Allocators keep some memory, so compare trends rather than single samples
+            size_t third = std::max<size_t>(1, checkpoints.size() / 3);
+            size_t n = checkpoints.size();
+            double rssEarly = Median(0, third, [](const Checkpoint& c) { return c.resources.residentBytes; }) / 1048576.0;
+            double rssLate = Median(n - third, n, [](const Checkpoint& c) { return c.resources.residentBytes; }) / 1048576.0;
+            if (rssLate > rssEarly + settings.rssSlackMb) {
+                fail("Idle resident memory (MB)", rssEarly, rssLate);
+            }
+
+            double latencyEarly = Median(0, third, [](const Checkpoint& c) { return c.p99LatencyNs; }) / 1e6;
+            double latencyLate = Median(n - third, n, [](const Checkpoint& c) { return c.p99LatencyNs; }) / 1e6;
+            if (latencyLate > 2.0 && latencyLate > latencyEarly * settings.latencyDriftRatio) {
+                fail("p99 frame latency (ms)", latencyEarly, latencyLate);
+            }
+
+            printf("%s after %llu operations and %llu bridges created\n", passed ? "PASS" : "FAIL",
+                   (unsigned long long)operations, (unsigned long long)created);
+            return passed;
+        }
+
+        SoakSettings settings;
+        std::mt19937_64 random;
+        std::shared_ptr<FakeBackend> backend;
+        BridgeList bridges;
+        std::vector<Checkpoint> checkpoints;
+        uint64_t operations;
+        uint64_t created;
+        uint64_t nameCounter;
+        uint64_t maxPoolBytesPerBridge;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    SoakSettings settings;
+    if (!ParseArguments(argc, argv, settings)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    Soak soak(settings);
+    return soak.Run() ? 0 : 1;
+}
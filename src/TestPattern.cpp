@@ -0,0 +1,405 @@
+#include "TestPattern.h"
+#include "Platform.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+    const uint16_t kStampSync = 0xA5C3;
+    const unsigned int kStampBits = 16 + 64 + 64 + 16;
+
+    unsigned int BytesPerPixel(PixelFormat format) {
+        return format == PixelFormat::UYVY ? 2 : 4;
+    }
+
+    uint64_t SplitMix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    uint16_t StampCheck(uint64_t sequence, uint64_t timestampNs) {
+        uint64_t h = SplitMix(sequence ^ SplitMix(timestampNs));
+        return (uint16_t)(h ^ (h >> 16) ^ (h >> 32) ^ (h >> 48));
+    }
+
+    // BT.601 video range
+    void ToYUV(uint8_t r, uint8_t g, uint8_t b, uint8_t& y, uint8_t& u, uint8_t& v) {
+        y = (uint8_t)(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        u = (uint8_t)(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        v = (uint8_t)(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+
+    // Fill [x, x + w) of one row with a solid color; UYVY spans are widened to whole pixel pairs
+    void FillSpan(unsigned char* row, PixelFormat format, unsigned int x, unsigned int w,
+                  uint8_t r, uint8_t g, uint8_t b) {
+        if (format == PixelFormat::UYVY) {
+            uint8_t y, u, v;
+            ToYUV(r, g, b, y, u, v);
+            for (unsigned int pair = x / 2; pair < (x + w + 1) / 2; pair++) {
+                unsigned char* p = row + pair * 4;
+                p[0] = u; p[1] = y; p[2] = v; p[3] = y;
+            }
+            return;
+        }
+        uint8_t first = format == PixelFormat::BGRA ? b : r;
+        uint8_t third = format == PixelFormat::BGRA ? r : b;
+        for (unsigned int i = x; i < x + w; i++) {
+            unsigned char* p = row + i * 4;
+            p[0] = first; p[1] = g; p[2] = third; p[3] = 255;
+        }
+    }
+
+    bool ParseRate(const std::string& token, int& n, int& d) {
+        size_t slash = token.find('/');
+        if (slash != std::string::npos) {
+            n = atoi(token.substr(0, slash).c_str());
+            d = atoi(token.substr(slash + 1).c_str());
+            return n > 0 && d > 0;
+        }
+        double fps = atof(token.c_str());
+        if (fps <= 0 || fps > 1000) return false;
+        // 59.94 -> 59940/1000
+        n = (int)(fps * 1000.0 + 0.5);
+        d = 1000;
+        if (n % 1000 == 0) {
+            n /= 1000;
+            d = 1;
+        }
+        return true;
+    }
+
+    class PatternFrameSource : public FrameSource {
+    public:
+        explicit PatternFrameSource(const PatternSettings& settings)
+            : settings(settings)
+            , generator(settings)
+            , open(false)
+            , startNs(0)
+            , nextIndex(0)
+        {
+        }
+
+        bool Open() override {
+            if (!settings.width || !settings.height || settings.frameRateN <= 0 || settings.frameRateD <= 0) {
+                return false;
+            }
+            pixels.resize(generator.GetFrameBytes());
+            startNs = Platform::NowNs();
+            nextIndex = 0;
+            open = true;
+            return true;
+        }
+
+        void Close() override { open = false; }
+
+        CaptureResult Capture(VideoFrame& frame, unsigned int timeoutMs) override {
+            if (!open) return CaptureResult::Disconnected;
+
+            if (settings.realTime) {
+                // A consumer that falls behind misses frames, as it would with a live sender
+                uint64_t now = Platform::NowNs();
+                uint64_t current = IndexAt(now - startNs);
+                if (current > nextIndex) nextIndex = current;
+
+                uint64_t dueNs = startNs + OffsetNs(nextIndex);
+                if (dueNs > now) {
+                    uint64_t waitNs = std::min<uint64_t>(dueNs - now, (uint64_t)timeoutMs * 1000000ull);
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+                    if (Platform::NowNs() < dueNs) return CaptureResult::Timeout;
+                }
+            }
+
+            generator.Render(pixels.data(), nextIndex);
+            frame = VideoFrame();
+            frame.data = pixels.data();
+            frame.width = settings.width;
+            frame.height = settings.height;
+            frame.strideBytes = generator.GetStrideBytes();
+            frame.format = settings.format;
+            frame.frameRateN = settings.frameRateN;
+            frame.frameRateD = settings.frameRateD;
+            frame.timestampNs = Platform::NowNs();
+            frame.sequence = (int64_t)++nextIndex;
+            if (settings.stamp) {
+                FrameStamp stamp;
+                stamp.sequence = (uint64_t)frame.sequence;
+                stamp.timestampNs = frame.timestampNs;
+                WriteFrameStamp(frame, stamp);
+            }
+            return CaptureResult::Frame;
+        }
+
+        void Release(VideoFrame& frame) override { frame.data = nullptr; }
+
+        // Capture itself waits for the next frame
+        unsigned int GetPollIntervalMs() const override { return 0; }
+
+    private:
+        // Exact for rational rates such as 60000/1001
+        uint64_t OffsetNs(uint64_t index) const {
+            uint64_t n = (uint64_t)settings.frameRateN, d = (uint64_t)settings.frameRateD;
+            return index / n * d * 1000000000ull + index % n * d * 1000000000ull / n;
+        }
+
+        uint64_t IndexAt(uint64_t elapsedNs) const {
+            return (uint64_t)((long double)elapsedNs * settings.frameRateN / (settings.frameRateD * 1e9L));
+        }
+
+        PatternSettings settings;
+        PatternGenerator generator;
+        bool open;
+        uint64_t startNs;
+        uint64_t nextIndex;
+        Platform::FrameBuffer pixels;
+    };
+}
+
+bool IsPatternSourceName(const std::string& name) {
+    return name.compare(0, strlen(kPatternSourcePrefix), kPatternSourcePrefix) == 0;
+}
+
+bool ParsePatternSourceName(const std::string& name, PatternSettings& settings, std::string& error) {
+    if (!IsPatternSourceName(name)) {
+        error = "not a pattern source";
+        return false;
+    }
+
+    PatternSettings result;
+    std::string spec = name.substr(strlen(kPatternSourcePrefix));
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        size_t end = spec.find(',', begin);
+        if (end == std::string::npos) end = spec.size();
+        std::string token = spec.substr(begin, end - begin);
+        token.erase(0, token.find_first_not_of(" \t"));
+        token.erase(token.find_last_not_of(" \t") + 1);
+        std::transform(token.begin(), token.end(), token.begin(),
+                       [](unsigned char c) { return (char)std::tolower(c); });
+        begin = end + 1;
+
+        size_t x = token.find('x');
+        if (token.empty()) continue;
+        else if (token == "bars") result.kind = PatternKind::Bars;
+        else if (token == "ramp") result.kind = PatternKind::Ramp;
+        else if (token == "moving_box" || token == "box") result.kind = PatternKind::MovingBox;
+        else if (token == "noise") result.kind = PatternKind::Noise;
+        else if (token == "rgba") result.format = PixelFormat::RGBA;
+        else if (token == "bgra") result.format = PixelFormat::BGRA;
+        else if (token == "uyvy") result.format = PixelFormat::UYVY;
+        else if (token == "fast") result.realTime = false;
+        else if (token == "nostamp") result.stamp = false;
+        else if (x != std::string::npos && x > 0 && isdigit((unsigned char)token[0])) {
+            int width = atoi(token.substr(0, x).c_str());
+            int height = atoi(token.substr(x + 1).c_str());
+            if (width < 16 || height < 16 || width > 16384 || height > 16384) {
+                error = "pattern size must be between 16x16 and 16384x16384";
+                return false;
+            }
+            result.width = (unsigned int)width;
+            result.height = (unsigned int)height;
+        }
+        else if (isdigit((unsigned char)token[0])) {
+            if (!ParseRate(token, result.frameRateN, result.frameRateD)) {
+                error = "bad pattern frame rate '" + token + "'";
+                return false;
+            }
+        }
+        else {
+            error = "unknown pattern option '" + token + "'";
+            return false;
+        }
+    }
+
+    if (result.format == PixelFormat::UYVY && result.width % 2) {
+        error = "UYVY patterns need an even width";
+        return false;
+    }
+    settings = result;
+    return true;
+}
+
+std::vector<std::string> GetPatternSourceNames() {
+    return { "pattern:bars", "pattern:ramp", "pattern:moving_box", "pattern:noise" };
+}
+
+PatternGenerator::PatternGenerator(const PatternSettings& settings)
+    : settings(settings)
+{
+}
+
+size_t PatternGenerator::GetStrideBytes() const {
+    return (size_t)settings.width * BytesPerPixel(settings.format);
+}
+
+void PatternGenerator::RenderBackground() {
+    static const uint8_t kBars[7][3] = {
+        { 191, 191, 191 }, { 191, 191, 0 }, { 0, 191, 191 }, { 0, 191, 0 },
+        { 191, 0, 191 }, { 191, 0, 0 }, { 0, 0, 191 }
+    };
+    const unsigned int width = settings.width;
+    const size_t stride = GetStrideBytes();
+    background.resize(stride * settings.height);
+
+    unsigned char* first = background.data();
+    switch (settings.kind) {
+        case PatternKind::Bars:
+            for (unsigned int bar = 0; bar < 7; bar++) {
+                unsigned int x0 = width * bar / 7, x1 = width * (bar + 1) / 7;
+                FillSpan(first, settings.format, x0, x1 - x0, kBars[bar][0], kBars[bar][1], kBars[bar][2]);
+            }
+            break;
+        case PatternKind::Ramp:
+            for (unsigned int x = 0; x < width; x++) {
+                uint8_t v = (uint8_t)(width > 1 ? x * 255 / (width - 1) : 0);
+                FillSpan(first, settings.format, x, 1, v, v, v);
+            }
+            if (settings.format == PixelFormat::UYVY) {
+                // Pairs share chroma; redo luma per pixel so the ramp stays smooth
+                for (unsigned int x = 0; x < width; x++) {
+                    uint8_t v = (uint8_t)(width > 1 ? x * 255 / (width - 1) : 0);
+                    first[x * 2 + 1] = (uint8_t)(16 + ((219 * v + 128) >> 8));
+                }
+            }
+            break;
+        default:
+            FillSpan(first, settings.format, 0, width, 32, 32, 32);
+            break;
+    }
+    // Every kind is uniform down the columns; copy the first row down
+    for (unsigned int y = 1; y < settings.height; y++) {
+        memcpy(first + y * stride, first, stride);
+    }
+}
+
+void PatternGenerator::Render(unsigned char* pixels, uint64_t index) {
+    const size_t stride = GetStrideBytes();
+    if (settings.kind == PatternKind::Noise) {
+        // Opaque for the 4-byte formats; every byte random for UYVY
+        uint64_t alpha = settings.format == PixelFormat::UYVY ? 0 : 0xFF000000FF000000ull;
+        uint64_t state = SplitMix(index + 1);
+        for (unsigned int y = 0; y < settings.height; y++) {
+            unsigned char* row = pixels + y * stride;
+            size_t words = stride / 8;
+            for (size_t i = 0; i < words; i++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                uint64_t value = state | alpha;
+                memcpy(row + i * 8, &value, 8);
+            }
+            for (size_t i = words * 8; i < stride; i++) {
+                row[i] = (unsigned char)(state >> (i % 8 * 8));
+            }
+        }
+        return;
+    }
+
+    if (background.empty()) {
+        RenderBackground();
+    }
+    memcpy(pixels, background.data(), background.size());
+
+    if (settings.kind == PatternKind::MovingBox) {
+        // Bounce off the edges; x and y move at different speeds so the path covers the frame
+        unsigned int size = std::max(8u, std::min(settings.width, settings.height) / 6);
+        size = std::min(size, std::min(settings.width, settings.height));
+        auto bounce = [](uint64_t position, unsigned int range) -> unsigned int {
+            if (range == 0) return 0;
+            uint64_t phase = position % (2ull * range);
+            return (unsigned int)(phase < range ? phase : 2ull * range - phase);
+        };
+        unsigned int x = bounce(index * 8, settings.width - size);
+        unsigned int y = bounce(index * 5, settings.height - size);
+        for (unsigned int row = y; row < y + size; row++) {
+            FillSpan(pixels + row * stride, settings.format, x, size, 235, 150, 40);
+        }
+    }
+}
+
+std::unique_ptr<FrameSource> CreatePatternSource(const PatternSettings& settings) {
+    return std::make_unique<PatternFrameSource>(settings);
+}
+
+bool WriteFrameStamp(VideoFrame& frame, const FrameStamp& stamp) {
+    unsigned int cellWidth = frame.width / kStampBits;
+    if (!frame.data || cellWidth == 0 || frame.height == 0) {
+        return false;
+    }
+
+    uint64_t words[4] = { kStampSync, stamp.sequence, stamp.timestampNs, StampCheck(stamp.sequence, stamp.timestampNs) };
+    const unsigned int widths[4] = { 16, 64, 64, 16 };
+    unsigned int rows = std::min(kFrameStampRows, frame.height);
+
+    // Black strip, then a white cell for every set bit, most significant first
+    for (unsigned int y = 0; y < rows; y++) {
+        FillSpan(frame.data + y * frame.strideBytes, frame.format, 0, frame.width, 0, 0, 0);
+    }
+    unsigned int cell = 0;
+    for (int w = 0; w < 4; w++) {
+        for (int bit = (int)widths[w] - 1; bit >= 0; bit--, cell++) {
+            if (!((words[w] >> bit) & 1)) continue;
+            for (unsigned int y = 0; y < rows; y++) {
+                unsigned char* row = frame.data + y * frame.strideBytes;
+                if (frame.format == PixelFormat::UYVY) {
+                    // Luma only, so odd cell widths don't bleed into the neighbour's pair
+                    for (unsigned int x = cell * cellWidth; x < (cell + 1) * cellWidth; x++) {
+                        row[x * 2 + 1] = 235;
+                    }
+                }
+                else {
+                    FillSpan(row, frame.format, cell * cellWidth, cellWidth, 255, 255, 255);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool ReadFrameStamp(const VideoFrame& frame, FrameStamp& stamp) {
+    unsigned int cellWidth = frame.width / kStampBits;
+    if (!frame.data || cellWidth == 0 || frame.height == 0) {
+        return false;
+    }
+
+    // Sample the middle of each cell on the middle row of the strip
+    const unsigned char* row = frame.data + (std::min(kFrameStampRows, frame.height) / 2) * frame.strideBytes;
+    auto readBits = [&](unsigned int& cell, unsigned int count) {
+        uint64_t value = 0;
+        for (unsigned int i = 0; i < count; i++, cell++) {
+            unsigned int x = cell * cellWidth + cellWidth / 2;
+            uint8_t luma = frame.format == PixelFormat::UYVY ? row[x * 2 + 1] : row[x * 4 + 1];
+            value = (value << 1) | (luma >= 128 ? 1 : 0);
+        }
+        return value;
+    };
+
+    unsigned int cell = 0;
+    if (readBits(cell, 16) != kStampSync) return false;
+    uint64_t sequence = readBits(cell, 64);
+    uint64_t timestampNs = readBits(cell, 64);
+    if (readBits(cell, 16) != StampCheck(sequence, timestampNs)) return false;
+
+    stamp.sequence = sequence;
+    stamp.timestampNs = timestampNs;
+    return true;
+}
+
+StampTracker::Observation StampTracker::Observe(const FrameStamp& stamp) {
+    Observation observation;
+    if (lastSequence == 0 || stamp.sequence > lastSequence) {
+        if (lastSequence != 0) observation.missed = stamp.sequence - lastSequence - 1;
+        lastSequence = stamp.sequence;
+    }
+    else if (stamp.sequence == lastSequence) {
+        observation.repeated = true;
+    }
+    else {
+        observation.reordered = true;
+    }
+    return observation;
+}
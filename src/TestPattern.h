@@ -0,0 +1,88 @@
+#pragma once
+
+#include "FrameIO.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class PatternKind {
+    Bars = 0,     // 75% color bars
+    Ramp,         // Horizontal grey ramp
+    MovingBox,    // Box bouncing over a dark field; small change every frame
+    Noise         // Fresh noise every frame; defeats duplicate and dirty-tile detection
+};
+
+struct PatternSettings {
+    PatternKind kind = PatternKind::Bars;
+    unsigned int width = 1920;
+    unsigned int height = 1080;
+    PixelFormat format = PixelFormat::RGBA;
+    int frameRateN = 60;
+    int frameRateD = 1;
+    bool realTime = true;    // false: produce frames as fast as they are asked for
+    bool stamp = true;       // Write the frame stamp strip into every frame
+};
+
+// Bridges whose source name starts with "pattern:" capture from a built-in
+// generator instead of Spout or NDI. The rest of the name is a comma
+// separated list, in any order, of a kind (bars, ramp, moving_box, noise),
+// a size (1280x720), a frame rate (60 or 60000/1001), a format (rgba, bgra,
+// uyvy), "fast" for unpaced output and "nostamp" to leave out the frame
+// stamp, e.g. "pattern:noise,1280x720,60000/1001".
+const char* const kPatternSourcePrefix = "pattern:";
+bool IsPatternSourceName(const std::string& name);
+bool ParsePatternSourceName(const std::string& name, PatternSettings& settings, std::string& error);
+
+// One name per kind at the default size and rate, for source pickers
+std::vector<std::string> GetPatternSourceNames();
+
+// Renders pattern frames into caller memory
+class PatternGenerator {
+public:
+    explicit PatternGenerator(const PatternSettings& settings);
+
+    size_t GetStrideBytes() const;
+    size_t GetFrameBytes() const { return GetStrideBytes() * settings.height; }
+
+    // Draw frame number index (stamp strip not included)
+    void Render(unsigned char* pixels, uint64_t index);
+
+private:
+    void RenderBackground();
+
+    PatternSettings settings;
+    std::vector<unsigned char> background;
+};
+
+std::unique_ptr<FrameSource> CreatePatternSource(const PatternSettings& settings);
+
+// Frame stamp: sequence number and timestamp written as black and white
+// cells across the top kFrameStampRows rows, with a sync word and check
+// bits. Black and white survive R/B swaps, format conversion and mild
+// compression. Needs a frame at least 160 pixels wide.
+struct FrameStamp {
+    uint64_t sequence = 0;
+    uint64_t timestampNs = 0;    // Platform::NowNs timeline
+};
+
+const unsigned int kFrameStampRows = 8;
+
+bool WriteFrameStamp(VideoFrame& frame, const FrameStamp& stamp);
+bool ReadFrameStamp(const VideoFrame& frame, FrameStamp& stamp);
+
+// Receiving side bookkeeping for stamped frames. Not thread-safe.
+class StampTracker {
+public:
+    struct Observation {
+        uint64_t missed = 0;     // Sequence numbers skipped since the previous frame
+        bool reordered = false;  // Older than a frame already seen
+        bool repeated = false;   // Same sequence as the previous frame
+    };
+
+    Observation Observe(const FrameStamp& stamp);
+    void Reset() { lastSequence = 0; }
+
+private:
+    uint64_t lastSequence = 0;
+};
@@ -0,0 +1,178 @@
+#include "TimeBaseCorrector.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+    const double kTargetLagFrames = 2.0;    // How far the output runs behind the newest frame
+    const double kMaxLagFrames = 8.0;       // Further behind than this and the output jumps ahead
+    const double kLagGain = 0.01;           // Share of the lag error corrected per tick
+    const uint64_t kBlockNs = 1000000000;   // Drift samples the fastest transit of each block
+    const size_t kMinDriftBlocks = 4;       // Blocks needed before drift is trusted
+    const int64_t kRestartNs = 1000000000;  // Transit jump that means a new stream
+}
+
+TimeBaseCorrector::TimeBaseCorrector(const TimeBaseSettings& settings)
+    : settings(settings)
+    , receiving(false)
+    , lastSourceNs(0)
+    , sourcePeriodNs(kDefaultFramePeriodNs)
+    , newestIndex(-1)
+    , lastTransitNs(0)
+    , nextTickNs(0)
+    , showing(false)
+    , phase(0.0)
+    , shownIndex(-1)
+    , anchorNs(0)
+    , transitBaseNs(0)
+    , blockStartNs(0)
+    , blockMinTransitNs(INT64_MAX)
+    , blockMinAtNs(0)
+    , driftPpm(0.0)
+{
+}
+
+void TimeBaseCorrector::Push(const VideoFrame& frame, uint64_t arrivalNs, uint64_t priorNs) {
+    int64_t periodNs = FramePeriodNs(frame);
+    int64_t sourceNs = SenderTimeNs(frame, arrivalNs, receiving, lastSourceNs);
+    int64_t transitNs = (int64_t)arrivalNs - sourceNs;
+
+    if (receiving && std::llabs(transitNs - lastTransitNs) > kRestartNs) {
+        Reset();
+        sourceNs = SenderTimeNs(frame, arrivalNs, false, 0);
+        transitNs = (int64_t)arrivalNs - sourceNs;
+    }
+
+    // Number frames by the sender's clock, so frames lost on the way leave gaps
+    int64_t index = 0;
+    if (receiving) {
+        if (sourceNs <= lastSourceNs) return;   // Stale
+        index = newestIndex + std::max<int64_t>(1, std::llround((double)(sourceNs - lastSourceNs) / periodNs));
+    }
+    receiving = true;
+    sourcePeriodNs = periodNs;
+    lastSourceNs = sourceNs;
+    lastTransitNs = transitNs;
+    newestIndex = index;
+    MeasureDrift(transitNs, arrivalNs);
+
+    Entry entry;
+    entry.stored = store.Store(frame, arrivalNs, priorNs);
+    entry.index = index;
+    queue.push_back(std::move(entry));
+
+    // The output starts once the target lag has built up
+    if (!nextTickNs) {
+        nextTickNs = arrivalNs + (uint64_t)(kTargetLagFrames * OutputPeriodNs());
+    }
+}
+
+TimeBaseTick TimeBaseCorrector::Tick(uint64_t nowNs) {
+    TimeBaseTick tick;
+    if (queue.empty() || !nextTickNs) {
+        return tick;
+    }
+
+    uint64_t periodNs = OutputPeriodNs();
+    uint64_t ticks = 1;
+    if (nowNs >= nextTickNs + periodNs) {
+        ticks += (nowNs - nextTickNs) / periodNs;
+    }
+    nextTickNs += ticks * periodNs;
+
+    // Source frames per output tick on the sender's clock, then on ours
+    double ratio = (double)periodNs / (double)sourcePeriodNs * (1.0 + driftPpm * 1e-6);
+    if (showing) {
+        phase += ratio * (double)ticks;
+    }
+    else {
+        phase = (double)newestIndex - kTargetLagFrames;
+        showing = true;
+    }
+
+    double lag = (double)newestIndex - phase;
+    if (lag > kMaxLagFrames) {
+        phase = (double)newestIndex - kTargetLagFrames;
+    }
+    else {
+        phase += (lag - kTargetLagFrames) * kLagGain;
+    }
+    phase = std::min(phase, (double)newestIndex);
+
+    // Newest frame the phase has reached; the front is the frame shown last
+    int64_t want = (int64_t)std::floor(phase);
+    size_t pick = 0;
+    while (pick + 1 < queue.size() && queue[pick + 1].index <= want) pick++;
+
+    bool frontShown = queue.front().index == shownIndex;
+    tick.repeated = frontShown && pick == 0;
+    tick.dropped = pick > 0 ? pick - (frontShown ? 1 : 0) : 0;
+    for (size_t i = 0; i < pick; i++) {
+        store.Recycle(queue.front().stored);
+        queue.pop_front();
+    }
+
+    const Entry& shown = queue.front();
+    shownIndex = shown.index;
+    tick.frame = &shown.stored.frame;
+    tick.latencyNs = shown.stored.LatencyNs(nowNs);
+    return tick;
+}
+
+void TimeBaseCorrector::Reset() {
+    for (Entry& entry : queue) store.Recycle(entry.stored);
+    queue.clear();
+    receiving = false;
+    newestIndex = -1;
+    nextTickNs = 0;
+    showing = false;
+    phase = 0.0;
+    shownIndex = -1;
+    anchorNs = 0;
+    blocks.clear();
+    driftPpm = 0.0;
+}
+
+void TimeBaseCorrector::MeasureDrift(int64_t transitNs, uint64_t arrivalNs) {
+    if (!anchorNs) {
+        anchorNs = arrivalNs;
+        blockStartNs = arrivalNs;
+        blockMinTransitNs = INT64_MAX;
+    }
+    else if (arrivalNs - blockStartNs >= kBlockNs) {
+        // Sender clocks can be far from ours, and doubles lose the detail
+        // at that size, so transits are taken relative to the first
+        if (blocks.empty()) transitBaseNs = blockMinTransitNs;
+        blocks.emplace_back((double)(blockMinAtNs - anchorNs) / 1e9, (double)(blockMinTransitNs - transitBaseNs));
+        if (blocks.size() > kDriftBlocks) blocks.pop_front();
+        blockStartNs = arrivalNs;
+        blockMinTransitNs = INT64_MAX;
+
+        // Least-squares slope in ns of transit per local second; transit
+        // shrinks as a fast sender pulls ahead
+        if (blocks.size() >= kMinDriftBlocks) {
+            double n = (double)blocks.size(), sx = 0, sy = 0, sxx = 0, sxy = 0;
+            for (const auto& block : blocks) {
+                sx += block.first;
+                sy += block.second;
+                sxx += block.first * block.first;
+                sxy += block.first * block.second;
+            }
+            double denominator = n * sxx - sx * sx;
+            if (denominator > 0) {
+                driftPpm = -(n * sxy - sx * sy) / denominator / 1000.0;
+            }
+        }
+    }
+    if (transitNs < blockMinTransitNs) {
+        blockMinTransitNs = transitNs;
+        blockMinAtNs = arrivalNs;
+    }
+}
+
+uint64_t TimeBaseCorrector::OutputPeriodNs() const {
+    if (settings.frameRateN > 0 && settings.frameRateD > 0) {
+        return (uint64_t)(1e9 * settings.frameRateD / settings.frameRateN);
+    }
+    return (uint64_t)sourcePeriodNs;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "FrameIO.h"
+#include "FrameStore.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+struct TimeBaseSettings {
+    bool enabled = false;
+    int frameRateN = 0;   // Output rate on the local clock; 0 follows the source's nominal rate
+    int frameRateD = 1;
+};
+
+// What the corrector gives one output tick
+struct TimeBaseTick {
+    const VideoFrame* frame = nullptr;  // Frame to send; nullptr until the first frame arrives
+    bool repeated = false;              // The same frame as the last tick
+    uint64_t dropped = 0;               // Received frames passed over since the last tick
+    uint64_t latencyNs = 0;             // Time the frame has spent in the bridge, priorNs included
+};
+
+// Frame sync between a sender's clock and ours: received frames are copied
+// in as they arrive and the output pulls one per tick of a local clock, so
+// the output runs at its own steady rate whatever the sender's clock does.
+// Which frame a tick shows comes from a phase that advances by the source
+// frames per output tick, the nominal rate ratio corrected by the measured
+// clock drift, so a fast sender has a frame dropped and a slow one has a
+// frame repeated at evenly spaced, predictable ticks rather than whenever
+// arrival jitter happens to leave the queue empty or full. The phase is
+// pulled gently toward a fixed lag behind the newest frame to absorb that
+// jitter and any error in the estimate.
+//
+// Drift is the slope of the sender-to-local transit time (sender timestamp,
+// VideoFrame::sourceTimeNs, or a cadence from the frame rate when it has
+// none), fitted by least squares to the fastest transit of each second over
+// the last kDriftBlocks seconds. A transit jump of over a second (a
+// restarted sender) starts over. Not thread-safe; one per bridge thread.
+class TimeBaseCorrector {
+public:
+    static constexpr unsigned int kDriftBlocks = 20;
+
+    explicit TimeBaseCorrector(const TimeBaseSettings& settings = TimeBaseSettings());
+
+    const TimeBaseSettings& GetSettings() const { return settings; }
+
+    // Queue a copy of frame, which arrived at arrivalNs (Platform::NowNs
+    // timeline) after the bridge had already spent priorNs capturing it
+    void Push(const VideoFrame& frame, uint64_t arrivalNs, uint64_t priorNs = 0);
+
+    // The frame for the output tick due by nowNs. Ticks missed since the
+    // last call advance the phase too. The frame is valid until the next
+    // Tick or Reset.
+    TimeBaseTick Tick(uint64_t nowNs);
+
+    // When the next output tick is due; 0 until the first frame arrives
+    uint64_t GetNextTickNs() const { return nextTickNs; }
+
+    // Sender clock against ours, in parts per million; positive when the sender runs fast
+    double GetDriftPpm() const { return driftPpm; }
+
+    size_t GetFrameCount() const { return queue.size(); }
+
+    // Frame buffers held, queued or free
+    size_t GetMemoryBytes() const { return store.GetMemoryBytes(); }
+
+    // Drop every frame and start measuring again
+    void Reset();
+
+private:
+    struct Entry {
+        StoredFrame stored;
+        int64_t index = 0;          // Source frame number, from the sender's timestamps
+    };
+
+    void MeasureDrift(int64_t transitNs, uint64_t arrivalNs);
+    uint64_t OutputPeriodNs() const;
+
+    TimeBaseSettings settings;
+    FrameStore store;
+    std::deque<Entry> queue;        // By index, the frame last shown first
+
+    // Source timeline
+    bool receiving;
+    int64_t lastSourceNs;
+    int64_t sourcePeriodNs;         // Sender's nominal frame period
+    int64_t newestIndex;
+    int64_t lastTransitNs;
+
+    // Output timeline
+    uint64_t nextTickNs;
+    bool showing;
+    double phase;                   // Source frame the output has reached
+    int64_t shownIndex;
+
+    // Drift: fastest transit of each block, (local seconds, transit ns)
+    uint64_t anchorNs;
+    int64_t transitBaseNs;          // Transits are kept relative to the first block's
+    uint64_t blockStartNs;
+    int64_t blockMinTransitNs;
+    uint64_t blockMinAtNs;
+    std::deque<std::pair<double, double>> blocks;
+    double driftPpm;
+};
@@ -0,0 +1,204 @@
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+    namespace detail {
+        std::atomic<bool> enabled(false);
+    }
+}
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const size_t kRingCapacity = 16384;   // Events kept per thread
+    const size_t kMaxRetiredBuffers = 64; // Buffers kept after their thread exits
+
+    struct Record {
+        uint64_t timestampNs;
+        uint64_t frameId;
+        Trace::Event event;
+        bool begin;
+    };
+
+    // Single-writer ring. The owning thread publishes each record by bumping
+    // head; the slot at head may be half rewritten, so readers copy the
+    // kRingCapacity - 1 records before it and discard any that the writer
+    // reached while they were copying.
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::string threadName;
+        std::atomic<uint64_t> head{ 0 };
+        std::atomic<uint64_t> clearedAt{ 0 };   // Records before this index were cleared
+        std::atomic<bool> retired{ false };
+        std::vector<Record> records = std::vector<Record>(kRingCapacity);
+    };
+
+    const Clock::time_point g_epoch = Clock::now();
+    std::mutex g_registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+    uint32_t g_nextThreadId = 1;
+
+    // Marks the thread's buffer retired when the thread exits
+    struct ThreadBufferHolder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~ThreadBufferHolder() {
+            if (buffer) buffer->retired.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    thread_local ThreadBufferHolder t_holder;
+    thread_local std::string t_threadName;
+
+    ThreadBuffer* GetThreadBuffer() {
+        if (t_holder.buffer) return t_holder.buffer.get();
+
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->threadName = t_threadName;
+
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        buffer->threadId = g_nextThreadId++;
+
+        // Bound memory under thread churn by forgetting the oldest dead threads
+        size_t retired = std::count_if(g_buffers.begin(), g_buffers.end(),
+            [](const std::shared_ptr<ThreadBuffer>& b) { return b->retired.load(std::memory_order_relaxed); });
+        for (auto it = g_buffers.begin(); retired >= kMaxRetiredBuffers && it != g_buffers.end();) {
+            if ((*it)->retired.load(std::memory_order_relaxed)) {
+                it = g_buffers.erase(it);
+                retired--;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        g_buffers.push_back(buffer);
+        t_holder.buffer = buffer;
+        return buffer.get();
+    }
+
+    void Append(Trace::Event event, uint64_t frameId, bool begin) {
+        ThreadBuffer* buffer = GetThreadBuffer();
+        uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        Record& record = buffer->records[head % kRingCapacity];
+        record.timestampNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_epoch).count();
+        record.frameId = frameId;
+        record.event = event;
+        record.begin = begin;
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    void WriteEscaped(std::ostream& out, const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20) {
+                out << ' ';
+            }
+            else {
+                out << c;
+            }
+        }
+    }
+}
+
+namespace Trace {
+    const char* EventName(Event event) {
+        switch (event) {
+            case Event::Capture:   return "capture";
+            case Event::Hash:      return "hash";
+            case Event::Convert:   return "convert";
+            case Event::Send:      return "send";
+            case Event::PoolAlloc: return "pool_alloc";
+            case Event::Wait:      return "wait";
+            case Event::Scale:     return "scale";
+            default:               return "unknown";
+        }
+    }
+
+    void SetEnabled(bool enabled) {
+        detail::enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    void SetThreadName(const std::string& name) {
+        t_threadName = name;
+        if (t_holder.buffer) {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            t_holder.buffer->threadName = name;
+        }
+    }
+
+    void Begin(Event event, uint64_t frameId) {
+        Append(event, frameId, true);
+    }
+
+    void End(Event event, uint64_t frameId) {
+        Append(event, frameId, false);
+    }
+
+    bool WriteChromeJson(std::ostream& out) {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            buffers = g_buffers;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            std::string threadName;
+            {
+                std::lock_guard<std::mutex> lock(g_registryMutex);
+                threadName = buffer->threadName;
+            }
+            if (!threadName.empty()) {
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                    << buffer->threadId << ",\"args\":{\"name\":\"";
+                WriteEscaped(out, threadName);
+                out << "\"}}";
+                first = false;
+            }
+
+            // Copy the live window, then drop records overwritten during the copy
+            uint64_t headBefore = buffer->head.load(std::memory_order_acquire);
+            uint64_t start = headBefore >= kRingCapacity ? headBefore - kRingCapacity + 1 : 0;
+            start = std::max(start, std::min(buffer->clearedAt.load(std::memory_order_relaxed), headBefore));
+            std::vector<Record> copy;
+            copy.reserve((size_t)(headBefore - start));
+            for (uint64_t i = start; i < headBefore; i++) {
+                copy.push_back(buffer->records[i % kRingCapacity]);
+            }
+            uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+            uint64_t firstValid = headAfter >= kRingCapacity ? headAfter - kRingCapacity + 1 : 0;
+            size_t skip = firstValid > start ? (size_t)std::min<uint64_t>(firstValid - start, copy.size()) : 0;
+
+            for (size_t i = skip; i < copy.size(); i++) {
+                const Record& r = copy[i];
+                out << (first ? "" : ",") << "\n{\"name\":\"" << EventName(r.event)
+                    << "\",\"cat\":\"frame\",\"ph\":\"" << (r.begin ? 'B' : 'E')
+                    << "\",\"ts\":" << r.timestampNs / 1000 << '.' << (char)('0' + r.timestampNs / 100 % 10)
+                    << ",\"pid\":1,\"tid\":" << buffer->threadId
+                    << ",\"args\":{\"frame\":" << r.frameId << "}}";
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+        return (bool)out;
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_buffers.erase(std::remove_if(g_buffers.begin(), g_buffers.end(),
+            [](const std::shared_ptr<ThreadBuffer>& b) { return b->retired.load(std::memory_order_relaxed); }),
+            g_buffers.end());
+
+        // Live threads keep their buffers; readers just skip what was recorded so far
+        for (auto& buffer : g_buffers) {
+            buffer->clearedAt.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+}
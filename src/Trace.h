@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Low-overhead per-frame lifecycle tracing.
+// Each thread records begin/end events into its own ring buffer; the buffers
+// are merged and written as Chrome Trace Event JSON (loadable in
+// chrome://tracing and the Perfetto UI). When tracing is off, every call
+// costs one relaxed atomic load and a branch.
+namespace Trace {
+    enum class Event : uint8_t {
+        Capture = 0,
+        Hash,
+        Convert,
+        Send,
+        PoolAlloc,
+        Wait,
+        Scale,
+        Count
+    };
+
+    const char* EventName(Event event);
+
+    namespace detail {
+        extern std::atomic<bool> enabled;
+    }
+
+    // Runtime switch; off by default
+    void SetEnabled(bool enabled);
+    inline bool IsEnabled() { return detail::enabled.load(std::memory_order_relaxed); }
+
+    // Label the calling thread in the exported timeline
+    void SetThreadName(const std::string& name);
+
+    void Begin(Event event, uint64_t frameId);
+    void End(Event event, uint64_t frameId);
+
+    // Write every buffered event as Chrome Trace Event JSON
+    bool WriteChromeJson(std::ostream& out);
+
+    // Drop all buffered events
+    void Clear();
+
+    // RAII begin/end pair; decides once at construction whether to record
+    class Scope {
+    public:
+        Scope(Event event, uint64_t frameId)
+            : event(event), frameId(frameId), active(IsEnabled()) {
+            if (active) Begin(event, frameId);
+        }
+        ~Scope() {
+            if (active) End(event, frameId);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Event event;
+        uint64_t frameId;
+        bool active;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(event, frameId) Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(event, frameId)
@@ -2,22 +2,43 @@
 #define _UNICODE
 #include <windows.h>
 #include <commctrl.h>
+#include <commdlg.h>
+#include <fstream>
 #include <Processing.NDI.Lib.h>
 #include "resource.h"
 #include "BridgeInstance.h"
+#include "BridgeLauncher.h"
+#include "BridgeReconciler.h"
 #include "ListView.h"
+#include "Utils.h"
 #include "DialogHandlers.h"
+#include "Trace.h"
+#include "MetricsServer.h"
+#include "Platform.h"
 
 // Global Variables:
 HINSTANCE hInst;                                
 WCHAR szTitle[] = L"NDI to Spout and Spout to NDI Bridge"; 
 WCHAR szWindowClass[] = L"NDISpoutBridge";    
 HACCEL hAccelTable;
+MetricsServer metricsServer;
+
+// Polls until every warm-started bridge has sent its first frame (ListView owns timer 1)
+const UINT_PTR kStartupTimerId = 2;
+const UINT kStartupPollMs = 50;
+const double kStartupGiveUpMs = 60000.0;
 
 // Forward declarations
 ATOM                MyRegisterClass(HINSTANCE hInstance);
 BOOL                InitInstance(HINSTANCE, int);
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
+BOOL                PromptSaveFile(HWND, LPCWSTR filter, LPCWSTR defaultExt, LPWSTR fileName);
+void                ExportLatencyHistograms(HWND);
+void                SaveFrameTrace(HWND);
+void                WarmStartBridges(HWND);
+void                SaveBridgeConfiguration(HWND);
+void                ReloadBridgeConfiguration(HWND);
+void                CheckStartupComplete(HWND);
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
                      _In_opt_ HINSTANCE hPrevInstance,
@@ -46,6 +67,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         return FALSE;
     }
 
+    // Before the first bridge allocates its frame buffers
+    Platform::EnableLargePages();
+
     // Register window class
     MyRegisterClass(hInstance);
 
@@ -120,6 +144,8 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
    ShowWindow(hWnd, nCmdShow);
    UpdateWindow(hWnd);
 
+   WarmStartBridges(hWnd);
+
    return TRUE;
 }
 
@@ -141,7 +167,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             case IDM_CREATE_SPOUT_TO_NDI:
                 try {
                     // For create Spout to NDI, pass 0 in wParam and TRUE in lParam
-                    DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_CREATE_BRIDGE), hWnd, CreateBridge, 1);
+                    if (DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_CREATE_BRIDGE), hWnd, CreateBridge, 1) == IDOK) {
+                        SaveBridgeConfiguration(hWnd);
+                    }
                 }
                 catch (...) {
                     MessageBoxW(hWnd, L"Failed to create dialog", L"Error", MB_OK | MB_ICONERROR);
@@ -150,19 +178,52 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             case IDM_CREATE_NDI_TO_SPOUT:
                 try {
                     // For create NDI to Spout, pass 0 in wParam and FALSE in lParam
-                    DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_CREATE_BRIDGE), hWnd, CreateBridge, 0);
+                    if (DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_CREATE_BRIDGE), hWnd, CreateBridge, 0) == IDOK) {
+                        SaveBridgeConfiguration(hWnd);
+                    }
                 }
                 catch (...) {
                     MessageBoxW(hWnd, L"Failed to create dialog", L"Error", MB_OK | MB_ICONERROR);
                 }
                 break;
+            case IDM_RELOAD_BRIDGES:
+                ReloadBridgeConfiguration(hWnd);
+                break;
+            case IDM_EXPORT_LATENCY:
+                ExportLatencyHistograms(hWnd);
+                break;
+            case IDM_TRACE_TOGGLE:
+                {
+                    // Starting a new recording discards the previous one
+                    bool enable = !Trace::IsEnabled();
+                    if (enable) {
+                        Trace::Clear();
+                    }
+                    Trace::SetEnabled(enable);
+                    CheckMenuItem(GetMenu(hWnd), IDM_TRACE_TOGGLE, enable ? MF_CHECKED : MF_UNCHECKED);
+                }
+                break;
+            case IDM_SAVE_TRACE:
+                SaveFrameTrace(hWnd);
+                break;
+            case IDM_METRICS_SERVER:
+                if (metricsServer.IsRunning()) {
+                    metricsServer.Stop();
+                }
+                else if (!metricsServer.Start()) {
+                    MessageBoxW(hWnd, L"Failed to listen on localhost:9464", L"Error", MB_OK | MB_ICONERROR);
+                }
+                CheckMenuItem(GetMenu(hWnd), IDM_METRICS_SERVER, metricsServer.IsRunning() ? MF_CHECKED : MF_UNCHECKED);
+                break;
             case IDC_EDIT_BUTTON:
                 {
                     int selectedIndex = ListView::GetSelectedIndex();
                     if (selectedIndex != -1) {
                         try {
                             // For edit, pass index + 2 to distinguish from create mode (0 or 1)
-                            DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_CREATE_BRIDGE), hWnd, CreateBridge, selectedIndex + 2);
+                            if (DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_CREATE_BRIDGE), hWnd, CreateBridge, selectedIndex + 2) == IDOK) {
+                                SaveBridgeConfiguration(hWnd);
+                            }
                         }
                         catch (...) {
                             MessageBoxW(hWnd, L"Failed to create dialog", L"Error", MB_OK | MB_ICONERROR);
@@ -178,6 +239,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                             L"Confirm Delete", MB_YESNO | MB_ICONQUESTION) == IDYES) {
                             g_instances.erase(g_instances.begin() + selectedIndex);
                             ListView::RefreshList();
+                            SaveBridgeConfiguration(hWnd);
                         }
                     }
                 }
@@ -201,7 +263,21 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             EndPaint(hWnd, &ps);
         }
         break;
+    case WM_NOTIFY:
+        if (!ListView::HandleNotify(lParam)) {
+            return DefWindowProc(hWnd, message, wParam, lParam);
+        }
+        break;
+    case WM_TIMER:
+        if (wParam == kStartupTimerId) {
+            CheckStartupComplete(hWnd);
+        }
+        else if (!ListView::HandleTimer(wParam)) {
+            return DefWindowProc(hWnd, message, wParam, lParam);
+        }
+        break;
     case WM_DESTROY:
+        metricsServer.Stop();
         PostQuitMessage(0);
         break;
     default:
@@ -209,3 +285,132 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     }
     return 0;
 }
+
+BOOL PromptSaveFile(HWND hWnd, LPCWSTR filter, LPCWSTR defaultExt, LPWSTR fileName)
+{
+    OPENFILENAMEW ofn = { 0 };
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = hWnd;
+    ofn.lpstrFilter = filter;
+    ofn.lpstrFile = fileName;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.lpstrDefExt = defaultExt;
+    ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+    return GetSaveFileNameW(&ofn);
+}
+
+void ExportLatencyHistograms(HWND hWnd)
+{
+    WCHAR fileName[MAX_PATH] = L"latency.nslh";
+    if (!PromptSaveFile(hWnd, L"Latency Histograms (*.nslh)\0*.nslh\0All Files (*.*)\0*.*\0", L"nslh", fileName)) {
+        return;
+    }
+
+    std::vector<LatencyReport> reports;
+    for (auto& instance : g_instances) {
+        reports.push_back(instance->GetLatencyReport());
+    }
+    std::vector<uint8_t> data = EncodeLatencyReports(reports);
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file) {
+        MessageBoxW(hWnd, L"Failed to write latency histograms", L"Error", MB_OK | MB_ICONERROR);
+    }
+}
+
+void SaveFrameTrace(HWND hWnd)
+{
+    WCHAR fileName[MAX_PATH] = L"trace.json";
+    if (!PromptSaveFile(hWnd, L"Chrome Trace (*.json)\0*.json\0All Files (*.*)\0*.*\0", L"json", fileName)) {
+        return;
+    }
+
+    std::ofstream file(fileName, std::ios::trunc);
+    if (!file || !Trace::WriteChromeJson(file)) {
+        MessageBoxW(hWnd, L"Failed to write frame trace", L"Error", MB_OK | MB_ICONERROR);
+    }
+}
+
+// Start every bridge from the saved configuration without going through discovery
+void WarmStartBridges(HWND hWnd)
+{
+    std::vector<BridgeDefinition> definitions;
+    std::string error;
+    std::string path = GetDefaultConfigPath();
+    if (!LoadBridgeConfig(path, definitions, error)) {
+        // No saved configuration yet is the normal first run
+        if (GetFileAttributesW(Utils::ToWide(path).c_str()) != INVALID_FILE_ATTRIBUTES) {
+            MessageBoxW(hWnd, Utils::ToWide("Cannot load saved bridges: " + error).c_str(), L"Error", MB_OK | MB_ICONERROR);
+        }
+        return;
+    }
+
+    std::vector<std::string> errors;
+    BridgeList started = StartBridges(definitions, errors);
+    for (auto& bridge : started) {
+        g_instances.push_back(std::move(bridge));
+    }
+    ListView::RefreshList();
+
+    if (!g_instances.empty()) {
+        SetTimer(hWnd, kStartupTimerId, kStartupPollMs, NULL);
+    }
+    if (!errors.empty()) {
+        std::string message = "Some saved bridges could not be started:";
+        for (const std::string& line : errors) {
+            message += "\n" + line;
+        }
+        MessageBoxW(hWnd, Utils::ToWide(message).c_str(), L"Warning", MB_OK | MB_ICONWARNING);
+    }
+}
+
+void SaveBridgeConfiguration(HWND hWnd)
+{
+    std::string error;
+    if (!SaveBridgeConfig(GetDefaultConfigPath(), DescribeBridges(g_instances), error)) {
+        MessageBoxW(hWnd, Utils::ToWide("Cannot save bridges: " + error).c_str(), L"Error", MB_OK | MB_ICONERROR);
+    }
+}
+
+// Re-read the saved configuration after it was edited by hand and apply only
+// what changed; untouched bridges keep streaming
+void ReloadBridgeConfiguration(HWND hWnd)
+{
+    std::vector<BridgeDefinition> definitions;
+    std::string error;
+    if (!LoadBridgeConfig(GetDefaultConfigPath(), definitions, error)) {
+        MessageBoxW(hWnd, Utils::ToWide("Cannot load saved bridges: " + error).c_str(), L"Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    ReconcileSummary summary = ReconcileBridges(g_instances, definitions);
+    ListView::RefreshList();
+    OutputDebugStringW(Utils::ToWide("Reloaded bridges: " + FormatReconcileSummary(summary) + "\n").c_str());
+    if (!summary.errors.empty()) {
+        std::string message = "Some bridges could not be started:";
+        for (const std::string& line : summary.errors) {
+            message += "\n" + line;
+        }
+        MessageBoxW(hWnd, Utils::ToWide(message).c_str(), L"Warning", MB_OK | MB_ICONWARNING);
+    }
+}
+
+// Report process launch to all bridges streaming once, in the title bar and debugger
+void CheckStartupComplete(HWND hWnd)
+{
+    double streamingMs = TimeToAllStreamingMs(g_instances);
+    if (streamingMs < 0 && ProcessUptimeMs() < kStartupGiveUpMs) {
+        return;
+    }
+    KillTimer(hWnd, kStartupTimerId);
+    if (streamingMs < 0) {
+        return;
+    }
+
+    wchar_t status[128];
+    swprintf_s(status, L"%zu bridges streaming %.0f ms after launch", g_instances.size(), streamingMs);
+    std::wstring title = std::wstring(szTitle) + L" - " + status;
+    SetWindowTextW(hWnd, title.c_str());
+    OutputDebugStringW((std::wstring(status) + L"\n").c_str());
+}
@@ -23,6 +23,11 @@
 #define IDC_DELETE_BUTTON              119
 #define IDC_COLOR_SPACE                120
 #define IDC_STATIC_COLOR               121
+#define IDM_EXPORT_LATENCY             122
+#define IDM_TRACE_TOGGLE               123
+#define IDM_SAVE_TRACE                 124
+#define IDM_METRICS_SERVER             125
+#define IDM_RELOAD_BRIDGES             126
 
 #define IDC_STATIC                     -1
 
@@ -0,0 +1,137 @@
+#pragma once
+
+// Stand-in for the subset of the NDI SDK the bridge engine uses, for headless
+// builds on machines without the SDK. Senders discard frames; receivers
+// deliver a synthetic moving pattern at ~60 fps. Names and layouts follow the
+// real SDK so engine code compiles unchanged against either.
+
+#include <cstdint>
+
+#define NDI_LIB_FOURCC(ch0, ch1, ch2, ch3) \
+    ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) | ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24))
+
+// Sent in place of a timestamp by senders that don't provide one
+static const int64_t NDIlib_recv_timestamp_undefined = INT64_MAX;
+
+typedef struct NDIlib_send_instance_type* NDIlib_send_instance_t;
+typedef struct NDIlib_recv_instance_type* NDIlib_recv_instance_t;
+typedef struct NDIlib_find_instance_type* NDIlib_find_instance_t;
+
+typedef enum NDIlib_frame_type_e {
+    NDIlib_frame_type_none = 0,
+    NDIlib_frame_type_video = 1,
+    NDIlib_frame_type_audio = 2,
+    NDIlib_frame_type_metadata = 3,
+    NDIlib_frame_type_error = 4,
+    NDIlib_frame_type_status_change = 100
+} NDIlib_frame_type_e;
+
+typedef enum NDIlib_FourCC_video_type_e {
+    NDIlib_FourCC_video_type_UYVY = NDI_LIB_FOURCC('U', 'Y', 'V', 'Y'),
+    NDIlib_FourCC_video_type_BGRA = NDI_LIB_FOURCC('B', 'G', 'R', 'A'),
+    NDIlib_FourCC_video_type_BGRX = NDI_LIB_FOURCC('B', 'G', 'R', 'X'),
+    NDIlib_FourCC_video_type_RGBA = NDI_LIB_FOURCC('R', 'G', 'B', 'A'),
+    NDIlib_FourCC_video_type_RGBX = NDI_LIB_FOURCC('R', 'G', 'B', 'X')
+} NDIlib_FourCC_video_type_e;
+
+typedef enum NDIlib_recv_color_format_e {
+    NDIlib_recv_color_format_BGRX_BGRA = 0,
+    NDIlib_recv_color_format_UYVY_BGRA = 1,
+    NDIlib_recv_color_format_RGBX_RGBA = 2,
+    NDIlib_recv_color_format_UYVY_RGBA = 3,
+    NDIlib_recv_color_format_fastest = 100,
+    NDIlib_recv_color_format_best = 101
+} NDIlib_recv_color_format_e;
+
+typedef enum NDIlib_recv_bandwidth_e {
+    NDIlib_recv_bandwidth_metadata_only = -10,
+    NDIlib_recv_bandwidth_audio_only = 10,
+    NDIlib_recv_bandwidth_lowest = 0,
+    NDIlib_recv_bandwidth_highest = 100
+} NDIlib_recv_bandwidth_e;
+
+typedef enum NDIlib_frame_format_type_e {
+    NDIlib_frame_format_type_progressive = 1,
+    NDIlib_frame_format_type_interleaved = 0,
+    NDIlib_frame_format_type_field_0 = 2,
+    NDIlib_frame_format_type_field_1 = 3
+} NDIlib_frame_format_type_e;
+
+typedef struct NDIlib_source_t {
+    const char* p_ndi_name;
+    const char* p_url_address;
+} NDIlib_source_t;
+
+typedef struct NDIlib_send_create_t {
+    const char* p_ndi_name;
+    const char* p_groups;
+    bool clock_video;
+    bool clock_audio;
+} NDIlib_send_create_t;
+
+typedef struct NDIlib_recv_create_v3_t {
+    NDIlib_source_t source_to_connect_to;
+    NDIlib_recv_color_format_e color_format;
+    NDIlib_recv_bandwidth_e bandwidth;
+    bool allow_video_fields;
+    const char* p_ndi_recv_name;
+} NDIlib_recv_create_v3_t;
+
+typedef struct NDIlib_video_frame_v2_t {
+    int xres;
+    int yres;
+    NDIlib_FourCC_video_type_e FourCC;
+    int frame_rate_N;
+    int frame_rate_D;
+    float picture_aspect_ratio;
+    NDIlib_frame_format_type_e frame_format_type;
+    int64_t timecode;
+    uint8_t* p_data;
+    union {
+        int line_stride_in_bytes;
+        int data_size_in_bytes;
+    };
+    const char* p_metadata;
+    int64_t timestamp;
+} NDIlib_video_frame_v2_t;
+
+typedef struct NDIlib_recv_performance_t {
+    int64_t video_frames;
+    int64_t audio_frames;
+    int64_t metadata_frames;
+} NDIlib_recv_performance_t;
+
+typedef struct NDIlib_recv_queue_t {
+    int video_frames;
+    int audio_frames;
+    int metadata_frames;
+} NDIlib_recv_queue_t;
+
+typedef struct NDIlib_audio_frame_v2_t NDIlib_audio_frame_v2_t;
+typedef struct NDIlib_metadata_frame_t NDIlib_metadata_frame_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool NDIlib_initialize(void);
+void NDIlib_destroy(void);
+
+NDIlib_send_instance_t NDIlib_send_create(const NDIlib_send_create_t* p_create_settings);
+void NDIlib_send_destroy(NDIlib_send_instance_t p_instance);
+void NDIlib_send_send_video_v2(NDIlib_send_instance_t p_instance, const NDIlib_video_frame_v2_t* p_video_data);
+int NDIlib_send_get_no_connections(NDIlib_send_instance_t p_instance, uint32_t timeout_in_ms);
+
+NDIlib_recv_instance_t NDIlib_recv_create_v3(const NDIlib_recv_create_v3_t* p_create_settings);
+void NDIlib_recv_destroy(NDIlib_recv_instance_t p_instance);
+NDIlib_frame_type_e NDIlib_recv_capture_v2(NDIlib_recv_instance_t p_instance, NDIlib_video_frame_v2_t* p_video_data,
+                                           NDIlib_audio_frame_v2_t* p_audio_data, NDIlib_metadata_frame_t* p_metadata,
+                                           uint32_t timeout_in_ms);
+void NDIlib_recv_free_video_v2(NDIlib_recv_instance_t p_instance, const NDIlib_video_frame_v2_t* p_video_data);
+void NDIlib_recv_get_performance(NDIlib_recv_instance_t p_instance, NDIlib_recv_performance_t* p_total,
+                                 NDIlib_recv_performance_t* p_dropped);
+void NDIlib_recv_get_queue(NDIlib_recv_instance_t p_instance, NDIlib_recv_queue_t* p_total);
+
+#ifdef __cplusplus
+}
+#endif
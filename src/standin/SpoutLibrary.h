@@ -0,0 +1,43 @@
+#pragma once
+
+// Stand-in for the subset of SpoutLibrary the bridge engine uses, for headless
+// builds without Spout. Receivers see one 1280x720 sender producing a moving
+// pattern; senders accept and discard frames.
+
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+
+#ifndef GL_RGBA
+#define GL_RGBA 0x1908
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+struct SPOUTLIBRARY
+{
+    // Sender
+    virtual void ReleaseSender(unsigned long dwMsec = 0) = 0;
+    virtual bool SendImage(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false) = 0;
+    virtual bool CreateSender(const char* Sendername, unsigned int width, unsigned int height, unsigned long dwFormat = 0) = 0;
+    virtual bool UpdateSender(const char* Sendername, unsigned int width, unsigned int height) = 0;
+
+    // Receiver
+    virtual bool CreateReceiver(char* Sendername, unsigned int& width, unsigned int& height) = 0;
+    virtual void ReleaseReceiver() = 0;
+    virtual bool ReceiveImage(unsigned char* pixels, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFbo = 0) = 0;
+    virtual bool IsUpdated() = 0;
+    virtual unsigned int GetSenderWidth() = 0;
+    virtual unsigned int GetSenderHeight() = 0;
+    virtual long GetSenderFrame() = 0;
+
+    virtual int GetSenderCount() = 0;
+    virtual bool GetSender(int index, char* sendername, int MaxSize = 256) = 0;
+
+    // Library release function
+    virtual void Release() = 0;
+};
+
+typedef SPOUTLIBRARY* SPOUTHANDLE;
+
+extern "C" SPOUTHANDLE GetSpout(void);
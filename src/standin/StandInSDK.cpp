@@ -0,0 +1,149 @@
+#include "Processing.NDI.Lib.h"
+#include "SpoutLibrary.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+    const unsigned int kWidth = 1280;
+    const unsigned int kHeight = 720;
+    const int kFrameIntervalMs = 16;
+
+    // Grey field with a white bar that moves a few pixels each frame, so
+    // duplicate and dirty-tile detection see realistic small changes
+    void FillPattern(unsigned char* pixels, unsigned int width, unsigned int height, uint64_t frame) {
+        const unsigned int barWidth = 32;
+        unsigned int barX = (unsigned int)((frame * 8) % width);
+        for (unsigned int y = 0; y < height; y++) {
+            unsigned char* row = pixels + (size_t)y * width * 4;
+            memset(row, 0x40, (size_t)width * 4);
+            unsigned int end = std::min(barX + barWidth, width);
+            memset(row + (size_t)barX * 4, 0xFF, (size_t)(end - barX) * 4);
+        }
+    }
+
+    struct StandInReceiver {
+        std::vector<uint8_t> pixels;
+        uint64_t frame = 0;
+    };
+
+    class StandInSpout final : public SPOUTLIBRARY {
+    public:
+        void ReleaseSender(unsigned long) override {}
+        bool SendImage(const unsigned char*, unsigned int, unsigned int, GLenum, bool) override { return true; }
+        bool CreateSender(const char*, unsigned int, unsigned int, unsigned long) override { return true; }
+        bool UpdateSender(const char*, unsigned int, unsigned int) override { return true; }
+
+        bool CreateReceiver(char*, unsigned int& width, unsigned int& height) override {
+            width = kWidth;
+            height = kHeight;
+            return true;
+        }
+        void ReleaseReceiver() override {}
+        bool ReceiveImage(unsigned char* pixels, GLenum, bool, GLuint) override {
+            FillPattern(pixels, kWidth, kHeight, ++frame);
+            return true;
+        }
+        bool IsUpdated() override { return false; }
+        unsigned int GetSenderWidth() override { return kWidth; }
+        unsigned int GetSenderHeight() override { return kHeight; }
+        long GetSenderFrame() override { return (long)frame; }
+
+        int GetSenderCount() override { return 1; }
+        bool GetSender(int index, char* sendername, int maxSize) override {
+            if (index != 0 || maxSize <= 0) return false;
+            strncpy(sendername, "Stand-in Sender", (size_t)maxSize - 1);
+            sendername[maxSize - 1] = '\0';
+            return true;
+        }
+
+        void Release() override { delete this; }
+
+    private:
+        uint64_t frame = 0;
+    };
+}
+
+bool NDIlib_initialize(void) {
+    return true;
+}
+
+void NDIlib_destroy(void) {
+}
+
+NDIlib_send_instance_t NDIlib_send_create(const NDIlib_send_create_t*) {
+    // Any non-null handle will do; senders keep no state
+    static char sender;
+    return reinterpret_cast<NDIlib_send_instance_t>(&sender);
+}
+
+void NDIlib_send_destroy(NDIlib_send_instance_t) {
+}
+
+void NDIlib_send_send_video_v2(NDIlib_send_instance_t, const NDIlib_video_frame_v2_t*) {
+}
+
+// Report one receiver so bridges built against the stand-in never go idle
+int NDIlib_send_get_no_connections(NDIlib_send_instance_t p_instance, uint32_t) {
+    return p_instance ? 1 : 0;
+}
+
+NDIlib_recv_instance_t NDIlib_recv_create_v3(const NDIlib_recv_create_v3_t*) {
+    StandInReceiver* receiver = new StandInReceiver();
+    receiver->pixels.resize((size_t)kWidth * kHeight * 4);
+    return reinterpret_cast<NDIlib_recv_instance_t>(receiver);
+}
+
+void NDIlib_recv_destroy(NDIlib_recv_instance_t p_instance) {
+    delete reinterpret_cast<StandInReceiver*>(p_instance);
+}
+
+NDIlib_frame_type_e NDIlib_recv_capture_v2(NDIlib_recv_instance_t p_instance, NDIlib_video_frame_v2_t* p_video_data,
+                                           NDIlib_audio_frame_v2_t*, NDIlib_metadata_frame_t*, uint32_t timeout_in_ms) {
+    StandInReceiver* receiver = reinterpret_cast<StandInReceiver*>(p_instance);
+    if (!receiver || !p_video_data) {
+        return NDIlib_frame_type_none;
+    }
+
+    // Pace like a 60 fps source
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::min<uint32_t>(timeout_in_ms, kFrameIntervalMs)));
+
+    FillPattern(receiver->pixels.data(), kWidth, kHeight, ++receiver->frame);
+    memset(p_video_data, 0, sizeof(*p_video_data));
+    p_video_data->xres = kWidth;
+    p_video_data->yres = kHeight;
+    p_video_data->FourCC = NDIlib_FourCC_video_type_RGBA;
+    p_video_data->frame_rate_N = 60000;
+    p_video_data->frame_rate_D = 1000;
+    p_video_data->picture_aspect_ratio = (float)kWidth / (float)kHeight;
+    p_video_data->frame_format_type = NDIlib_frame_format_type_progressive;
+    p_video_data->p_data = receiver->pixels.data();
+    p_video_data->line_stride_in_bytes = kWidth * 4;
+    p_video_data->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now().time_since_epoch()).count() / 100;
+    return NDIlib_frame_type_video;
+}
+
+void NDIlib_recv_free_video_v2(NDIlib_recv_instance_t, const NDIlib_video_frame_v2_t*) {
+}
+
+// Frames are made on demand, so nothing ever queues or drops
+void NDIlib_recv_get_performance(NDIlib_recv_instance_t p_instance, NDIlib_recv_performance_t* p_total,
+                                 NDIlib_recv_performance_t* p_dropped) {
+    StandInReceiver* receiver = reinterpret_cast<StandInReceiver*>(p_instance);
+    if (p_total) {
+        memset(p_total, 0, sizeof(*p_total));
+        if (receiver) p_total->video_frames = (int64_t)receiver->frame;
+    }
+    if (p_dropped) memset(p_dropped, 0, sizeof(*p_dropped));
+}
+
+void NDIlib_recv_get_queue(NDIlib_recv_instance_t, NDIlib_recv_queue_t* p_total) {
+    if (p_total) memset(p_total, 0, sizeof(*p_total));
+}
+
+SPOUTHANDLE GetSpout(void) {
+    return new StandInSpout();
+}
@@ -0,0 +1,264 @@
+#include "BridgeConfig.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    bool Parse(const std::string& text, std::vector<BridgeDefinition>& bridges, std::string& error) {
+        std::istringstream input(text);
+        return ParseBridgeConfig(input, bridges, error);
+    }
+
+    bool SameDefinition(const BridgeDefinition& a, const BridgeDefinition& b) {
+        const BridgeOptions& x = a.options;
+        const BridgeOptions& y = b.options;
+        return a.id == b.id && a.name == b.name && a.source == b.source && a.isSpoutToNDI == b.isSpoutToNDI &&
+               a.colorSpace == b.colorSpace && x.duplicateFilter == y.duplicateFilter &&
+               x.dirtyTiles == y.dirtyTiles && x.tileSize == y.tileSize && x.cpu == y.cpu &&
+               x.shareCapture == y.shareCapture && x.subscription.queueDepth == y.subscription.queueDepth &&
+               x.subscription.dropPolicy == y.subscription.dropPolicy && x.mosaic.width == y.mosaic.width &&
+               x.mosaic.height == y.mosaic.height && x.mosaic.frameRateN == y.mosaic.frameRateN &&
+               x.mosaic.frameRateD == y.mosaic.frameRateD && x.mosaic.columns == y.mosaic.columns &&
+               x.mosaic.proxy == y.mosaic.proxy && x.outputWidth == y.outputWidth &&
+               x.outputHeight == y.outputHeight && x.scaleFilter == y.scaleFilter &&
+               x.proxyOutputs == y.proxyOutputs && x.idleWhenUnwatched == y.idleWhenUnwatched &&
+               x.idleFrameMs == y.idleFrameMs && x.receiveBandwidth == y.receiveBandwidth &&
+               x.allowFields == y.allowFields && x.receiverName == y.receiverName &&
+               x.jitterBuffer.enabled == y.jitterBuffer.enabled &&
+               x.jitterBuffer.maxLatencyMs == y.jitterBuffer.maxLatencyMs &&
+               x.timeBase.enabled == y.timeBase.enabled && x.timeBase.frameRateN == y.timeBase.frameRateN &&
+               x.timeBase.frameRateD == y.timeBase.frameRateD;
+    }
+
+    // A bridge each way with every setting off its default, and names that
+    // need quoting: ';' and '"' in them, a backslash, edge spaces
+    std::vector<BridgeDefinition> EveryKey() {
+        BridgeDefinition mosaic;
+        mosaic.id = "5f3a9c0e12b47d86";
+        mosaic.name = " Stage; \"Left\" \\ ";
+        mosaic.source = "mosaic:STUDIO (Cam 1)|STUDIO \"Cam 2\"";
+        mosaic.isSpoutToNDI = true;
+        mosaic.colorSpace = ColorSpace::BGRA;
+        BridgeOptions& a = mosaic.options;
+        a.duplicateFilter.policy = DuplicatePolicy::RateLimit;
+        a.duplicateFilter.hashMode = FrameHash::Mode::Sampled;
+        a.duplicateFilter.keepAliveMs = 250;
+        a.duplicateFilter.rateLimitMs = 40;
+        a.dirtyTiles = false;
+        a.tileSize = 32;
+        a.cpu = 3;
+        a.shareCapture = true;
+        a.subscription.queueDepth = 4;
+        a.subscription.dropPolicy = QueueDropPolicy::DropNewest;
+        a.mosaic.width = 1280;
+        a.mosaic.height = 720;
+        a.mosaic.frameRateN = 30000;
+        a.mosaic.frameRateD = 1001;
+        a.mosaic.columns = 3;
+        a.mosaic.proxy = false;
+        a.outputWidth = 960;
+        a.outputHeight = 540;
+        a.scaleFilter = ScaleFilter::Lanczos;
+        a.proxyOutputs = 2;
+        a.idleWhenUnwatched = false;
+        a.idleFrameMs = 0;
+
+        BridgeDefinition receiver;
+        receiver.id = "id with spaces; and \"quotes\"";
+        receiver.name = "Output #2";
+        receiver.source = "STUDIO (Cam 1)";
+        receiver.isSpoutToNDI = false;
+        receiver.colorSpace = ColorSpace::UYVY;
+        BridgeOptions& b = receiver.options;
+        b.duplicateFilter.policy = DuplicatePolicy::Off;
+        b.receiveBandwidth = ReceiveBandwidth::Lowest;
+        b.allowFields = true;
+        b.receiverName = "Preview; Wall";
+        b.jitterBuffer.enabled = true;
+        b.jitterBuffer.maxLatencyMs = 80;
+        b.timeBase.enabled = true;
+        b.timeBase.frameRateN = 60000;
+        b.timeBase.frameRateD = 1001;
+        return { mosaic, receiver };
+    }
+
+    // Everything written reads back the same, and every key is written
+    void EveryKeyRoundTrips() {
+        std::vector<BridgeDefinition> bridges = EveryKey();
+        std::ostringstream output;
+        WriteBridgeConfig(output, bridges);
+        std::string text = output.str();
+
+        const char* const keys[] = {
+            "version", "id", "name", "direction", "source", "color_space", "duplicate_policy", "hash_mode",
+            "keep_alive_ms", "rate_limit_ms", "dirty_tiles", "tile_size", "cpu", "share_capture", "queue_depth",
+            "drop_policy", "output_size", "scale_filter", "proxy_outputs", "idle_when_unwatched", "idle_frame_ms",
+            "receive_bandwidth", "allow_fields", "receiver_name", "jitter_buffer", "jitter_max_latency_ms",
+            "time_base_corrector", "tbc_rate", "mosaic_size", "mosaic_rate", "mosaic_columns", "mosaic_proxy",
+        };
+        for (const char* key : keys) {
+            CHECK(text.find("\n" + std::string(key) + " = ") != std::string::npos);
+        }
+
+        std::vector<BridgeDefinition> parsed;
+        std::string error;
+        CHECK(Parse(text, parsed, error));
+        CHECK(error.empty());
+        CHECK(parsed.size() == bridges.size());
+        for (size_t i = 0; i < parsed.size() && i < bridges.size(); i++) {
+            CHECK(SameDefinition(parsed[i], bridges[i]));
+        }
+
+        // Defaults survive too, including the keep-the-source-size settings
+        BridgeDefinition plain;
+        plain.id = "plain";
+        plain.name = "Plain";
+        plain.source = "Camera";
+        std::ostringstream plainOutput;
+        WriteBridgeConfig(plainOutput, { plain });
+        CHECK(Parse(plainOutput.str(), parsed, error) && parsed.size() == 1 && SameDefinition(parsed[0], plain));
+    }
+
+    // Hand-written values: quotes keep ';' and spaces, escapes unescape,
+    // comments after either are dropped, and bad quoting names its line
+    void QuotedValuesParse() {
+        std::vector<BridgeDefinition> bridges;
+        std::string error;
+        CHECK(Parse("[bridge]\n"
+                    "name = \"  A;B \\\"C\\\" \\\\ \"   ; trailing comment\n"
+                    "source = Output #2 ; comment\n"
+                    "receiver_name = \"\"\n",
+                    bridges, error));
+        CHECK(bridges.size() == 1);
+        if (!bridges.empty()) {
+            CHECK(bridges[0].name == "  A;B \"C\" \\ ");
+            CHECK(bridges[0].source == "Output #2");
+            CHECK(bridges[0].options.receiverName.empty());
+        }
+
+        CHECK(!Parse("[bridge]\nname = \"open\nsource = Camera\n", bridges, error));
+        CHECK(error == "line 2: unterminated quoted value");
+        CHECK(!Parse("[bridge]\nname = \"A\" B\nsource = Camera\n", bridges, error));
+        CHECK(error == "line 2: unexpected text after quoted value");
+    }
+
+    // Files from a newer build, and versions that are not versions, are
+    // refused rather than half read; so are unknown keys and sections
+    void NewerOrUnknownIsRejected() {
+        std::vector<BridgeDefinition> bridges;
+        std::string error;
+        const std::string bridge = "\n[bridge]\nname = A\nsource = Camera\n";
+        std::string newer = "version = " + std::to_string(kBridgeConfigVersion + 1) + "\n" + bridge;
+        CHECK(!Parse(newer, bridges, error));
+        CHECK(error.find("line 1: file is version " + std::to_string(kBridgeConfigVersion + 1)) == 0);
+        CHECK(!Parse("version = 0\n" + bridge, bridges, error) && error.find("line 1:") == 0);
+        CHECK(!Parse("version = two\n" + bridge, bridges, error) && error.find("line 1:") == 0);
+        CHECK(Parse("version = " + std::to_string(kBridgeConfigVersion) + "\n" + bridge, bridges, error));
+
+        CHECK(!Parse("[bridge]\nname = A\nsource = Camera\nframe_rate = 30\n", bridges, error));
+        CHECK(error == "line 4: unknown key 'frame_rate'");
+        CHECK(!Parse("[sender]\nname = A\n", bridges, error));
+        CHECK(error == "line 1: unknown section [sender]");
+        CHECK(!Parse("name = A\n", bridges, error));
+        CHECK(error == "line 1: setting outside a [bridge] section");
+        CHECK(!Parse("[bridge]\nsource = Camera\n", bridges, error));
+        CHECK(error == "line 1: bridge is missing a name");
+
+        // A failed parse leaves the caller's list alone
+        CHECK(Parse(bridge, bridges, error) && bridges.size() == 1);
+        CHECK(!Parse(newer, bridges, error) && bridges.size() == 1);
+    }
+
+    // Version 1 files have no ids: each bridge takes its name, with a -2,
+    // -3... suffix on collisions, steering around any explicit ids
+    void VersionOneIdsComeFromNames() {
+        std::vector<BridgeDefinition> bridges;
+        std::string error;
+        CHECK(Parse("version = 1\n"
+                    "[bridge]\nname = Stage\nsource = A\n"
+                    "[bridge]\nname = Stage\nsource = B\n"
+                    "[bridge]\nname = Stage\nsource = C\n"
+                    "[bridge]\nname = Wall\nsource = D\n"
+                    "[bridge]\nid = Stage-3\nname = Other\nsource = E\n",
+                    bridges, error));
+        CHECK(bridges.size() == 5);
+        if (bridges.size() == 5) {
+            CHECK(bridges[0].id == "Stage");
+            CHECK(bridges[1].id == "Stage-2");
+            CHECK(bridges[2].id == "Stage-4");
+            CHECK(bridges[3].id == "Wall");
+            CHECK(bridges[4].id == "Stage-3");
+        }
+
+        // A missing version reads as version 1
+        CHECK(Parse("[bridge]\nname = Stage\nsource = A\n[bridge]\nname = Stage\nsource = B\n", bridges, error));
+        CHECK(bridges.size() == 2 && bridges[0].id == "Stage" && bridges[1].id == "Stage-2");
+    }
+
+    void DuplicateIdsAreRejected() {
+        std::vector<BridgeDefinition> bridges;
+        std::string error;
+        CHECK(!Parse("version = 2\n"
+                     "[bridge]\nid = abc\nname = A\nsource = Camera\n"
+                     "[bridge]\nid = abc\nname = B\nsource = Camera\n",
+                     bridges, error));
+        CHECK(error == "duplicate bridge id 'abc'");
+        CHECK(!Parse("[bridge]\nid =\nname = A\nsource = Camera\n", bridges, error));
+        CHECK(error == "line 2: id must not be empty");
+    }
+
+    std::string ReadFile(const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    bool FileExists(const std::string& path) {
+        std::ifstream file(path);
+        return (bool)file;
+    }
+
+    // Saving over an existing file replaces it whole, creating the directory
+    // the first time, and leaves no temporary file behind
+    void SaveReplacesExistingFile() {
+        const std::string directory = "BridgeConfigTests.out";
+        const std::string path = directory + "/nested/bridges.ini";
+        remove(path.c_str());
+
+        std::vector<BridgeDefinition> bridges = EveryKey();
+        std::string error;
+        CHECK(SaveBridgeConfig(path, bridges, error));
+        CHECK(error.empty());
+        CHECK(FileExists(path) && !FileExists(path + ".tmp"));
+
+        bridges.pop_back();
+        bridges[0].name = "Renamed";
+        CHECK(SaveBridgeConfig(path, bridges, error));
+        CHECK(!FileExists(path + ".tmp"));
+        std::ostringstream expected;
+        WriteBridgeConfig(expected, bridges);
+        CHECK(ReadFile(path) == expected.str());
+
+        std::vector<BridgeDefinition> loaded;
+        CHECK(LoadBridgeConfig(path, loaded, error));
+        CHECK(loaded.size() == 1 && SameDefinition(loaded[0], bridges[0]));
+
+        CHECK(!LoadBridgeConfig(directory + "/missing.ini", loaded, error));
+        CHECK(error == "cannot open " + directory + "/missing.ini");
+        remove(path.c_str());
+    }
+}
+
+int main() {
+    RUN_TEST(EveryKeyRoundTrips);
+    RUN_TEST(QuotedValuesParse);
+    RUN_TEST(NewerOrUnknownIsRejected);
+    RUN_TEST(VersionOneIdsComeFromNames);
+    RUN_TEST(DuplicateIdsAreRejected);
+    RUN_TEST(SaveReplacesExistingFile);
+    return TestResult();
+}
@@ -0,0 +1,259 @@
+#include "BridgeInstance.h"
+#include "FakeBackend.h"
+#include "MetricsServer.h"
+#include "TestCheck.h"
+#include "TestPattern.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    const char* const kBarsSource = "pattern:bars,320x180,30";
+
+    bool WaitFor(const std::function<bool()>& condition, int timeoutMs = 5000) {
+        for (int waited = 0; waited < timeoutMs; waited += 10) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return condition();
+    }
+
+    std::unique_ptr<BridgeInstance> StartBridge(const std::shared_ptr<FakeBackend>& backend, const char* source,
+                                                bool isSpoutToNDI, const BridgeOptions& options) {
+        auto bridge = std::make_unique<BridgeInstance>();
+        bridge->SetBackend(backend);
+        bridge->SetId("test");
+        CHECK(bridge->Start(source, "Test Output", isSpoutToNDI, ColorSpace::BGRA, options));
+        return bridge;
+    }
+
+    // Bottom row of the bars the pattern source sends, with red and blue swapped
+    std::vector<unsigned char> SwappedBarsRow() {
+        PatternSettings settings;
+        std::string error;
+        ParsePatternSourceName(kBarsSource, settings, error);
+        PatternGenerator generator(settings);
+        std::vector<unsigned char> pixels(generator.GetFrameBytes());
+        generator.Render(pixels.data(), 0);
+        size_t stride = generator.GetStrideBytes();
+        std::vector<unsigned char> row(pixels.end() - stride, pixels.end());
+        for (size_t i = 0; i < row.size(); i += 4) std::swap(row[i], row[i + 2]);
+        return row;
+    }
+
+    // Every path through the bridge, shared capture or not and whole frame or
+    // dirty tiles, hands the sink the source pixels with red and blue swapped
+    void RunSwapsRedAndBlue(bool isSpoutToNDI) {
+        const std::vector<unsigned char> expected = SwappedBarsRow();
+        for (int path = 0; path < 3; path++) {
+            BridgeOptions options;
+            options.shareCapture = path == 0;
+            options.dirtyTiles = path == 1;
+            auto backend = std::make_shared<FakeBackend>();
+            auto bridge = StartBridge(backend, kBarsSource, isSpoutToNDI, options);
+            CHECK(WaitFor([&] { return bridge->GetStats().framesOut >= 5; }));
+            bridge->Stop();
+
+            std::vector<FakeSinkReport> sinks = backend->GetSinkReports();
+            CHECK(sinks.size() == 1);
+            if (sinks.empty()) continue;
+            CHECK(sinks[0].frames == bridge->GetStats().framesOut);
+            CHECK(sinks[0].width == 320 && sinks[0].height == 180);
+            CHECK(sinks[0].stamped == sinks[0].frames);
+            CHECK(sinks[0].lastRow == expected);
+
+            // Shared frames arrive converted, so they neither convert nor
+            // reuse pixels as far as the dirty-tile counters go
+            BridgeStats stats = bridge->GetStats();
+            CHECK(options.shareCapture ? stats.pixelsConverted == 0 && stats.pixelsReused == 0
+                                       : stats.pixelsConverted > 0);
+        }
+    }
+
+    void SpoutToNDISwapsRedAndBlue() {
+        RunSwapsRedAndBlue(true);
+    }
+
+    void NDIToSpoutSwapsRedAndBlue() {
+        RunSwapsRedAndBlue(false);
+    }
+
+    // A bridge left on the default options reconverts only the tiles a small
+    // moving box touches, and opens its own receiver rather than a shared one
+    void DefaultOptionsUseDirtyTiles() {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        sourceSettings.frameRate = 60.0;
+        sourceSettings.changeBoxSize = 16;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings);
+        auto bridge = StartBridge(backend, "Camera", true, BridgeOptions());
+        CHECK(WaitFor([&] { return bridge->GetStats().framesOut >= 10; }));
+        CHECK(GetSharedCaptureCount() == 0);
+        bridge->Stop();
+
+        BridgeStats stats = bridge->GetStats();
+        CHECK(stats.tilesTotal > 0 && stats.tilesDirty < stats.tilesTotal);
+        CHECK(stats.pixelsReused > stats.pixelsConverted);
+    }
+
+    // A bridge that can't keep up with a receiver holding two frames loses
+    // the rest; the gaps in the frame counter are counted as drops
+    void RunCountsSequenceGaps(bool isSpoutToNDI) {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        sourceSettings.frameRate = 60.0;
+        sourceSettings.pollIntervalMs = 40;
+        sourceSettings.receiveQueueFrames = 2;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings);
+        BridgeOptions options;
+        options.shareCapture = false;
+        auto bridge = StartBridge(backend, "Camera", isSpoutToNDI, options);
+        CHECK(WaitFor([&] { return bridge->GetStats().framesOut >= 10; }));
+        bridge->Stop();
+
+        BridgeStats stats = bridge->GetStats();
+        std::vector<FakeSinkReport> sinks = backend->GetSinkReports();
+        CHECK(sinks.size() == 1);
+        CHECK(stats.drops > 0);
+        if (!sinks.empty()) {
+            // Every sequence number up to the last one sent was captured or dropped
+            CHECK(stats.framesIn + stats.drops >= (uint64_t)sinks[0].lastSequence);
+            CHECK(stats.framesIn + stats.drops <= (uint64_t)sinks[0].lastSequence + 1);
+        }
+        if (!isSpoutToNDI) {
+            CHECK(stats.receiverDrops > 0 && stats.receiverDrops <= stats.drops);
+        }
+    }
+
+    void SpoutToNDICountsSequenceGaps() {
+        RunCountsSequenceGaps(true);
+    }
+
+    void NDIToSpoutCountsSequenceGaps() {
+        RunCountsSequenceGaps(false);
+    }
+
+    // What an NDI receiver throws away before capture reaches the bridge
+    // stats and the metrics endpoint, apart from frames the bridge passed over
+    void ReceiverDropsAreExported() {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        sourceSettings.frameRate = 60.0;
+        sourceSettings.burstFrames = 5;
+        sourceSettings.receiveQueueFrames = 3;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings);
+        BridgeOptions options;
+        options.shareCapture = false;
+        auto bridge = StartBridge(backend, "Camera", false, options);
+        CHECK(WaitFor([&] { return bridge->GetStats().framesOut >= 5; }));
+        bridge->Stop();
+
+        BridgeStats stats = bridge->GetStats();
+        CHECK(stats.receiverDrops > 0);
+        CHECK(stats.skippedFrames > 0);
+        CHECK(stats.drops >= stats.receiverDrops);
+
+        std::string text = RenderOpenMetrics({ bridge->GetMetrics() }, 0.0);
+        std::string sample = "ndispout_bridge_receiver_dropped_frames_total{bridge=\"Test Output\",bridge_id=\"test\","
+                             "source=\"Camera\","
+                             "direction=\"ndi_to_spout\"} " + std::to_string(stats.receiverDrops) + "\n";
+        CHECK(text.find(sample) != std::string::npos);
+    }
+    uint64_t SinkFrames(const FakeBackend& backend) {
+        std::vector<FakeSinkReport> sinks = backend.GetSinkReports();
+        return sinks.empty() ? 0 : sinks[0].frames;
+    }
+
+    // Nobody receives the output: the bridge stops capturing apart from one
+    // frame each idleFrameMs. When a receiver connects, the next frame goes
+    // out at once and converted whole, not as the tiles changed since the
+    // last idle frame.
+    void IdleBridgeSendsOnlyIdleFrames() {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        sourceSettings.frameRate = 60.0;
+        sourceSettings.changeEvery = 1000000;     // Still, so a watched bridge sends only the first frame
+        sourceSettings.receiveQueueFrames = 1;
+        FakeSinkSettings sinkSettings;
+        sinkSettings.connections = 0;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings, sinkSettings);
+        BridgeOptions options;
+        options.idleFrameMs = 250;
+        auto bridge = StartBridge(backend, "Camera", true, options);
+        CHECK(WaitFor([&] { return bridge->GetStats().idle == 1; }));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        BridgeStats before = bridge->GetStats();
+        uint64_t framesBefore = SinkFrames(*backend);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        BridgeStats after = bridge->GetStats();
+        uint64_t idleFrames = SinkFrames(*backend) - framesBefore;
+        CHECK(idleFrames >= 2 && idleFrames <= 5);
+        CHECK(after.framesIn - before.framesIn <= idleFrames + 1);
+        CHECK(after.idle == 1 && after.idleNs > before.idleNs);
+
+        uint64_t framesIdle = SinkFrames(*backend);
+        std::chrono::steady_clock::time_point connected = std::chrono::steady_clock::now();
+        backend->SetSinkConnections("Test Output", 1);
+        CHECK(WaitFor([&] { return SinkFrames(*backend) > framesIdle; }, 1000));
+        auto waited = std::chrono::steady_clock::now() - connected;
+        CHECK(waited < std::chrono::milliseconds(200));
+        CHECK(WaitFor([&] { return bridge->GetStats().idle == 0; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bridge->Stop();
+
+        // Idle frames of a still source reconvert nothing; the first watched
+        // frame converts every pixel, and the rest are skipped as unchanged
+        BridgeStats watched = bridge->GetStats();
+        CHECK(watched.pixelsConverted - after.pixelsConverted == 320u * 180u);
+        CHECK(watched.framesOut - after.framesOut <= 2);
+    }
+
+    // An idle frame the source fails to deliver is retried on the next
+    // pass rather than skipped until idleFrameMs comes round again. Three
+    // captures in four find the sender away.
+    void IdleFrameRetriesFailedCapture() {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        sourceSettings.frameRate = 60.0;
+        sourceSettings.disconnectEvery = 4;
+        sourceSettings.disconnectFrames = 3;
+        FakeSinkSettings sinkSettings;
+        sinkSettings.connections = 0;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings, sinkSettings);
+        BridgeOptions options;
+        options.idleFrameMs = 200;
+        auto bridge = StartBridge(backend, "Camera", true, options);
+        CHECK(WaitFor([&] { return bridge->GetStats().idle == 1; }));
+
+        // A frame about every 500 ms: due after 200, then three failed
+        // captures 100 ms apart; skipping to the next due time would give
+        // one every 800 ms
+        uint64_t framesBefore = SinkFrames(*backend);
+        std::this_thread::sleep_for(std::chrono::milliseconds(3000));
+        uint64_t idleFrames = SinkFrames(*backend) - framesBefore;
+        bridge->Stop();
+        CHECK(idleFrames >= 5 && idleFrames <= 7);
+    }
+}
+
+int main() {
+    RUN_TEST(SpoutToNDISwapsRedAndBlue);
+    RUN_TEST(NDIToSpoutSwapsRedAndBlue);
+    RUN_TEST(DefaultOptionsUseDirtyTiles);
+    RUN_TEST(SpoutToNDICountsSequenceGaps);
+    RUN_TEST(NDIToSpoutCountsSequenceGaps);
+    RUN_TEST(ReceiverDropsAreExported);
+    RUN_TEST(IdleBridgeSendsOnlyIdleFrames);
+    RUN_TEST(IdleFrameRetriesFailedCapture);
+    return TestResult();
+}
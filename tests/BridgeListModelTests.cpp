@@ -0,0 +1,126 @@
+#include "BridgeListModel.h"
+#include "TestCheck.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    std::shared_ptr<BridgeMetrics> MakeMetrics(const std::string& name) {
+        auto metrics = std::make_shared<BridgeMetrics>();
+        metrics->bridgeName = name;
+        metrics->sourceName = name + " source";
+        metrics->direction = "spout_to_ndi";
+        return metrics;
+    }
+
+    BridgeListEntry Entry(const std::shared_ptr<BridgeMetrics>& metrics, bool running = true) {
+        BridgeListEntry entry;
+        entry.metrics = metrics;
+        entry.colorSpace = "BT.709";
+        entry.running = running;
+        return entry;
+    }
+
+    void RefreshReturnsOnlyChangedRows() {
+        auto a = MakeMetrics("A");
+        auto b = MakeMetrics("B");
+        auto c = MakeMetrics("C");
+        BridgeListModel model;
+        model.Reset({ Entry(a), Entry(b), Entry(c) });
+        CHECK(model.GetRowCount() == 3);
+        CHECK(model.GetText(0, BridgeListColumn::State) == "Waiting");
+
+        // Nothing moved
+        CHECK(model.Refresh().empty());
+
+        // New input on B only
+        b->counters.AddFramesIn();
+        std::vector<int> changed = model.Refresh();
+        CHECK(changed == std::vector<int>{ 1 });
+        CHECK(model.GetText(1, BridgeListColumn::State) == "Streaming");
+
+        // B waits again, C drops a frame
+        c->counters.AddDrops(3);
+        changed = model.Refresh();
+        CHECK((changed == std::vector<int>{ 1, 2 }));
+        CHECK(model.GetText(2, BridgeListColumn::Drops) == "3");
+
+        // A latency sample shows once, then the window empties
+        a->latency[(int)LatencyMetric::EndToEnd].Record(12000000);
+        changed = model.Refresh();
+        CHECK(changed == std::vector<int>{ 0 });
+        CHECK(model.GetText(0, BridgeListColumn::Latency).compare(0, 2, "12") == 0);
+        CHECK(model.Refresh() == std::vector<int>{ 0 });
+        CHECK(model.GetText(0, BridgeListColumn::Latency) == "-");
+        CHECK(model.Refresh().empty());
+    }
+
+    // A row keeps its latency window and input count when the list is rebuilt
+    // around it, so a Reset neither replays old samples nor flickers the state
+    void ResetCarriesLiveStateOver() {
+        auto a = MakeMetrics("A");
+        auto b = MakeMetrics("B");
+        BridgeListModel model;
+        model.Reset({ Entry(a), Entry(b) });
+
+        a->latency[(int)LatencyMetric::EndToEnd].Record(40000000);
+        a->counters.AddFramesIn();
+        model.Refresh();
+        CHECK(model.GetText(0, BridgeListColumn::Latency) != "-");
+
+        // A moves down behind a new bridge; its samples were already shown
+        auto added = MakeMetrics("New");
+        added->latency[(int)LatencyMetric::EndToEnd].Record(5000000);
+        model.Reset({ Entry(b), Entry(added), Entry(a) });
+        CHECK(model.GetRowCount() == 3);
+        CHECK(model.GetText(2, BridgeListColumn::Name) == "A");
+        CHECK(model.GetText(2, BridgeListColumn::Latency) == "-");
+        CHECK(model.GetText(2, BridgeListColumn::State) == "Waiting");
+
+        // The new row starts its window at zero and shows what it has so far
+        CHECK(model.GetText(1, BridgeListColumn::Latency).compare(0, 1, "5") == 0);
+
+        // A restarted bridge brings a new metrics object and a fresh window
+        auto restarted = MakeMetrics("A");
+        restarted->latency[(int)LatencyMetric::EndToEnd].Record(40000000);
+        model.Reset({ Entry(b), Entry(added), Entry(restarted) });
+        CHECK(model.GetText(2, BridgeListColumn::Latency).compare(0, 2, "40") == 0);
+    }
+
+    void StoppedRowsShowNoLiveValues() {
+        auto a = MakeMetrics("A");
+        a->counters.AddFramesIn(10);
+        a->counters.AddDrops(1);
+        a->latency[(int)LatencyMetric::EndToEnd].Record(1000000);
+        BridgeListModel model;
+        model.Reset({ Entry(a, false) });
+        CHECK(model.GetText(0, BridgeListColumn::State) == "Stopped");
+        CHECK(model.GetText(0, BridgeListColumn::Fps) == "-");
+        CHECK(model.GetText(0, BridgeListColumn::Latency) == "-");
+        CHECK(model.GetText(0, BridgeListColumn::Drops) == "1");
+        CHECK(model.GetText(5, BridgeListColumn::Name).empty());
+    }
+
+    // The share of frames skipped as unchanged and the time that saved
+    void SkippedColumnShowsDuplicateSavings() {
+        auto a = MakeMetrics("A");
+        BridgeListModel model;
+        model.Reset({ Entry(a) });
+        CHECK(model.GetText(0, BridgeListColumn::Skipped) == "-");
+
+        a->counters.AddFramesIn(4);
+        a->counters.AddDuplicates(3);
+        a->counters.RecordStage(PipelineStage::Convert, 1500000000);
+        a->counters.RecordStage(PipelineStage::Send, 500000000);
+        CHECK(model.Refresh() == std::vector<int>{ 0 });
+        CHECK(model.GetText(0, BridgeListColumn::Skipped) == "75% (6.0 s)");
+    }
+}
+
+int main() {
+    RUN_TEST(RefreshReturnsOnlyChangedRows);
+    RUN_TEST(ResetCarriesLiveStateOver);
+    RUN_TEST(StoppedRowsShowNoLiveValues);
+    RUN_TEST(SkippedColumnShowsDuplicateSavings);
+    return TestResult();
+}
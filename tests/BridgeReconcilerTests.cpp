@@ -0,0 +1,193 @@
+#include "BridgeReconciler.h"
+#include "FakeBackend.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    BridgeDefinition Definition(const std::string& id, const std::string& source) {
+        BridgeDefinition definition;
+        definition.id = id;
+        definition.name = "Bridge " + id;
+        definition.source = source;
+        return definition;
+    }
+
+    // a unchanged, b renamed, c moved to another source, e new, d gone
+    void Definitions(std::vector<BridgeDefinition>& current, std::vector<BridgeDefinition>& desired) {
+        current = { Definition("a", "Camera A"), Definition("b", "Camera B"), Definition("c", "Camera C"),
+                    Definition("d", "Camera D") };
+        desired = { current[0], current[1], current[2], Definition("e", "Camera E") };
+        desired[1].name = "Renamed";
+        desired[2].source = "Camera C2";
+    }
+
+    bool WaitFor(const std::function<bool()>& condition, int timeoutMs = 5000) {
+        for (int waited = 0; waited < timeoutMs; waited += 10) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return condition();
+    }
+
+    void PlanCoversEveryKindOfChange() {
+        std::vector<BridgeDefinition> current, desired;
+        Definitions(current, desired);
+        std::vector<BridgeChangeStep> steps = PlanBridgeChanges(current, desired);
+        CHECK(steps.size() == 5);
+        if (steps.size() != 5) return;
+        CHECK(steps[0].change == BridgeChange::Unchanged && steps[0].currentIndex == 0 && steps[0].desiredIndex == 0);
+        CHECK(steps[1].change == BridgeChange::Update && steps[1].currentIndex == 1);
+        CHECK(steps[2].change == BridgeChange::Restart && steps[2].currentIndex == 2);
+        CHECK(steps[3].change == BridgeChange::Add && steps[3].currentIndex == -1 && steps[3].desiredIndex == 3);
+        CHECK(steps[4].change == BridgeChange::Remove && steps[4].id == "d" && steps[4].desiredIndex == -1);
+    }
+
+    void PlanClassifiesOptions() {
+        BridgeDefinition base = Definition("a", "Camera A");
+        BridgeDefinition tuned = base;
+        tuned.options.duplicateFilter.keepAliveMs += 100;
+        CHECK(ClassifyBridgeChange(base, tuned) == BridgeChange::Update);
+        tuned = base;
+        tuned.options.shareCapture = !base.options.shareCapture;
+        CHECK(ClassifyBridgeChange(base, tuned) == BridgeChange::Restart);
+        tuned = base;
+        tuned.isSpoutToNDI = !base.isSpoutToNDI;
+        CHECK(ClassifyBridgeChange(base, tuned) == BridgeChange::Restart);
+        CHECK(ClassifyBridgeChange(base, base) == BridgeChange::Unchanged);
+    }
+
+    // Empty and repeated ids can't match a running bridge, so they are added
+    void PlanAddsUnmatchedIds() {
+        std::vector<BridgeDefinition> current = { Definition("a", "Camera A"), Definition("", "Camera X") };
+        std::vector<BridgeDefinition> desired = { Definition("a", "Camera A"), Definition("a", "Camera A"),
+                                                  Definition("", "Camera X") };
+        std::vector<BridgeChangeStep> steps = PlanBridgeChanges(current, desired);
+        CHECK(steps.size() == 4);
+        if (steps.size() != 4) return;
+        CHECK(steps[0].change == BridgeChange::Unchanged);
+        CHECK(steps[1].change == BridgeChange::Add);
+        CHECK(steps[2].change == BridgeChange::Add);
+        CHECK(steps[3].change == BridgeChange::Remove && steps[3].currentIndex == 1);
+    }
+
+    void ReconcileTouchesOnlyChangedBridges() {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        sourceSettings.frameRate = 30.0;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings);
+        SetDefaultFrameBackend(backend);
+
+        std::vector<BridgeDefinition> current, desired;
+        Definitions(current, desired);
+        std::vector<std::string> errors;
+        BridgeList bridges = StartBridges(current, errors);
+        CHECK(errors.empty());
+        CHECK(bridges.size() == 4);
+        if (bridges.size() != 4) {
+            SetDefaultFrameBackend(nullptr);
+            return;
+        }
+        CHECK(WaitFor([&] { return bridges[0]->GetStats().framesOut >= 5; }));
+
+        std::map<std::string, BridgeInstance*> before;
+        for (const auto& bridge : bridges) before[bridge->GetId()] = bridge.get();
+        uint64_t framesBefore = bridges[0]->GetStats().framesOut;
+        CHECK(bridges[0]->GetStats().drops == 0);
+
+        ReconcileSummary summary = ReconcileBridges(bridges, desired);
+        CHECK(summary.errors.empty());
+        CHECK(summary.unchanged == 1 && summary.updated == 1 && summary.restarted == 1);
+        CHECK(summary.added == 1 && summary.removed == 1);
+        CHECK(FormatReconcileSummary(summary) == "1 updated, 1 restarted, 1 added, 1 removed, 1 unchanged");
+
+        CHECK(bridges.size() == 4);
+        if (bridges.size() == 4) {
+            CHECK(bridges[0]->GetId() == "a" && bridges[1]->GetId() == "b");
+            CHECK(bridges[2]->GetId() == "c" && bridges[3]->GetId() == "e");
+
+            // Unchanged and updated bridges are the same running instances;
+            // the restarted one is the same object started again
+            CHECK(bridges[0].get() == before["a"]);
+            CHECK(bridges[1].get() == before["b"]);
+            CHECK(bridges[2].get() == before["c"]);
+            CHECK(bridges[1]->GetBridgeName() == "Renamed");
+            CHECK(bridges[2]->GetSourceName() == "Camera C2");
+
+            // The untouched bridge kept its counters and kept streaming through
+            // it all, without losing a frame
+            CHECK(bridges[0]->IsRunning());
+            CHECK(bridges[0]->GetStats().framesOut >= framesBefore);
+            CHECK(WaitFor([&] { return bridges[0]->GetStats().framesOut >= framesBefore + 5; }));
+            CHECK(bridges[0]->GetStats().drops == 0);
+            CHECK(WaitFor([&] { return bridges[3]->GetStats().framesOut > 0; }));
+            CHECK(WaitFor([&] { return bridges[2]->GetStats().framesOut > 0; }));
+        }
+
+        // Reconciling to the same set again changes nothing, and the
+        // untouched bridge is still streaming
+        uint64_t framesAgain = bridges.empty() ? 0 : bridges[0]->GetStats().framesOut;
+        summary = ReconcileBridges(bridges, DescribeBridges(bridges));
+        CHECK(summary.unchanged == bridges.size());
+        CHECK(FormatReconcileSummary(summary) == "no changes");
+        if (!bridges.empty()) {
+            CHECK(WaitFor([&] { return bridges[0]->GetStats().framesOut >= framesAgain + 5; }));
+            CHECK(bridges[0]->GetStats().drops == 0);
+        }
+
+        for (auto& bridge : bridges) bridge->RequestStop();
+        for (auto& bridge : bridges) bridge->Stop();
+        SetDefaultFrameBackend(nullptr);
+    }
+
+    // A stopped bridge (as a failed restart leaves it) stays listed and is
+    // started again by the next reconcile
+    void ReconcileKeepsAndRestartsStoppedBridges() {
+        FakeSourceSettings sourceSettings;
+        sourceSettings.width = 320;
+        sourceSettings.height = 180;
+        auto backend = std::make_shared<FakeBackend>(sourceSettings);
+        SetDefaultFrameBackend(backend);
+
+        std::vector<std::string> errors;
+        BridgeList bridges = StartBridges({ Definition("a", "Camera A") }, errors);
+        CHECK(bridges.size() == 1);
+        if (bridges.size() == 1) {
+            bridges[0]->Stop();
+            std::vector<BridgeDefinition> desired = DescribeBridges(bridges);
+            desired[0].name = "Retuned";
+            ReconcileSummary summary = ReconcileBridges(bridges, desired);
+            CHECK(bridges.size() == 1);
+            CHECK(summary.errors.empty());
+            CHECK(bridges.size() == 1 && bridges[0]->IsRunning() && bridges[0]->GetBridgeName() == "Retuned");
+
+            // Stopped with nothing to change is started again too
+            bridges[0]->Stop();
+            summary = ReconcileBridges(bridges, DescribeBridges(bridges));
+            CHECK(summary.errors.empty());
+            CHECK(summary.restarted == 1 && summary.unchanged == 0);
+            CHECK(bridges.size() == 1 && bridges[0]->IsRunning());
+            if (bridges.size() == 1) {
+                uint64_t framesBefore = bridges[0]->GetStats().framesOut;
+                CHECK(WaitFor([&] { return bridges[0]->GetStats().framesOut > framesBefore; }));
+            }
+            for (auto& bridge : bridges) bridge->Stop();
+        }
+        SetDefaultFrameBackend(nullptr);
+    }
+}
+
+int main() {
+    RUN_TEST(PlanCoversEveryKindOfChange);
+    RUN_TEST(PlanClassifiesOptions);
+    RUN_TEST(PlanAddsUnmatchedIds);
+    RUN_TEST(ReconcileTouchesOnlyChangedBridges);
+    RUN_TEST(ReconcileKeepsAndRestartsStoppedBridges);
+    return TestResult();
+}
@@ -0,0 +1,170 @@
+#include "FakeBackend.h"
+#include "FrameFanOut.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    bool WaitFor(const std::function<bool()>& condition, int timeoutMs = 5000) {
+        for (int waited = 0; waited < timeoutMs; waited += 10) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return condition();
+    }
+
+    std::shared_ptr<FakeBackend> MakeBackend() {
+        FakeSourceSettings settings;
+        settings.width = 320;
+        settings.height = 180;
+        settings.frameRate = 30.0;
+        return std::make_shared<FakeBackend>(settings);
+    }
+
+    std::vector<std::unique_ptr<FrameSource>> Subscribe(const std::shared_ptr<FakeBackend>& backend, size_t count) {
+        std::vector<std::unique_ptr<FrameSource>> sources;
+        for (size_t i = 0; i < count; i++) {
+            sources.push_back(CreateSharedSource(backend, FrameEndpoint::Spout, "Camera", ReceiveSettings()));
+            CHECK(sources.back() && sources.back()->Open());
+        }
+        return sources;
+    }
+
+    // Capture until a frame arrives; its sequence number, or -1 on timeout
+    int64_t NextSequence(FrameSource& source) {
+        for (int attempt = 0; attempt < 50; attempt++) {
+            VideoFrame frame;
+            if (source.Capture(frame, 100) == CaptureResult::Frame) {
+                int64_t sequence = frame.sequence;
+                source.Release(frame);
+                return sequence;
+            }
+        }
+        return -1;
+    }
+
+    void SubscribersShareOneCapture() {
+        auto backend = MakeBackend();
+        {
+            std::vector<std::unique_ptr<FrameSource>> sources = Subscribe(backend, 4);
+            for (auto& source : sources) {
+                CHECK(source->IsShared());
+                CHECK(NextSequence(*source) > 0);
+            }
+            CHECK(GetSharedCaptureCount() == 1);
+
+            std::vector<FakeSourceReport> reports = backend->GetSourceReports();
+            CHECK(reports.size() == 1);
+            if (!reports.empty()) {
+                CHECK(reports[0].name == "Camera");
+                CHECK(reports[0].created == 1 && reports[0].opens == 1 && reports[0].openNow == 1);
+            }
+
+            // Subscribers converting the same frame share the one conversion.
+            // Both queues hold the newest frame once they have caught up
+            VideoFrame a, b;
+            bool same = false;
+            for (int attempt = 0; attempt < 10 && !same; attempt++) {
+                CHECK(sources[0]->Capture(a, 1000) == CaptureResult::Frame);
+                CHECK(sources[1]->Capture(b, 1000) == CaptureResult::Frame);
+                same = a.sequence == b.sequence;
+                if (!same) {
+                    sources[0]->Release(a);
+                    sources[1]->Release(b);
+                }
+            }
+            CHECK(same);
+            if (same) {
+                std::shared_ptr<const VideoFrame> first = sources[0]->Convert(a, PixelFormat::BGRA);
+                std::shared_ptr<const VideoFrame> second = sources[1]->Convert(b, PixelFormat::BGRA);
+                CHECK(first && first == second);
+                CHECK(first && first->format == PixelFormat::BGRA);
+                sources[0]->Release(a);
+                sources[1]->Release(b);
+            }
+        }
+        CHECK(WaitFor([] { return GetSharedCaptureCount() == 0; }));
+        std::vector<FakeSourceReport> reports = backend->GetSourceReports();
+        CHECK(reports.size() == 1 && reports[0].openNow == 0);
+    }
+
+    // A subscriber that holds a frame and stops capturing for a second loses
+    // frames from its own queue; the others keep getting every frame
+    void SlowSubscriberDoesNotStallOthers() {
+        auto backend = MakeBackend();
+        std::vector<std::unique_ptr<FrameSource>> sources = Subscribe(backend, 3);
+        VideoFrame held;
+        CHECK(sources[0]->Capture(held, 1000) == CaptureResult::Frame);
+        int64_t heldSequence = held.sequence;
+
+        std::vector<std::thread> readers;
+        std::vector<uint64_t> frames(2, 0), gaps(2, 0);
+        auto stopAt = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        for (int i = 0; i < 2; i++) {
+            readers.emplace_back([&, i] {
+                FrameSource& source = *sources[i + 1];
+                int64_t last = -1;
+                while (std::chrono::steady_clock::now() < stopAt) {
+                    VideoFrame frame;
+                    if (source.Capture(frame, 100) != CaptureResult::Frame) continue;
+                    if (last >= 0 && frame.sequence > last + 1) gaps[i] += frame.sequence - last - 1;
+                    last = frame.sequence;
+                    frames[i]++;
+                    source.Release(frame);
+                }
+            });
+        }
+        for (auto& reader : readers) reader.join();
+
+        for (int i = 0; i < 2; i++) {
+            CHECK(frames[i] >= 20);
+            CHECK(gaps[i] == 0);
+        }
+
+        // The slow one picks up the newest frame, not a backlog
+        sources[0]->Release(held);
+        int64_t next = NextSequence(*sources[0]);
+        CHECK(next > heldSequence + 20);
+        CHECK(GetSharedCaptureCount() == 1);
+    }
+
+    // Frames that arrive five at a time: CaptureNewest keeps the last of
+    // each burst and passes over the four before it, and a receiver that
+    // holds only three has already thrown the first two away
+    void CaptureNewestTakesTheLastOfABurst() {
+        for (unsigned int receiveQueue : { 0u, 3u }) {
+            FakeSourceSettings settings;
+            settings.width = 320;
+            settings.height = 180;
+            settings.frameRate = 60.0;
+            settings.burstFrames = 5;
+            settings.receiveQueueFrames = receiveQueue;
+            auto backend = std::make_shared<FakeBackend>(settings);
+            std::unique_ptr<FrameSource> source = backend->CreateSource(FrameEndpoint::NDI, "Camera", ReceiveSettings());
+            CHECK(source && source->Open());
+            if (!source) continue;
+
+            uint64_t expectedSkipped = receiveQueue ? receiveQueue - 1 : 4;
+            for (int64_t burst = 1; burst <= 3; burst++) {
+                VideoFrame frame;
+                uint64_t skipped = 0;
+                CHECK(CaptureNewest(*source, frame, 1000, skipped) == CaptureResult::Frame);
+                CHECK(frame.sequence == burst * 5);
+                CHECK(skipped == expectedSkipped);
+                CHECK(source->GetQueuedFrames() == 0);
+                source->Release(frame);
+                CHECK(source->GetReceiverStats().framesDropped == (uint64_t)burst * (4 - expectedSkipped));
+            }
+        }
+    }
+}
+
+int main() {
+    RUN_TEST(SubscribersShareOneCapture);
+    RUN_TEST(SlowSubscriberDoesNotStallOthers);
+    RUN_TEST(CaptureNewestTakesTheLastOfABurst);
+    return TestResult();
+}
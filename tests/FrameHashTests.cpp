@@ -0,0 +1,146 @@
+#include "DuplicateFilter.h"
+#include "FrameHash.h"
+#include "TestCheck.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+    using Clock = DuplicateFilter::Clock;
+
+    std::vector<unsigned char> Noise(size_t size, uint64_t seed) {
+        std::vector<unsigned char> bytes(size);
+        uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+        for (unsigned char& b : bytes) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            b = (unsigned char)x;
+        }
+        return bytes;
+    }
+
+    // Every length around the 32-byte stripe and 8-byte word boundaries
+    void HashMatchesScalarForAllLengths() {
+        std::vector<unsigned char> bytes = Noise(1100, 1);
+        for (size_t size = 0; size <= 1100; size++) {
+            for (uint64_t seed : { 0ull, 7ull, 0xFFFFFFFFFFFFFFFFull }) {
+                CHECK(FrameHash::Hash(bytes.data(), size, seed) == FrameHash::HashScalar(bytes.data(), size, seed));
+            }
+        }
+        // Unaligned start
+        CHECK(FrameHash::Hash(bytes.data() + 3, 517) == FrameHash::HashScalar(bytes.data() + 3, 517));
+    }
+
+    void HashImageMatchesScalarOnOddWidthsAndPaddedStrides() {
+        const unsigned int widths[] = { 1, 3, 7, 9, 33, 127, 641 };
+        for (unsigned int width : widths) {
+            for (unsigned int padding : { 0u, 4u, 12u, 60u }) {
+                unsigned int height = 37;
+                size_t stride = (size_t)width * 4 + padding;
+                std::vector<unsigned char> pixels = Noise(stride * height, width + padding);
+                for (FrameHash::Mode mode : { FrameHash::Mode::Full, FrameHash::Mode::Sampled }) {
+                    uint64_t simd = FrameHash::HashImage(pixels.data(), width, height, stride, mode);
+                    uint64_t scalar = FrameHash::HashImageScalar(pixels.data(), width, height, stride, mode);
+                    CHECK(simd == scalar);
+                }
+            }
+        }
+    }
+
+    void HashImageIgnoresRowPadding() {
+        const unsigned int width = 33, height = 20;
+        size_t stride = width * 4 + 28;
+        std::vector<unsigned char> pixels = Noise(stride * height, 3);
+        uint64_t before = FrameHash::HashImage(pixels.data(), width, height, stride, FrameHash::Mode::Full);
+        for (unsigned int y = 0; y < height; y++) {
+            pixels[y * stride + width * 4] ^= 0xFF;
+        }
+        CHECK(FrameHash::HashImage(pixels.data(), width, height, stride, FrameHash::Mode::Full) == before);
+
+        pixels[5 * stride + 17] ^= 1;
+        CHECK(FrameHash::HashImage(pixels.data(), width, height, stride, FrameHash::Mode::Full) != before);
+    }
+
+    void SampledModeAlwaysHashesLastRow() {
+        const unsigned int width = 16, height = 21;   // 20 is not a multiple of the row step
+        std::vector<unsigned char> pixels = Noise(width * 4 * height, 4);
+        uint64_t before = FrameHash::HashImage(pixels.data(), width, height, width * 4, FrameHash::Mode::Sampled, 8);
+        pixels[(height - 1) * width * 4] ^= 1;
+        CHECK(FrameHash::HashImage(pixels.data(), width, height, width * 4, FrameHash::Mode::Sampled, 8) != before);
+    }
+
+    void OffPolicySendsEverything() {
+        DuplicateFilterSettings settings;
+        settings.policy = DuplicatePolicy::Off;
+        DuplicateFilter filter(settings);
+        Clock::time_point now = Clock::now();
+        CHECK(!filter.IsEnabled());
+        for (int i = 0; i < 5; i++) {
+            CHECK(filter.ShouldSend(42, now));
+        }
+    }
+
+    // Suppress: identical frames wait for the keep-alive interval, new content goes at once
+    void SuppressHoldsDuplicatesUntilKeepAlive() {
+        DuplicateFilterSettings settings;
+        settings.policy = DuplicatePolicy::Suppress;
+        settings.keepAliveMs = 1000;
+        DuplicateFilter filter(settings);
+        Clock::time_point t0 = Clock::now();
+        CHECK(filter.ShouldSend(1, t0));
+        CHECK(!filter.ShouldSend(1, t0 + std::chrono::milliseconds(16)));
+        CHECK(!filter.ShouldSend(1, t0 + std::chrono::milliseconds(999)));
+        CHECK(filter.ShouldSend(1, t0 + std::chrono::milliseconds(1000)));
+        CHECK(!filter.ShouldSend(1, t0 + std::chrono::milliseconds(1500)));
+        CHECK(filter.ShouldSend(2, t0 + std::chrono::milliseconds(1501)));
+        CHECK(!filter.ShouldSend(2, t0 + std::chrono::milliseconds(1502)));
+        // The keep-alive counts from the last send, including the content change
+        CHECK(filter.ShouldSend(2, t0 + std::chrono::milliseconds(2501)));
+    }
+
+    void RateLimitSpacesDuplicates() {
+        DuplicateFilterSettings settings;
+        settings.policy = DuplicatePolicy::RateLimit;
+        settings.rateLimitMs = 100;
+        DuplicateFilter filter(settings);
+        Clock::time_point t0 = Clock::now();
+        int sent = 0;
+        for (int ms = 0; ms < 1000; ms += 10) {
+            if (filter.ShouldSend(9, t0 + std::chrono::milliseconds(ms))) sent++;
+        }
+        CHECK(sent == 10);
+    }
+
+    void ResetSendsNextFrame() {
+        DuplicateFilter filter;
+        Clock::time_point t0 = Clock::now();
+        CHECK(filter.ShouldSend(5, t0));
+        CHECK(!filter.ShouldSend(5, t0));
+        filter.Reset();
+        CHECK(filter.ShouldSend(5, t0));
+    }
+
+    void SettingsCompareByValue() {
+        DuplicateFilterSettings a, b;
+        CHECK(a == b);
+        b.keepAliveMs = 500;
+        CHECK(a != b);
+        b = a;
+        b.hashMode = FrameHash::Mode::Sampled;
+        CHECK(a != b);
+    }
+}
+
+int main() {
+    printf("FrameHash SIMD path: %s\n", FrameHash::IsAccelerated() ? "on" : "off");
+    RUN_TEST(HashMatchesScalarForAllLengths);
+    RUN_TEST(HashImageMatchesScalarOnOddWidthsAndPaddedStrides);
+    RUN_TEST(HashImageIgnoresRowPadding);
+    RUN_TEST(SampledModeAlwaysHashesLastRow);
+    RUN_TEST(OffPolicySendsEverything);
+    RUN_TEST(SuppressHoldsDuplicatesUntilKeepAlive);
+    RUN_TEST(RateLimitSpacesDuplicates);
+    RUN_TEST(ResetSendsNextFrame);
+    RUN_TEST(SettingsCompareByValue);
+    return TestResult();
+}
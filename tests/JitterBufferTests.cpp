@@ -0,0 +1,196 @@
+#include "JitterBuffer.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    const uint64_t kMs = 1000000ull;
+    const uint64_t kPeriodNs = 20 * kMs;
+
+    // A 160x8 frame whose pixels all hold value, sent at sourceNs
+    struct Frame {
+        std::vector<unsigned char> pixels;
+        VideoFrame frame;
+
+        Frame(int64_t sourceNs, unsigned char value)
+            : pixels(160 * 8 * 4, value)
+        {
+            frame.data = pixels.data();
+            frame.width = 160;
+            frame.height = 8;
+            frame.strideBytes = 160 * 4;
+            frame.frameRateN = 50;
+            frame.frameRateD = 1;
+            frame.sourceTimeNs = sourceNs;
+        }
+    };
+
+    // Frames arriving evenly go out in order, each a copy, and the latency
+    // reported for each covers the capture time before it was pushed
+    void EvenFramesGoOutInOrderWithTheirLatency() {
+        JitterBuffer buffer;
+        uint64_t base = 1000 * kMs;
+        for (int i = 0; i < 5; i++) {
+            Frame frame(i * (int64_t)kPeriodNs, (unsigned char)(i + 1));
+            uint64_t arrivalNs = base + i * kPeriodNs;
+            CHECK(buffer.Push(frame.frame, arrivalNs, 3 * kMs) != JitterPush::Stale);
+            frame.pixels.assign(frame.pixels.size(), 0);   // The buffer holds its own copy
+
+            uint64_t waitedNs = 0, latencyNs = 0, skipped = 0;
+            const VideoFrame* due = buffer.Pop(arrivalNs + kMs, waitedNs, latencyNs, skipped);
+            CHECK(due != nullptr);
+            if (!due) continue;
+            CHECK(due->data[0] == i + 1 && due->strideBytes == 160 * 4);
+            CHECK(skipped == 0);
+            CHECK(waitedNs == kMs);
+            CHECK(latencyNs == 4 * kMs);
+        }
+        CHECK(buffer.GetFrameCount() == 0);
+    }
+
+    void OlderDueFramesArePassedOver() {
+        JitterBuffer buffer;
+        uint64_t base = 1000 * kMs;
+        for (int i = 0; i < 3; i++) {
+            Frame frame(i * (int64_t)kPeriodNs, (unsigned char)(i + 1));
+            buffer.Push(frame.frame, base + i * kPeriodNs, i * kMs);
+        }
+        uint64_t waitedNs = 0, latencyNs = 0, skipped = 0;
+        const VideoFrame* due = buffer.Pop(base + 10 * kPeriodNs, waitedNs, latencyNs, skipped);
+        CHECK(due && due->data[0] == 3);
+        CHECK(skipped == 2);
+        CHECK(waitedNs == 8 * kPeriodNs && latencyNs == waitedNs + 2 * kMs);
+
+        // Anything older than what went out is too late to send
+        Frame old(kPeriodNs, 9);
+        CHECK(buffer.Push(old.frame, base + 11 * kPeriodNs) == JitterPush::Stale);
+        CHECK(buffer.GetMemoryBytes() >= 3 * old.pixels.size());
+    }
+    // Push frame i of an even stream, sent every kPeriodNs, arriving
+    // offsetNs off its slot; then take whatever is due
+    JitterPush PushAt(JitterBuffer& buffer, int64_t i, int64_t offsetNs) {
+        const int64_t base = 1000 * (int64_t)kMs;
+        Frame frame(i * (int64_t)kPeriodNs, (unsigned char)i);
+        uint64_t arrivalNs = (uint64_t)(base + i * (int64_t)kPeriodNs + offsetNs);
+        JitterPush result = buffer.Push(frame.frame, arrivalNs);
+        uint64_t waitedNs = 0, latencyNs = 0, skipped = 0;
+        buffer.Pop(arrivalNs, waitedNs, latencyNs, skipped);
+        return result;
+    }
+
+    // Arrivals 0 or 8 ms late raise the delay to cover them; once they
+    // come evenly again it gives the extra back, a little every frame
+    void DelayFollowsJitterThenDecays() {
+        JitterBuffer buffer;
+        int64_t i = 0;
+        for (; i < 200; i++) {
+            PushAt(buffer, i, (i % 2) * 8 * (int64_t)kMs);
+        }
+        uint64_t peakNs = buffer.GetDelayNs();
+        CHECK(peakNs >= 8 * kMs && peakNs <= 50 * kMs);
+        CHECK(buffer.GetJitterNs() >= 4 * kMs);
+
+        uint64_t previousNs = peakNs;
+        for (int64_t end = i + 1000; i < end; i++) {
+            PushAt(buffer, i, 8 * (int64_t)kMs);
+            CHECK(buffer.GetDelayNs() <= previousNs);
+            previousNs = buffer.GetDelayNs();
+        }
+        CHECK(buffer.GetJitterNs() < kMs);
+        CHECK(buffer.GetDelayNs() < peakNs / 4);
+    }
+
+    // However wild the arrivals, no frame is held past maxLatencyMs after
+    // it arrived, taking each frame as soon as it falls due
+    void DelayNeverExceedsTheCap() {
+        JitterBufferSettings settings;
+        settings.maxLatencyMs = 30;
+        JitterBuffer buffer(settings);
+        uint64_t arrivalNs = 1000 * kMs;
+        uint64_t x = 12345;
+        for (int64_t i = 0; i < 2000; i++) {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+            uint64_t offsetNs = (x >> 33) % (200 * kMs);
+            arrivalNs = std::max(arrivalNs, 1000 * kMs + i * kPeriodNs + offsetNs);
+            while (buffer.GetFrameCount() > 0 && buffer.GetNextReleaseNs() <= arrivalNs) {
+                uint64_t waitedNs = 0, latencyNs = 0, skipped = 0;
+                CHECK(buffer.Pop(buffer.GetNextReleaseNs(), waitedNs, latencyNs, skipped) != nullptr);
+                CHECK(waitedNs <= 30 * kMs);
+            }
+
+            Frame frame(i * (int64_t)kPeriodNs, 1);
+            buffer.Push(frame.frame, arrivalNs);
+            CHECK(buffer.GetDelayNs() <= 30 * kMs);
+            CHECK(buffer.GetNextReleaseNs() <= arrivalNs + 30 * kMs);
+        }
+        CHECK(buffer.GetDelayNs() == 30 * kMs);
+    }
+
+    // A frame that misses its release time says so, and the delay grows by
+    // how late it was
+    void LateFrameIsReported() {
+        JitterBuffer buffer;
+        int64_t i = 0;
+        for (; i < 50; i++) {
+            CHECK(PushAt(buffer, i, 0) == JitterPush::Queued);
+        }
+        CHECK(buffer.GetDelayNs() == 0);
+        CHECK(PushAt(buffer, i, 25 * (int64_t)kMs) == JitterPush::Late);
+        CHECK(buffer.GetDelayNs() >= 25 * kMs);
+    }
+
+    // A frame the network delivered after newer ones never holds back the
+    // frames behind it that are already due
+    void ReorderedFrameDoesNotHoldBackDueFrames() {
+        JitterBuffer buffer;
+        uint64_t base = 1000 * kMs;
+        Frame first(kPeriodNs, 1), second(2 * kPeriodNs, 2), overtaken(0, 9);
+        CHECK(buffer.Push(first.frame, base + kPeriodNs) == JitterPush::Queued);
+        CHECK(buffer.Push(second.frame, base + 2 * kPeriodNs) != JitterPush::Stale);
+        CHECK(buffer.Push(overtaken.frame, base + 2 * kPeriodNs + 5 * kMs) == JitterPush::Late);
+        CHECK(buffer.GetFrameCount() == 3);
+        CHECK(buffer.GetNextReleaseNs() <= base + kPeriodNs);
+
+        // The newest due frame goes out, passing over the two older ones
+        uint64_t waitedNs = 0, latencyNs = 0, skipped = 0;
+        const VideoFrame* due = buffer.Pop(base + 2 * kPeriodNs + 4 * kMs, waitedNs, latencyNs, skipped);
+        CHECK(due && due->data[0] == 2);
+        CHECK(skipped == 2);
+        CHECK(buffer.GetFrameCount() == 0);
+    }
+
+    // A jump of over a second in transit is a new stream: what was queued
+    // is dropped and measuring starts again from the new frame
+    void TransitJumpResets() {
+        JitterBuffer buffer;
+        int64_t i = 0;
+        for (; i < 50; i++) {
+            PushAt(buffer, i, (i % 2) * 8 * (int64_t)kMs);
+        }
+        CHECK(buffer.GetDelayNs() > 0);
+        Frame held(i * (int64_t)kPeriodNs, 1);
+        CHECK(buffer.Push(held.frame, 1000 * kMs + i * kPeriodNs) == JitterPush::Queued);
+        CHECK(buffer.GetFrameCount() >= 1);
+
+        Frame restarted(0, 7);
+        uint64_t arrivalNs = 1000 * kMs + (i + 1) * kPeriodNs + 1500 * kMs;
+        CHECK(buffer.Push(restarted.frame, arrivalNs) == JitterPush::Queued);
+        CHECK(buffer.GetFrameCount() == 1);
+        CHECK(buffer.GetDelayNs() == 0 && buffer.GetJitterNs() == 0);
+        uint64_t waitedNs = 0, latencyNs = 0, skipped = 0;
+        const VideoFrame* due = buffer.Pop(arrivalNs, waitedNs, latencyNs, skipped);
+        CHECK(due && due->data[0] == 7 && skipped == 0);
+    }
+}
+
+int main() {
+    RUN_TEST(EvenFramesGoOutInOrderWithTheirLatency);
+    RUN_TEST(OlderDueFramesArePassedOver);
+    RUN_TEST(DelayFollowsJitterThenDecays);
+    RUN_TEST(DelayNeverExceedsTheCap);
+    RUN_TEST(LateFrameIsReported);
+    RUN_TEST(ReorderedFrameDoesNotHoldBackDueFrames);
+    RUN_TEST(TransitJumpResets);
+    return TestResult();
+}
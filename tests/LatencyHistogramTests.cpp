@@ -0,0 +1,115 @@
+#include "LatencyHistogram.h"
+#include "TestCheck.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+    bool SameSnapshot(const HistogramSnapshot& a, const HistogramSnapshot& b) {
+        if (a.Count() != b.Count() || a.SumNs() != b.SumNs() || a.MaxNs() != b.MaxNs()) return false;
+        for (int i = 0; i < HistogramLayout::kBucketCount; i++) {
+            uint64_t high = HistogramLayout::BucketHigh(i);
+            if (a.CountAtOrBelow(high) != b.CountAtOrBelow(high)) return false;
+        }
+        return true;
+    }
+
+    std::vector<LatencyReport> MakeReports() {
+        std::vector<LatencyReport> reports;
+        const char* names[] = { "Camera 1", "", "Caf\xC3\xA9 \"Main\"" };
+        uint64_t x = 12345;
+        for (const char* name : names) {
+            LatencyHistogram histograms[(int)LatencyMetric::Count];
+            for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+                // Spread over the whole range, including 0 and the overflow bucket
+                for (int i = 0; i < 1000 * m; i++) {
+                    x = x * 6364136223846793005ull + 1442695040888963407ull;
+                    histograms[m].Record((x >> 20) >> (x % 40));
+                }
+                if (m == 1) histograms[m].Record(0);
+                if (m == 2) histograms[m].Record(1ull << 40);
+            }
+            LatencyReport report;
+            report.bridgeName = name;
+            for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+                report.metrics[m] = histograms[m].Snapshot();
+            }
+            reports.push_back(report);
+        }
+        return reports;
+    }
+
+    void ReportsRoundTrip() {
+        std::vector<LatencyReport> reports = MakeReports();
+        std::vector<uint8_t> data = EncodeLatencyReports(reports);
+        std::vector<LatencyReport> decoded;
+        CHECK(DecodeLatencyReports(data, decoded));
+        CHECK(decoded.size() == reports.size());
+        for (size_t r = 0; r < reports.size() && r < decoded.size(); r++) {
+            CHECK(decoded[r].bridgeName == reports[r].bridgeName);
+            for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+                CHECK(SameSnapshot(decoded[r].metrics[m], reports[r].metrics[m]));
+                CHECK(decoded[r].metrics[m].ValueAtPercentile(99.0) == reports[r].metrics[m].ValueAtPercentile(99.0));
+            }
+        }
+    }
+
+    void EmptyReportListRoundTrips() {
+        std::vector<LatencyReport> decoded(1);
+        CHECK(DecodeLatencyReports(EncodeLatencyReports({}), decoded));
+        CHECK(decoded.empty());
+    }
+
+    // Every truncation fails cleanly rather than reading past the end
+    void TruncatedDataIsRejected() {
+        std::vector<uint8_t> data = EncodeLatencyReports(MakeReports());
+        for (size_t size = 0; size < data.size(); size++) {
+            std::vector<uint8_t> part(data.begin(), data.begin() + size);
+            std::vector<LatencyReport> decoded;
+            if (DecodeLatencyReports(part, decoded)) {
+                CHECK(!"truncated data decoded");
+                break;
+            }
+        }
+    }
+
+    // Files from a build with another version or metric set are refused
+    void ForeignHeaderIsRejected() {
+        std::vector<uint8_t> data = EncodeLatencyReports(MakeReports());
+        std::vector<LatencyReport> decoded;
+        for (size_t byte = 0; byte < 8; byte++) {
+            std::vector<uint8_t> changed = data;
+            changed[byte] ^= 0x01;
+            CHECK(!DecodeLatencyReports(changed, decoded));
+        }
+
+        // Version 1 reports, from before the jitter buffer metric, are refused
+        std::vector<uint8_t> older = data;
+        older[4] = 1;
+        older[7] = (uint8_t)LatencyMetric::JitterBuffer;
+        CHECK(!DecodeLatencyReports(older, decoded));
+    }
+
+    void SinceAndMergeCountSamples() {
+        LatencyHistogram histogram;
+        for (uint64_t ns = 1000; ns < 2000; ns++) histogram.Record(ns);
+        HistogramSnapshot first = histogram.Snapshot();
+        for (uint64_t ns = 1000000; ns < 1000100; ns++) histogram.Record(ns);
+        HistogramSnapshot later = histogram.Snapshot().Since(first);
+        CHECK(later.Count() == 100);
+        CHECK(later.ValueAtPercentile(50.0) >= 1000000 * 97 / 100);
+
+        HistogramSnapshot merged = first;
+        merged.Merge(later);
+        CHECK(merged.Count() == 1100);
+        CHECK(merged.MaxNs() == 1000099);
+    }
+}
+
+int main() {
+    RUN_TEST(ReportsRoundTrip);
+    RUN_TEST(EmptyReportListRoundTrips);
+    RUN_TEST(TruncatedDataIsRejected);
+    RUN_TEST(ForeignHeaderIsRejected);
+    RUN_TEST(SinceAndMergeCountSamples);
+    return TestResult();
+}
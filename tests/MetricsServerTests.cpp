@@ -0,0 +1,258 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "MetricsServer.h"
+#include "TestCheck.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+#ifdef _WIN32
+    typedef SOCKET socket_t;
+    const socket_t kInvalidSocket = INVALID_SOCKET;
+    void CloseSocket(socket_t s) { closesocket(s); }
+#else
+    typedef int socket_t;
+    const socket_t kInvalidSocket = -1;
+    void CloseSocket(socket_t s) { close(s); }
+#endif
+
+    // Whole response to one request over 127.0.0.1; empty if the connection fails
+    std::string Fetch(uint16_t port, const std::string& request) {
+        socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (s == kInvalidSocket) return "";
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        std::string response;
+        if (connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            send(s, request.data(), (int)request.size(), 0);
+            char buffer[4096];
+            int received;
+            while ((received = recv(s, buffer, sizeof(buffer), 0)) > 0) {
+                response.append(buffer, received);
+            }
+        }
+        CloseSocket(s);
+        return response;
+    }
+
+    std::string Body(const std::string& response) {
+        size_t end = response.find("\r\n\r\n");
+        return end == std::string::npos ? "" : response.substr(end + 4);
+    }
+
+    std::vector<std::string> Lines(const std::string& text) {
+        std::vector<std::string> lines;
+        std::stringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) lines.push_back(line);
+        return lines;
+    }
+
+    bool StartsWith(const std::string& text, const std::string& prefix) {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    std::shared_ptr<BridgeMetrics> MakeBridge(const std::string& id, const std::string& name) {
+        auto metrics = std::make_shared<BridgeMetrics>();
+        metrics->bridgeId = id;
+        metrics->bridgeName = name;
+        metrics->sourceName = "Camera";
+        metrics->direction = "ndi_to_spout";
+        metrics->counters.AddFramesIn(120);
+        metrics->counters.AddFramesOut(118);
+        metrics->counters.AddDrops(2);
+        for (int m = 0; m < (int)LatencyMetric::Count; m++) {
+            for (uint64_t ns = 100000; ns < 3000000000ull; ns = ns * 3 / 2) {
+                metrics->latency[m].Record(ns);
+            }
+        }
+        return metrics;
+    }
+
+    struct Server {
+        MetricsServer server;
+        std::vector<std::shared_ptr<BridgeMetrics>> bridges;
+
+        Server() {
+            bridges.push_back(MakeBridge("a", "Stage \"A\""));
+            bridges.push_back(MakeBridge("b", "Stage B"));
+            for (const auto& bridge : bridges) MetricsRegistry::Register(bridge);
+        }
+        ~Server() {
+            server.Stop();
+            for (const auto& bridge : bridges) MetricsRegistry::Unregister(bridge.get());
+        }
+    };
+
+    void ServesMetricsOnAnyPort() {
+        Server fixture;
+        CHECK(fixture.server.Start(0));
+        CHECK(fixture.server.GetPort() != 0);
+
+        std::string response = Fetch(fixture.server.GetPort(), "GET /metrics HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+        CHECK(StartsWith(response, "HTTP/1.1 200 OK\r\n"));
+        CHECK(response.find("Content-Type: application/openmetrics-text; version=1.0.0") != std::string::npos);
+        std::string body = Body(response);
+        CHECK(body.size() > 6 && body.compare(body.size() - 6, 6, "# EOF\n") == 0);
+        CHECK(body.find("# EOF") == body.size() - 6);
+        CHECK(body.find("bridge=\"Stage \\\"A\\\"\"") != std::string::npos);
+        CHECK(body.find("ndispout_bridge_frames_out_total{bridge=\"Stage B\",bridge_id=\"b\",source=\"Camera\","
+                        "direction=\"ndi_to_spout\"} 118") != std::string::npos);
+    }
+
+    // OpenMetrics counters are exposed only as <family>_total samples
+    void CounterSamplesEndInTotal() {
+        Server fixture;
+        CHECK(fixture.server.Start(0));
+        std::vector<std::string> lines = Lines(Body(Fetch(fixture.server.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n")));
+        std::string family;
+        std::string type;
+        int counters = 0;
+        for (const std::string& line : lines) {
+            if (StartsWith(line, "# TYPE ")) {
+                std::stringstream stream(line.substr(7));
+                stream >> family >> type;
+                if (type == "counter") counters++;
+                continue;
+            }
+            if (StartsWith(line, "#") || type != "counter") continue;
+            std::string name = line.substr(0, line.find_first_of("{ "));
+            CHECK(name == family + "_total");
+        }
+        CHECK(counters >= 10);
+    }
+
+    // Per bridge and stage: buckets never decrease, +Inf is last and equals the count
+    void HistogramBucketsAreCumulative() {
+        Server fixture;
+        CHECK(fixture.server.Start(0));
+        std::vector<std::string> lines = Lines(Body(Fetch(fixture.server.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n")));
+
+        std::map<std::string, std::vector<std::pair<std::string, double>>> series;
+        std::map<std::string, double> counts;
+        const std::string bucket = "ndispout_bridge_latency_seconds_bucket{";
+        const std::string count = "ndispout_bridge_latency_seconds_count{";
+        for (const std::string& line : lines) {
+            if (StartsWith(line, bucket)) {
+                size_t le = line.find(",le=\"");
+                size_t close = line.find("\"}", le);
+                std::string labels = line.substr(bucket.size(), le - bucket.size());
+                std::string bound = line.substr(le + 5, close - le - 5);
+                series[labels].emplace_back(bound, atof(line.substr(close + 3).c_str()));
+            }
+            else if (StartsWith(line, count)) {
+                size_t close = line.rfind("} ");
+                counts[line.substr(count.size(), close - count.size())] = atof(line.substr(close + 2).c_str());
+            }
+        }
+
+        CHECK(series.size() == 2 * (size_t)LatencyMetric::Count);
+        for (const auto& entry : series) {
+            const auto& buckets = entry.second;
+            CHECK(buckets.size() > 2);
+            CHECK(!buckets.empty() && buckets.back().first == "+Inf");
+            for (size_t i = 1; i < buckets.size(); i++) {
+                CHECK(buckets[i].second >= buckets[i - 1].second);
+                if (buckets[i].first != "+Inf") {
+                    CHECK(atof(buckets[i].first.c_str()) > atof(buckets[i - 1].first.c_str()));
+                }
+            }
+            CHECK(counts.count(entry.first) && buckets.back().second == counts[entry.first]);
+            CHECK(buckets.front().second < buckets.back().second);   // Samples above the first bound exist
+        }
+    }
+
+    // What skipping unchanged frames and reusing clean tiles saved, from
+    // the bridge's own stage timings
+    void SavingsAreExported() {
+        auto metrics = std::make_shared<BridgeMetrics>();
+        metrics->bridgeName = "Overlay";
+        metrics->sourceName = "Camera";
+        metrics->direction = "spout_to_ndi";
+        BridgeCounters& counters = metrics->counters;
+        counters.AddFramesIn(40);
+        counters.AddDuplicates(30);
+        for (int i = 0; i < 10; i++) {
+            counters.RecordStage(PipelineStage::Convert, 2000000);
+            counters.RecordStage(PipelineStage::Send, 1000000);
+        }
+        counters.RecordStage(PipelineStage::Hash, 5000000);
+        counters.AddTiles(100, 25);
+        counters.AddPixels(1000, 3000);
+
+        // 30 skipped frames at 3 ms each, less 5 ms hashing; clean tiles at
+        // 20 ms per 1000 pixels converted
+        BridgeStats stats = counters.Snapshot();
+        CHECK(stats.DuplicatePercent() == 75.0);
+        CHECK(std::fabs(stats.DuplicateCpuSavedMs() - 85.0) < 1e-9);
+        CHECK(stats.DirtyTileRatio() == 0.25);
+        CHECK(std::fabs(stats.DirtyTileSavedMs() - 60.0) < 1e-9);
+        CHECK(BridgeStats().DuplicatePercent() == 0.0 && BridgeStats().DuplicateCpuSavedMs() == 0.0);
+        CHECK(BridgeStats().DirtyTileRatio() == 0.0 && BridgeStats().DirtyTileSavedMs() == 0.0);
+
+        std::string text = RenderOpenMetrics({ metrics }, 0.0);
+        const std::string labels = "{bridge=\"Overlay\",bridge_id=\"\",source=\"Camera\",direction=\"spout_to_ndi\"} ";
+        CHECK(text.find("ndispout_bridge_duplicate_percent" + labels + "75\n") != std::string::npos);
+        CHECK(text.find("ndispout_bridge_duplicate_cpu_saved_seconds" + labels + "0.085\n") != std::string::npos);
+        CHECK(text.find("ndispout_bridge_dirty_tile_ratio" + labels + "0.25\n") != std::string::npos);
+        CHECK(text.find("ndispout_bridge_dirty_tile_saved_seconds" + labels + "0.06\n") != std::string::npos);
+    }
+
+    // Bridges that share a name and source still get a series each, told
+    // apart by their ids
+    void SameNamedBridgesGetOwnSeries() {
+        std::string text = RenderOpenMetrics({ MakeBridge("one", "Stage"), MakeBridge("two", "Stage") }, 0.0);
+        std::map<std::string, int> samples;
+        for (const std::string& line : Lines(text)) {
+            if (StartsWith(line, "#")) continue;
+            samples[line.substr(0, line.rfind(' '))]++;
+        }
+        CHECK(!samples.empty());
+        for (const auto& sample : samples) {
+            CHECK(sample.second == 1);
+        }
+        CHECK(samples.count("ndispout_bridge_frames_out_total{bridge=\"Stage\",bridge_id=\"one\",source=\"Camera\","
+                            "direction=\"ndi_to_spout\"}") == 1);
+        CHECK(samples.count("ndispout_bridge_frames_out_total{bridge=\"Stage\",bridge_id=\"two\",source=\"Camera\","
+                            "direction=\"ndi_to_spout\"}") == 1);
+    }
+
+    void OtherRequestsAreRefused() {
+        Server fixture;
+        CHECK(fixture.server.Start(0));
+        CHECK(StartsWith(Fetch(fixture.server.GetPort(), "GET / HTTP/1.1\r\n\r\n"), "HTTP/1.1 404"));
+        CHECK(StartsWith(Fetch(fixture.server.GetPort(), "POST /metrics HTTP/1.1\r\n\r\n"), "HTTP/1.1 405"));
+    }
+}
+
+int main() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+    RUN_TEST(ServesMetricsOnAnyPort);
+    RUN_TEST(CounterSamplesEndInTotal);
+    RUN_TEST(HistogramBucketsAreCumulative);
+    RUN_TEST(SavingsAreExported);
+    RUN_TEST(SameNamedBridgesGetOwnSeries);
+    RUN_TEST(OtherRequestsAreRefused);
+    return TestResult();
+}
@@ -0,0 +1,111 @@
+#include "Platform.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace {
+    uint64_t SteadyNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // NowNs and steady_clock are one timeline, so bridge timestamps and frame
+    // timestamps can be compared directly
+    void NowNsIsTheSteadyClock() {
+        uint64_t before = SteadyNs();
+        uint64_t now = Platform::NowNs();
+        uint64_t after = SteadyNs();
+        CHECK(before <= now && now <= after);
+
+        uint64_t start = Platform::NowNs();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t elapsed = Platform::NowNs() - start;
+        CHECK(elapsed >= 20000000ull && elapsed < 2000000000ull);
+    }
+
+    void ProcessCpuTimeGrows() {
+        uint64_t start = Platform::ProcessCpuTimeNs();
+        volatile uint64_t sink = 0;
+        uint64_t until = Platform::NowNs() + 20000000ull;
+        while (Platform::NowNs() < until) sink = sink + 1;
+        CHECK(Platform::ProcessCpuTimeNs() > start);
+    }
+
+    void AutoResetEventReleasesOnce() {
+        Platform::Event event;
+        CHECK(!event.Wait(0));
+        event.Set();
+        CHECK(event.Wait(0));
+        CHECK(!event.Wait(0));
+
+        std::thread setter([&event] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            event.Set();
+        });
+        CHECK(event.Wait(5000));
+        setter.join();
+    }
+
+    void ManualResetEventStaysSet() {
+        Platform::Event event(true);
+        event.Set();
+        CHECK(event.Wait(0));
+        CHECK(event.Wait(0));
+        event.Reset();
+        CHECK(!event.Wait(10));
+    }
+
+    // Large pages are opt-in; either way the memory is usable and page aligned
+    void PagesAreAlignedAndWritable() {
+        CHECK(Platform::GetLargePageSize() == 0);
+        void* small = Platform::AllocatePages(100);
+        CHECK(small && (uintptr_t)small % 4096 == 0);
+        if (small) {
+            memset(small, 0xAB, 100);
+            Platform::FreePages(small, 100);
+        }
+
+        if (Platform::EnableLargePages()) {
+            CHECK(Platform::GetLargePageSize() >= 4096);
+        }
+        size_t bytes = 3840 * 2160 * 4;
+        Platform::FrameBuffer frame(bytes, 0x11);
+        CHECK(frame.size() == bytes && (uintptr_t)frame.data() % 4096 == 0);
+        CHECK(frame.front() == 0x11 && frame.back() == 0x11);
+        frame.resize(bytes * 2, 0x22);
+        CHECK(frame[bytes - 1] == 0x11 && frame.back() == 0x22);
+    }
+
+    void ThreadsCanBeNamedAndUnpinned() {
+        Platform::SetCurrentThreadName("PlatformTests worker with a long name");
+        CHECK(Platform::SetCurrentThreadAffinity(-1));
+    }
+
+    void ResourcesAreReported() {
+        Platform::ProcessResources resources = Platform::GetProcessResources();
+#ifdef __APPLE__
+        (void)resources;
+#else
+        CHECK(resources.residentBytes > 0);
+        CHECK(resources.threads >= 1);
+        CHECK(resources.handles >= 3);  // At least stdin, stdout and stderr
+
+        std::thread extra([] { std::this_thread::sleep_for(std::chrono::milliseconds(200)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(Platform::GetProcessResources().threads == resources.threads + 1);
+        extra.join();
+#endif
+    }
+}
+
+int main() {
+    RUN_TEST(NowNsIsTheSteadyClock);
+    RUN_TEST(ProcessCpuTimeGrows);
+    RUN_TEST(AutoResetEventReleasesOnce);
+    RUN_TEST(ManualResetEventStaysSet);
+    RUN_TEST(PagesAreAlignedAndWritable);
+    RUN_TEST(ThreadsCanBeNamedAndUnpinned);
+    RUN_TEST(ResourcesAreReported);
+    return TestResult();
+}
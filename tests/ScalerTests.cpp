@@ -0,0 +1,198 @@
+#include "Scaler.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    std::vector<unsigned char> Noise(size_t size, uint64_t seed) {
+        std::vector<unsigned char> bytes(size);
+        uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+        for (unsigned char& b : bytes) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            b = (unsigned char)x;
+        }
+        return bytes;
+    }
+
+    VideoFrame Frame(std::vector<unsigned char>& pixels, unsigned int width, unsigned int height, size_t strideBytes) {
+        VideoFrame frame;
+        frame.data = pixels.data();
+        frame.width = width;
+        frame.height = height;
+        frame.strideBytes = strideBytes;
+        return frame;
+    }
+
+    // The box average BoxScale promises, one output pixel at a time: the
+    // rounded integer mean of the source pixels from i * src / dst up to
+    // (i + 1) * src / dst, at least one
+    std::vector<unsigned char> ReferenceBoxScale(const VideoFrame& src, unsigned int dstWidth, unsigned int dstHeight) {
+        std::vector<unsigned char> out((size_t)dstWidth * dstHeight * 4);
+        for (unsigned int y = 0; y < dstHeight; y++) {
+            unsigned int top = (unsigned int)((uint64_t)y * src.height / dstHeight);
+            unsigned int bottom = std::max(top + 1, (unsigned int)((uint64_t)(y + 1) * src.height / dstHeight));
+            for (unsigned int x = 0; x < dstWidth; x++) {
+                unsigned int left = (unsigned int)((uint64_t)x * src.width / dstWidth);
+                unsigned int right = std::max(left + 1, (unsigned int)((uint64_t)(x + 1) * src.width / dstWidth));
+                uint64_t area = (uint64_t)(bottom - top) * (right - left);
+                for (int c = 0; c < 4; c++) {
+                    uint64_t sum = 0;
+                    for (unsigned int sy = top; sy < bottom; sy++) {
+                        for (unsigned int sx = left; sx < right; sx++) {
+                            sum += src.data[sy * src.strideBytes + sx * 4 + c];
+                        }
+                    }
+                    out[((size_t)y * dstWidth + x) * 4 + c] = (unsigned char)((sum + area / 2) / area);
+                }
+            }
+        }
+        return out;
+    }
+
+    // Scale src both ways and check each against the reference
+    void CheckBoxScale(const VideoFrame& src, unsigned int dstWidth, unsigned int dstHeight) {
+        std::vector<unsigned char> expected = ReferenceBoxScale(src, dstWidth, dstHeight);
+        std::vector<unsigned char> simd(expected.size()), scalar(expected.size());
+        CHECK(BoxScale(src, simd.data(), dstWidth, dstHeight, (size_t)dstWidth * 4));
+        CHECK(BoxScaleScalar(src, scalar.data(), dstWidth, dstHeight, (size_t)dstWidth * 4));
+        CHECK(simd == expected);
+        CHECK(scalar == expected);
+    }
+
+    // Every box area a 16-bit sum can hold, at the sums where the rounded
+    // mean steps up: (k * area - area / 2) and the one below, for every k.
+    // Each output pixel averages area pixels of a one-row frame, and its
+    // four channels carry four of the sums.
+    void BoxMeanIsExactForEveryArea() {
+        for (unsigned int area = 2; area <= 256; area++) {
+            std::vector<uint32_t> sums;
+            for (uint32_t k = 0; k <= 256; k++) {
+                for (uint32_t below = 0; below < 2; below++) {
+                    int64_t sum = (int64_t)k * area - area / 2 - below;
+                    if (sum >= 0 && sum <= 255 * (int64_t)area) sums.push_back((uint32_t)sum);
+                }
+            }
+            unsigned int dstWidth = (unsigned int)(sums.size() + 3) / 4;
+            unsigned int width = dstWidth * area;
+            std::vector<unsigned char> pixels((size_t)width * 4, 0);
+            for (size_t i = 0; i < sums.size(); i++) {
+                // sum spread over the box as full pixels, one partial, then zeros
+                size_t x = i / 4, c = i % 4;
+                uint32_t left = sums[i];
+                for (unsigned int p = 0; p < area && left > 0; p++) {
+                    unsigned char value = (unsigned char)std::min<uint32_t>(255, left);
+                    pixels[(x * area + p) * 4 + c] = value;
+                    left -= value;
+                }
+            }
+            CheckBoxScale(Frame(pixels, width, 1, (size_t)width * 4), dstWidth, 1);
+        }
+    }
+
+    // Shrinking, growing and mixed, with odd sizes, padded rows, and boxes
+    // both under and over the 256 pixels a 16-bit sum holds
+    void BoxScaleMatchesIntegerAverage() {
+        struct Case {
+            unsigned int srcWidth, srcHeight, dstWidth, dstHeight;
+        };
+        const Case cases[] = {
+            { 64, 48, 32, 24 }, { 67, 41, 13, 7 }, { 33, 17, 5, 3 }, { 17, 17, 1, 1 },
+            { 9, 5, 23, 11 }, { 7, 31, 19, 4 }, { 300, 200, 7, 5 }, { 1021, 3, 2, 3 },
+            { 1, 1, 3, 2 }, { 640, 360, 640, 360 },
+        };
+        for (const Case& c : cases) {
+            for (size_t padding : { (size_t)0, (size_t)12 }) {
+                size_t stride = (size_t)c.srcWidth * 4 + padding;
+                std::vector<unsigned char> pixels = Noise(stride * c.srcHeight, c.srcWidth * 31 + c.dstWidth);
+                CheckBoxScale(Frame(pixels, c.srcWidth, c.srcHeight, stride), c.dstWidth, c.dstHeight);
+            }
+        }
+
+        // Bright frames keep the 16-bit sums near their limit
+        std::vector<unsigned char> white((size_t)256 * 16 * 4, 255);
+        CheckBoxScale(Frame(white, 256, 16, 256 * 4), 16, 1);
+    }
+    const ScaleFilter kFilters[] = { ScaleFilter::Box, ScaleFilter::Bilinear, ScaleFilter::Lanczos };
+
+    // Each filter through the SSE2 and scalar kernels, on one thread and on
+    // stripes, shrinking and growing to odd sizes; all four must agree
+    void FilterKernelsMatchScalar() {
+        struct Case {
+            unsigned int srcWidth, srcHeight, dstWidth, dstHeight;
+        };
+        const Case cases[] = {
+            { 64, 48, 32, 24 }, { 67, 41, 13, 7 }, { 333, 177, 101, 61 }, { 9, 5, 23, 11 },
+            { 7, 31, 19, 4 }, { 3, 3, 97, 65 }, { 641, 359, 319, 181 }, { 2, 2, 2, 2 },
+        };
+        FrameScaler single(0), striped(3);
+        for (const Case& c : cases) {
+            size_t stride = (size_t)c.srcWidth * 4 + 8;
+            std::vector<unsigned char> pixels = Noise(stride * c.srcHeight, c.srcWidth * 7 + c.dstHeight);
+            VideoFrame src = Frame(pixels, c.srcWidth, c.srcHeight, stride);
+            size_t dstStride = (size_t)c.dstWidth * 4;
+            for (ScaleFilter filter : kFilters) {
+                std::vector<unsigned char> expected(dstStride * c.dstHeight), simd(expected.size());
+                std::vector<unsigned char> stripedSimd(expected.size()), stripedScalar(expected.size());
+                CHECK(single.ScaleScalar(src, filter, expected.data(), c.dstWidth, c.dstHeight, dstStride));
+                CHECK(single.Scale(src, filter, simd.data(), c.dstWidth, c.dstHeight, dstStride));
+                CHECK(striped.Scale(src, filter, stripedSimd.data(), c.dstWidth, c.dstHeight, dstStride));
+                CHECK(striped.ScaleScalar(src, filter, stripedScalar.data(), c.dstWidth, c.dstHeight, dstStride));
+                CHECK(simd == expected);
+                CHECK(stripedSimd == expected);
+                CHECK(stripedScalar == expected);
+            }
+        }
+    }
+
+    // Rescaling only the rows a change reaches gives the same frame as
+    // rescaling it all, while writing fewer rows
+    void DirtyRowsMatchFullRescale() {
+        const unsigned int srcWidth = 320, srcHeight = 180, dstWidth = 213, dstHeight = 121;
+        size_t stride = (size_t)srcWidth * 4;
+        size_t dstStride = (size_t)dstWidth * 4;
+        for (ScaleFilter filter : kFilters) {
+            for (int threads : { 0, 3 }) {
+                std::vector<unsigned char> pixels = Noise(stride * srcHeight, 5);
+                VideoFrame src = Frame(pixels, srcWidth, srcHeight, stride);
+                FrameScaler scaler(threads);
+                std::vector<unsigned char> kept(dstStride * dstHeight);
+                CHECK(scaler.Scale(src, filter, kept.data(), dstWidth, dstHeight, dstStride));
+                CHECK(scaler.GetRowsScaled() == dstHeight);
+
+                // Change two bands of source rows, one touching the bottom edge
+                std::vector<bool> dirtyRows(srcHeight, false);
+                for (unsigned int y = 0; y < srcHeight; y++) {
+                    if ((y >= 40 && y < 56) || y >= 172) {
+                        std::vector<unsigned char> row = Noise(stride, y + 100);
+                        std::copy(row.begin(), row.end(), pixels.begin() + y * stride);
+                        dirtyRows[y] = true;
+                    }
+                }
+                CHECK(scaler.Scale(src, filter, kept.data(), dstWidth, dstHeight, dstStride, &dirtyRows));
+                CHECK(scaler.GetRowsScaled() > 0 && scaler.GetRowsScaled() < dstHeight / 2);
+
+                std::vector<unsigned char> full(kept.size());
+                FrameScaler fresh(0);
+                CHECK(fresh.ScaleScalar(src, filter, full.data(), dstWidth, dstHeight, dstStride));
+                CHECK(kept == full);
+
+                // Nothing changed: nothing to write
+                std::vector<bool> clean(srcHeight, false);
+                CHECK(scaler.Scale(src, filter, kept.data(), dstWidth, dstHeight, dstStride, &clean));
+                CHECK(scaler.GetRowsScaled() == 0);
+                CHECK(kept == full);
+            }
+        }
+    }
+}
+
+int main() {
+    RUN_TEST(BoxMeanIsExactForEveryArea);
+    RUN_TEST(BoxScaleMatchesIntegerAverage);
+    RUN_TEST(FilterKernelsMatchScalar);
+    RUN_TEST(DirtyRowsMatchFullRescale);
+    return TestResult();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Minimal checks for the test executables. A failed CHECK prints the
+// expression and where it is and counts the failure; main returns
+// TestResult() so CTest sees the count as the exit status. No framework, so
+// the tests build wherever the engine does.
+
+#include <cstdio>
+
+namespace TestCheck {
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool Report(bool ok, const char* expression, const char* file, int line) {
+        if (!ok) {
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expression);
+            Failures()++;
+        }
+        return ok;
+    }
+}
+
+#define CHECK(expression) TestCheck::Report(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+// Run one test function, naming it in the output
+#define RUN_TEST(test)                                  \
+    do {                                                \
+        int before = TestCheck::Failures();             \
+        test();                                         \
+        printf("%s %s\n", TestCheck::Failures() == before ? "ok  " : "FAIL", #test); \
+    } while (0)
+
+inline int TestResult() {
+    if (TestCheck::Failures()) {
+        fprintf(stderr, "%d check(s) failed\n", TestCheck::Failures());
+        return 1;
+    }
+    return 0;
+}
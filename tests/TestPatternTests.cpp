@@ -0,0 +1,117 @@
+#include "TestPattern.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    // A rendered pattern frame in caller memory, rows padded when asked
+    struct PatternFrame {
+        std::vector<unsigned char> pixels;
+        VideoFrame frame;
+
+        PatternFrame(const char* sourceName, size_t padBytes = 0) {
+            PatternSettings settings;
+            std::string error;
+            CHECK(ParsePatternSourceName(sourceName, settings, error));
+            PatternGenerator generator(settings);
+            size_t rowBytes = generator.GetStrideBytes();
+            std::vector<unsigned char> tight(generator.GetFrameBytes());
+            generator.Render(tight.data(), 0);
+
+            frame.strideBytes = rowBytes + padBytes;
+            pixels.assign(frame.strideBytes * settings.height, 0x5A);
+            for (unsigned int y = 0; y < settings.height; y++) {
+                std::copy(tight.begin() + y * rowBytes, tight.begin() + (y + 1) * rowBytes,
+                          pixels.begin() + y * frame.strideBytes);
+            }
+            frame.data = pixels.data();
+            frame.width = settings.width;
+            frame.height = settings.height;
+            frame.format = settings.format;
+        }
+    };
+
+    FrameStamp Stamp(uint64_t sequence, uint64_t timestampNs) {
+        FrameStamp stamp;
+        stamp.sequence = sequence;
+        stamp.timestampNs = timestampNs;
+        return stamp;
+    }
+
+    void StampRoundTripsInEveryFormat() {
+        const char* const sources[] = { "pattern:noise,320x180,rgba", "pattern:noise,320x180,bgra",
+                                        "pattern:noise,320x180,uyvy", "pattern:bars,1921x1081,rgba" };
+        const FrameStamp written = Stamp(0x0123456789ABCDEFull, 0xFEDCBA9876543210ull);
+        for (const char* source : sources) {
+            PatternFrame image(source, 64);
+            CHECK(WriteFrameStamp(image.frame, written));
+            FrameStamp read;
+            CHECK(ReadFrameStamp(image.frame, read));
+            CHECK(read.sequence == written.sequence && read.timestampNs == written.timestampNs);
+
+            // The strip stops at the row end; padding beside it is untouched
+            size_t rowBytes = image.frame.strideBytes - 64;
+            CHECK(image.pixels[rowBytes] == 0x5A && image.pixels[image.frame.strideBytes - 1] == 0x5A);
+        }
+    }
+
+    void StampSurvivesRedBlueSwap() {
+        PatternFrame image("pattern:bars,640x360,rgba");
+        CHECK(WriteFrameStamp(image.frame, Stamp(42, 123456789)));
+        for (size_t i = 0; i < image.pixels.size(); i += 4) {
+            std::swap(image.pixels[i], image.pixels[i + 2]);
+        }
+        image.frame.format = PixelFormat::BGRA;
+        FrameStamp read;
+        CHECK(ReadFrameStamp(image.frame, read));
+        CHECK(read.sequence == 42 && read.timestampNs == 123456789);
+    }
+
+    void UnstampedAndDamagedFramesAreRejected() {
+        FrameStamp read;
+        PatternFrame plain("pattern:noise,320x180,rgba");
+        CHECK(!ReadFrameStamp(plain.frame, read));
+
+        // One flipped cell in the sequence fails the check bits
+        PatternFrame damaged("pattern:bars,320x180,rgba");
+        CHECK(WriteFrameStamp(damaged.frame, Stamp(7, 1000)));
+        unsigned int cellWidth = damaged.frame.width / 160;
+        unsigned char* cell = damaged.pixels.data() + (size_t)(17 * cellWidth) * 4;
+        for (unsigned int y = 0; y < kFrameStampRows; y++) {
+            for (unsigned int x = 0; x < cellWidth * 4; x++) {
+                cell[y * damaged.frame.strideBytes + x] ^= 0xFF;
+            }
+        }
+        CHECK(!ReadFrameStamp(damaged.frame, read));
+
+        // Too narrow for one pixel per bit
+        PatternFrame narrow("pattern:bars,158x90,rgba");
+        CHECK(!WriteFrameStamp(narrow.frame, Stamp(1, 1)));
+        CHECK(!ReadFrameStamp(narrow.frame, read));
+    }
+
+    void TrackerCountsGapsRepeatsAndReorders() {
+        StampTracker tracker;
+        CHECK(tracker.Observe(Stamp(5, 0)).missed == 0);
+        CHECK(tracker.Observe(Stamp(6, 0)).missed == 0);
+        CHECK(tracker.Observe(Stamp(9, 0)).missed == 2);
+        CHECK(tracker.Observe(Stamp(9, 0)).repeated);
+        StampTracker::Observation old = tracker.Observe(Stamp(8, 0));
+        CHECK(old.reordered && old.missed == 0);
+        CHECK(tracker.Observe(Stamp(10, 0)).missed == 0);
+
+        // After a reset the next frame starts a new run
+        tracker.Reset();
+        CHECK(tracker.Observe(Stamp(1, 0)).missed == 0);
+    }
+}
+
+int main() {
+    RUN_TEST(StampRoundTripsInEveryFormat);
+    RUN_TEST(StampSurvivesRedBlueSwap);
+    RUN_TEST(UnstampedAndDamagedFramesAreRejected);
+    RUN_TEST(TrackerCountsGapsRepeatsAndReorders);
+    return TestResult();
+}
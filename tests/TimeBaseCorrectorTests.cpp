@@ -0,0 +1,132 @@
+#include "BridgeInstance.h"
+#include "FakeBackend.h"
+#include "TestCheck.h"
+#include "TimeBaseCorrector.h"
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct DriftRun {
+        double driftPpm = 0.0;
+        uint64_t ticks = 0;
+        std::vector<uint64_t> repeats;    // Ticks that showed the last frame again
+        std::vector<uint64_t> drops;      // Ticks that passed a frame over
+    };
+
+    // Feed frames from a fake sender whose clock is ppm off ours through a
+    // corrector, on the arrival times the sender models rather than the
+    // wall clock, ticking the output whenever a tick falls due
+    DriftRun RunSender(double ppm, double jitterMs, uint64_t frames) {
+        FakeSourceSettings settings;
+        settings.width = 160;
+        settings.height = 90;
+        settings.frameRate = 60.0;
+        settings.clockDriftPpm = ppm;
+        settings.jitterMs = jitterMs;
+        settings.realTime = false;
+        FakeBackend backend(settings);
+        std::unique_ptr<FrameSource> source = backend.CreateSource(FrameEndpoint::NDI, "Camera", ReceiveSettings());
+        CHECK(source && source->Open());
+
+        DriftRun run;
+        TimeBaseSettings timeBaseSettings;
+        timeBaseSettings.enabled = true;
+        TimeBaseCorrector corrector(timeBaseSettings);
+        for (uint64_t i = 0; source && i < frames; i++) {
+            VideoFrame frame;
+            if (source->Capture(frame, 0) != CaptureResult::Frame) continue;
+            uint64_t arrivalNs = frame.timestampNs;
+            while (corrector.GetNextTickNs() != 0 && corrector.GetNextTickNs() <= arrivalNs) {
+                TimeBaseTick tick = corrector.Tick(corrector.GetNextTickNs());
+                if (tick.repeated) run.repeats.push_back(run.ticks);
+                if (tick.dropped) run.drops.push_back(run.ticks);
+                run.ticks++;
+            }
+            corrector.Push(frame, arrivalNs);
+            source->Release(frame);
+        }
+        run.driftPpm = corrector.GetDriftPpm();
+        return run;
+    }
+
+    // Ticks before the drift estimate and the lag have settled
+    const uint64_t kSettleTicks = 2000;
+
+    std::vector<uint64_t> Settled(const std::vector<uint64_t>& events) {
+        std::vector<uint64_t> settled;
+        for (uint64_t tick : events) {
+            if (tick >= kSettleTicks) settled.push_back(tick);
+        }
+        return settled;
+    }
+
+    // Once settled, corrections come evenly, one per 1/ppm frames: every
+    // ~1000 ticks at 1000 ppm
+    void CheckSpacing(const std::vector<uint64_t>& events, uint64_t ticks) {
+        std::vector<uint64_t> settled = Settled(events);
+        uint64_t expected = (ticks - kSettleTicks) / 1000;
+        CHECK(settled.size() + 2 >= expected && settled.size() <= expected + 2);
+        for (size_t i = 1; i < settled.size(); i++) {
+            uint64_t spacing = settled[i] - settled[i - 1];
+            CHECK(spacing >= 900 && spacing <= 1100);
+        }
+    }
+
+    void FastSenderDropsEvenly() {
+        DriftRun run = RunSender(1000.0, 2.0, 30000);
+        CHECK(std::fabs(run.driftPpm - 1000.0) < 50.0);
+        CHECK(Settled(run.repeats).empty());
+        CheckSpacing(run.drops, run.ticks);
+    }
+
+    void SlowSenderRepeatsEvenly() {
+        DriftRun run = RunSender(-1000.0, 2.0, 30000);
+        CHECK(std::fabs(run.driftPpm + 1000.0) < 50.0);
+        CHECK(Settled(run.drops).empty());
+        CheckSpacing(run.repeats, run.ticks);
+    }
+
+    void MatchedSenderNeedsNoCorrection() {
+        DriftRun run = RunSender(0.0, 2.0, 12000);
+        CHECK(std::fabs(run.driftPpm) < 50.0);
+        CHECK(Settled(run.drops).empty());
+        CHECK(Settled(run.repeats).empty());
+    }
+
+    // The same through a running bridge: the drift it reports for a
+    // real-time sender 1000 ppm fast, after the four one-second blocks the
+    // estimate needs
+    void BridgeReportsSenderDrift() {
+        FakeSourceSettings settings;
+        settings.width = 320;
+        settings.height = 180;
+        settings.frameRate = 60.0;
+        settings.clockDriftPpm = 1000.0;
+        auto backend = std::make_shared<FakeBackend>(settings);
+        BridgeOptions options;
+        options.shareCapture = false;
+        options.timeBase.enabled = true;
+        BridgeInstance bridge;
+        bridge.SetBackend(backend);
+        CHECK(bridge.Start("Camera", "Test Output", false, ColorSpace::BGRA, options));
+        for (int waited = 0; waited < 15000 && bridge.GetStats().clockDriftPpm == 0.0; waited += 100) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        BridgeStats stats = bridge.GetStats();
+        bridge.Stop();
+        CHECK(std::fabs(stats.clockDriftPpm - 1000.0) < 300.0);
+        CHECK(stats.framesOut > 0);
+    }
+}
+
+int main() {
+    RUN_TEST(FastSenderDropsEvenly);
+    RUN_TEST(SlowSenderRepeatsEvenly);
+    RUN_TEST(MatchedSenderNeedsNoCorrection);
+    RUN_TEST(BridgeReportsSenderDrift);
+    return TestResult();
+}
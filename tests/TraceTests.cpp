@@ -0,0 +1,144 @@
+#include "TestCheck.h"
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const uint64_t kRingCapacity = 16384;     // Events Trace keeps per thread
+
+    struct ExportedEvent {
+        std::string name;
+        char phase = 0;
+        uint64_t tid = 0;
+        uint64_t frame = 0;
+    };
+
+    std::string Field(const std::string& line, const std::string& key) {
+        size_t at = line.find("\"" + key + "\":");
+        if (at == std::string::npos) return "";
+        at += key.size() + 3;
+        if (line[at] == '"') return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+        return line.substr(at, line.find_first_of(",}", at) - at);
+    }
+
+    // The frame events of one export, in order; sets valid to whether the
+    // document is framed as the Chrome trace format expects
+    std::vector<ExportedEvent> Export(bool& valid) {
+        std::ostringstream out;
+        valid = Trace::WriteChromeJson(out);
+        std::string json = out.str();
+        const std::string head = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        valid = valid && json.compare(0, head.size(), head) == 0 && json.size() >= head.size() + 4 &&
+                json.compare(json.size() - 4, 4, "\n]}\n") == 0;
+
+        std::vector<ExportedEvent> events;
+        std::istringstream lines(json);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.empty() || line[0] != '{' || line == head) continue;
+            // Objects are comma separated, so only the last lacks one
+            if (line.back() == ',') line.pop_back();
+            else if (lines.peek() != ']') valid = false;
+            if (Field(line, "cat") != "frame") continue;
+            ExportedEvent event;
+            event.name = Field(line, "name");
+            event.phase = Field(line, "ph").empty() ? 0 : Field(line, "ph")[0];
+            event.tid = strtoull(Field(line, "tid").c_str(), nullptr, 10);
+            event.frame = strtoull(Field(line, "frame").c_str(), nullptr, 10);
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    // Event i of a run: the name and phase follow from the frame id, so a
+    // record mixing two writes shows up
+    void RecordEvent(uint64_t i) {
+        Trace::Event event = (Trace::Event)(i / 2 % (uint64_t)Trace::Event::Count);
+        if (i % 2 == 0) Trace::Begin(event, i);
+        else Trace::End(event, i);
+    }
+
+    bool Matches(const ExportedEvent& event) {
+        Trace::Event expected = (Trace::Event)(event.frame / 2 % (uint64_t)Trace::Event::Count);
+        return event.name == Trace::EventName(expected) && event.phase == (event.frame % 2 == 0 ? 'B' : 'E');
+    }
+
+    // Past capacity the ring wraps: the export holds the newest events in
+    // order, all but the slot the writer fills next
+    void WrappedRingExportsNewestEvents() {
+        Trace::SetEnabled(true);
+        Trace::Clear();
+        const uint64_t total = kRingCapacity * 2 + 100;
+        for (uint64_t i = 0; i < total; i++) {
+            RecordEvent(i);
+        }
+
+        bool valid = false;
+        std::vector<ExportedEvent> events = Export(valid);
+        CHECK(valid);
+        CHECK(events.size() == kRingCapacity - 1);
+        if (!events.empty()) {
+            CHECK(events.front().frame == total - (kRingCapacity - 1));
+            CHECK(events.back().frame == total - 1);
+        }
+        for (size_t i = 0; i < events.size(); i++) {
+            CHECK(Matches(events[i]));
+            CHECK(i == 0 || events[i].frame == events[i - 1].frame + 1);
+            CHECK(events[i].tid == events[0].tid);
+        }
+
+        // Clear hides everything recorded so far
+        Trace::Clear();
+        CHECK(Export(valid).empty() && valid);
+        Trace::SetEnabled(false);
+    }
+
+    // An export taken while a thread keeps writing never shows a record the
+    // writer was part way through
+    void ExportWhileWritingIsNeverTorn() {
+        Trace::SetEnabled(true);
+        Trace::Clear();
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> written(0);
+        std::thread writer([&] {
+            for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                RecordEvent(i);
+                written.store(i + 1, std::memory_order_relaxed);
+                // Pauses keep the writer from lapping the ring within one export
+                if (i % 1024 == 1023) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        while (written.load() < kRingCapacity * 2) {
+            std::this_thread::yield();
+        }
+
+        for (int round = 0; round < 20; round++) {
+            bool valid = false;
+            std::vector<ExportedEvent> events = Export(valid);
+            CHECK(valid);
+            CHECK(!events.empty() && events.size() < kRingCapacity);
+            for (size_t i = 0; i < events.size(); i++) {
+                if (!Matches(events[i]) || (i > 0 && events[i].frame != events[i - 1].frame + 1)) {
+                    CHECK(!"torn or out of order record");
+                    break;
+                }
+            }
+        }
+        stop = true;
+        writer.join();
+        Trace::Clear();
+        Trace::SetEnabled(false);
+    }
+}
+
+int main() {
+    RUN_TEST(WrappedRingExportsNewestEvents);
+    RUN_TEST(ExportWhileWritingIsNeverTorn);
+    return TestResult();
+}